@@ -0,0 +1,128 @@
+#include "AssetIO.h"
+#include "Bench.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 1ファイルのバイト数
+const size_t kFileSize = 1024 * 1024;
+
+// ファイルをページキャッシュから追い出す。追い出せなければfalse(Windowsとtmpfsでは追い出せない)
+bool EvictFromPageCache(const std::string& path) {
+#ifdef _WIN32
+	(void)path;
+	return false;
+#else
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	// 書き込み待ちのページは追い出せないので先に書き出す
+	fdatasync(fd);
+	bool evicted = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+	close(fd);
+	return evicted;
+#endif
+}
+
+// 読み込み側が中身を解析する代わりに、8バイトずつ全体を足す
+uint64_t Parse(const uint8_t* data, size_t size) {
+	uint64_t sum = 0;
+	for (size_t i = 0; i + 8 <= size; i += 8) {
+		uint64_t value;
+		std::memcpy(&value, data + i, 8);
+		sum += value;
+	}
+	return sum;
+}
+
+// 今までの読み込み方(ヒープのバッファに読んでから解析する)
+uint64_t LoadWithStream(const std::string& path) {
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	std::vector<uint8_t> buffer(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+	return Parse(buffer.data(), buffer.size());
+}
+
+// マップしてその場で解析する
+uint64_t LoadWithMap(const std::string& path) {
+	AssetView view = AssetIO::GetInstance()->Map(path);
+	return view ? Parse(view.GetData(), view.GetSize()) : 0;
+}
+
+// 全ファイルを読み、MB/sを返す。coldなら読む前にページキャッシュから追い出す
+template<typename Load> double Measure(const std::vector<std::string>& paths, bool cold, Load load) {
+	if (cold) {
+		for (const std::string& path : paths) {
+			EvictFromPageCache(path);
+		}
+	}
+	uint64_t checksum = 0;
+	Bench::Stopwatch stopwatch;
+	load(paths, checksum);
+	double milliseconds = stopwatch.GetMilliseconds();
+	Bench::DoNotOptimize(checksum);
+	return paths.size() * (kFileSize / (1024.0 * 1024.0)) / (milliseconds / 1000.0);
+}
+
+} // namespace
+
+BENCHMARK(AssetIO, ColdAndWarmLoad) {
+	// 起動直後(ページキャッシュに無い)と2回目以降(キャッシュ済み)で、ストリームで読む場合とマップしてその場で解析する場合を比べる
+	// tmpfsでは追い出せないので、作業ディレクトリ(ctestではビルドディレクトリ)に置く
+	const uint32_t fileCount = Bench::Iterations(64);
+	const std::filesystem::path directory = std::filesystem::current_path() / "AssetIOBench";
+	std::filesystem::create_directories(directory);
+	std::vector<std::string> paths;
+	std::vector<uint8_t> data(kFileSize);
+	uint32_t state = 1;
+	for (uint32_t i = 0; i < fileCount; ++i) {
+		for (uint8_t& value : data) {
+			state = state * 1664525u + 1013904223u;
+			value = static_cast<uint8_t>(state >> 24);
+		}
+		paths.push_back((directory / ("asset" + std::to_string(i) + ".bin")).string());
+		std::ofstream(paths.back(), std::ios::binary).write(reinterpret_cast<const char*>(data.data()), data.size());
+	}
+	bool canEvict = EvictFromPageCache(paths.front());
+	Bench::Report("page cache eviction", canEvict ? 1.0 : 0.0, canEvict ? "(cold runs drop the page cache first)" : "(unsupported, cold runs are warm)");
+
+	auto stream = [](const std::vector<std::string>& files, uint64_t& checksum) {
+		for (const std::string& path : files) {
+			checksum += LoadWithStream(path);
+		}
+	};
+	auto map = [](const std::vector<std::string>& files, uint64_t& checksum) {
+		for (const std::string& path : files) {
+			checksum += LoadWithMap(path);
+		}
+	};
+	// 全部に先読みを依頼してから順に解析する(起動時にまとめて読む場合)
+	auto prefetch = [](const std::vector<std::string>& files, uint64_t& checksum) {
+		std::vector<AssetView> views;
+		for (const std::string& path : files) {
+			views.push_back(AssetIO::GetInstance()->Prefetch(path));
+		}
+		for (const AssetView& view : views) {
+			checksum += Parse(view.GetData(), view.GetSize());
+		}
+	};
+	for (bool cold : {true, false}) {
+		std::string prefix = cold ? "cold " : "warm ";
+		Bench::Report((prefix + "stream").c_str(), Measure(paths, cold, stream), "MB/s");
+		Bench::Report((prefix + "map").c_str(), Measure(paths, cold, map), "MB/s");
+		Bench::Report((prefix + "map + prefetch").c_str(), Measure(paths, cold, prefetch), "MB/s");
+	}
+	Bench::Report("live mappings after run", AssetIO::GetInstance()->GetStatistics().liveMappings, "files");
+
+	std::filesystem::remove_all(directory);
+}
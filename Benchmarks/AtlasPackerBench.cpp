@@ -0,0 +1,70 @@
+#include "AtlasPacker.h"
+#include "Bench.h"
+#include <random>
+#include <string>
+
+namespace {
+
+// 矩形の集合の作り方
+struct SizeSet {
+	const char* name;
+	uint32_t count;
+	uint32_t minSize;
+	uint32_t maxSize;
+};
+
+// UIのアイコン、キャラクターのスプライト、大小の混ざったものを想定する
+const SizeSet kSizeSets[] = {
+    {"icons", 1000, 24, 48},
+    {"sprites", 300, 32, 192},
+    {"mixed", 500, 8, 256},
+};
+
+std::vector<AtlasPacker::Size> CreateSizes(const SizeSet& sizeSet) {
+	std::mt19937 random(11);
+	std::uniform_int_distribution<uint32_t> distribution(sizeSet.minSize, sizeSet.maxSize);
+	std::vector<AtlasPacker::Size> sizes(sizeSet.count);
+	for (AtlasPacker::Size& size : sizes) {
+		size.width = distribution(random);
+		size.height = distribution(random);
+	}
+	return sizes;
+}
+
+} // namespace
+
+BENCHMARK(AtlasPacker, EfficiencyAndBuildTime) {
+	// 2048四方のページに余白1で詰め、面積の利用率、ページ数、1回の詰め込みにかかる時間を出す
+	const uint32_t pageSize = 2048;
+	const uint32_t iterations = Bench::Iterations(50);
+	for (const SizeSet& sizeSet : kSizeSets) {
+		std::vector<AtlasPacker::Size> sizes = CreateSizes(sizeSet);
+		AtlasPacker::Result result;
+		Bench::Stopwatch stopwatch;
+		for (uint32_t i = 0; i < iterations; ++i) {
+			result = AtlasPacker::Pack(sizes, pageSize, pageSize, 1);
+			Bench::DoNotOptimize(result.pageCount);
+		}
+		double milliseconds = stopwatch.GetMilliseconds() / iterations;
+		std::string label = sizeSet.name;
+		Bench::Report((label + " efficiency").c_str(), result.efficiency * 100.0, "%");
+		Bench::Report((label + " pages").c_str(), result.pageCount, "pages");
+		Bench::Report((label + " pack time").c_str(), milliseconds, "ms");
+	}
+
+	// 詰めた後のページへの書き込み(余白の引き延ばしを含む)
+	std::vector<AtlasPacker::Size> sizes = CreateSizes(kSizeSets[1]);
+	AtlasPacker::Result result = AtlasPacker::Pack(sizes, pageSize, pageSize, 1);
+	std::vector<uint8_t> page(static_cast<size_t>(pageSize) * pageSize * 4);
+	std::vector<uint8_t> image(256 * 256 * 4, 128);
+	Bench::Stopwatch stopwatch;
+	for (uint32_t i = 0; i < iterations; ++i) {
+		for (const AtlasPacker::Placement& placement : result.placements) {
+			if (placement.page == 0) {
+				AtlasPacker::Blit(page.data(), pageSize, pageSize, image.data(), placement, 1);
+			}
+		}
+	}
+	Bench::DoNotOptimize(page[page.size() / 2]);
+	Bench::Report("sprites blit time (page 0)", stopwatch.GetMilliseconds() / iterations, "ms");
+}
@@ -0,0 +1,69 @@
+#include "AudioMixer.h"
+#include "Bench.h"
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 短い効果音(0.2秒の減衰する正弦波、44.1kHzモノラル)
+std::shared_ptr<const MixerSound> CreateImpactSound(uint32_t seed) {
+	const uint32_t frameCount = 44100 / 5;
+	PcmSound pcm;
+	pcm.format.formatTag = WaveFormat::kPcm;
+	pcm.format.channels = 1;
+	pcm.format.sampleRate = 44100;
+	pcm.format.bitsPerSample = 16;
+	pcm.format.blockAlign = 2;
+	pcm.format.avgBytesPerSec = 88200;
+	pcm.data.resize(frameCount * 2);
+	for (uint32_t i = 0; i < frameCount; ++i) {
+		double envelope = std::exp(-8.0 * i / frameCount);
+		int16_t sample = static_cast<int16_t>(20000.0 * envelope * std::sin(i * (0.05 + seed * 0.01)));
+		std::memcpy(&pcm.data[i * 2], &sample, 2);
+	}
+	return CreateMixerSound(pcm);
+}
+
+} // namespace
+
+BENCHMARK(AudioMixer, VoiceChurn) {
+	// 60fpsの1フレームごとに効果音をまとめて鳴らし、1フレーム分(800フレーム)を合成する。
+	// 鳴らす数を増やして枠(256)が埋まり、奪う(奪われた方を絞る)ようになったときの再生と合成の費用を見る
+	std::vector<std::shared_ptr<const MixerSound>> sounds;
+	for (uint32_t i = 0; i < 8; ++i) {
+		sounds.push_back(CreateImpactSound(i));
+	}
+	const uint32_t frameCount = Bench::Iterations(600);
+	const uint32_t framesPerUpdate = AudioMixer::kDefaultSampleRate / 60;
+	std::vector<float> output(framesPerUpdate * 2);
+	for (uint32_t playsPerFrame : {4u, 32u, 128u}) {
+		AudioMixer mixer;
+		double playMilliseconds = 0.0;
+		double mixMilliseconds = 0.0;
+		uint32_t random = 1;
+		for (uint32_t frame = 0; frame < frameCount; ++frame) {
+			Bench::Stopwatch playStopwatch;
+			for (uint32_t i = 0; i < playsPerFrame; ++i) {
+				random = random * 1664525u + 1013904223u;
+				float volume = 0.2f + (random >> 24) / 255.0f * 0.8f;
+				mixer.Play(sounds[random % sounds.size()], AudioMixer::Bus::kSfx, false, volume, 1.0f, static_cast<uint8_t>(random >> 28));
+			}
+			playMilliseconds += playStopwatch.GetMilliseconds();
+			Bench::Stopwatch mixStopwatch;
+			mixer.Mix(output.data(), framesPerUpdate);
+			mixMilliseconds += mixStopwatch.GetMilliseconds();
+		}
+		Bench::DoNotOptimize(static_cast<uint64_t>(output[0] * 1000.0f));
+
+		AudioMixer::Statistics statistics = mixer.GetStatistics();
+		std::string label = std::to_string(playsPerFrame) + " plays/frame";
+		Bench::Report((label + " play").c_str(), playMilliseconds * 1e6 / (static_cast<double>(frameCount) * playsPerFrame), "ns/play");
+		Bench::Report((label + " mix").c_str(), mixMilliseconds / frameCount, "ms/frame");
+		Bench::Report((label + " mix speed").c_str(), frameCount * 1000.0 / 60.0 / mixMilliseconds, "x realtime");
+		Bench::Report((label + " steals").c_str(), static_cast<double>(statistics.steals), "voices");
+		Bench::Report((label + " fade outs").c_str(), static_cast<double>(statistics.fadeOuts), "voices");
+		Bench::Report((label + " rejects").c_str(), static_cast<double>(statistics.rejects), "plays");
+	}
+}
@@ -0,0 +1,95 @@
+#include "AudioMixer.h"
+#include "AudioSpatializer.h"
+#include "Bench.h"
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace {
+
+const size_t kEmitterCount = 2000;
+// 60fps
+const float kDeltaTime = 1.0f / 60.0f;
+
+// 円を描いて動く発音体(半径と速さを発音体ごとに変える)
+void MoveEmitters(AudioSpatializer& spatializer, uint32_t frame) {
+	for (size_t i = 0; i < kEmitterCount; ++i) {
+		float radius = 5.0f + static_cast<float>(i % 100) * 1.5f;
+		float angularSpeed = 0.2f + static_cast<float>(i % 13) * 0.1f;
+		float angle = static_cast<float>(i) + frame * kDeltaTime * angularSpeed;
+		float position[3] = {radius * std::cos(angle), static_cast<float>(i % 5), radius * std::sin(angle)};
+		float velocity[3] = {-radius * angularSpeed * std::sin(angle), 0.0f, radius * angularSpeed * std::cos(angle)};
+		spatializer.SetEmitter(i, position, velocity, 2.0f, 60.0f);
+	}
+}
+
+} // namespace
+
+BENCHMARK(AudioSpatializer, Emitters2000) {
+	// SpatialAudio::Updateと同じ流れ(発音体の更新、まとめて計算、聞こえるもののボイスの更新と合成)をエンジン無しで回す
+	const uint32_t frameCount = Bench::Iterations(600);
+	AudioSpatializer::Listener listener;
+	AudioSpatializer spatializer;
+	spatializer.Resize(kEmitterCount);
+	MoveEmitters(spatializer, 0);
+
+	// 計算だけ(SIMDと1つずつ)
+	for (bool simd : {true, false}) {
+		Bench::Stopwatch stopwatch;
+		for (uint32_t frame = 0; frame < frameCount; ++frame) {
+			if (simd) {
+				spatializer.Process(listener);
+			} else {
+				spatializer.ProcessScalar(listener);
+			}
+			Bench::DoNotOptimize(static_cast<uint64_t>(spatializer.GetPitch(frame % kEmitterCount) * 1000.0f));
+		}
+		double microseconds = stopwatch.GetMilliseconds() * 1000.0 / frameCount;
+		std::string label = simd ? "process simd" : "process scalar";
+		Bench::Report(label.c_str(), microseconds, "us/frame");
+		Bench::Report((label + " throughput").c_str(), kEmitterCount / microseconds, "emitters/us");
+	}
+
+	// 発音体ごとにループするボイスを1つ鳴らし、聞こえるものだけ毎フレーム音量・定位・再生速度を送る
+	PcmSound pcm;
+	pcm.format.formatTag = WaveFormat::kPcm;
+	pcm.format.channels = 1;
+	pcm.format.sampleRate = 48000;
+	pcm.format.bitsPerSample = 16;
+	pcm.format.blockAlign = 2;
+	pcm.format.avgBytesPerSec = 96000;
+	pcm.data.assign(48000 * 2, 0);
+	std::shared_ptr<const MixerSound> sound = CreateMixerSound(pcm);
+	AudioMixer mixer(AudioMixer::kDefaultSampleRate, static_cast<uint32_t>(kEmitterCount));
+	std::vector<uint32_t> voices(kEmitterCount);
+	for (uint32_t& voice : voices) {
+		voice = mixer.Play(sound, AudioMixer::Bus::kSfx, true, 0.0f);
+	}
+	std::vector<float> output(AudioMixer::kDefaultSampleRate / 60 * 2);
+	std::vector<bool> audible(kEmitterCount, false);
+	uint64_t audibleTotal = 0;
+	double updateMilliseconds = 0.0;
+	double mixMilliseconds = 0.0;
+	for (uint32_t frame = 0; frame < frameCount; ++frame) {
+		Bench::Stopwatch updateStopwatch;
+		MoveEmitters(spatializer, frame);
+		spatializer.Process(listener);
+		for (size_t i = 0; i < kEmitterCount; ++i) {
+			if (spatializer.IsAudible(i)) {
+				mixer.SetParameters(voices[i], spatializer.GetGain(i), spatializer.GetPan(i), spatializer.GetPitch(i));
+				++audibleTotal;
+			} else if (audible[i]) {
+				mixer.SetVolume(voices[i], 0.0f);
+			}
+			audible[i] = spatializer.IsAudible(i);
+		}
+		updateMilliseconds += updateStopwatch.GetMilliseconds();
+		Bench::Stopwatch mixStopwatch;
+		mixer.Mix(output.data(), AudioMixer::kDefaultSampleRate / 60);
+		mixMilliseconds += mixStopwatch.GetMilliseconds();
+	}
+	Bench::Report("audible emitters", static_cast<double>(audibleTotal) / frameCount, "emitters/frame");
+	Bench::Report("update (move + process + voice parameters)", updateMilliseconds * 1000.0 / frameCount, "us/frame");
+	Bench::Report("mix", mixMilliseconds / frameCount, "ms/frame");
+	Bench::Report("virtual voices", mixer.GetStatistics().virtualVoices, "voices");
+}
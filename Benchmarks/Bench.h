@@ -0,0 +1,62 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// 最小限のベンチマークの仕組み(Tests/Test.hと同じ作り)
+/// BENCHMARK(スイート名, 名前)で関数を登録し、Bench::Reportで結果を1行ずつ出す
+/// </summary>
+namespace Bench {
+
+/// <summary>
+/// 登録されたベンチマーク
+/// </summary>
+struct BenchmarkCase {
+	const char* suite;
+	const char* name;
+	void (*function)();
+};
+
+// 登録されたベンチマークの一覧
+std::vector<BenchmarkCase>& GetBenchmarkCases();
+
+// 短く回すか(--quick。ctestでの動作確認用で、数値は参考にならない)
+bool IsQuick();
+
+// 繰り返し回数(短く回すときは1/10、最低1)
+uint32_t Iterations(uint32_t count);
+
+// 結果を"[スイート.名前] 項目: 値 単位"の形で出す
+void Report(const char* label, double value, const char* unit);
+
+/// <summary>
+/// 静的変数の初期化でベンチマークを登録する
+/// </summary>
+struct Registrar {
+	Registrar(const char* suite, const char* name, void (*function)()) { GetBenchmarkCases().push_back({suite, name, function}); }
+};
+
+/// <summary>
+/// 経過時間の計測
+/// </summary>
+class Stopwatch {
+public:
+	Stopwatch() : start_(std::chrono::steady_clock::now()) {}
+	// 計測開始からのミリ秒
+	double GetMilliseconds() const { return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count(); }
+
+private:
+	std::chrono::steady_clock::time_point start_;
+};
+
+// 計算結果を使ったことにして、最適化で処理ごと消されないようにする
+void DoNotOptimize(uint64_t value);
+
+} // namespace Bench
+
+#define BENCHMARK(suite, name)                                                                                                                                                                         \
+	static void suite##_##name();                                                                                                                                                                      \
+	static const Bench::Registrar suite##_##name##_registrar(#suite, #name, &suite##_##name);                                                                                                         \
+	static void suite##_##name()
@@ -0,0 +1,52 @@
+#include "Bench.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+namespace Bench {
+
+namespace {
+// 実行中のベンチマーク
+const BenchmarkCase* currentCase = nullptr;
+bool quick = false;
+std::atomic<uint64_t> sink = 0;
+} // namespace
+
+std::vector<BenchmarkCase>& GetBenchmarkCases() {
+	static std::vector<BenchmarkCase> benchmarkCases;
+	return benchmarkCases;
+}
+
+bool IsQuick() { return quick; }
+
+uint32_t Iterations(uint32_t count) { return quick ? (count / 10 > 0 ? count / 10 : 1) : count; }
+
+void Report(const char* label, double value, const char* unit) { std::printf("[%s.%s] %s: %.3f %s\n", currentCase->suite, currentCase->name, label, value, unit); }
+
+void DoNotOptimize(uint64_t value) { sink.fetch_xor(value, std::memory_order_relaxed); }
+
+} // namespace Bench
+
+// 引数にスイート名を与えるとそのスイートだけを実行する。--quickで繰り返しを減らす
+int main(int argc, char* argv[]) {
+	const char* suite = nullptr;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--quick") == 0) {
+			Bench::quick = true;
+		} else {
+			suite = argv[i];
+		}
+	}
+	uint32_t runCount = 0;
+	for (const Bench::BenchmarkCase& benchmarkCase : Bench::GetBenchmarkCases()) {
+		if (suite != nullptr && std::strcmp(suite, benchmarkCase.suite) != 0) {
+			continue;
+		}
+		Bench::currentCase = &benchmarkCase;
+		benchmarkCase.function();
+		++runCount;
+	}
+	std::printf("%u benchmarks\n", runCount);
+	// スイート名の綴り間違いで何も実行されないのは失敗にする
+	return runCount == 0 ? 1 : 0;
+}
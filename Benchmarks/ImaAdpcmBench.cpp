@@ -0,0 +1,109 @@
+#include "Bench.h"
+#include "ImaAdpcm.h"
+#include "PcmSound.h"
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 44.1kHzステレオ、1ブロック2048バイト(チャンネルあたり2041サンプル)
+const uint32_t kSampleRate = 44100;
+const uint16_t kBlockAlign = 2048;
+
+WaveFormat MakeAdpcmFormat() {
+	WaveFormat format;
+	format.formatTag = WaveFormat::kImaAdpcm;
+	format.channels = 2;
+	format.sampleRate = kSampleRate;
+	format.bitsPerSample = 4;
+	format.blockAlign = kBlockAlign;
+	format.avgBytesPerSec = kSampleRate * kBlockAlign / GetImaAdpcmSamplesPerBlock(format);
+	return format;
+}
+
+// 雑音に近いADPCMのデータ(ヘッダのステップ位置は範囲内にする)
+std::vector<uint8_t> CreateAdpcmData(uint32_t blockCount) {
+	std::vector<uint8_t> data(static_cast<size_t>(blockCount) * kBlockAlign);
+	uint32_t state = 5;
+	for (size_t i = 0; i < data.size(); ++i) {
+		state = state * 1664525u + 1013904223u;
+		data[i] = static_cast<uint8_t>(state >> 24);
+		if (i % kBlockAlign == 2 || i % kBlockAlign == 6) {
+			data[i] %= 89;
+		}
+	}
+	return data;
+}
+
+// 音源を終端まで4KiBずつ読む(ストリーミング再生と同じ読み方)。読んだバイト数を返す
+uint64_t Drain(AudioStreamSource& source) {
+	std::vector<uint8_t> buffer(4096);
+	uint64_t bytes = 0;
+	uint64_t checksum = 0;
+	while (size_t read = source.Read(buffer.data(), buffer.size())) {
+		bytes += read;
+		checksum += buffer[0];
+	}
+	Bench::DoNotOptimize(checksum);
+	return bytes;
+}
+
+} // namespace
+
+BENCHMARK(ImaAdpcm, DecodeVersusPcm) {
+	// 同じ長さのIMA-ADPCMとリニアPCMのWAVで、読み込み時デコード(LoadPcmSound)とストリーミング(OpenSoundStream)の時間とメモリを比べる
+	const uint32_t seconds = Bench::IsQuick() ? 2 : 60;
+	const WaveFormat adpcmFormat = MakeAdpcmFormat();
+	const uint32_t samplesPerBlock = GetImaAdpcmSamplesPerBlock(adpcmFormat);
+	const uint32_t blockCount = seconds * kSampleRate / samplesPerBlock;
+	std::vector<uint8_t> adpcm = CreateAdpcmData(blockCount);
+	std::vector<int16_t> decoded;
+	DecodeImaAdpcm(adpcmFormat, adpcm.data(), adpcm.size(), decoded);
+
+	const std::filesystem::path directory = std::filesystem::current_path();
+	const std::string adpcmPath = (directory / "ImaAdpcmBench.adpcm.wav").string();
+	const std::string pcmPath = (directory / "ImaAdpcmBench.pcm.wav").string();
+	WriteWaveFile(adpcmPath, adpcmFormat, adpcm.data(), adpcm.size());
+	WriteWaveFile(pcmPath, MakeImaAdpcmOutputFormat(adpcmFormat), decoded.data(), decoded.size() * sizeof(int16_t));
+	const double audioMilliseconds = static_cast<double>(decoded.size() / 2) * 1000.0 / kSampleRate;
+
+	// デコードだけの速さ(メモリ上の全ブロック)
+	const uint32_t repeat = Bench::Iterations(20);
+	Bench::Stopwatch decodeStopwatch;
+	for (uint32_t i = 0; i < repeat; ++i) {
+		DecodeImaAdpcm(adpcmFormat, adpcm.data(), adpcm.size(), decoded);
+		Bench::DoNotOptimize(static_cast<uint64_t>(decoded[decoded.size() / 2]));
+	}
+	double decodeMilliseconds = decodeStopwatch.GetMilliseconds() / repeat;
+	Bench::Report("block decode", decoded.size() / 2 / (decodeMilliseconds * 1000.0), "Msamples/s");
+	Bench::Report("block decode speed", audioMilliseconds / decodeMilliseconds, "x realtime");
+
+	for (const std::string& path : {adpcmPath, pcmPath}) {
+		std::string label = path == adpcmPath ? "adpcm " : "pcm ";
+		Bench::Report((label + "file").c_str(), std::filesystem::file_size(path) / 1024.0, "KiB");
+
+		// 読み込み時デコード。再生中に持つメモリはデコード後のPCM
+		PcmSound sound;
+		Bench::Stopwatch loadStopwatch;
+		for (uint32_t i = 0; i < repeat; ++i) {
+			LoadPcmSound(path, sound);
+		}
+		Bench::Report((label + "load").c_str(), loadStopwatch.GetMilliseconds() / repeat, "ms");
+		Bench::Report((label + "loaded memory").c_str(), sound.data.size() / 1024.0, "KiB");
+
+		// ストリーミング。再生中に持つメモリはデコーダのブロックとデコード済みの1ブロック分だけ
+		Bench::Stopwatch streamStopwatch;
+		for (uint32_t i = 0; i < repeat; ++i) {
+			std::unique_ptr<AudioStreamSource> source = OpenSoundStream(path);
+			Drain(*source);
+		}
+		double streamMilliseconds = streamStopwatch.GetMilliseconds() / repeat;
+		Bench::Report((label + "stream").c_str(), streamMilliseconds, "ms");
+		Bench::Report((label + "stream speed").c_str(), audioMilliseconds / streamMilliseconds, "x realtime");
+	}
+	Bench::Report("adpcm stream decoder memory", (kBlockAlign + samplesPerBlock * 2 * sizeof(int16_t)) / 1024.0, "KiB");
+
+	std::filesystem::remove(adpcmPath);
+	std::filesystem::remove(pcmPath);
+}
@@ -0,0 +1,63 @@
+#include "Bench.h"
+#include "SlotAllocator.h"
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 比較用の空きリスト(解放した番号を積み、割り当てで取り出す)
+class FreeListAllocator {
+public:
+	uint32_t Allocate() {
+		if (freeSlots_.empty()) {
+			return nextSlot_++;
+		}
+		uint32_t slot = freeSlots_.back();
+		freeSlots_.pop_back();
+		return slot;
+	}
+	void Free(uint32_t slot) { freeSlots_.push_back(slot); }
+
+private:
+	std::vector<uint32_t> freeSlots_;
+	uint32_t nextSlot_ = 0;
+};
+
+// 半分埋めた状態から、乱数で選んだ番号の解放と割り当てを繰り返す。1操作あたりのナノ秒を返す
+template<typename Allocator> double MeasureChurn(uint32_t liveCount, uint32_t operationCount) {
+	Allocator allocator;
+	std::vector<uint32_t> live;
+	for (uint32_t i = 0; i < liveCount; ++i) {
+		live.push_back(allocator.Allocate());
+	}
+	std::mt19937 random(1);
+	// 乱数の生成を計測に含めないよう先に作っておく
+	std::vector<uint32_t> picks(operationCount);
+	for (uint32_t& pick : picks) {
+		pick = random() % liveCount;
+	}
+	uint64_t checksum = 0;
+	Bench::Stopwatch stopwatch;
+	for (uint32_t pick : picks) {
+		allocator.Free(live[pick]);
+		live[pick] = allocator.Allocate();
+		checksum += live[pick];
+	}
+	double milliseconds = stopwatch.GetMilliseconds();
+	Bench::DoNotOptimize(checksum);
+	return milliseconds * 1e6 / (operationCount * 2.0);
+}
+
+} // namespace
+
+BENCHMARK(SlotAllocator, Churn) {
+	// 番号を小さい順に詰める代わりにどれだけ遅いかを、空きリストと比べる
+	const uint32_t operationCount = Bench::Iterations(2000000);
+	for (uint32_t liveCount : {1000u, 10000u, 100000u}) {
+		std::string label = std::to_string(liveCount) + " live";
+		Bench::Report((label + " bitmap").c_str(), MeasureChurn<SlotAllocator>(liveCount, operationCount), "ns/op");
+		Bench::Report((label + " free list").c_str(), MeasureChurn<FreeListAllocator>(liveCount, operationCount), "ns/op");
+	}
+}
@@ -0,0 +1,85 @@
+#include "BatchSprite.h"
+#include "Bench.h"
+#include "NullRenderDevice.h"
+#include "SpriteBatch.h"
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace {
+
+const uint32_t kSpriteCount = 10000;
+const uint32_t kTextureCount = 4;
+
+// 画面内に並べたスプライト(テクスチャとブレンドモードを混ぜる)
+SpriteBatch::SpriteDesc MakeSprite(uint32_t index) {
+	SpriteBatch::SpriteDesc sprite;
+	sprite.textureHandle = 1 + index % kTextureCount;
+	sprite.position = {static_cast<float>(index * 37 % 1264), static_cast<float>(index * 53 % 704)};
+	sprite.size = {16.0f, 16.0f};
+	sprite.rotation = static_cast<float>(index % 360) * 0.0174533f;
+	sprite.anchorPoint = {0.5f, 0.5f};
+	sprite.blendMode = index % 8 != 0 ? RenderBlendMode::kNormal : RenderBlendMode::kAdd;
+	return sprite;
+}
+
+// 1フレームの溜めてから描画の記録までを計測し、1ミリ秒あたりのスプライト数を報告する
+// (resident: BatchSpriteを使い、毎フレーム1/changeEvery枚だけ動かす)
+void MeasureFrames(const char* label, SpriteBatch::Mode mode, bool resident, uint32_t changeEvery) {
+	NullRenderDevice device;
+	for (uint32_t textureHandle = 1; textureHandle <= kTextureCount; ++textureHandle) {
+		device.SetTextureSize(textureHandle, 64, 64);
+	}
+	SpriteBatch batch(&device, kSpriteCount, mode);
+	std::vector<SpriteBatch::SpriteDesc> descs(kSpriteCount);
+	std::vector<BatchSprite> sprites;
+	sprites.reserve(kSpriteCount);
+	for (uint32_t i = 0; i < kSpriteCount; ++i) {
+		descs[i] = MakeSprite(i);
+		sprites.emplace_back(descs[i]);
+	}
+
+	const uint32_t frameCount = Bench::Iterations(300);
+	double milliseconds = 0.0;
+	uint64_t drawn = 0;
+	for (uint32_t frame = 0; frame < frameCount; ++frame) {
+		// 動かす分の更新は描画の前に済ませ、計測に含めない
+		float offset = std::sin(static_cast<float>(frame) * 0.1f);
+		for (uint32_t i = frame % changeEvery; i < kSpriteCount; i += changeEvery) {
+			KamataEngine::Vector2 position = {MakeSprite(i).position.x + offset, MakeSprite(i).position.y};
+			descs[i].position = position;
+			if (resident) {
+				sprites[i].SetPosition(position);
+			}
+		}
+
+		device.BeginFrame();
+		Bench::Stopwatch stopwatch;
+		batch.Begin();
+		for (uint32_t i = 0; i < kSpriteCount; ++i) {
+			if (resident) {
+				batch.Draw(sprites[i]);
+			} else {
+				batch.Draw(descs[i]);
+			}
+		}
+		batch.End();
+		milliseconds += stopwatch.GetMilliseconds();
+		device.EndFrame();
+		drawn += batch.GetStatistics().sprites;
+	}
+	Bench::DoNotOptimize(drawn);
+	Bench::Report((std::string(label) + " throughput").c_str(), static_cast<double>(drawn) / milliseconds, "sprites/ms");
+	Bench::Report((std::string(label) + " frame").c_str(), milliseconds * 1000.0 / frameCount, "us/frame");
+}
+
+} // namespace
+
+BENCHMARK(SpriteBatch, SpritesPerMillisecond) {
+	// 10000枚を毎フレーム描く。描画命令はNullRenderDeviceが受けるので、GPUを使わずCPU側の処理だけを測る
+	MeasureFrames("vertex", SpriteBatch::Mode::kVertex, false, 1);
+	MeasureFrames("instanced", SpriteBatch::Mode::kInstanced, false, 1);
+	// 常駐スプライトで1割だけ動かす(変わったものだけ作り直す)
+	MeasureFrames("vertex resident", SpriteBatch::Mode::kVertex, true, 10);
+	MeasureFrames("instanced resident", SpriteBatch::Mode::kInstanced, true, 10);
+}
@@ -0,0 +1,81 @@
+#include "Bench.h"
+#include "Lz4.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <string>
+#include <thread>
+
+namespace {
+
+// 1枚のテクスチャの幅と高さ
+const uint32_t kTextureSize = 256;
+
+// PNGの展開の代わりに、LZ4で縮めたRGBA8の画像を用意する(なだらかな模様と細かい雑音を混ぜて、縮みすぎないようにする)
+std::vector<uint8_t> CreateCompressedTexture(uint32_t seed) {
+	std::vector<uint8_t> pixels(static_cast<size_t>(kTextureSize) * kTextureSize * 4);
+	uint32_t state = seed * 2654435761u + 1;
+	for (size_t i = 0; i < pixels.size(); ++i) {
+		state = state * 1664525u + 1013904223u;
+		pixels[i] = static_cast<uint8_t>((i / 4 % kTextureSize) + ((state >> 29) & 3));
+	}
+	std::vector<uint8_t> compressed(LZ4CompressBound(pixels.size()));
+	compressed.resize(LZ4Compress(pixels.data(), pixels.size(), compressed.data(), compressed.size()));
+	return compressed;
+}
+
+// ワーカーで行う読み込み1枚分(展開とミップマップの生成)。結果の要約を返す
+uint64_t DecodeTexture(const std::vector<uint8_t>& compressed) {
+	std::vector<uint8_t> level(static_cast<size_t>(kTextureSize) * kTextureSize * 4);
+	if (!LZ4Decompress(compressed.data(), compressed.size(), level.data(), level.size())) {
+		return 0;
+	}
+	uint64_t checksum = 0;
+	for (uint32_t size = kTextureSize; size > 1; size /= 2) {
+		uint32_t half = size / 2;
+		std::vector<uint8_t> next(static_cast<size_t>(half) * half * 4);
+		for (uint32_t y = 0; y < half; ++y) {
+			for (uint32_t x = 0; x < half; ++x) {
+				for (uint32_t c = 0; c < 4; ++c) {
+					size_t top = (static_cast<size_t>(y) * 2 * size + x * 2) * 4 + c;
+					uint32_t sum = level[top] + level[top + 4] + level[top + size * 4] + level[top + size * 4 + 4];
+					next[(static_cast<size_t>(y) * half + x) * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+				}
+			}
+		}
+		checksum += next[0];
+		level.swap(next);
+	}
+	return checksum;
+}
+
+} // namespace
+
+BENCHMARK(ThreadPool, TextureDecodeScaling) {
+	// AsyncTextureLoaderと同じく1枚1ジョブで投入し、スレッド数を変えたときの処理量を比べる
+	const uint32_t textureCount = Bench::Iterations(256);
+	std::vector<std::vector<uint8_t>> textures;
+	for (uint32_t i = 0; i < 8; ++i) {
+		textures.push_back(CreateCompressedTexture(i));
+	}
+
+	const uint32_t hardwareThreads = (std::max)(std::thread::hardware_concurrency(), 1u);
+	Bench::Report("hardware threads", hardwareThreads, "threads");
+	double baseline = 0.0;
+	for (uint32_t threadCount = 1; threadCount <= (std::max)(hardwareThreads, 8u); threadCount *= 2) {
+		ThreadPool pool;
+		pool.Start(threadCount);
+		Bench::Stopwatch stopwatch;
+		for (uint32_t i = 0; i < textureCount; ++i) {
+			const std::vector<uint8_t>& texture = textures[i % textures.size()];
+			pool.Submit([&texture]() { Bench::DoNotOptimize(DecodeTexture(texture)); });
+		}
+		pool.WaitIdle();
+		double texturesPerSecond = textureCount / (stopwatch.GetMilliseconds() / 1000.0);
+		if (threadCount == 1) {
+			baseline = texturesPerSecond;
+		}
+		std::string label = std::to_string(threadCount) + " threads";
+		Bench::Report(label.c_str(), texturesPerSecond, "textures/s");
+		Bench::Report((label + " speedup").c_str(), texturesPerSecond / baseline, "x");
+	}
+}
@@ -0,0 +1,47 @@
+#include "Bench.h"
+#include "NullRenderDevice.h"
+#include "UploadRingBuffer.h"
+#include <string>
+#include <vector>
+
+namespace {
+
+// 1フレームにcopyCount個のcopyBytesバイトの転送を予約してFlushする。転送量(MB/s)を返す
+double MeasureThroughput(size_t copyBytes, uint32_t copyCount, uint32_t frameCount, uint64_t& failures) {
+	NullRenderDevice device;
+	std::unique_ptr<RenderBuffer> destination = device.CreateBuffer(copyBytes * copyCount, BufferUsage::kDefault);
+	UploadRingBuffer uploader(&device);
+	std::vector<uint8_t> source(copyBytes, 0x5a);
+
+	Bench::Stopwatch stopwatch;
+	for (uint32_t frame = 0; frame < frameCount; ++frame) {
+		device.BeginFrame();
+		for (uint32_t i = 0; i < copyCount; ++i) {
+			uploader.Upload(destination.get(), i * copyBytes, source.data(), copyBytes);
+		}
+		uploader.Flush();
+		device.EndFrame();
+	}
+	double milliseconds = stopwatch.GetMilliseconds();
+	failures = uploader.GetStatistics().allocationFailures;
+	Bench::DoNotOptimize(uploader.GetStatistics().bytesUploaded);
+	return uploader.GetStatistics().bytesUploaded / (1024.0 * 1024.0) / (milliseconds / 1000.0);
+}
+
+} // namespace
+
+BENCHMARK(UploadRingBuffer, Throughput) {
+	// 小さい転送を多数と、大きい転送を少数で、リングへの書き込みとコピーの記録の速さを見る
+	// (NullRenderDeviceはコピーを検証するだけなので、CPU側の費用だけを測る)
+	const uint32_t frameCount = Bench::Iterations(1000);
+	struct Case {
+		size_t copyBytes;
+		uint32_t copyCount;
+	};
+	for (Case c : {Case{256, 4096}, Case{4 * 1024, 256}, Case{64 * 1024, 64}, Case{1024 * 1024, 8}}) {
+		uint64_t failures = 0;
+		std::string label = std::to_string(c.copyBytes) + " B x " + std::to_string(c.copyCount);
+		Bench::Report(label.c_str(), MeasureThroughput(c.copyBytes, c.copyCount, frameCount, failures), "MB/s");
+		Bench::Report((label + " failures").c_str(), static_cast<double>(failures), "copies");
+	}
+}
@@ -0,0 +1,79 @@
+#include "AssetArchive.h"
+#include "Hash.h"
+#include "Lz4.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+bool AssetArchive::Open(std::span<const uint8_t> data) {
+	data_ = {};
+	index_ = {};
+	names_ = {};
+
+	Header header;
+	if (data.size() < sizeof(header)) {
+		return false;
+	}
+	std::memcpy(&header, data.data(), sizeof(header));
+	if (header.magic != kMagic || header.version != kVersion) {
+		return false;
+	}
+	if (header.indexOffset % alignof(IndexEntry) != 0 || header.indexOffset > data.size() || (data.size() - header.indexOffset) / sizeof(IndexEntry) < header.entryCount ||
+	    header.namesOffset > data.size() || data.size() - header.namesOffset < header.namesSize) {
+		return false;
+	}
+
+	// マップした領域はページ境界から始まるので、索引はそのまま構造体として読める
+	std::span<const IndexEntry> index(reinterpret_cast<const IndexEntry*>(data.data() + header.indexOffset), header.entryCount);
+	for (const IndexEntry& entry : index) {
+		if (entry.offset > data.size() || data.size() - entry.offset < entry.storedSize || uint64_t(entry.nameOffset) + entry.nameSize > header.namesSize) {
+			return false;
+		}
+		if (entry.compression == Compression::kNone ? entry.storedSize != entry.size : entry.compression != Compression::kLZ4) {
+			return false;
+		}
+	}
+
+	data_ = data;
+	index_ = index;
+	names_ = {reinterpret_cast<const char*>(data.data() + header.namesOffset), static_cast<size_t>(header.namesSize)};
+	return true;
+}
+
+const AssetArchive::IndexEntry* AssetArchive::Find(const std::string& name) const {
+	std::string normalized = NormalizeName(name);
+	uint64_t hash = HashName(normalized);
+	auto it = std::lower_bound(index_.begin(), index_.end(), hash, [](const IndexEntry& entry, uint64_t value) { return entry.hash < value; });
+	// ハッシュが衝突していても名前で確かめる
+	for (; it != index_.end() && it->hash == hash; ++it) {
+		if (GetName(*it) == normalized) {
+			return &*it;
+		}
+	}
+	return nullptr;
+}
+
+bool AssetArchive::Extract(const IndexEntry& entry, uint8_t* dst) const {
+	std::span<const uint8_t> stored = GetStoredData(entry);
+	if (entry.compression == Compression::kNone) {
+		std::memcpy(dst, stored.data(), stored.size());
+		return true;
+	}
+	return LZ4Decompress(stored.data(), stored.size(), dst, static_cast<size_t>(entry.size));
+}
+
+std::string_view AssetArchive::GetName(const IndexEntry& entry) const { return {names_.data() + entry.nameOffset, entry.nameSize}; }
+
+std::string AssetArchive::NormalizeName(std::string_view name) {
+	std::string normalized;
+	normalized.reserve(name.size());
+	for (char c : name) {
+		normalized.push_back(c == '\\' ? '/' : static_cast<char>(tolower(static_cast<unsigned char>(c))));
+	}
+	while (normalized.starts_with("./")) {
+		normalized.erase(0, 2);
+	}
+	return normalized;
+}
+
+uint64_t AssetArchive::HashName(std::string_view normalizedName) { return XXHash64(normalizedName.data(), normalizedName.size()); }
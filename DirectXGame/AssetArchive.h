@@ -0,0 +1,110 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+/// <summary>
+/// パックしたアセットアーカイブの読み取り
+/// ファイル名のハッシュで整列した索引を二分探索し、4KiB境界に置いた中身の位置を直接引く。
+/// 中身のバイト列はマップしたアーカイブをそのまま指すので、無圧縮の要素はコピーせずに読める
+/// </summary>
+class AssetArchive {
+public:
+	// 識別子("KPAK")
+	static const uint32_t kMagic = 0x4B41504B;
+	// 版
+	static const uint32_t kVersion = 1;
+	// 要素の配置境界
+	static const uint64_t kAlignment = 4096;
+
+	/// <summary>
+	/// 圧縮形式
+	/// </summary>
+	enum class Compression : uint32_t {
+		kNone,
+		kLZ4, //!< LZ4ブロック形式
+	};
+
+	/// <summary>
+	/// ファイル先頭のヘッダ
+	/// </summary>
+	struct Header {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t reserved;
+		// 索引の位置
+		uint64_t indexOffset;
+		// 名前表の位置とバイト数
+		uint64_t namesOffset;
+		uint64_t namesSize;
+	};
+
+	/// <summary>
+	/// 索引の要素(名前のハッシュ、名前の順に整列)
+	/// </summary>
+	struct IndexEntry {
+		uint64_t hash;
+		// 中身の位置(kAlignmentの倍数)
+		uint64_t offset;
+		// 格納されているバイト数
+		uint64_t storedSize;
+		// 展開後のバイト数
+		uint64_t size;
+		// 名前表内の名前の位置とバイト数
+		uint32_t nameOffset;
+		uint32_t nameSize;
+		Compression compression;
+		uint32_t reserved;
+	};
+
+	/// <summary>
+	/// アーカイブを開く。範囲外を指す索引があれば失敗する
+	/// </summary>
+	/// <param name="data">アーカイブ全体(開いている間は有効であること)</param>
+	/// <returns>成否</returns>
+	bool Open(std::span<const uint8_t> data);
+
+	/// <summary>
+	/// 要素の検索
+	/// </summary>
+	/// <param name="name">名前(NormalizeNameで正規化して比較する)</param>
+	/// <returns>要素。無ければnullptr</returns>
+	const IndexEntry* Find(const std::string& name) const;
+
+	/// <summary>
+	/// 格納されているバイト列(圧縮されていればそのまま)
+	/// </summary>
+	std::span<const uint8_t> GetStoredData(const IndexEntry& entry) const { return data_.subspan(entry.offset, entry.storedSize); }
+
+	/// <summary>
+	/// 展開
+	/// </summary>
+	/// <param name="entry">要素</param>
+	/// <param name="dst">出力先(entry.sizeバイト)</param>
+	/// <returns>成否</returns>
+	bool Extract(const IndexEntry& entry, uint8_t* dst) const;
+
+	// 名前の取得
+	std::string_view GetName(const IndexEntry& entry) const;
+	// 要素数
+	uint32_t GetEntryCount() const { return static_cast<uint32_t>(index_.size()); }
+	// 索引
+	std::span<const IndexEntry> GetIndex() const { return index_; }
+
+	/// <summary>
+	/// 名前の正規化(区切りを'/'に、英字を小文字にし、先頭の"./"を除く)
+	/// </summary>
+	static std::string NormalizeName(std::string_view name);
+
+	/// <summary>
+	/// 正規化した名前のハッシュ
+	/// </summary>
+	static uint64_t HashName(std::string_view normalizedName);
+
+private:
+	std::span<const uint8_t> data_;
+	std::span<const IndexEntry> index_;
+	std::span<const char> names_;
+};
@@ -0,0 +1,108 @@
+#include "AssetArchiveBuilder.h"
+#include "AssetArchive.h"
+#include "Lz4.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+// 圧縮後がこの割合を下回るときだけ圧縮して格納する
+const double kCompressionThreshold = 0.875;
+
+} // namespace
+
+void AssetArchiveBuilder::AddFile(const std::string& name, const std::string& filePath) { sources_.push_back({AssetArchive::NormalizeName(name), filePath}); }
+
+uint32_t AssetArchiveBuilder::AddDirectory(const std::string& directoryPath) {
+	namespace fs = std::filesystem;
+	std::error_code ec;
+	uint32_t count = 0;
+	for (const fs::directory_entry& entry : fs::recursive_directory_iterator(directoryPath, ec)) {
+		if (!entry.is_regular_file()) {
+			continue;
+		}
+		AddFile(entry.path().lexically_relative(directoryPath).generic_string(), entry.path().string());
+		++count;
+	}
+	return count;
+}
+
+bool AssetArchiveBuilder::Build(const std::string& outputPath, bool compress) {
+	statistics_ = {};
+	std::ofstream file(outputPath, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+
+	// ヘッダの分を空けて中身から書く
+	std::vector<AssetArchive::IndexEntry> index;
+	std::string names;
+	uint64_t position = AssetArchive::kAlignment;
+	std::vector<uint8_t> compressed;
+	for (const Source& source : sources_) {
+		std::ifstream input(source.filePath, std::ios::binary);
+		if (!input) {
+			return false;
+		}
+		std::vector<uint8_t> data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+		AssetArchive::IndexEntry entry{};
+		entry.hash = AssetArchive::HashName(source.name);
+		entry.offset = position;
+		entry.size = data.size();
+		entry.nameOffset = static_cast<uint32_t>(names.size());
+		entry.nameSize = static_cast<uint32_t>(source.name.size());
+		entry.compression = AssetArchive::Compression::kNone;
+		names += source.name;
+
+		const uint8_t* stored = data.data();
+		size_t storedSize = data.size();
+		if (compress && !data.empty()) {
+			compressed.resize(LZ4CompressBound(data.size()));
+			size_t compressedSize = LZ4Compress(data.data(), data.size(), compressed.data(), compressed.size());
+			if (compressedSize > 0 && compressedSize < data.size() * kCompressionThreshold) {
+				stored = compressed.data();
+				storedSize = compressedSize;
+				entry.compression = AssetArchive::Compression::kLZ4;
+				++statistics_.compressedCount;
+			}
+		}
+		entry.storedSize = storedSize;
+
+		file.seekp(static_cast<std::streamoff>(position));
+		file.write(reinterpret_cast<const char*>(stored), static_cast<std::streamsize>(storedSize));
+		position = (position + storedSize + AssetArchive::kAlignment - 1) & ~(AssetArchive::kAlignment - 1);
+		index.push_back(entry);
+
+		++statistics_.fileCount;
+		statistics_.rawBytes += data.size();
+		statistics_.storedBytes += storedSize;
+	}
+
+	// 索引はハッシュ、名前の順に整列して二分探索できるようにする
+	std::sort(index.begin(), index.end(), [&names](const AssetArchive::IndexEntry& a, const AssetArchive::IndexEntry& b) {
+		if (a.hash != b.hash) {
+			return a.hash < b.hash;
+		}
+		return names.compare(a.nameOffset, a.nameSize, names, b.nameOffset, b.nameSize) < 0;
+	});
+
+	AssetArchive::Header header{};
+	header.magic = AssetArchive::kMagic;
+	header.version = AssetArchive::kVersion;
+	header.entryCount = static_cast<uint32_t>(index.size());
+	header.indexOffset = position;
+	header.namesOffset = position + index.size() * sizeof(AssetArchive::IndexEntry);
+	header.namesSize = names.size();
+
+	file.seekp(static_cast<std::streamoff>(header.indexOffset));
+	file.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(AssetArchive::IndexEntry)));
+	file.write(names.data(), static_cast<std::streamsize>(names.size()));
+	file.seekp(0);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	statistics_.archiveBytes = header.namesOffset + header.namesSize;
+	return static_cast<bool>(file);
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// アセットアーカイブの書き出し
+/// 登録したファイルを4KiB境界に並べ、縮むものはLZ4で圧縮し、名前のハッシュで整列した索引を付ける
+/// </summary>
+class AssetArchiveBuilder {
+public:
+	/// <summary>
+	/// 書き出し結果
+	/// </summary>
+	struct Statistics {
+		uint32_t fileCount = 0;
+		uint32_t compressedCount = 0;
+		// 元のバイト数の合計
+		uint64_t rawBytes = 0;
+		// 格納したバイト数の合計
+		uint64_t storedBytes = 0;
+		// アーカイブのバイト数(境界合わせの余白を含む)
+		uint64_t archiveBytes = 0;
+	};
+
+	/// <summary>
+	/// ファイルの登録
+	/// </summary>
+	/// <param name="name">アーカイブ内の名前</param>
+	/// <param name="filePath">読み込むファイル</param>
+	void AddFile(const std::string& name, const std::string& filePath);
+
+	/// <summary>
+	/// ディレクトリ以下のファイルをまとめて登録する。名前はディレクトリからの相対パス
+	/// </summary>
+	/// <param name="directoryPath">ディレクトリ</param>
+	/// <returns>登録したファイル数</returns>
+	uint32_t AddDirectory(const std::string& directoryPath);
+
+	/// <summary>
+	/// 書き出し
+	/// </summary>
+	/// <param name="outputPath">出力先</param>
+	/// <param name="compress">縮むものを圧縮するか</param>
+	/// <returns>成否</returns>
+	bool Build(const std::string& outputPath, bool compress = true);
+
+	// 直近の書き出し結果
+	const Statistics& GetStatistics() const { return statistics_; }
+
+private:
+	struct Source {
+		std::string name;
+		std::string filePath;
+	};
+
+	std::vector<Source> sources_;
+	Statistics statistics_;
+};
@@ -0,0 +1,165 @@
+#include "AssetIO.h"
+#include <algorithm>
+
+AssetIO* AssetIO::GetInstance() {
+	static AssetIO instance;
+	return &instance;
+}
+
+AssetView AssetIO::Map(const std::string& filePath) {
+	AssetView view = MapFromArchive(filePath);
+	if (view) {
+		return view;
+	}
+	return MapFile(filePath);
+}
+
+bool AssetIO::Mount(const std::string& archivePath, const std::string& mountPoint) {
+	auto mounted = std::make_shared<MountedArchive>();
+	mounted->archivePath = archivePath;
+	mounted->mountPoint = AssetArchive::NormalizeName(mountPoint);
+	mounted->view = MapFile(archivePath);
+	if (!mounted->view || !mounted->archive.Open(mounted->view.GetSpan())) {
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(mutex_);
+	archives_.push_back(std::move(mounted));
+	return true;
+}
+
+void AssetIO::UnmountAll() {
+	// 解放でReleaseが呼ばれるので、ロックの外で破棄する
+	std::vector<std::shared_ptr<const MountedArchive>> archives;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		archives.swap(archives_);
+	}
+}
+
+std::string AssetIO::FindArchive(const std::string& filePath) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	std::string normalized = AssetArchive::NormalizeName(filePath);
+	for (auto it = archives_.rbegin(); it != archives_.rend(); ++it) {
+		const MountedArchive& mounted = **it;
+		if (normalized.starts_with(mounted.mountPoint) && mounted.archive.Find(normalized.substr(mounted.mountPoint.size()))) {
+			return mounted.archivePath;
+		}
+	}
+	return std::string();
+}
+
+AssetView AssetIO::MapFromArchive(const std::string& filePath) {
+	std::vector<std::shared_ptr<const MountedArchive>> archives;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (archives_.empty()) {
+			return AssetView();
+		}
+		archives = archives_;
+	}
+
+	std::string normalized = AssetArchive::NormalizeName(filePath);
+	for (auto it = archives.rbegin(); it != archives.rend(); ++it) {
+		const MountedArchive& mounted = **it;
+		if (!normalized.starts_with(mounted.mountPoint)) {
+			continue;
+		}
+		const AssetArchive::IndexEntry* entry = mounted.archive.Find(normalized.substr(mounted.mountPoint.size()));
+		if (!entry) {
+			continue;
+		}
+
+		AssetView view;
+		if (entry->compression == AssetArchive::Compression::kNone) {
+			// アーカイブのマップをそのまま指す
+			std::span<const uint8_t> stored = mounted.archive.GetStoredData(*entry);
+			view = AssetView(mounted.view.owner_, mounted.view.file_, stored.data(), stored.size());
+		} else {
+			auto buffer = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(entry->size));
+			if (!mounted.archive.Extract(*entry, buffer->data())) {
+				continue;
+			}
+			const uint8_t* data = buffer->data();
+			view = AssetView(std::move(buffer), nullptr, data, static_cast<size_t>(entry->size));
+		}
+		std::lock_guard<std::mutex> lock(mutex_);
+		++statistics_.archiveCount;
+		return view;
+	}
+	return AssetView();
+}
+
+AssetView AssetIO::MapFile(const std::string& filePath) {
+	std::shared_ptr<const MappedFile> file;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = mappings_.find(filePath);
+		if (it != mappings_.end()) {
+			file = it->second.lock();
+			if (file) {
+				++statistics_.sharedCount;
+				const MappedFile* mapped = file.get();
+				return AssetView(std::move(file), mapped, mapped->GetData(), mapped->GetSize());
+			}
+		}
+	}
+
+	// マップはロックの外で行い、他のスレッドの読み出しを待たせない
+	auto mapped = std::make_unique<MappedFile>();
+	if (!mapped->Open(filePath)) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		++statistics_.failedCount;
+		return AssetView();
+	}
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	// 同時に開かれていたら先に登録された方を使う(こちらはロックの外で破棄する)
+	std::weak_ptr<const MappedFile>& entry = mappings_[filePath];
+	file = entry.lock();
+	if (file) {
+		++statistics_.sharedCount;
+		const MappedFile* shared = file.get();
+		return AssetView(std::move(file), shared, shared->GetData(), shared->GetSize());
+	}
+	++statistics_.mapCount;
+	++statistics_.liveMappings;
+	statistics_.liveBytes += mapped->GetSize();
+	file = std::shared_ptr<const MappedFile>(mapped.release(), [this](const MappedFile* released) { Release(const_cast<MappedFile*>(released)); });
+	entry = file;
+	const MappedFile* raw = file.get();
+	return AssetView(std::move(file), raw, raw->GetData(), raw->GetSize());
+}
+
+AssetView AssetIO::Prefetch(const std::string& filePath) {
+	AssetView view = Map(filePath);
+	Prefetch(view, 0, view.GetSize());
+	return view;
+}
+
+AssetView AssetIO::PrefetchFile(const std::string& filePath) {
+	AssetView view = MapFile(filePath);
+	Prefetch(view, 0, view.GetSize());
+	return view;
+}
+
+void AssetIO::Prefetch(const AssetView& view, size_t offset, size_t size) {
+	if (view && view.file_ && offset < view.size_) {
+		view.file_->Prefetch(static_cast<size_t>(view.data_ - view.file_->GetData()) + offset, (std::min)(size, view.size_ - offset));
+	}
+}
+
+AssetIO::Statistics AssetIO::GetStatistics() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return statistics_;
+}
+
+void AssetIO::Release(MappedFile* file) {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		--statistics_.liveMappings;
+		statistics_.liveBytes -= file->GetSize();
+		// 期限切れの対応を掃除する
+		std::erase_if(mappings_, [](const auto& mapping) { return mapping.second.expired(); });
+	}
+	delete file;
+}
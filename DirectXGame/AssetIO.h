@@ -0,0 +1,153 @@
+#pragma once
+#include "AssetArchive.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// マップしたファイルの読み取り専用ビュー
+/// ビューが残っている間はマップが解除されないので、読み込み側は中身をコピーせずにそのまま解析できる
+/// </summary>
+class AssetView {
+public:
+	AssetView() = default;
+
+	// 先頭アドレス
+	const uint8_t* GetData() const { return data_; }
+	// バイト数
+	size_t GetSize() const { return size_; }
+	// 範囲
+	std::span<const uint8_t> GetSpan() const { return {data_, size_}; }
+	// 開けたか
+	explicit operator bool() const { return owner_ != nullptr; }
+
+private:
+	friend class AssetIO;
+	AssetView(std::shared_ptr<const void> owner, const MappedFile* file, const uint8_t* data, size_t size) : owner_(std::move(owner)), file_(file), data_(data), size_(size) {}
+
+	// 中身の寿命を保つ参照(マップしたファイルか展開したバッファ)
+	std::shared_ptr<const void> owner_;
+	// マップしたファイル(展開したバッファならnullptr)
+	const MappedFile* file_ = nullptr;
+	const uint8_t* data_ = nullptr;
+	size_t size_ = 0;
+};
+
+/// <summary>
+/// アセットの読み出し
+/// 同じファイルへのマップは共有し、最後のビューが破棄されたら解除する。
+/// マウントしたアーカイブに含まれるファイルはアーカイブから引く
+/// </summary>
+class AssetIO {
+public:
+	/// <summary>
+	/// 統計
+	/// </summary>
+	struct Statistics {
+		// 新しくマップした回数
+		uint64_t mapCount = 0;
+		// 既存のマップを共有した回数
+		uint64_t sharedCount = 0;
+		// 開けなかった回数
+		uint64_t failedCount = 0;
+		// アーカイブから引いた回数
+		uint64_t archiveCount = 0;
+		// 現在マップしているファイル数
+		uint32_t liveMappings = 0;
+		// 現在マップしているバイト数
+		uint64_t liveBytes = 0;
+	};
+
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static AssetIO* GetInstance();
+
+	/// <summary>
+	/// ファイルをマップする(どのスレッドからでも呼べる)
+	/// </summary>
+	/// <param name="filePath">ファイルパス</param>
+	/// <returns>ビュー。開けなければ空</returns>
+	AssetView Map(const std::string& filePath);
+
+	/// <summary>
+	/// アーカイブのマウント。以降mountPoint以下のパスはアーカイブを先に探す
+	/// </summary>
+	/// <param name="archivePath">アーカイブのパス</param>
+	/// <param name="mountPoint">アーカイブの中身を置くディレクトリ</param>
+	/// <returns>成否</returns>
+	bool Mount(const std::string& archivePath, const std::string& mountPoint = "Resources/");
+
+	/// <summary>
+	/// ファイルを引くアーカイブの検索(Mapがアーカイブから引くかどうか)
+	/// </summary>
+	/// <param name="filePath">ファイルパス</param>
+	/// <returns>アーカイブのパス。どのアーカイブにも含まれていなければ空</returns>
+	std::string FindArchive(const std::string& filePath);
+
+	/// <summary>
+	/// すべてのアーカイブのマウント解除(取得済みのビューは有効なまま)
+	/// </summary>
+	void UnmountAll();
+
+	/// <summary>
+	/// 先読みのヒント。マップしてOSに先読みを依頼する
+	/// </summary>
+	/// <param name="filePath">ファイルパス</param>
+	/// <returns>ビュー。先読みが終わるまで保持しておく</returns>
+	AssetView Prefetch(const std::string& filePath);
+
+	/// <summary>
+	/// アーカイブを引かずにファイルを直接マップして先読みする(ファイルから読み直す読み込み側向け)
+	/// </summary>
+	/// <param name="filePath">ファイルパス</param>
+	/// <returns>ビュー。ファイルが無ければ空</returns>
+	AssetView PrefetchFile(const std::string& filePath);
+
+	/// <summary>
+	/// ビューの範囲の先読みのヒント
+	/// </summary>
+	/// <param name="view">ビュー</param>
+	/// <param name="offset">先頭</param>
+	/// <param name="size">バイト数</param>
+	static void Prefetch(const AssetView& view, size_t offset, size_t size);
+
+	// 統計の取得
+	Statistics GetStatistics();
+
+private:
+	AssetIO() = default;
+	~AssetIO() = default;
+	AssetIO(const AssetIO&) = delete;
+	const AssetIO& operator=(const AssetIO&) = delete;
+
+	// マウントしたアーカイブ
+	struct MountedArchive {
+		// アーカイブのパス
+		std::string archivePath;
+		// 正規化したマウント先
+		std::string mountPoint;
+		AssetView view;
+		AssetArchive archive;
+	};
+
+	// ファイルを直接マップする
+	AssetView MapFile(const std::string& filePath);
+	// アーカイブから引く。含まれていなければ空
+	AssetView MapFromArchive(const std::string& filePath);
+	// 最後のビューが破棄されたときの処理
+	void Release(MappedFile* file);
+
+	std::mutex mutex_;
+	// パスから共有中のマップへの対応
+	std::unordered_map<std::string, std::weak_ptr<const MappedFile>> mappings_;
+	// 後からマウントしたものを優先する
+	std::vector<std::shared_ptr<const MountedArchive>> archives_;
+	Statistics statistics_;
+};
@@ -0,0 +1,223 @@
+#include "AssetStreamer.h"
+#include <algorithm>
+
+namespace {
+
+float ToMilliseconds(std::chrono::steady_clock::duration duration) { return std::chrono::duration<float, std::milli>(duration).count(); }
+
+} // namespace
+
+AssetStreamer* AssetStreamer::GetInstance() {
+	static AssetStreamer instance;
+	return &instance;
+}
+
+void AssetStreamer::Initialize(uint32_t ioThreadCount, uint32_t decodeThreadCount) {
+	Finalize();
+	if (decodeThreadCount == 0) {
+		uint32_t hardwareThreads = std::thread::hardware_concurrency();
+		decodeThreadCount = hardwareThreads > 3 ? hardwareThreads - 2 : 1;
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		statistics_ = {};
+		latencies_.clear();
+		latencyCursor_ = 0;
+	}
+	StartStage(ioStage_, (std::max)(ioThreadCount, 1u), &AssetStreamer::Read);
+	StartStage(decodeStage_, decodeThreadCount, &AssetStreamer::Decode);
+}
+
+void AssetStreamer::Finalize() {
+	StopStage(ioStage_);
+	StopStage(decodeStage_);
+	ioQueued_ = 0;
+	decodeQueued_ = 0;
+	std::lock_guard<std::mutex> lock(mutex_);
+	requests_.clear();
+	completions_.clear();
+}
+
+AssetStreamer::RequestId AssetStreamer::Request(const std::string& filePath, Priority priority, DecodeFunction decode, CompleteFunction complete, bool fileOnly) {
+	auto request = std::make_shared<RequestData>();
+	request->filePath = filePath;
+	request->priority = priority;
+	request->decode = std::move(decode);
+	request->complete = std::move(complete);
+	request->fileOnly = fileOnly;
+	request->requestTime = Clock::now();
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		request->id = nextId_++;
+		requests_[request->id] = request;
+		++statistics_.requested;
+		statistics_.maxQueueDepth = (std::max)(statistics_.maxQueueDepth, static_cast<uint32_t>(requests_.size()));
+	}
+	++ioQueued_;
+	Push(ioStage_, request);
+	return request->id;
+}
+
+bool AssetStreamer::Cancel(RequestId id) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto it = requests_.find(id);
+	if (it == requests_.end() || it->second->canceled) {
+		return false;
+	}
+	it->second->canceled = true;
+	return true;
+}
+
+void AssetStreamer::Update(float budgetMilliseconds) {
+	Clock::time_point start = Clock::now();
+	while (true) {
+		std::shared_ptr<RequestData> request;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (completions_.empty()) {
+				break;
+			}
+			request = std::move(completions_.front());
+			completions_.pop_front();
+
+			// 要求を消すまではキャンセルを受け付ける(Cancelと同じロックの中で確かめる)
+			requests_.erase(request->id);
+			if (request->canceled) {
+				++statistics_.canceled;
+				continue;
+			}
+			if (request->succeeded) {
+				++statistics_.completed;
+			} else {
+				++statistics_.failed;
+			}
+			float latency = ToMilliseconds(Clock::now() - request->requestTime);
+			if (latencies_.size() < kLatencySamples) {
+				latencies_.push_back(latency);
+			} else {
+				latencies_[latencyCursor_] = latency;
+				latencyCursor_ = (latencyCursor_ + 1) % kLatencySamples;
+			}
+		}
+		if (request->complete) {
+			request->complete(request->succeeded, request->data);
+		}
+
+		if (ToMilliseconds(Clock::now() - start) >= budgetMilliseconds) {
+			break;
+		}
+	}
+}
+
+uint32_t AssetStreamer::GetPendingCount() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return static_cast<uint32_t>(requests_.size());
+}
+
+AssetStreamer::Statistics AssetStreamer::GetStatistics() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	Statistics statistics = statistics_;
+	statistics.ioQueueDepth = ioQueued_;
+	statistics.decodeQueueDepth = decodeQueued_;
+	statistics.completionQueueDepth = static_cast<uint32_t>(completions_.size());
+	if (!latencies_.empty()) {
+		std::vector<float> sorted = latencies_;
+		std::sort(sorted.begin(), sorted.end());
+		auto percentile = [&sorted](float p) { return sorted[static_cast<size_t>(p * (sorted.size() - 1) + 0.5f)]; };
+		statistics.latencyP50 = percentile(0.50f);
+		statistics.latencyP95 = percentile(0.95f);
+		statistics.latencyP99 = percentile(0.99f);
+		statistics.latencyMax = sorted.back();
+	}
+	return statistics;
+}
+
+void AssetStreamer::StartStage(Stage& stage, uint32_t threadCount, void (AssetStreamer::*process)(const std::shared_ptr<RequestData>&)) {
+	stage.stopping = false;
+	for (uint32_t i = 0; i < threadCount; ++i) {
+		stage.threads.emplace_back([this, &stage, process] { StageMain(stage, process); });
+	}
+}
+
+void AssetStreamer::StopStage(Stage& stage) {
+	{
+		std::lock_guard<std::mutex> lock(stage.mutex);
+		stage.stopping = true;
+		stage.queue = {};
+	}
+	stage.available.notify_all();
+	for (std::thread& thread : stage.threads) {
+		thread.join();
+	}
+	stage.threads.clear();
+}
+
+void AssetStreamer::Push(Stage& stage, std::shared_ptr<RequestData> request) {
+	{
+		std::lock_guard<std::mutex> lock(stage.mutex);
+		stage.queue.push(std::move(request));
+	}
+	stage.available.notify_one();
+}
+
+void AssetStreamer::StageMain(Stage& stage, void (AssetStreamer::*process)(const std::shared_ptr<RequestData>&)) {
+	while (true) {
+		std::shared_ptr<RequestData> request;
+		{
+			std::unique_lock<std::mutex> lock(stage.mutex);
+			stage.available.wait(lock, [&stage] { return stage.stopping || !stage.queue.empty(); });
+			if (stage.stopping) {
+				return;
+			}
+			request = stage.queue.top();
+			stage.queue.pop();
+		}
+		(this->*process)(request);
+	}
+}
+
+void AssetStreamer::Read(const std::shared_ptr<RequestData>& request) {
+	--ioQueued_;
+	if (request->canceled) {
+		Drop(request);
+		return;
+	}
+
+	// マップして全ページに触れ、デコードスレッドがページフォールトで待たないようにする
+	request->data = request->fileOnly ? AssetIO::GetInstance()->PrefetchFile(request->filePath) : AssetIO::GetInstance()->Prefetch(request->filePath);
+	if (!request->data) {
+		request->succeeded = false;
+		Finish(request);
+		return;
+	}
+	const size_t kPageSize = 4096;
+	volatile uint8_t sink = 0;
+	for (size_t offset = 0; offset < request->data.GetSize(); offset += kPageSize) {
+		sink = sink ^ request->data.GetData()[offset];
+	}
+
+	++decodeQueued_;
+	Push(decodeStage_, request);
+}
+
+void AssetStreamer::Decode(const std::shared_ptr<RequestData>& request) {
+	--decodeQueued_;
+	if (request->canceled) {
+		Drop(request);
+		return;
+	}
+	request->succeeded = request->decode ? request->decode(request->data) : true;
+	Finish(request);
+}
+
+void AssetStreamer::Finish(const std::shared_ptr<RequestData>& request) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	completions_.push_back(request);
+}
+
+void AssetStreamer::Drop(const std::shared_ptr<RequestData>& request) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (requests_.erase(request->id) > 0) {
+		++statistics_.canceled;
+	}
+}
@@ -0,0 +1,189 @@
+#pragma once
+#include "AssetIO.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// アセットの非同期ストリーミング
+/// 要求を優先度順に読み出しスレッドでマップし、デコードスレッドで解析して、
+/// 完了の通知はメインスレッドのUpdate(KamataEngine::Updateの直後)でまとめて行う
+/// </summary>
+class AssetStreamer {
+public:
+	// 要求ID
+	using RequestId = uint64_t;
+	// 無効な要求ID
+	static const RequestId kInvalidRequest = 0;
+
+	/// <summary>
+	/// 優先度(大きいほど先に処理する)
+	/// </summary>
+	enum class Priority : uint8_t {
+		kLow,
+		kNormal,
+		kHigh,
+		kCritical,
+	};
+
+	// デコード処理(デコードスレッドで呼ばれる)。成否を返す
+	using DecodeFunction = std::function<bool(const AssetView& data)>;
+	// 完了通知(メインスレッドで呼ばれる)。キャンセルした要求では呼ばれない
+	using CompleteFunction = std::function<void(bool succeeded, const AssetView& data)>;
+
+	/// <summary>
+	/// 統計
+	/// </summary>
+	struct Statistics {
+		uint64_t requested = 0;
+		uint64_t completed = 0;
+		uint64_t failed = 0;
+		uint64_t canceled = 0;
+		// 読み出し待ち、デコード待ち、通知待ちの要求数
+		uint32_t ioQueueDepth = 0;
+		uint32_t decodeQueueDepth = 0;
+		uint32_t completionQueueDepth = 0;
+		// 未完了の要求数の最大
+		uint32_t maxQueueDepth = 0;
+		// 要求から通知までの時間(直近kLatencySamples件、ミリ秒)
+		float latencyP50 = 0.0f;
+		float latencyP95 = 0.0f;
+		float latencyP99 = 0.0f;
+		float latencyMax = 0.0f;
+	};
+
+	// 遅延の百分位に使う標本数
+	static const uint32_t kLatencySamples = 1024;
+
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static AssetStreamer* GetInstance();
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="ioThreadCount">読み出しスレッド数</param>
+	/// <param name="decodeThreadCount">デコードスレッド数。0ならハードウェアスレッド数-2(最低1)</param>
+	void Initialize(uint32_t ioThreadCount = 2, uint32_t decodeThreadCount = 0);
+
+	/// <summary>
+	/// 終了処理。未完了の要求は通知せずに捨てる
+	/// </summary>
+	void Finalize();
+
+	/// <summary>
+	/// 読み込みの要求
+	/// </summary>
+	/// <param name="filePath">ファイルパス</param>
+	/// <param name="priority">優先度</param>
+	/// <param name="decode">デコード処理(nullptrなら読み出しだけ)</param>
+	/// <param name="complete">完了通知(nullptr可)</param>
+	/// <param name="fileOnly">アーカイブを引かずにファイルを読む(TextureManagerのように完了後にファイルから読み直す側が、同じファイルを先読みするため)</param>
+	/// <returns>要求ID</returns>
+	RequestId Request(const std::string& filePath, Priority priority, DecodeFunction decode, CompleteFunction complete, bool fileOnly = false);
+
+	/// <summary>
+	/// 要求のキャンセル。処理中の段階が終わったところで捨てられ、完了通知は呼ばれない
+	/// </summary>
+	/// <param name="id">要求ID</param>
+	/// <returns>未完了の要求をキャンセルできたらtrue</returns>
+	bool Cancel(RequestId id);
+
+	/// <summary>
+	/// 完了通知。メインスレッドの安全な位置で毎フレーム呼ぶ
+	/// </summary>
+	/// <param name="budgetMilliseconds">1フレームで通知に使ってよい時間</param>
+	void Update(float budgetMilliseconds = 2.0f);
+
+	// 未完了の要求数
+	uint32_t GetPendingCount();
+
+	// 統計の取得
+	Statistics GetStatistics();
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	// 要求ごとの情報
+	struct RequestData {
+		RequestId id = kInvalidRequest;
+		std::string filePath;
+		Priority priority = Priority::kNormal;
+		DecodeFunction decode;
+		CompleteFunction complete;
+		bool fileOnly = false;
+		Clock::time_point requestTime;
+		std::atomic<bool> canceled = false;
+		AssetView data;
+		bool succeeded = false;
+	};
+
+	// 優先度の高い順、同じなら古い順
+	struct Compare {
+		bool operator()(const std::shared_ptr<RequestData>& a, const std::shared_ptr<RequestData>& b) const {
+			if (a->priority != b->priority) {
+				return a->priority < b->priority;
+			}
+			return a->id > b->id;
+		}
+	};
+
+	// 処理段階(優先度付きの待ち行列とスレッド)
+	struct Stage {
+		std::mutex mutex;
+		std::condition_variable available;
+		std::priority_queue<std::shared_ptr<RequestData>, std::vector<std::shared_ptr<RequestData>>, Compare> queue;
+		std::vector<std::thread> threads;
+		bool stopping = false;
+	};
+
+	AssetStreamer() = default;
+	~AssetStreamer() = default;
+	AssetStreamer(const AssetStreamer&) = delete;
+	const AssetStreamer& operator=(const AssetStreamer&) = delete;
+
+	// 段階のスレッドの処理
+	void StageMain(Stage& stage, void (AssetStreamer::*process)(const std::shared_ptr<RequestData>&));
+	// 段階への投入
+	static void Push(Stage& stage, std::shared_ptr<RequestData> request);
+	// 段階のスレッドの起動と停止
+	void StartStage(Stage& stage, uint32_t threadCount, void (AssetStreamer::*process)(const std::shared_ptr<RequestData>&));
+	static void StopStage(Stage& stage);
+
+	// 読み出し
+	void Read(const std::shared_ptr<RequestData>& request);
+	// デコード
+	void Decode(const std::shared_ptr<RequestData>& request);
+	// 通知待ちへ移す
+	void Finish(const std::shared_ptr<RequestData>& request);
+	// キャンセル済みの要求を捨てる
+	void Drop(const std::shared_ptr<RequestData>& request);
+
+	Stage ioStage_;
+	Stage decodeStage_;
+
+	std::mutex mutex_;
+	// 未完了の要求
+	std::unordered_map<RequestId, std::shared_ptr<RequestData>> requests_;
+	// 通知待ちの要求
+	std::deque<std::shared_ptr<RequestData>> completions_;
+	RequestId nextId_ = 1;
+	// 遅延の標本(リング)
+	std::vector<float> latencies_;
+	uint32_t latencyCursor_ = 0;
+	std::atomic<uint32_t> ioQueued_ = 0;
+	std::atomic<uint32_t> decodeQueued_ = 0;
+	Statistics statistics_;
+};
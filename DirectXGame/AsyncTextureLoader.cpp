@@ -0,0 +1,260 @@
+#include "AsyncTextureLoader.h"
+#include "AssetIO.h"
+#include "TextureCooker.h"
+#include "TextureRegistry.h"
+#include <DirectXTex.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+namespace {
+
+// 読み込み中に返すテクスチャ
+const char kPlaceholderFileName[] = "white1x1.png";
+
+float ToMilliseconds(std::chrono::steady_clock::duration duration) { return std::chrono::duration<float, std::milli>(duration).count(); }
+
+// ワーカースレッドでWICを使うためのCOMの初期化(スレッドの終了時に解除する)
+struct ComScope {
+	HRESULT result = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+	~ComScope() {
+		if (SUCCEEDED(result)) {
+			CoUninitialize();
+		}
+	}
+};
+
+// 展開済みのDDSがあり、元のファイルより新しいか
+bool IsDecodedFileFresh(const std::filesystem::path& decodedPath, const std::filesystem::path& sourcePath) {
+	std::error_code ec;
+	if (!std::filesystem::exists(decodedPath, ec)) {
+		return false;
+	}
+	std::filesystem::file_time_type decodedTime = std::filesystem::last_write_time(decodedPath, ec);
+	return !ec && decodedTime >= std::filesystem::last_write_time(sourcePath, ec) && !ec;
+}
+
+// 書きかけのファイルを読ませないように、一時ファイルに書いてから置き換える
+bool WriteFileAtomically(const std::filesystem::path& path, const uint8_t* data, size_t size) {
+	std::error_code ec;
+	std::filesystem::create_directories(path.parent_path(), ec);
+	std::filesystem::path temporaryPath = path;
+	temporaryPath += ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::binary);
+		if (!file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size))) {
+			return false;
+		}
+	}
+	std::filesystem::rename(temporaryPath, path, ec);
+	return !ec;
+}
+
+} // namespace
+
+AsyncTextureLoader* AsyncTextureLoader::GetInstance() {
+	static AsyncTextureLoader instance;
+	return &instance;
+}
+
+void AsyncTextureLoader::Initialize(const std::string& directoryPath, uint32_t threadCount) {
+	directoryPath_ = directoryPath;
+	placeholder_ = TextureRegistry::Load(kPlaceholderFileName);
+	entries_.clear();
+	handleMap_.clear();
+	readResults_.clear();
+	statistics_ = {};
+	totalLatency_ = 0.0;
+	threadPool_.Start(threadCount);
+}
+
+void AsyncTextureLoader::Finalize() {
+	threadPool_.Stop();
+	readResults_.clear();
+	for (Entry& entry : entries_) {
+		if (entry.state == State::kReady) {
+			TextureRegistry::Unload(entry.textureHandle);
+		}
+		entry.textureHandle = placeholder_;
+	}
+	TextureRegistry::Unload(placeholder_);
+}
+
+uint32_t AsyncTextureLoader::LoadAsync(const std::string& fileName) {
+	auto it = handleMap_.find(fileName);
+	if (it != handleMap_.end()) {
+		return it->second;
+	}
+
+	uint32_t handle = static_cast<uint32_t>(entries_.size());
+	Entry entry;
+	// クック済みのDDSがあればそちらを読む
+	entry.fileName = TextureCooker::ResolveCookedFileName(directoryPath_, fileName);
+	entry.textureHandle = placeholder_;
+	entry.requestTime = Clock::now();
+	entries_.push_back(entry);
+	handleMap_[fileName] = handle;
+	++statistics_.requested;
+
+	std::string fileName = entry.fileName;
+	threadPool_.Submit([this, handle, fileName] { PrepareFile(handle, fileName); });
+	return handle;
+}
+
+uint64_t AsyncTextureLoader::TouchFile(const std::string& filePath) {
+	// マップして全ページに触れ、OSのファイルキャッシュに載せてメインスレッドでの読み込みを待たせないようにする。
+	// ヒープへのコピーは行わない。TextureManagerはファイルから読むので、アーカイブは引かない
+	// (展開の無駄になり、ファイルが無いのに成功扱いになる)
+	AssetView view = AssetIO::GetInstance()->PrefetchFile(filePath);
+	if (!view) {
+		return 0;
+	}
+	const size_t kPageSize = 4096;
+	volatile uint8_t sink = 0;
+	for (size_t offset = 0; offset < view.GetSize(); offset += kPageSize) {
+		sink = sink ^ view.GetData()[offset];
+	}
+	return view.GetSize();
+}
+
+void AsyncTextureLoader::PrepareFile(uint32_t handle, const std::string& fileName) {
+	ReadResult result;
+	result.handle = handle;
+	result.fileName = fileName;
+
+	std::filesystem::path sourcePath = std::filesystem::path(directoryPath_) / fileName;
+	bool isDds = sourcePath.extension() == ".dds";
+	// マウントしたアーカイブに含まれていればそちらが優先される(AssetIO::Mapと同じ)
+	std::string archivePath = AssetIO::GetInstance()->FindArchive(sourcePath.string());
+	if (isDds && archivePath.empty()) {
+		// ブロック圧縮済みのDDSは展開が要らないので先読みだけ行う
+		result.size = TouchFile(sourcePath.string());
+		result.succeeded = result.size > 0;
+	} else {
+		// TextureManagerはファイルからしか読めないので、展開したもの(アーカイブ内のDDSはそのまま)をDDSとして書き出す
+		std::filesystem::path decodedFileName = std::filesystem::path(kDecodedDirectory) / fileName;
+		decodedFileName.replace_extension(".dds");
+		std::filesystem::path decodedPath = std::filesystem::path(directoryPath_) / decodedFileName;
+		result.fileName = decodedFileName.generic_string();
+
+		if (IsDecodedFileFresh(decodedPath, archivePath.empty() ? sourcePath : std::filesystem::path(archivePath))) {
+			result.size = TouchFile(decodedPath.string());
+			result.succeeded = result.size > 0;
+		} else {
+			Clock::time_point decodeStart = Clock::now();
+			AssetView view = AssetIO::GetInstance()->Map(sourcePath.string());
+			AssetIO::Prefetch(view, 0, view.GetSize());
+			if (view) {
+				result.size = view.GetSize();
+				if (isDds) {
+					// 壊れていないかだけ確かめて中身をそのまま書き出す
+					DirectX::TexMetadata metadata{};
+					result.succeeded = SUCCEEDED(DirectX::GetMetadataFromDDSMemory(view.GetData(), view.GetSize(), DirectX::DDS_FLAGS_NONE, metadata)) &&
+					                   WriteFileAtomically(decodedPath, view.GetData(), view.GetSize());
+				} else {
+					static thread_local ComScope comScope;
+					DirectX::TexMetadata metadata{};
+					DirectX::ScratchImage image{};
+					DirectX::Blob blob;
+					if (SUCCEEDED(DirectX::LoadFromWICMemory(view.GetData(), view.GetSize(), DirectX::WIC_FLAGS_NONE, &metadata, image))) {
+						// ミップもここで作っておく(1x1などで作れなければそのまま)
+						DirectX::ScratchImage mipChain{};
+						if (SUCCEEDED(DirectX::GenerateMipMaps(image.GetImages(), image.GetImageCount(), image.GetMetadata(), DirectX::TEX_FILTER_DEFAULT, 0, mipChain))) {
+							image = std::move(mipChain);
+						}
+						result.succeeded = SUCCEEDED(DirectX::SaveToDDSMemory(image.GetImages(), image.GetImageCount(), image.GetMetadata(), DirectX::DDS_FLAGS_NONE, blob)) &&
+						                   WriteFileAtomically(decodedPath, static_cast<const uint8_t*>(blob.GetBufferPointer()), blob.GetBufferSize());
+					}
+				}
+			}
+			result.decoded = result.succeeded;
+			result.decodeTime = ToMilliseconds(Clock::now() - decodeStart);
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(readResultsMutex_);
+	readResults_.push_back(std::move(result));
+}
+
+void AsyncTextureLoader::Update(float budgetMilliseconds) {
+	Clock::time_point start = Clock::now();
+	while (true) {
+		ReadResult result;
+		{
+			std::lock_guard<std::mutex> lock(readResultsMutex_);
+			if (readResults_.empty()) {
+				break;
+			}
+			result = std::move(readResults_.front());
+			readResults_.pop_front();
+		}
+
+		Entry& entry = entries_[result.handle];
+		statistics_.bytesRead += result.size;
+		if (result.decoded) {
+			++statistics_.decoded;
+			statistics_.workerDecodeTime += result.decodeTime;
+		}
+		if (!result.succeeded) {
+			Complete(entry, false);
+			continue;
+		}
+
+		// GPUへの転送はTextureManagerの内部で行われる(メインスレッド)。展開はワーカーで済んでいる
+		Clock::time_point loadStart = Clock::now();
+		entry.textureHandle = TextureRegistry::Load(result.fileName);
+		statistics_.mainThreadTime += ToMilliseconds(Clock::now() - loadStart);
+		Complete(entry, true);
+
+		if (ToMilliseconds(Clock::now() - start) >= budgetMilliseconds) {
+			break;
+		}
+	}
+}
+
+void AsyncTextureLoader::Flush() {
+	while (GetPendingCount() > 0) {
+		Update((std::numeric_limits<float>::max)());
+		if (GetPendingCount() == 0) {
+			break;
+		}
+		// 停止したプールでは残りの先読みが実行されないので、待たずに失敗にする
+		if (!threadPool_.IsRunning()) {
+			for (Entry& entry : entries_) {
+				if (entry.state == State::kLoading) {
+					Complete(entry, false);
+				}
+			}
+			break;
+		}
+		std::this_thread::yield();
+	}
+}
+
+void AsyncTextureLoader::Complete(Entry& entry, bool succeeded) {
+	entry.state = succeeded ? State::kReady : State::kFailed;
+	if (succeeded) {
+		++statistics_.completed;
+	} else {
+		++statistics_.failed;
+	}
+	float latency = ToMilliseconds(Clock::now() - entry.requestTime);
+	totalLatency_ += latency;
+	statistics_.maxLatency = (std::max)(statistics_.maxLatency, latency);
+	statistics_.averageLatency = static_cast<float>(totalLatency_ / (statistics_.completed + statistics_.failed));
+}
+
+uint32_t AsyncTextureLoader::GetTextureHandle(uint32_t handle) const {
+	if (handle >= entries_.size()) {
+		return placeholder_;
+	}
+	return entries_[handle].textureHandle;
+}
+
+AsyncTextureLoader::State AsyncTextureLoader::GetState(uint32_t handle) const {
+	if (handle >= entries_.size()) {
+		return State::kFailed;
+	}
+	return entries_[handle].state;
+}
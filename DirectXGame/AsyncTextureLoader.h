@@ -0,0 +1,164 @@
+#pragma once
+#include "ThreadPool.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// テクスチャの非同期読み込み
+/// TextureManagerはファイル名からしか読めないので、ワーカースレッドでPNG/JPGを展開してミップを作り、
+/// 非圧縮のDDSとしてkDecodedDirectoryに書き出しておく(元のファイルより新しければ使い回す)。
+/// 読み出しはAssetIOを通すので、マウントしたアーカイブに含まれるものはアーカイブから展開する(DDSはそのまま書き出す)。
+/// メインスレッドではそのDDS(クック済みならそのDDS)を1フレームあたりの時間予算内に少しずつTextureManagerに登録する。
+/// 登録が終わるまではwhite1x1.pngを返す
+/// </summary>
+class AsyncTextureLoader {
+public:
+	// 無効なハンドル
+	static const uint32_t kInvalidHandle = UINT32_MAX;
+	// 展開済みのDDSを置くディレクトリ(読み込み元のディレクトリからの相対パス)
+	static constexpr const char* kDecodedDirectory = ".decoded/";
+
+	/// <summary>
+	/// 読み込み状態
+	/// </summary>
+	enum class State {
+		kLoading, //!< 読み込み中(プレースホルダーを返す)
+		kReady,   //!< 読み込み完了
+		kFailed,  //!< 読み込み失敗(プレースホルダーのまま)
+	};
+
+	/// <summary>
+	/// 読み込み統計
+	/// </summary>
+	struct Statistics {
+		uint32_t requested = 0;
+		uint32_t completed = 0;
+		uint32_t failed = 0;
+		// 読み出したバイト数
+		uint64_t bytesRead = 0;
+		// ワーカースレッドで展開した枚数
+		uint32_t decoded = 0;
+		// ワーカースレッドでの展開とDDSの書き出しにかかった時間の合計(ミリ秒)
+		float workerDecodeTime = 0.0f;
+		// 要求から完了までの時間の平均と最大(ミリ秒)
+		float averageLatency = 0.0f;
+		float maxLatency = 0.0f;
+		// メインスレッドでの登録にかかった時間の合計(ミリ秒)
+		float mainThreadTime = 0.0f;
+	};
+
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static AsyncTextureLoader* GetInstance();
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="directoryPath">テクスチャを読み込むディレクトリ(TextureManagerと同じ)</param>
+	/// <param name="threadCount">ワーカースレッド数(展開を並列に行う数)。0なら自動</param>
+	void Initialize(const std::string& directoryPath = "Resources/", uint32_t threadCount = 0);
+
+	/// <summary>
+	/// 終了処理
+	/// </summary>
+	void Finalize();
+
+	/// <summary>
+	/// 非同期読み込みの要求
+	/// </summary>
+	/// <param name="fileName">ファイル名</param>
+	/// <returns>非同期テクスチャハンドル。同じファイルなら同じハンドルを返す</returns>
+	uint32_t LoadAsync(const std::string& fileName);
+
+	/// <summary>
+	/// 更新。読み出しが終わったテクスチャを時間予算内でTextureManagerに登録する
+	/// </summary>
+	/// <param name="budgetMilliseconds">1フレームで使ってよい時間</param>
+	void Update(float budgetMilliseconds = 2.0f);
+
+	/// <summary>
+	/// すべての要求が完了するまで読み込みを進める(ロード画面用)。終了処理の後は残りを失敗にする
+	/// </summary>
+	void Flush();
+
+	/// <summary>
+	/// 描画に使うテクスチャハンドルの取得
+	/// </summary>
+	/// <param name="handle">非同期テクスチャハンドル</param>
+	/// <returns>TextureManagerのテクスチャハンドル。読み込み中はプレースホルダー</returns>
+	uint32_t GetTextureHandle(uint32_t handle) const;
+
+	// 読み込み状態の取得
+	State GetState(uint32_t handle) const;
+
+	// 未完了の要求数の取得
+	uint32_t GetPendingCount() const { return statistics_.requested - statistics_.completed - statistics_.failed; }
+
+	// 読み込み統計の取得
+	const Statistics& GetStatistics() const { return statistics_; }
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	// 要求ごとの情報
+	struct Entry {
+		std::string fileName;
+		State state = State::kLoading;
+		uint32_t textureHandle = 0;
+		Clock::time_point requestTime;
+	};
+
+	// 読み出し結果
+	struct ReadResult {
+		uint32_t handle = 0;
+		bool succeeded = false;
+		uint64_t size = 0;
+		// TextureManagerに渡すファイル名(展開した場合は展開済みのDDS)
+		std::string fileName;
+		// 展開したか
+		bool decoded = false;
+		float decodeTime = 0.0f;
+	};
+
+	AsyncTextureLoader() = default;
+	~AsyncTextureLoader() = default;
+	AsyncTextureLoader(const AsyncTextureLoader&) = delete;
+	const AsyncTextureLoader& operator=(const AsyncTextureLoader&) = delete;
+
+	/// <summary>
+	/// ワーカースレッドでの読み込みの準備。ファイルのDDSは先読みだけ、それ以外は展開して展開済みのDDSを書き出す
+	/// </summary>
+	/// <param name="handle">非同期テクスチャハンドル</param>
+	/// <param name="fileName">ファイル名(クック済みならDDS)</param>
+	void PrepareFile(uint32_t handle, const std::string& fileName);
+
+	// ファイルを先読みする。読み出したバイト数を返し、開けなければ(空なら)0
+	static uint64_t TouchFile(const std::string& filePath);
+
+	// 読み込み完了時の処理
+	void Complete(Entry& entry, bool succeeded);
+
+	// ディレクトリパス
+	std::string directoryPath_;
+	// プレースホルダーのテクスチャハンドル
+	uint32_t placeholder_ = 0;
+	// ワーカースレッド
+	ThreadPool threadPool_;
+	// 要求ごとの情報(ハンドルで引く)
+	std::vector<Entry> entries_;
+	// ファイル名からハンドルへの対応
+	std::unordered_map<std::string, uint32_t> handleMap_;
+	// 読み出しが終わった要求
+	std::deque<ReadResult> readResults_;
+	std::mutex readResultsMutex_;
+	// 読み込み統計
+	Statistics statistics_;
+	double totalLatency_ = 0.0;
+};
@@ -0,0 +1,74 @@
+#include "AtlasPacker.h"
+#include <algorithm>
+#include <cstring>
+
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include <imstb_rectpack.h>
+
+AtlasPacker::Result AtlasPacker::Pack(const std::vector<Size>& sizes, uint32_t pageWidth, uint32_t pageHeight, uint32_t padding) {
+	Result result;
+	result.placements.resize(sizes.size());
+	result.succeeded = true;
+
+	// 余白込みの矩形を用意する。1ページに収まらないものは諦める
+	std::vector<stbrp_rect> pending;
+	pending.reserve(sizes.size());
+	uint64_t imageArea = 0;
+	for (size_t i = 0; i < sizes.size(); ++i) {
+		stbrp_rect rect{};
+		rect.id = static_cast<int>(i);
+		rect.w = static_cast<int>(sizes[i].width + padding * 2);
+		rect.h = static_cast<int>(sizes[i].height + padding * 2);
+		if (static_cast<uint32_t>(rect.w) > pageWidth || static_cast<uint32_t>(rect.h) > pageHeight) {
+			result.succeeded = false;
+			continue;
+		}
+		imageArea += static_cast<uint64_t>(sizes[i].width) * sizes[i].height;
+		pending.push_back(rect);
+	}
+
+	std::vector<stbrp_node> nodes(pageWidth);
+	while (!pending.empty()) {
+		stbrp_context context;
+		stbrp_init_target(&context, static_cast<int>(pageWidth), static_cast<int>(pageHeight), nodes.data(), static_cast<int>(nodes.size()));
+		stbrp_pack_rects(&context, pending.data(), static_cast<int>(pending.size()));
+
+		// 入ったものを確定し、残りを次のページに回す
+		std::vector<stbrp_rect> rest;
+		for (const stbrp_rect& rect : pending) {
+			if (rect.was_packed) {
+				Placement& placement = result.placements[rect.id];
+				placement.page = result.pageCount;
+				placement.x = static_cast<uint32_t>(rect.x) + padding;
+				placement.y = static_cast<uint32_t>(rect.y) + padding;
+				placement.width = sizes[rect.id].width;
+				placement.height = sizes[rect.id].height;
+			} else {
+				rest.push_back(rect);
+			}
+		}
+		++result.pageCount;
+		pending.swap(rest);
+	}
+
+	if (result.pageCount > 0) {
+		result.efficiency = static_cast<float>(static_cast<double>(imageArea) / (static_cast<double>(pageWidth) * pageHeight * result.pageCount));
+	}
+	return result;
+}
+
+void AtlasPacker::Blit(uint8_t* page, uint32_t pageWidth, uint32_t pageHeight, const uint8_t* image, const Placement& placement, uint32_t padding) {
+	int32_t left = static_cast<int32_t>(placement.x) - static_cast<int32_t>(padding);
+	int32_t top = static_cast<int32_t>(placement.y) - static_cast<int32_t>(padding);
+	int32_t right = static_cast<int32_t>(placement.x + placement.width + padding);
+	int32_t bottom = static_cast<int32_t>(placement.y + placement.height + padding);
+	for (int32_t y = (std::max)(top, 0); y < (std::min)(bottom, static_cast<int32_t>(pageHeight)); ++y) {
+		// 余白は最も近い画像の画素で埋める
+		int32_t sy = std::clamp(y - static_cast<int32_t>(placement.y), 0, static_cast<int32_t>(placement.height) - 1);
+		for (int32_t x = (std::max)(left, 0); x < (std::min)(right, static_cast<int32_t>(pageWidth)); ++x) {
+			int32_t sx = std::clamp(x - static_cast<int32_t>(placement.x), 0, static_cast<int32_t>(placement.width) - 1);
+			std::memcpy(page + (static_cast<size_t>(y) * pageWidth + x) * 4, image + (static_cast<size_t>(sy) * placement.width + sx) * 4, 4);
+		}
+	}
+}
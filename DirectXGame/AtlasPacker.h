@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// 矩形のアトラス詰め込み
+/// ImGuiに同梱のimstb_rectpack.hで小さな画像をページに詰め、溢れた分は次のページに回す
+/// </summary>
+class AtlasPacker {
+public:
+	/// <summary>
+	/// 詰め込む矩形の大きさ
+	/// </summary>
+	struct Size {
+		uint32_t width = 0;
+		uint32_t height = 0;
+	};
+
+	/// <summary>
+	/// 配置結果(余白を除いた画像の位置)
+	/// </summary>
+	struct Placement {
+		uint32_t page = 0;
+		uint32_t x = 0;
+		uint32_t y = 0;
+		uint32_t width = 0;
+		uint32_t height = 0;
+	};
+
+	/// <summary>
+	/// 詰め込み結果
+	/// </summary>
+	struct Result {
+		// 入力と同じ順の配置
+		std::vector<Placement> placements;
+		// 使ったページ数
+		uint32_t pageCount = 0;
+		// 全ページの面積に対する画像の面積の割合
+		float efficiency = 0.0f;
+		// すべて配置できたらtrue(1ページに収まらない矩形があるとfalse)
+		bool succeeded = false;
+	};
+
+	/// <summary>
+	/// 詰め込み
+	/// </summary>
+	/// <param name="sizes">矩形の大きさ</param>
+	/// <param name="pageWidth">ページの幅</param>
+	/// <param name="pageHeight">ページの高さ</param>
+	/// <param name="padding">矩形の周囲に空ける画素数(にじみ防止の縁取り用)</param>
+	/// <returns>詰め込み結果</returns>
+	static Result Pack(const std::vector<Size>& sizes, uint32_t pageWidth, uint32_t pageHeight, uint32_t padding = 1);
+
+	/// <summary>
+	/// RGBA8画像をページに書き込む。余白には画像の縁の画素を引き延ばす
+	/// </summary>
+	/// <param name="page">ページの画素(RGBA8)</param>
+	/// <param name="pageWidth">ページの幅</param>
+	/// <param name="pageHeight">ページの高さ</param>
+	/// <param name="image">画像の画素(RGBA8)</param>
+	/// <param name="placement">配置</param>
+	/// <param name="padding">Packに渡した余白</param>
+	static void Blit(uint8_t* page, uint32_t pageWidth, uint32_t pageHeight, const uint8_t* image, const Placement& placement, uint32_t padding);
+};
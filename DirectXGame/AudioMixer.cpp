@@ -0,0 +1,722 @@
+#include "AudioMixer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define AUDIO_MIXER_USE_SSE2
+#endif
+
+namespace {
+
+// 一度に合成するフレーム数
+const uint32_t kBlockFrames = 256;
+// 固定小数点の小数部を0～1にする係数
+const float kFractionScale = 1.0f / 4294967296.0f;
+
+// ハンドルは下位16bitが枠の番号、上位16bitが世代
+uint32_t MakeHandle(uint32_t index, uint16_t generation) { return static_cast<uint32_t>(generation) << 16 | index; }
+
+// WAVE_FORMAT_IEEE_FLOAT
+const uint16_t kFormatFloat = 0x0003;
+// WAVE_FORMAT_EXTENSIBLE
+const uint16_t kFormatExtensible = 0xFFFE;
+
+// 実際のサンプル形式(EXTENSIBLEならSubFormatの先頭2バイト)
+uint16_t GetSampleFormat(const WaveFormat& format) {
+	if (format.formatTag == kFormatExtensible && format.extra.size() >= 8) {
+		uint16_t tag = 0;
+		std::memcpy(&tag, &format.extra[6], 2);
+		return tag;
+	}
+	return format.formatTag;
+}
+
+// 1サンプルを-1～1のfloatにする
+float DecodeSample(const uint8_t* src, uint16_t sampleFormat, uint16_t bitsPerSample) {
+	if (sampleFormat == kFormatFloat) {
+		float value;
+		std::memcpy(&value, src, 4);
+		return value;
+	}
+	switch (bitsPerSample) {
+	case 8:
+		return (static_cast<int32_t>(src[0]) - 128) * (1.0f / 128.0f);
+	case 16: {
+		int16_t value;
+		std::memcpy(&value, src, 2);
+		return value * (1.0f / 32768.0f);
+	}
+	case 24: {
+		int32_t value = static_cast<int32_t>(static_cast<uint32_t>(src[0]) << 8 | static_cast<uint32_t>(src[1]) << 16 | static_cast<uint32_t>(src[2]) << 24);
+		return (value >> 8) * (1.0f / 8388608.0f);
+	}
+	default: {
+		int32_t value;
+		std::memcpy(&value, src, 4);
+		return static_cast<float>(value * (1.0 / 2147483648.0));
+	}
+	}
+}
+
+// 線形補間した値に左右の音量を掛けて足す
+inline void MixFrame(float* dst, float l0, float l1, float r0, float r1, float t, float leftGain, float rightGain) {
+	dst[0] += (l0 + (l1 - l0) * t) * leftGain;
+	dst[1] += (r0 + (r1 - r0) * t) * rightGain;
+}
+
+// 4フレーム分をまとめて補間して足す(各配列は4要素、dstはステレオ交互で8要素)
+inline void MixFrames4(float* dst, const float* l0, const float* l1, const float* r0, const float* r1, const float* t, const float* leftGain, const float* rightGain) {
+#if defined(AUDIO_MIXER_USE_SSE2)
+	__m128 vt = _mm_loadu_ps(t);
+	__m128 vl0 = _mm_loadu_ps(l0);
+	__m128 vr0 = _mm_loadu_ps(r0);
+	__m128 left = _mm_mul_ps(_mm_add_ps(vl0, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(l1), vl0), vt)), _mm_loadu_ps(leftGain));
+	__m128 right = _mm_mul_ps(_mm_add_ps(vr0, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(r1), vr0), vt)), _mm_loadu_ps(rightGain));
+	// L0 R0 L1 R1 / L2 R2 L3 R3 に並べ替えて足す
+	_mm_storeu_ps(dst, _mm_add_ps(_mm_loadu_ps(dst), _mm_unpacklo_ps(left, right)));
+	_mm_storeu_ps(dst + 4, _mm_add_ps(_mm_loadu_ps(dst + 4), _mm_unpackhi_ps(left, right)));
+#else
+	for (int i = 0; i < 4; ++i) {
+		MixFrame(dst + i * 2, l0[i], l1[i], r0[i], r1[i], t[i], leftGain[i], rightGain[i]);
+	}
+#endif
+}
+
+// floatを16bitに変換する。範囲外は-1～1に収め、最近接偶数に丸める
+void ConvertToPcm16(int16_t* dst, const float* src, size_t count) {
+	size_t i = 0;
+#if defined(AUDIO_MIXER_USE_SSE2)
+	const __m128 scale = _mm_set1_ps(32767.0f);
+	const __m128 minimum = _mm_set1_ps(-1.0f);
+	const __m128 maximum = _mm_set1_ps(1.0f);
+	for (; i + 8 <= count; i += 8) {
+		__m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), minimum), maximum);
+		__m128 b = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 4), minimum), maximum);
+		__m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(a, scale)), _mm_cvtps_epi32(_mm_mul_ps(b, scale)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+	}
+#endif
+	for (; i < count; ++i) {
+		float value = (std::clamp)(src[i], -1.0f, 1.0f);
+		dst[i] = static_cast<int16_t>(std::nearbyint(value * 32767.0f));
+	}
+}
+
+} // namespace
+
+std::shared_ptr<const MixerSound> CreateMixerSound(const PcmSound& sound) {
+	const WaveFormat& format = sound.format;
+	uint16_t sampleFormat = GetSampleFormat(format);
+	bool supported = (sampleFormat == WaveFormat::kPcm && (format.bitsPerSample == 8 || format.bitsPerSample == 16 || format.bitsPerSample == 24 || format.bitsPerSample == 32)) ||
+	                 (sampleFormat == kFormatFloat && format.bitsPerSample == 32);
+	if (!supported || format.channels < 1 || format.channels > 2 || format.sampleRate == 0 || format.blockAlign != format.channels * format.bitsPerSample / 8) {
+		return nullptr;
+	}
+
+	auto result = std::make_shared<MixerSound>();
+	result->channels = format.channels;
+	result->sampleRate = format.sampleRate;
+	result->frameCount = static_cast<uint32_t>(sound.data.size() / format.blockAlign);
+	result->samples.resize(static_cast<size_t>(result->frameCount) * format.channels);
+	size_t bytesPerSample = format.bitsPerSample / 8;
+	for (size_t i = 0; i < result->samples.size(); ++i) {
+		result->samples[i] = DecodeSample(&sound.data[i * bytesPerSample], sampleFormat, format.bitsPerSample);
+	}
+	return result;
+}
+
+void AudioMixer::GainRamp::Set(float newTarget, uint32_t frameCount) {
+	target = newTarget;
+	remaining = frameCount;
+	if (frameCount == 0) {
+		current = newTarget;
+		step = 0.0f;
+	} else {
+		step = (newTarget - current) / frameCount;
+	}
+}
+
+float AudioMixer::GainRamp::Next() {
+	if (remaining == 0) {
+		return current;
+	}
+	// 最後のフレームで誤差を残さないようtargetに揃える
+	current = --remaining == 0 ? target : current + step;
+	return current;
+}
+
+void AudioMixer::GainRamp::Advance(uint32_t frameCount) {
+	if (frameCount >= remaining) {
+		current = target;
+		remaining = 0;
+	} else {
+		current += step * frameCount;
+		remaining -= frameCount;
+	}
+}
+
+/// <summary>
+/// ミキサーの出力を16bitステレオで読み出す音源
+/// </summary>
+class AudioMixer::OutputSource : public AudioStreamSource {
+public:
+	explicit OutputSource(AudioMixer* mixer) : mixer_(mixer) {}
+
+	const WaveFormat& GetFormat() const override { return mixer_->outputFormat_; }
+	// 無音でも常に埋めて返すので終端にならない
+	size_t Read(uint8_t* dst, size_t size) override { return mixer_->ReadPcm16(dst, size); }
+	bool Rewind() override { return true; }
+
+private:
+	AudioMixer* mixer_;
+};
+
+AudioMixer::AudioMixer(uint32_t sampleRate, uint32_t maxVoices, uint32_t maxRealVoices)
+    : sampleRate_(sampleRate), rampFrames_(sampleRate * kRampMilliseconds / 1000), maxRealVoices_(maxRealVoices), slots_((std::min)(maxVoices, 0xFFFFu)), commands_(kCommandQueueSize),
+      // 通知はボイスごとに1回なので、生きているボイスとキューに入る再生コマンドの数を超えない
+      released_(slots_.size() + kCommandQueueSize), states_(std::make_unique<std::atomic<uint32_t>[]>(slots_.size())), voices_(slots_.size()),
+      fadingVoices_((std::min)(maxRealVoices, static_cast<uint32_t>(slots_.size()))) {
+	outputFormat_.formatTag = WaveFormat::kPcm;
+	outputFormat_.channels = 2;
+	outputFormat_.sampleRate = sampleRate;
+	outputFormat_.bitsPerSample = 16;
+	outputFormat_.blockAlign = 4;
+	outputFormat_.avgBytesPerSec = sampleRate * 4;
+
+	busVolumes_.fill(1.0f);
+	for (BusState& bus : buses_) {
+		bus.gain.Set(1.0f, 0);
+		bus.buffer.resize(kBlockFrames * 2);
+	}
+	mixBuffer_.resize(kBlockFrames * 2);
+
+	// 小さい番号から使うよう逆順に積む
+	freeSlots_.reserve(slots_.size());
+	for (uint32_t i = static_cast<uint32_t>(slots_.size()); i > 0; --i) {
+		freeSlots_.push_back(i - 1);
+	}
+	activeVoices_.reserve(voices_.size());
+}
+
+uint32_t AudioMixer::Play(std::shared_ptr<const MixerSound> sound, Bus bus, bool loopFlag, float volume, float pitch, uint8_t priority) {
+	if (!sound || sound->frameCount == 0) {
+		return kInvalidHandle;
+	}
+	std::lock_guard<std::mutex> lock(producerMutex_);
+	CollectReleased();
+	uint32_t index = 0;
+	if (freeSlots_.empty()) {
+		// 枠が埋まっていれば、最も重要でないボイスが同じ優先度以下なら止めて譲ってもらう。
+		// 合成する側は同じ枠への再生コマンドで、前のボイスが鳴っていれば絞りながら鳴らし切るよう移してから上書きする
+		uint32_t victim = 0;
+		float victimAudibility = 0.0f;
+		for (uint32_t i = 0; i < slots_.size(); ++i) {
+			const Slot& slot = slots_[i];
+			float audibility = slot.volume * busVolumes_[static_cast<size_t>(slot.bus)];
+			if (i == 0 || slot.priority < slots_[victim].priority || (slot.priority == slots_[victim].priority && audibility <= victimAudibility)) {
+				victim = i;
+				victimAudibility = audibility;
+			}
+		}
+		if (slots_.empty() || slots_[victim].priority > priority) {
+			++rejects_;
+			return kInvalidHandle;
+		}
+		index = victim;
+		++steals_;
+	} else {
+		index = freeSlots_.back();
+		freeSlots_.pop_back();
+	}
+	++plays_;
+
+	Slot& slot = slots_[index];
+	++slot.generation;
+	slot.used = true;
+	slot.priority = priority;
+	slot.bus = bus;
+	slot.volume = volume;
+	states_[index].store(static_cast<uint32_t>(slot.generation) << 16 | 1, std::memory_order_release);
+
+	Command command;
+	command.type = CommandType::kPlay;
+	command.index = index;
+	command.generation = slot.generation;
+	command.priority = priority;
+	command.bus = bus;
+	command.loop = loopFlag;
+	command.value = volume;
+	command.pitch = pitch;
+	command.sound = std::move(sound);
+	Send(std::move(command));
+	return MakeHandle(index, slot.generation);
+}
+
+void AudioMixer::Stop(uint32_t handle) {
+	std::lock_guard<std::mutex> lock(producerMutex_);
+	if (FindSlot(handle)) {
+		ClearPlaying(handle & 0xFFFF, static_cast<uint16_t>(handle >> 16));
+		Command command;
+		command.type = CommandType::kStop;
+		command.index = handle & 0xFFFF;
+		command.generation = static_cast<uint16_t>(handle >> 16);
+		Send(std::move(command));
+	}
+}
+
+bool AudioMixer::IsPlaying(uint32_t handle) const {
+	uint32_t index = handle & 0xFFFF;
+	return index < slots_.size() && states_[index].load(std::memory_order_acquire) == ((handle & 0xFFFF0000) | 1);
+}
+
+void AudioMixer::SetVolume(uint32_t handle, float volume) {
+	std::lock_guard<std::mutex> lock(producerMutex_);
+	if (Slot* slot = FindSlot(handle)) {
+		slot->volume = volume;
+		Command command;
+		command.type = CommandType::kSetVolume;
+		command.index = handle & 0xFFFF;
+		command.generation = slot->generation;
+		command.value = volume;
+		Send(std::move(command));
+	}
+}
+
+void AudioMixer::SetPitch(uint32_t handle, float pitch) {
+	std::lock_guard<std::mutex> lock(producerMutex_);
+	if (Slot* slot = FindSlot(handle)) {
+		Command command;
+		command.type = CommandType::kSetPitch;
+		command.index = handle & 0xFFFF;
+		command.generation = slot->generation;
+		command.pitch = pitch;
+		Send(std::move(command));
+	}
+}
+
+void AudioMixer::SetPan(uint32_t handle, float pan) {
+	std::lock_guard<std::mutex> lock(producerMutex_);
+	if (Slot* slot = FindSlot(handle)) {
+		Command command;
+		command.type = CommandType::kSetPan;
+		command.index = handle & 0xFFFF;
+		command.generation = slot->generation;
+		command.pan = pan;
+		Send(std::move(command));
+	}
+}
+
+void AudioMixer::SetParameters(uint32_t handle, float volume, float pan, float pitch) {
+	std::lock_guard<std::mutex> lock(producerMutex_);
+	if (Slot* slot = FindSlot(handle)) {
+		slot->volume = volume;
+		Command command;
+		command.type = CommandType::kSetParameters;
+		command.index = handle & 0xFFFF;
+		command.generation = slot->generation;
+		command.value = volume;
+		command.pan = pan;
+		command.pitch = pitch;
+		Send(std::move(command));
+	}
+}
+
+void AudioMixer::SetBusVolume(Bus bus, float volume) {
+	std::lock_guard<std::mutex> lock(producerMutex_);
+	busVolumes_[static_cast<size_t>(bus)] = volume;
+	Command command;
+	command.type = CommandType::kSetBusVolume;
+	command.index = static_cast<uint32_t>(bus);
+	command.value = volume;
+	Send(std::move(command));
+}
+
+void AudioMixer::SetBusLowPass(Bus bus, float cutoffHz) {
+	std::lock_guard<std::mutex> lock(producerMutex_);
+	Command command;
+	command.type = CommandType::kSetBusLowPass;
+	command.index = static_cast<uint32_t>(bus);
+	command.value = cutoffHz;
+	Send(std::move(command));
+}
+
+uint32_t AudioMixer::GetVoiceCount() const {
+	uint32_t count = 0;
+	for (size_t i = 0; i < slots_.size(); ++i) {
+		count += states_[i].load(std::memory_order_relaxed) & 1;
+	}
+	return count;
+}
+
+AudioMixer::Statistics AudioMixer::GetStatistics() const {
+	Statistics statistics;
+	statistics.realVoices = realVoices_.load(std::memory_order_relaxed);
+	statistics.virtualVoices = virtualVoices_.load(std::memory_order_relaxed);
+	statistics.virtualizations = virtualizations_.load(std::memory_order_relaxed);
+	statistics.fadeOuts = fadeOuts_.load(std::memory_order_relaxed);
+	statistics.fadeOutCuts = fadeOutCuts_.load(std::memory_order_relaxed);
+	std::lock_guard<std::mutex> lock(producerMutex_);
+	statistics.pendingCommands = static_cast<uint32_t>(pendingCommands_.size());
+	statistics.plays = plays_;
+	statistics.steals = steals_;
+	statistics.rejects = rejects_;
+	return statistics;
+}
+
+void AudioMixer::Mix(float* dst, uint32_t frameCount) {
+	ProcessCommands();
+	for (uint32_t offset = 0; offset < frameCount; offset += kBlockFrames) {
+		uint32_t frames = (std::min)(kBlockFrames, frameCount - offset);
+		for (BusState& bus : buses_) {
+			std::fill(bus.buffer.begin(), bus.buffer.end(), 0.0f);
+		}
+
+		// 実ボイスはバスごとに足し込み、仮想ボイスは位置だけ進める。絞り終えたもの、鳴り終えたものは空ける
+		SelectRealVoices();
+		for (uint32_t index : activeVoices_) {
+			Voice& voice = voices_[index];
+			bool playing = voice.real ? MixVoice(voice, buses_[static_cast<size_t>(voice.bus)].buffer.data(), frames) : SkipVoice(voice, frames);
+			if (!playing || (voice.stopping && voice.gain.remaining == 0)) {
+				Release(index);
+			}
+		}
+		// 枠を奪われたボイスは絞り切るまで合成する(枠は既に譲っているので通知はしない)
+		for (Voice& voice : fadingVoices_) {
+			if (voice.sound && (!MixVoice(voice, buses_[static_cast<size_t>(voice.bus)].buffer.data(), frames) || voice.gain.remaining == 0)) {
+				voice.sound.reset();
+			}
+		}
+
+		// バスの音量とフィルタを掛けてまとめる
+		float* out = dst + static_cast<size_t>(offset) * 2;
+		std::fill(out, out + frames * 2, 0.0f);
+		for (BusState& bus : buses_) {
+			const float* src = bus.buffer.data();
+			for (uint32_t i = 0; i < frames; ++i) {
+				float gain = bus.gain.Next();
+				float left = src[i * 2] * gain;
+				float right = src[i * 2 + 1] * gain;
+				if (bus.lowPass != 0.0f) {
+					bus.lowPassState[0] += bus.lowPass * (left - bus.lowPassState[0]);
+					bus.lowPassState[1] += bus.lowPass * (right - bus.lowPassState[1]);
+					left = bus.lowPassState[0];
+					right = bus.lowPassState[1];
+				}
+				out[i * 2] += left;
+				out[i * 2 + 1] += right;
+			}
+		}
+	}
+}
+
+std::unique_ptr<AudioStreamSource> AudioMixer::CreateOutputSource() { return std::make_unique<OutputSource>(this); }
+
+bool AudioMixer::RenderToWaveFile(const std::string& filePath, uint32_t frameCount) {
+	std::vector<uint8_t> data(static_cast<size_t>(frameCount) * outputFormat_.blockAlign);
+	ReadPcm16(data.data(), data.size());
+	return WriteWaveFile(filePath, outputFormat_, data.data(), data.size());
+}
+
+void AudioMixer::CollectReleased() {
+	Released released;
+	while (released_.TryPop(released)) {
+		// 既に別の再生に譲った枠なら世代が違うので戻さない
+		Slot& slot = slots_[released.index];
+		if (slot.used && slot.generation == released.generation) {
+			slot.used = false;
+			freeSlots_.push_back(released.index);
+		}
+	}
+}
+
+void AudioMixer::Send(Command&& command) {
+	// 通知を溜めすぎないよう送るたびに受け取る
+	CollectReleased();
+	// 順序を保つため、取っておいた分を先に送る
+	while (!pendingCommands_.empty() && commands_.TryPush(std::move(pendingCommands_.front()))) {
+		pendingCommands_.pop_front();
+	}
+	if (!pendingCommands_.empty() || !commands_.TryPush(std::move(command))) {
+		pendingCommands_.push_back(std::move(command));
+	}
+}
+
+AudioMixer::Slot* AudioMixer::FindSlot(uint32_t handle) {
+	CollectReleased();
+	// 枠が使い回されていれば世代が合わないので、古いハンドルは無視される
+	uint32_t index = handle & 0xFFFF;
+	if (index >= slots_.size() || !slots_[index].used || slots_[index].generation != handle >> 16) {
+		return nullptr;
+	}
+	return &slots_[index];
+}
+
+void AudioMixer::ClearPlaying(uint32_t index, uint16_t generation) {
+	uint32_t expected = static_cast<uint32_t>(generation) << 16 | 1;
+	// 失敗するのは既に落ちているか、別の再生に譲ったとき
+	states_[index].compare_exchange_strong(expected, expected & ~1u, std::memory_order_acq_rel);
+}
+
+void AudioMixer::ProcessCommands() {
+	Command command;
+	while (commands_.TryPop(command)) {
+		if (command.type == CommandType::kSetBusVolume) {
+			buses_[command.index].gain.Set(command.value, rampFrames_);
+			continue;
+		}
+		if (command.type == CommandType::kSetBusLowPass) {
+			// 1次のIIR: y += a * (x - y)、a = 1 - exp(-2πfc/fs)。ナイキスト周波数以上は無効と同じ
+			BusState& bus = buses_[command.index];
+			if (command.value <= 0.0f || command.value * 2.0f >= static_cast<float>(sampleRate_)) {
+				bus.lowPass = 0.0f;
+			} else {
+				bus.lowPass = static_cast<float>(1.0 - std::exp(-2.0 * 3.14159265358979323846 * command.value / sampleRate_));
+			}
+			continue;
+		}
+		if (command.type == CommandType::kPlay) {
+			// 譲られた枠なら前のボイスはここで上書きする(通知はしない)。鳴っていたものは絞りながら鳴らし切る
+			Voice& voice = voices_[command.index];
+			if (voice.sound && voice.real) {
+				FadeOutStolenVoice(voice);
+			}
+			voice.generation = command.generation;
+			voice.priority = command.priority;
+			voice.bus = command.bus;
+			voice.loop = command.loop;
+			voice.stopping = false;
+			voice.position = 0;
+			voice.step = CalculateStep(*command.sound, command.pitch);
+			// 鳴り始めは素材の立ち上がりをそのまま使う
+			voice.gain = GainRamp();
+			voice.gain.Set(command.value, 0);
+			voice.fade = GainRamp();
+			voice.fade.Set(1.0f, 0);
+			voice.leftGain = GainRamp();
+			voice.rightGain = GainRamp();
+			ApplyPan(voice, command.pan, 0);
+			// 合成するかはSelectRealVoicesで決める
+			voice.real = true;
+			// 最後の参照ならここで解放されるので、音声はSoundBankなどで持っておくこと
+			voice.sound = std::move(command.sound);
+			continue;
+		}
+
+		Voice* voice = FindVoice(command.index, command.generation);
+		if (!voice) {
+			continue;
+		}
+		switch (command.type) {
+		case CommandType::kStop:
+			voice->stopping = true;
+			voice->gain.Set(0.0f, rampFrames_);
+			break;
+		case CommandType::kSetVolume:
+			if (!voice->stopping) {
+				voice->gain.Set(command.value, rampFrames_);
+			}
+			break;
+		case CommandType::kSetPitch:
+			voice->step = CalculateStep(*voice->sound, command.pitch);
+			break;
+		case CommandType::kSetPan:
+			ApplyPan(*voice, command.pan, rampFrames_);
+			break;
+		case CommandType::kSetParameters:
+			if (!voice->stopping) {
+				voice->gain.Set(command.value, rampFrames_);
+			}
+			ApplyPan(*voice, command.pan, rampFrames_);
+			voice->step = CalculateStep(*voice->sound, command.pitch);
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+void AudioMixer::FadeOutStolenVoice(Voice& voice) {
+	if (fadingVoices_.empty()) {
+		return;
+	}
+	// 空きが無ければ今最も小さい音のものを打ち切る
+	Voice* slot = &fadingVoices_[0];
+	for (Voice& fading : fadingVoices_) {
+		if (!fading.sound) {
+			slot = &fading;
+			break;
+		}
+		if (fading.gain.current * fading.fade.current < slot->gain.current * slot->fade.current) {
+			slot = &fading;
+		}
+	}
+	if (slot->sound) {
+		fadeOutCuts_.fetch_add(1, std::memory_order_relaxed);
+	}
+	*slot = std::move(voice);
+	// 停止の途中ならそのまま絞り続ける
+	if (!slot->stopping) {
+		slot->stopping = true;
+		slot->gain.Set(0.0f, rampFrames_);
+	}
+	fadeOuts_.fetch_add(1, std::memory_order_relaxed);
+}
+
+AudioMixer::Voice* AudioMixer::FindVoice(uint32_t index, uint16_t generation) {
+	Voice& voice = voices_[index];
+	return voice.sound && voice.generation == generation ? &voice : nullptr;
+}
+
+void AudioMixer::Release(uint32_t index) {
+	Voice& voice = voices_[index];
+	voice.sound.reset();
+	ClearPlaying(index, voice.generation);
+	// 容量は足りるように確保しているので失敗しない
+	released_.TryPush({index, voice.generation});
+}
+
+void AudioMixer::ApplyPan(Voice& voice, float pan, uint32_t frameCount) {
+	// 中央で左右とも1になる振り分け(中央に置いた音の大きさを変えない)
+	pan = (std::clamp)(pan, -1.0f, 1.0f);
+	voice.leftGain.Set((std::min)(1.0f, 1.0f - pan), frameCount);
+	voice.rightGain.Set((std::min)(1.0f, 1.0f + pan), frameCount);
+}
+
+float AudioMixer::GetAudibility(const Voice& voice) const { return voice.gain.target * buses_[static_cast<size_t>(voice.bus)].gain.target; }
+
+bool AudioMixer::IsLessImportant(uint32_t a, uint32_t b) const {
+	const Voice& voiceA = voices_[a];
+	const Voice& voiceB = voices_[b];
+	if (voiceA.priority != voiceB.priority) {
+		return voiceA.priority < voiceB.priority;
+	}
+	float audibilityA = GetAudibility(voiceA);
+	float audibilityB = GetAudibility(voiceB);
+	if (audibilityA != audibilityB) {
+		return audibilityA < audibilityB;
+	}
+	// 同じなら仮想ボイス、後の枠の順。結果が毎回同じになるよう必ず順序を決める
+	if (voiceA.real != voiceB.real) {
+		return !voiceA.real;
+	}
+	return a > b;
+}
+
+void AudioMixer::SelectRealVoices() {
+	activeVoices_.clear();
+	for (uint32_t i = 0; i < voices_.size(); ++i) {
+		if (voices_[i].sound) {
+			activeVoices_.push_back(i);
+		}
+	}
+
+	// 音量が0に落ち着いたもの(聞こえない距離の発音体など)は合成しても無音なので、常に仮想ボイスにする
+	auto silent = std::partition(activeVoices_.begin(), activeVoices_.end(), [this](uint32_t index) { return voices_[index].gain.target != 0.0f || voices_[index].gain.remaining != 0; });
+	size_t audibleCount = static_cast<size_t>(silent - activeVoices_.begin());
+
+	// 重要な順に実ボイスの数だけ前に集める
+	size_t realCount = (std::min)(audibleCount, static_cast<size_t>(maxRealVoices_));
+	if (realCount < audibleCount) {
+		std::nth_element(activeVoices_.begin(), activeVoices_.begin() + realCount, silent, [this](uint32_t a, uint32_t b) { return IsLessImportant(b, a); });
+	}
+	for (size_t i = 0; i < activeVoices_.size(); ++i) {
+		Voice& voice = voices_[activeVoices_[i]];
+		bool real = i < realCount;
+		if (real && !voice.real) {
+			// 途中から鳴り始めるのでプチノイズが出ないようフェードインする
+			voice.fade.Set(0.0f, 0);
+			voice.fade.Set(1.0f, rampFrames_);
+		} else if (!real && voice.real) {
+			virtualizations_.fetch_add(1, std::memory_order_relaxed);
+		}
+		voice.real = real;
+	}
+	realVoices_.store(static_cast<uint32_t>(realCount), std::memory_order_relaxed);
+	virtualVoices_.store(static_cast<uint32_t>(activeVoices_.size() - realCount), std::memory_order_relaxed);
+}
+
+uint64_t AudioMixer::CalculateStep(const MixerSound& sound, float pitch) const {
+	double ratio = static_cast<double>(sound.sampleRate) / sampleRate_ * (std::max)(pitch, 0.0f);
+	// 止まらないよう最低でも1/2^32は進める
+	return (std::max)(static_cast<uint64_t>(ratio * 4294967296.0), static_cast<uint64_t>(1));
+}
+
+bool AudioMixer::MixVoice(Voice& voice, float* dst, uint32_t frameCount) {
+	const MixerSound& sound = *voice.sound;
+	const float* samples = sound.samples.data();
+	const uint32_t channels = sound.channels;
+	// モノラルは左右に同じサンプルを使う
+	const uint32_t rightOffset = channels - 1;
+	const uint64_t length = static_cast<uint64_t>(sound.frameCount) << 32;
+
+	uint32_t i = 0;
+	while (i < frameCount) {
+		if (voice.position >= length) {
+			if (!voice.loop) {
+				return false;
+			}
+			voice.position %= length;
+		}
+
+		// 4フレーム先まで補間相手が終端をまたがなければまとめて処理する
+		if (i + 4 <= frameCount && ((voice.position + voice.step * 3) >> 32) + 1 < sound.frameCount) {
+			float l0[4], l1[4], r0[4], r1[4], t[4], leftGain[4], rightGain[4];
+			for (int j = 0; j < 4; ++j) {
+				uint64_t position = voice.position + voice.step * j;
+				size_t index = static_cast<size_t>(position >> 32) * channels;
+				l0[j] = samples[index];
+				l1[j] = samples[index + channels];
+				r0[j] = samples[index + rightOffset];
+				r1[j] = samples[index + channels + rightOffset];
+				t[j] = static_cast<uint32_t>(position) * kFractionScale;
+				float gain = voice.gain.Next() * voice.fade.Next();
+				leftGain[j] = gain * voice.leftGain.Next();
+				rightGain[j] = gain * voice.rightGain.Next();
+			}
+			MixFrames4(dst + i * 2, l0, l1, r0, r1, t, leftGain, rightGain);
+			voice.position += voice.step * 4;
+			i += 4;
+			continue;
+		}
+
+		// 終端付近は1フレームずつ。補間相手はループなら先頭、そうでなければ最後のサンプル
+		uint32_t frame = static_cast<uint32_t>(voice.position >> 32);
+		uint32_t next = frame + 1 < sound.frameCount ? frame + 1 : (voice.loop ? 0 : frame);
+		size_t index = static_cast<size_t>(frame) * channels;
+		size_t nextIndex = static_cast<size_t>(next) * channels;
+		float t = static_cast<uint32_t>(voice.position) * kFractionScale;
+		float gain = voice.gain.Next() * voice.fade.Next();
+		MixFrame(dst + i * 2, samples[index], samples[nextIndex], samples[index + rightOffset], samples[nextIndex + rightOffset], t, gain * voice.leftGain.Next(), gain * voice.rightGain.Next());
+		voice.position += voice.step;
+		++i;
+	}
+	return true;
+}
+
+bool AudioMixer::SkipVoice(Voice& voice, uint32_t frameCount) {
+	const uint64_t length = static_cast<uint64_t>(voice.sound->frameCount) << 32;
+	voice.gain.Advance(frameCount);
+	voice.leftGain.Advance(frameCount);
+	voice.rightGain.Advance(frameCount);
+	voice.position += voice.step * frameCount;
+	if (voice.position >= length) {
+		if (!voice.loop) {
+			return false;
+		}
+		voice.position %= length;
+	}
+	return true;
+}
+
+size_t AudioMixer::ReadPcm16(uint8_t* dst, size_t size) {
+	uint32_t frameCount = static_cast<uint32_t>(size / outputFormat_.blockAlign);
+	int16_t* out = reinterpret_cast<int16_t*>(dst);
+	for (uint32_t offset = 0; offset < frameCount; offset += kBlockFrames) {
+		uint32_t frames = (std::min)(kBlockFrames, frameCount - offset);
+		Mix(mixBuffer_.data(), frames);
+		ConvertToPcm16(out + static_cast<size_t>(offset) * 2, mixBuffer_.data(), frames * 2);
+	}
+	return static_cast<size_t>(frameCount) * outputFormat_.blockAlign;
+}
@@ -0,0 +1,315 @@
+#pragma once
+#include "AudioStreamSource.h"
+#include "PcmSound.h"
+#include "SpscQueue.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// ミキサーで再生する音声(floatに変換済み、チャンネル交互)
+/// </summary>
+struct MixerSound {
+	// 1(モノラル)か2(ステレオ)
+	uint32_t channels = 0;
+	uint32_t sampleRate = 0;
+	uint32_t frameCount = 0;
+	std::vector<float> samples;
+};
+
+/// <summary>
+/// リニアPCMをミキサー用に変換する(8/16/24/32bit、モノラルかステレオ)
+/// </summary>
+/// <param name="sound">変換元</param>
+/// <returns>変換後の音声。対応しない形式ならnullptr</returns>
+std::shared_ptr<const MixerSound> CreateMixerSound(const PcmSound& sound);
+
+/// <summary>
+/// ソフトウェアミキサー
+/// 複数のボイスをサンプルレート変換しながらバスごとに合成し、ステレオ1本の出力にまとめる。
+/// 出力は呼び出し側が要求したフレーム数だけ決まった順序で計算するので、同じ操作なら同じ結果になる。
+/// ボイスは固定数の枠を使い回し、実際に合成する数を超えた分は優先度と音量の低いものから
+/// 仮想ボイス(再生位置だけ進めて合成しない)にする。
+/// 枠が埋まっていて他のボイスから奪うときは、奪われたボイスを絞り切るまで別に合成してプチノイズを防ぐ。
+/// 操作はコマンドとしてキューに積み、合成するスレッドがMixの先頭でまとめて反映する。
+/// 合成するスレッドはロックを取らず、再生状態は原子変数で公開するのでIsPlayingはどのスレッドからも待たずに読める
+/// </summary>
+class AudioMixer {
+public:
+	// バス
+	enum class Bus {
+		kSfx, // 効果音
+		kBgm, // 曲
+		kUi,  // UI
+	};
+	// バスの数
+	static const size_t kBusCount = 3;
+	// 無効な再生ハンドル
+	static const uint32_t kInvalidHandle = UINT32_MAX;
+	// 出力のサンプルレートの既定値
+	static const uint32_t kDefaultSampleRate = 48000;
+	// 同時に再生できるボイス数(仮想ボイスを含む)の既定値
+	static const uint32_t kDefaultMaxVoices = 256;
+	// 実際に合成するボイス数の既定値
+	static const uint32_t kDefaultMaxRealVoices = 64;
+	// 優先度の既定値。大きいほど仮想化されにくい
+	static const uint8_t kDefaultPriority = 128;
+	// 音量を変えるときにかける時間(ミリ秒)。急に変えるとプチノイズになる
+	static const uint32_t kRampMilliseconds = 10;
+	// 合成するスレッドに一度に送れるコマンド数。あふれた分は次の操作のときに送る
+	static const uint32_t kCommandQueueSize = 4096;
+
+	/// <summary>
+	/// コンストラクタ
+	/// </summary>
+	/// <param name="sampleRate">出力のサンプルレート</param>
+	/// <param name="maxVoices">同時に再生できるボイス数(仮想ボイスを含む、65535まで)</param>
+	/// <param name="maxRealVoices">実際に合成するボイス数</param>
+	explicit AudioMixer(uint32_t sampleRate = kDefaultSampleRate, uint32_t maxVoices = kDefaultMaxVoices, uint32_t maxRealVoices = kDefaultMaxRealVoices);
+
+	/// <summary>
+	/// 再生。以下の操作は複数のスレッドから呼んでよい
+	/// </summary>
+	/// <param name="sound">音声</param>
+	/// <param name="bus">出力先のバス</param>
+	/// <param name="loopFlag">ループ再生フラグ</param>
+	/// <param name="volume">ボリューム</param>
+	/// <param name="pitch">再生速度の倍率</param>
+	/// <param name="priority">優先度。枠が埋まっていれば、これ以下の優先度のボイスを止めて使う</param>
+	/// <returns>再生ハンドル。枠を確保できなければkInvalidHandle</returns>
+	uint32_t Play(std::shared_ptr<const MixerSound> sound, Bus bus = Bus::kSfx, bool loopFlag = false, float volume = 1.0f, float pitch = 1.0f, uint8_t priority = kDefaultPriority);
+
+	// 停止(音量を絞ってから止める)
+	void Stop(uint32_t handle);
+	// 再生中か(停止を指示したものは含まない)
+	bool IsPlaying(uint32_t handle) const;
+	// 音量設定
+	void SetVolume(uint32_t handle, float volume);
+	// 再生速度の倍率の設定
+	void SetPitch(uint32_t handle, float pitch);
+	// 左右の定位の設定(-1で左、0で中央、1で右)
+	void SetPan(uint32_t handle, float pan);
+	// 音量・定位・再生速度の倍率をまとめて設定(3Dサウンドの毎フレームの更新用)
+	void SetParameters(uint32_t handle, float volume, float pan, float pitch);
+	// バスの音量設定
+	void SetBusVolume(Bus bus, float volume);
+	// バスのローパスフィルタのカットオフ周波数の設定。0で無効
+	void SetBusLowPass(Bus bus, float cutoffHz);
+	// 再生中のボイス数(仮想ボイスを含み、停止を指示したものは含まない)
+	uint32_t GetVoiceCount() const;
+
+	// 統計情報
+	struct Statistics {
+		// 直近の合成での実ボイス数と仮想ボイス数
+		uint32_t realVoices = 0;
+		uint32_t virtualVoices = 0;
+		// キューがあふれて送れずにいるコマンド数
+		uint32_t pendingCommands = 0;
+		// 再生した回数、枠が埋まっていて他のボイスを止めた回数、再生できなかった回数
+		uint64_t plays = 0;
+		uint64_t steals = 0;
+		uint64_t rejects = 0;
+		// 仮想ボイスにした回数(鳴り始めから仮想ボイスになったものを含む)
+		uint64_t virtualizations = 0;
+		// 枠を奪われて絞りながら鳴らし切ることにしたボイスの数と、そのうち絞り切る前に打ち切った数
+		uint64_t fadeOuts = 0;
+		uint64_t fadeOutCuts = 0;
+	};
+	Statistics GetStatistics() const;
+
+	// 出力のサンプルレート
+	uint32_t GetSampleRate() const { return sampleRate_; }
+
+	/// <summary>
+	/// 合成。1つのスレッドからだけ呼ぶ
+	/// </summary>
+	/// <param name="dst">出力先(ステレオ交互のfloat、frameCount * 2個)</param>
+	/// <param name="frameCount">フレーム数</param>
+	void Mix(float* dst, uint32_t frameCount);
+
+	/// <summary>
+	/// 出力を16bitステレオのPCMとして読み出す音源を作る。
+	/// StreamingAudioに渡せばそのまま鳴らせる。音源はミキサーより先に破棄すること
+	/// </summary>
+	/// <returns>音源</returns>
+	std::unique_ptr<AudioStreamSource> CreateOutputSource();
+
+	/// <summary>
+	/// 出力をWAVファイルに書き出す(オフラインでの確認用)
+	/// </summary>
+	/// <param name="filePath">ファイルパス</param>
+	/// <param name="frameCount">書き出すフレーム数</param>
+	/// <returns>成否</returns>
+	bool RenderToWaveFile(const std::string& filePath, uint32_t frameCount);
+
+private:
+	class OutputSource;
+
+	// 音量の補間
+	struct GainRamp {
+		float current = 0.0f;
+		float target = 0.0f;
+		float step = 0.0f;
+		uint32_t remaining = 0;
+
+		// frameCountフレームかけてtargetに近づける
+		void Set(float newTarget, uint32_t frameCount);
+		// 次のフレームの音量
+		float Next();
+		// frameCountフレーム進める
+		void Advance(uint32_t frameCount);
+	};
+
+	// コマンドの種類
+	enum class CommandType : uint8_t {
+		kPlay,
+		kStop,
+		kSetVolume,
+		kSetPitch,
+		kSetPan,
+		kSetParameters,
+		kSetBusVolume,
+		kSetBusLowPass,
+	};
+
+	// 合成するスレッドへの指示
+	struct Command {
+		CommandType type = CommandType::kPlay;
+		// ボイスの枠の番号と世代(バスの操作ではバスの番号)
+		uint32_t index = 0;
+		uint16_t generation = 0;
+		uint8_t priority = kDefaultPriority;
+		Bus bus = Bus::kSfx;
+		bool loop = false;
+		// 音量、再生速度の倍率、カットオフ周波数
+		float value = 0.0f;
+		float pitch = 1.0f;
+		float pan = 0.0f;
+		std::shared_ptr<const MixerSound> sound;
+	};
+
+	// 再生し終えて空いた枠の通知
+	struct Released {
+		uint32_t index = 0;
+		uint16_t generation = 0;
+	};
+
+	// 操作する側から見た枠の状態
+	struct Slot {
+		// 再生するたびに増やす。ハンドルの上位16bit
+		uint16_t generation = 0;
+		bool used = false;
+		uint8_t priority = kDefaultPriority;
+		Bus bus = Bus::kSfx;
+		float volume = 0.0f;
+	};
+
+	// 合成する側のボイス
+	struct Voice {
+		std::shared_ptr<const MixerSound> sound;
+		uint16_t generation = 0;
+		uint8_t priority = kDefaultPriority;
+		Bus bus = Bus::kSfx;
+		bool loop = false;
+		// 絞り終えたら止める
+		bool stopping = false;
+		// 実ボイスとして合成しているか
+		bool real = false;
+		// 再生位置(32.32の固定小数点のフレーム位置)と1出力フレームあたりの進み
+		uint64_t position = 0;
+		uint64_t step = 0;
+		GainRamp gain;
+		// 仮想ボイスから戻ったときのフェードイン
+		GainRamp fade;
+		// 定位による左右の音量
+		GainRamp leftGain;
+		GainRamp rightGain;
+	};
+
+	struct BusState {
+		GainRamp gain;
+		// ローパスフィルタの係数(0なら無効)と左右の状態
+		float lowPass = 0.0f;
+		float lowPassState[2] = {};
+		// 合成途中の波形(ステレオ交互)
+		std::vector<float> buffer;
+	};
+
+	// 操作する側の処理(producerMutex_を取った状態で呼ぶ)
+	// 空いた枠の通知を受け取る
+	void CollectReleased();
+	// コマンドを送る。あふれた分は取っておいて次に送る
+	void Send(Command&& command);
+	// ハンドルが指す枠。再生が終わっていればnullptr
+	Slot* FindSlot(uint32_t handle);
+	// 再生状態の再生中フラグを落とす。世代が違えば何もしない
+	void ClearPlaying(uint32_t index, uint16_t generation);
+
+	// 合成する側の処理
+	// 溜まったコマンドを反映する
+	void ProcessCommands();
+	// 枠を奪われる実ボイスを絞りながら鳴らし切るよう移す
+	void FadeOutStolenVoice(Voice& voice);
+	// ハンドルが指すボイス。再生し終えていればnullptr
+	Voice* FindVoice(uint32_t index, uint16_t generation);
+	// 枠を空けて操作する側に知らせる
+	void Release(uint32_t index);
+	// 定位から左右の音量を決める
+	static void ApplyPan(Voice& voice, float pan, uint32_t frameCount);
+	// 聞こえる大きさの目安(ボイスとバスの音量)
+	float GetAudibility(const Voice& voice) const;
+	// 優先度と音量で比べてaの方が先に仮想化・停止されるべきか
+	bool IsLessImportant(uint32_t a, uint32_t b) const;
+	// 実ボイスを選ぶ。それ以外は仮想ボイスにする
+	void SelectRealVoices();
+	// 再生速度から位置の進みを計算
+	uint64_t CalculateStep(const MixerSound& sound, float pitch) const;
+	// ボイスを合成先に足し込む。再生し終えたらfalse
+	static bool MixVoice(Voice& voice, float* dst, uint32_t frameCount);
+	// 仮想ボイスの再生位置と音量だけ進める。再生し終えたらfalse
+	static bool SkipVoice(Voice& voice, uint32_t frameCount);
+	// 16bitに変換して読み出す
+	size_t ReadPcm16(uint8_t* dst, size_t size);
+
+	uint32_t sampleRate_;
+	uint32_t rampFrames_;
+	WaveFormat outputFormat_;
+	uint32_t maxRealVoices_;
+
+	// 操作する側の状態。合成する側はこのロックを取らない
+	mutable std::mutex producerMutex_;
+	std::vector<Slot> slots_;
+	// 空いている枠の番号
+	std::vector<uint32_t> freeSlots_;
+	std::array<float, kBusCount> busVolumes_;
+	// キューに入りきらなかったコマンド
+	std::deque<Command> pendingCommands_;
+	uint64_t plays_ = 0;
+	uint64_t steals_ = 0;
+	uint64_t rejects_ = 0;
+
+	// 操作する側から合成する側へのコマンドと、その逆向きの空いた枠の通知
+	SpscQueue<Command> commands_;
+	SpscQueue<Released> released_;
+	// 枠ごとの再生状態(上位16bitが世代、最下位bitが再生中)
+	std::unique_ptr<std::atomic<uint32_t>[]> states_;
+
+	// 合成する側の状態
+	std::vector<Voice> voices_;
+	// 枠を奪われて絞っている途中のボイス(実ボイスの数だけ用意し、足りなければ最も小さいものを打ち切る)
+	std::vector<Voice> fadingVoices_;
+	// 再生中の枠の番号(合成時の作業用)
+	std::vector<uint32_t> activeVoices_;
+	std::array<BusState, kBusCount> buses_;
+	std::vector<float> mixBuffer_;
+	std::atomic<uint32_t> realVoices_{0};
+	std::atomic<uint32_t> virtualVoices_{0};
+	std::atomic<uint64_t> virtualizations_{0};
+	std::atomic<uint64_t> fadeOuts_{0};
+	std::atomic<uint64_t> fadeOutCuts_{0};
+};
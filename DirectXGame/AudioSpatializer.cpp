@@ -0,0 +1,131 @@
+#include "AudioSpatializer.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define AUDIO_SPATIALIZER_USE_SSE2
+#endif
+
+namespace {
+
+// 0除算を避けるための最小の距離
+const float kMinimumDistance = 1.0e-4f;
+
+} // namespace
+
+void AudioSpatializer::Resize(size_t count) {
+	count_ = count;
+	// SIMDで端数を気にせず4つずつ読めるよう切り上げる
+	size_t padded = (count + 3) & ~static_cast<size_t>(3);
+	for (std::vector<float>* values : {&positionX_, &positionY_, &positionZ_, &velocityX_, &velocityY_, &velocityZ_, &minDistance_, &gain_, &pan_}) {
+		values->resize(padded, 0.0f);
+	}
+	// 最大距離が0なら常に聞こえない
+	maxDistance_.resize(padded, 0.0f);
+	pitch_.resize(padded, 1.0f);
+}
+
+void AudioSpatializer::SetEmitter(size_t index, const float position[3], const float velocity[3], float minDistance, float maxDistance) {
+	positionX_[index] = position[0];
+	positionY_[index] = position[1];
+	positionZ_[index] = position[2];
+	velocityX_[index] = velocity[0];
+	velocityY_[index] = velocity[1];
+	velocityZ_[index] = velocity[2];
+	minDistance_[index] = (std::max)(minDistance, kMinimumDistance);
+	maxDistance_[index] = maxDistance;
+}
+
+void AudioSpatializer::Process(const Listener& listener, float dopplerScale, float speedOfSound) {
+	size_t i = 0;
+
+#if defined(AUDIO_SPATIALIZER_USE_SSE2)
+	// 音速を超えると式が破綻するので、近づく・遠ざかる速さは音速の半分までにする
+	const float speedLimit = speedOfSound * 0.5f;
+	const __m128 lx = _mm_set1_ps(listener.position[0]);
+	const __m128 ly = _mm_set1_ps(listener.position[1]);
+	const __m128 lz = _mm_set1_ps(listener.position[2]);
+	const __m128 lvx = _mm_set1_ps(listener.velocity[0] * dopplerScale);
+	const __m128 lvy = _mm_set1_ps(listener.velocity[1] * dopplerScale);
+	const __m128 lvz = _mm_set1_ps(listener.velocity[2] * dopplerScale);
+	const __m128 rx = _mm_set1_ps(listener.right[0]);
+	const __m128 ry = _mm_set1_ps(listener.right[1]);
+	const __m128 rz = _mm_set1_ps(listener.right[2]);
+	const __m128 scale = _mm_set1_ps(dopplerScale);
+	const __m128 c = _mm_set1_ps(speedOfSound);
+	const __m128 limit = _mm_set1_ps(speedLimit);
+	const __m128 negativeLimit = _mm_set1_ps(-speedLimit);
+	const __m128 minimumDistance = _mm_set1_ps(kMinimumDistance);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 negativeOne = _mm_set1_ps(-1.0f);
+	const __m128 minPitch = _mm_set1_ps(kMinPitch);
+	const __m128 maxPitch = _mm_set1_ps(kMaxPitch);
+
+	for (; i < count_; i += 4) {
+		// 聴取者から発音体への向きと距離
+		__m128 dx = _mm_sub_ps(_mm_loadu_ps(&positionX_[i]), lx);
+		__m128 dy = _mm_sub_ps(_mm_loadu_ps(&positionY_[i]), ly);
+		__m128 dz = _mm_sub_ps(_mm_loadu_ps(&positionZ_[i]), lz);
+		__m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+		__m128 inverse = _mm_div_ps(one, _mm_max_ps(distance, minimumDistance));
+		__m128 ux = _mm_mul_ps(dx, inverse);
+		__m128 uy = _mm_mul_ps(dy, inverse);
+		__m128 uz = _mm_mul_ps(dz, inverse);
+
+		// 最小距離までは減衰せず、その先は距離に反比例し、最大距離で0になるよう絞る
+		__m128 minDistance = _mm_loadu_ps(&minDistance_[i]);
+		__m128 maxDistance = _mm_loadu_ps(&maxDistance_[i]);
+		__m128 attenuation = _mm_div_ps(minDistance, _mm_max_ps(distance, minDistance));
+		__m128 fade = _mm_div_ps(_mm_sub_ps(maxDistance, distance), _mm_max_ps(_mm_sub_ps(maxDistance, minDistance), minimumDistance));
+		fade = _mm_min_ps(_mm_max_ps(fade, zero), one);
+		_mm_storeu_ps(&gain_[i], _mm_mul_ps(attenuation, fade));
+
+		// 右方向との内積で左右に振る
+		__m128 pan = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ux, rx), _mm_mul_ps(uy, ry)), _mm_mul_ps(uz, rz));
+		_mm_storeu_ps(&pan_[i], _mm_min_ps(_mm_max_ps(pan, negativeOne), one));
+
+		// 聴取者が近づく速さと発音体が遠ざかる速さから f' = f * (c + vl) / (c + vs)
+		__m128 vl = _mm_add_ps(_mm_add_ps(_mm_mul_ps(lvx, ux), _mm_mul_ps(lvy, uy)), _mm_mul_ps(lvz, uz));
+		__m128 vx = _mm_mul_ps(_mm_loadu_ps(&velocityX_[i]), scale);
+		__m128 vy = _mm_mul_ps(_mm_loadu_ps(&velocityY_[i]), scale);
+		__m128 vz = _mm_mul_ps(_mm_loadu_ps(&velocityZ_[i]), scale);
+		__m128 vs = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, ux), _mm_mul_ps(vy, uy)), _mm_mul_ps(vz, uz));
+		vl = _mm_min_ps(_mm_max_ps(vl, negativeLimit), limit);
+		vs = _mm_min_ps(_mm_max_ps(vs, negativeLimit), limit);
+		__m128 pitch = _mm_div_ps(_mm_add_ps(c, vl), _mm_add_ps(c, vs));
+		_mm_storeu_ps(&pitch_[i], _mm_min_ps(_mm_max_ps(pitch, minPitch), maxPitch));
+	}
+#endif
+
+	// SIMDが使えない環境では同じ計算を1つずつ行う
+	ProcessScalar(listener, dopplerScale, speedOfSound, i);
+}
+
+void AudioSpatializer::ProcessScalar(const Listener& listener, float dopplerScale, float speedOfSound, size_t begin) {
+	// 音速を超えると式が破綻するので、近づく・遠ざかる速さは音速の半分までにする
+	const float speedLimit = speedOfSound * 0.5f;
+	for (size_t i = begin; i < count_; ++i) {
+		float dx = positionX_[i] - listener.position[0];
+		float dy = positionY_[i] - listener.position[1];
+		float dz = positionZ_[i] - listener.position[2];
+		float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+		float inverse = 1.0f / (std::max)(distance, kMinimumDistance);
+		float ux = dx * inverse;
+		float uy = dy * inverse;
+		float uz = dz * inverse;
+
+		float attenuation = minDistance_[i] / (std::max)(distance, minDistance_[i]);
+		float fade = (maxDistance_[i] - distance) / (std::max)(maxDistance_[i] - minDistance_[i], kMinimumDistance);
+		gain_[i] = attenuation * (std::clamp)(fade, 0.0f, 1.0f);
+
+		pan_[i] = (std::clamp)(ux * listener.right[0] + uy * listener.right[1] + uz * listener.right[2], -1.0f, 1.0f);
+
+		float vl = (listener.velocity[0] * dopplerScale) * ux + (listener.velocity[1] * dopplerScale) * uy + (listener.velocity[2] * dopplerScale) * uz;
+		float vs = (velocityX_[i] * dopplerScale) * ux + (velocityY_[i] * dopplerScale) * uy + (velocityZ_[i] * dopplerScale) * uz;
+		vl = (std::clamp)(vl, -speedLimit, speedLimit);
+		vs = (std::clamp)(vs, -speedLimit, speedLimit);
+		pitch_[i] = (std::clamp)((speedOfSound + vl) / (speedOfSound + vs), kMinPitch, kMaxPitch);
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// 3Dサウンドの計算
+/// 発音体ごとの位置と速度から、聴取者に対する音量・左右の定位・ドップラー効果による再生速度の倍率をまとめて計算する。
+/// 発音体は要素ごとの配列(SoA)で持ち、4つずつSIMDで処理する
+/// </summary>
+class AudioSpatializer {
+public:
+	// 音速(m/s)の既定値
+	static constexpr float kSpeedOfSound = 343.0f;
+	// ドップラー効果による再生速度の倍率の範囲
+	static constexpr float kMinPitch = 0.5f;
+	static constexpr float kMaxPitch = 2.0f;
+
+	/// <summary>
+	/// 聴取者
+	/// </summary>
+	struct Listener {
+		float position[3] = {};
+		float velocity[3] = {};
+		// 右方向の単位ベクトル(左右の定位に使う)
+		float right[3] = {1.0f, 0.0f, 0.0f};
+	};
+
+	/// <summary>
+	/// 発音体の数の変更(増えた分は聞こえない設定になる)
+	/// </summary>
+	/// <param name="count">発音体の数</param>
+	void Resize(size_t count);
+
+	/// <summary>
+	/// 発音体の設定
+	/// </summary>
+	/// <param name="index">番号</param>
+	/// <param name="position">位置</param>
+	/// <param name="velocity">速度(m/s)</param>
+	/// <param name="minDistance">これより近ければ減衰しない距離</param>
+	/// <param name="maxDistance">これより遠ければ聞こえない距離</param>
+	void SetEmitter(size_t index, const float position[3], const float velocity[3], float minDistance, float maxDistance);
+
+	/// <summary>
+	/// すべての発音体の音量・定位・再生速度の倍率を計算する
+	/// </summary>
+	/// <param name="listener">聴取者</param>
+	/// <param name="dopplerScale">ドップラー効果の強さ(0で無効)</param>
+	/// <param name="speedOfSound">音速</param>
+	void Process(const Listener& listener, float dopplerScale = 1.0f, float speedOfSound = kSpeedOfSound);
+
+	/// <summary>
+	/// Processと同じ計算をSIMDを使わずに1つずつ行う(SIMDが使えない環境用。結果の比較にも使う)
+	/// </summary>
+	/// <param name="listener">聴取者</param>
+	/// <param name="dopplerScale">ドップラー効果の強さ(0で無効)</param>
+	/// <param name="speedOfSound">音速</param>
+	/// <param name="begin">計算を始める発音体の番号</param>
+	void ProcessScalar(const Listener& listener, float dopplerScale = 1.0f, float speedOfSound = kSpeedOfSound, size_t begin = 0);
+
+	// 発音体の数
+	size_t GetCount() const { return count_; }
+	// 距離による音量(0～1)
+	float GetGain(size_t index) const { return gain_[index]; }
+	// 左右の定位(-1で左、1で右)
+	float GetPan(size_t index) const { return pan_[index]; }
+	// ドップラー効果による再生速度の倍率
+	float GetPitch(size_t index) const { return pitch_[index]; }
+	// 聞こえる距離にあるか
+	bool IsAudible(size_t index) const { return gain_[index] > 0.0f; }
+
+private:
+	size_t count_ = 0;
+	// 入力(4の倍数に切り上げた長さで持つ)
+	std::vector<float> positionX_, positionY_, positionZ_;
+	std::vector<float> velocityX_, velocityY_, velocityZ_;
+	std::vector<float> minDistance_, maxDistance_;
+	// 出力
+	std::vector<float> gain_, pan_, pitch_;
+};
@@ -0,0 +1,130 @@
+#include "AudioStreamSource.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// チャンクのヘッダ
+struct ChunkHeader {
+	char id[4];
+	uint32_t size;
+};
+
+} // namespace
+
+bool WaveFileSource::ReadHeader(std::istream& stream, WaveFormat& format, uint64_t& dataSize) {
+	ChunkHeader riff;
+	char waveId[4];
+	if (!stream.read(reinterpret_cast<char*>(&riff), sizeof(riff)) || !stream.read(waveId, sizeof(waveId))) {
+		return false;
+	}
+	if (std::strncmp(riff.id, "RIFF", 4) != 0 || std::strncmp(waveId, "WAVE", 4) != 0) {
+		return false;
+	}
+
+	// fmtチャンクの後のdataチャンクまで読み進める(LISTなど他のチャンクは飛ばす)
+	bool hasFormat = false;
+	ChunkHeader chunk;
+	while (stream.read(reinterpret_cast<char*>(&chunk), sizeof(chunk))) {
+		if (std::strncmp(chunk.id, "fmt ", 4) == 0) {
+			std::vector<uint8_t> body(chunk.size);
+			if (chunk.size < 16 || !stream.read(reinterpret_cast<char*>(body.data()), chunk.size)) {
+				return false;
+			}
+			std::memcpy(&format.formatTag, &body[0], 2);
+			std::memcpy(&format.channels, &body[2], 2);
+			std::memcpy(&format.sampleRate, &body[4], 4);
+			std::memcpy(&format.avgBytesPerSec, &body[8], 4);
+			std::memcpy(&format.blockAlign, &body[12], 2);
+			std::memcpy(&format.bitsPerSample, &body[14], 2);
+			format.extra.clear();
+			if (chunk.size >= 18) {
+				uint16_t extraSize = 0;
+				std::memcpy(&extraSize, &body[16], 2);
+				extraSize = static_cast<uint16_t>((std::min)(static_cast<uint32_t>(extraSize), chunk.size - 18));
+				format.extra.assign(body.begin() + 18, body.begin() + 18 + extraSize);
+			}
+			hasFormat = true;
+		} else if (std::strncmp(chunk.id, "data", 4) == 0) {
+			dataSize = chunk.size;
+			return hasFormat && format.blockAlign != 0;
+		} else {
+			stream.seekg(chunk.size, std::ios::cur);
+		}
+		// チャンクは2バイト境界に置かれる
+		if (chunk.size & 1) {
+			stream.seekg(1, std::ios::cur);
+		}
+	}
+	return false;
+}
+
+bool WaveFileSource::Open(const std::string& filePath) {
+	file_.close();
+	file_.clear();
+	file_.open(filePath, std::ios::binary);
+	if (!file_ || !ReadHeader(file_, format_, dataSize_)) {
+		return false;
+	}
+	dataOffset_ = file_.tellg();
+	position_ = 0;
+	return true;
+}
+
+size_t WaveFileSource::Read(uint8_t* dst, size_t size) {
+	uint64_t remaining = dataSize_ - position_;
+	// 終端の短いブロックはそのまま返し、それ以外はブロック境界で区切る
+	if (size < remaining) {
+		size -= size % format_.blockAlign;
+	} else {
+		size = static_cast<size_t>(remaining);
+	}
+	if (size == 0 || !file_.read(reinterpret_cast<char*>(dst), static_cast<std::streamsize>(size))) {
+		return 0;
+	}
+	position_ += size;
+	return size;
+}
+
+bool WaveFileSource::Rewind() {
+	file_.clear();
+	file_.seekg(dataOffset_);
+	position_ = 0;
+	return static_cast<bool>(file_);
+}
+
+bool WriteWaveFile(const std::string& filePath, const WaveFormat& format, const void* data, size_t size) {
+	std::ofstream file(filePath, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+	// PCMは16バイト、それ以外はcbSizeと拡張部分を付ける
+	uint32_t formatSize = format.formatTag == WaveFormat::kPcm ? 16 : 18 + static_cast<uint32_t>(format.extra.size());
+	uint32_t dataSize = static_cast<uint32_t>(size);
+
+	ChunkHeader riff = {{'R', 'I', 'F', 'F'}, static_cast<uint32_t>(4 + sizeof(ChunkHeader) + formatSize + sizeof(ChunkHeader) + dataSize + (dataSize & 1))};
+	file.write(reinterpret_cast<const char*>(&riff), sizeof(riff));
+	file.write("WAVE", 4);
+
+	ChunkHeader fmt = {{'f', 'm', 't', ' '}, formatSize};
+	file.write(reinterpret_cast<const char*>(&fmt), sizeof(fmt));
+	file.write(reinterpret_cast<const char*>(&format.formatTag), 2);
+	file.write(reinterpret_cast<const char*>(&format.channels), 2);
+	file.write(reinterpret_cast<const char*>(&format.sampleRate), 4);
+	file.write(reinterpret_cast<const char*>(&format.avgBytesPerSec), 4);
+	file.write(reinterpret_cast<const char*>(&format.blockAlign), 2);
+	file.write(reinterpret_cast<const char*>(&format.bitsPerSample), 2);
+	if (format.formatTag != WaveFormat::kPcm) {
+		uint16_t extraSize = static_cast<uint16_t>(format.extra.size());
+		file.write(reinterpret_cast<const char*>(&extraSize), 2);
+		file.write(reinterpret_cast<const char*>(format.extra.data()), extraSize);
+	}
+
+	ChunkHeader chunk = {{'d', 'a', 't', 'a'}, dataSize};
+	file.write(reinterpret_cast<const char*>(&chunk), sizeof(chunk));
+	file.write(static_cast<const char*>(data), size);
+	if (dataSize & 1) {
+		file.put(0);
+	}
+	return static_cast<bool>(file);
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// 波形フォーマット(WAVEFORMATEXと同じ内容をXAudio2に依存せずに持つ)
+/// </summary>
+struct WaveFormat {
+	// リニアPCM
+	static const uint16_t kPcm = 0x0001;
+	// IMA-ADPCM
+	static const uint16_t kImaAdpcm = 0x0011;
+
+	uint16_t formatTag = 0;
+	uint16_t channels = 0;
+	uint32_t sampleRate = 0;
+	uint32_t avgBytesPerSec = 0;
+	uint16_t blockAlign = 0;
+	uint16_t bitsPerSample = 0;
+	// fmtチャンクの拡張部分(cbSizeの後ろ)
+	std::vector<uint8_t> extra;
+};
+
+/// <summary>
+/// ストリーミング再生の音源
+/// 出力はGetFormatの形式で、ブロック境界で区切って返す
+/// </summary>
+class AudioStreamSource {
+public:
+	virtual ~AudioStreamSource() = default;
+
+	// 出力する波形フォーマット
+	virtual const WaveFormat& GetFormat() const = 0;
+
+	/// <summary>
+	/// 続きの読み出し
+	/// </summary>
+	/// <param name="dst">出力先</param>
+	/// <param name="size">出力先のバイト数</param>
+	/// <returns>書き込んだバイト数(blockAlignの倍数)。終端なら0</returns>
+	virtual size_t Read(uint8_t* dst, size_t size) = 0;
+
+	/// <summary>
+	/// 先頭に戻る(ループ再生用)
+	/// </summary>
+	/// <returns>成否</returns>
+	virtual bool Rewind() = 0;
+};
+
+/// <summary>
+/// WAVファイルのチャンクを順に読み出す音源
+/// 波形データ全体はメモリに載せず、Readのたびにファイルから読む
+/// </summary>
+class WaveFileSource : public AudioStreamSource {
+public:
+	/// <summary>
+	/// ファイルを開いてfmtチャンクとdataチャンクの位置を読む
+	/// </summary>
+	/// <param name="filePath">ファイルパス</param>
+	/// <returns>成否</returns>
+	bool Open(const std::string& filePath);
+
+	const WaveFormat& GetFormat() const override { return format_; }
+	size_t Read(uint8_t* dst, size_t size) override;
+	bool Rewind() override;
+
+	// dataチャンクのバイト数
+	uint64_t GetDataSize() const { return dataSize_; }
+
+	/// <summary>
+	/// RIFFヘッダを読み、dataチャンクの先頭まで進める
+	/// </summary>
+	/// <param name="stream">入力</param>
+	/// <param name="format">fmtチャンクの内容</param>
+	/// <param name="dataSize">dataチャンクのバイト数</param>
+	/// <returns>成否</returns>
+	static bool ReadHeader(std::istream& stream, WaveFormat& format, uint64_t& dataSize);
+
+private:
+	std::ifstream file_;
+	WaveFormat format_;
+	// dataチャンクの中身の位置とバイト数
+	std::streamoff dataOffset_ = 0;
+	uint64_t dataSize_ = 0;
+	// 読み出し済みのバイト数
+	uint64_t position_ = 0;
+};
+
+/// <summary>
+/// WAVファイルの書き出し(ミキサーのオフライン出力用)
+/// </summary>
+/// <param name="filePath">ファイルパス</param>
+/// <param name="format">波形フォーマット</param>
+/// <param name="data">波形データ</param>
+/// <param name="size">波形データのバイト数</param>
+/// <returns>成否</returns>
+bool WriteWaveFile(const std::string& filePath, const WaveFormat& format, const void* data, size_t size);
@@ -0,0 +1,63 @@
+#include "BatchSprite.h"
+
+using namespace KamataEngine;
+
+// 同じ値を毎フレーム設定しても作り直さないよう、変わったときだけフラグを立てる
+
+void BatchSprite::SetPosition(const Vector2& position) {
+	if (desc_.position.x != position.x || desc_.position.y != position.y) {
+		desc_.position = position;
+		// 範囲はアンカーポイントから見た値なので作り直さない
+		dirtyFlags_ |= kDirtyVertices | kDirtyInstance;
+	}
+}
+
+void BatchSprite::SetRotation(float rotation) {
+	if (desc_.rotation != rotation) {
+		desc_.rotation = rotation;
+		dirtyFlags_ |= kDirtyAll;
+	}
+}
+
+void BatchSprite::SetSize(const Vector2& size) {
+	if (desc_.size.x != size.x || desc_.size.y != size.y) {
+		desc_.size = size;
+		dirtyFlags_ |= kDirtyAll;
+	}
+}
+
+void BatchSprite::SetAnchorPoint(const Vector2& anchorPoint) {
+	if (desc_.anchorPoint.x != anchorPoint.x || desc_.anchorPoint.y != anchorPoint.y) {
+		desc_.anchorPoint = anchorPoint;
+		dirtyFlags_ |= kDirtyAll;
+	}
+}
+
+void BatchSprite::SetColor(const Vector4& color) {
+	if (desc_.color.x != color.x || desc_.color.y != color.y || desc_.color.z != color.z || desc_.color.w != color.w) {
+		desc_.color = color;
+		dirtyFlags_ |= kDirtyVertices | kDirtyInstance;
+	}
+}
+
+void BatchSprite::SetIsFlipX(bool isFlipX) {
+	if (desc_.isFlipX != isFlipX) {
+		desc_.isFlipX = isFlipX;
+		dirtyFlags_ |= kDirtyAll;
+	}
+}
+
+void BatchSprite::SetIsFlipY(bool isFlipY) {
+	if (desc_.isFlipY != isFlipY) {
+		desc_.isFlipY = isFlipY;
+		dirtyFlags_ |= kDirtyAll;
+	}
+}
+
+void BatchSprite::SetTextureRect(const Vector2& texBase, const Vector2& texSize) {
+	if (desc_.texBase.x != texBase.x || desc_.texBase.y != texBase.y || desc_.texSize.x != texSize.x || desc_.texSize.y != texSize.y) {
+		desc_.texBase = texBase;
+		desc_.texSize = texSize;
+		dirtyFlags_ |= kDirtyVertices | kDirtyInstance;
+	}
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include "SpriteBatch.h"
+
+/// <summary>
+/// SpriteBatchで描く常駐スプライト
+/// 変換済みの頂点(インスタンス)と画面外判定用の範囲を持ち続け、設定が変わったときだけSpriteBatch::Endで1回作り直す。
+/// 変わらないスプライトは毎フレームの書き込みがコピーだけになる
+/// </summary>
+class BatchSprite {
+public:
+	BatchSprite() = default;
+
+	/// <summary>
+	/// コンストラクタ
+	/// </summary>
+	/// <param name="desc">描画設定</param>
+	explicit BatchSprite(const SpriteBatch::SpriteDesc& desc) : desc_(desc) {}
+
+	/// <summary>
+	/// テクスチャハンドルの設定
+	/// </summary>
+	/// <param name="textureHandle">テクスチャハンドル</param>
+	void SetTextureHandle(uint32_t textureHandle) { desc_.textureHandle = textureHandle; }
+	uint32_t GetTextureHandle() const { return desc_.textureHandle; }
+
+	/// <summary>
+	/// 座標の設定
+	/// </summary>
+	/// <param name="position">座標</param>
+	void SetPosition(const KamataEngine::Vector2& position);
+	const KamataEngine::Vector2& GetPosition() const { return desc_.position; }
+
+	/// <summary>
+	/// 回転角の設定
+	/// </summary>
+	/// <param name="rotation">回転角(ラジアン)</param>
+	void SetRotation(float rotation);
+	float GetRotation() const { return desc_.rotation; }
+
+	/// <summary>
+	/// サイズの設定
+	/// </summary>
+	/// <param name="size">サイズ</param>
+	void SetSize(const KamataEngine::Vector2& size);
+	const KamataEngine::Vector2& GetSize() const { return desc_.size; }
+
+	/// <summary>
+	/// アンカーポイントの設定
+	/// </summary>
+	/// <param name="anchorPoint">アンカーポイント</param>
+	void SetAnchorPoint(const KamataEngine::Vector2& anchorPoint);
+	const KamataEngine::Vector2& GetAnchorPoint() const { return desc_.anchorPoint; }
+
+	/// <summary>
+	/// 色の設定
+	/// </summary>
+	/// <param name="color">色(RGBA)</param>
+	void SetColor(const KamataEngine::Vector4& color);
+	const KamataEngine::Vector4& GetColor() const { return desc_.color; }
+
+	/// <summary>
+	/// 左右反転の設定
+	/// </summary>
+	/// <param name="isFlipX">左右反転</param>
+	void SetIsFlipX(bool isFlipX);
+	bool GetIsFlipX() const { return desc_.isFlipX; }
+
+	/// <summary>
+	/// 上下反転の設定
+	/// </summary>
+	/// <param name="isFlipY">上下反転</param>
+	void SetIsFlipY(bool isFlipY);
+	bool GetIsFlipY() const { return desc_.isFlipY; }
+
+	/// <summary>
+	/// テクスチャ範囲設定
+	/// </summary>
+	/// <param name="texBase">テクスチャ左上座標</param>
+	/// <param name="texSize">テクスチャサイズ</param>
+	void SetTextureRect(const KamataEngine::Vector2& texBase, const KamataEngine::Vector2& texSize);
+
+	// ブレンドモードの設定
+	void SetBlendMode(RenderBlendMode blendMode) { desc_.blendMode = blendMode; }
+	// レイヤーの設定
+	void SetLayer(int32_t layer) { desc_.layer = layer; }
+
+	// 描画設定の取得
+	const SpriteBatch::SpriteDesc& GetDesc() const { return desc_; }
+
+private:
+	friend class SpriteBatch;
+
+	// 作り直しが必要なもの
+	enum DirtyFlag : uint32_t {
+		kDirtyBounds = 1 << 0,   //!< 画面外判定用の範囲
+		kDirtyVertices = 1 << 1, //!< SpriteBatch::Mode::kVertexの頂点
+		kDirtyInstance = 1 << 2, //!< SpriteBatch::Mode::kInstancedのインスタンス
+		kDirtyAll = kDirtyBounds | kDirtyVertices | kDirtyInstance,
+	};
+
+	SpriteBatch::SpriteDesc desc_;
+	uint32_t dirtyFlags_ = kDirtyAll;
+	// アンカーポイントから見た範囲(左、上、右、下)
+	float bounds_[4] = {};
+	SpriteBatch::Vertex vertices_[4] = {};
+	SpriteBatch::Instance instance_ = {};
+	// 頂点を作ったときのテクスチャの大きさ(変わればテクスチャ座標から作り直す)
+	uint32_t textureWidth_ = 0;
+	uint32_t textureHeight_ = 0;
+};
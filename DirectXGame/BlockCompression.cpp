@@ -0,0 +1,257 @@
+#include "BlockCompression.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+namespace {
+
+// 8bitのRGBを565に詰める
+uint16_t PackRgb565(const int* color) {
+	int r = (color[0] * 31 + 127) / 255;
+	int g = (color[1] * 63 + 127) / 255;
+	int b = (color[2] * 31 + 127) / 255;
+	return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+// 565を8bitのRGBに戻す
+void UnpackRgb565(uint16_t packed, int* color) {
+	int r = (packed >> 11) & 31;
+	int g = (packed >> 5) & 63;
+	int b = packed & 31;
+	color[0] = (r << 3) | (r >> 2);
+	color[1] = (g << 2) | (g >> 4);
+	color[2] = (b << 3) | (b >> 2);
+}
+
+// 色のブロックを8バイトに圧縮する(4色モード)
+void CompressColorBlock(const uint8_t* rgba, uint8_t* output) {
+	// 主軸の代わりに各成分の範囲で端点を決め、少し内側に寄せる
+	int minColor[3] = {255, 255, 255};
+	int maxColor[3] = {0, 0, 0};
+	for (int i = 0; i < 16; ++i) {
+		for (int c = 0; c < 3; ++c) {
+			minColor[c] = (std::min)(minColor[c], static_cast<int>(rgba[i * 4 + c]));
+			maxColor[c] = (std::max)(maxColor[c], static_cast<int>(rgba[i * 4 + c]));
+		}
+	}
+	for (int c = 0; c < 3; ++c) {
+		int inset = (maxColor[c] - minColor[c]) / 16;
+		minColor[c] = (std::min)(minColor[c] + inset, 255);
+		maxColor[c] = (std::max)(maxColor[c] - inset, 0);
+	}
+
+	uint16_t color0 = PackRgb565(maxColor);
+	uint16_t color1 = PackRgb565(minColor);
+	uint32_t indices = 0;
+	if (color0 < color1) {
+		std::swap(color0, color1);
+	}
+	if (color0 != color1) {
+		// 4色のパレットを作って各画素に最も近い色を選ぶ
+		int palette[4][3];
+		UnpackRgb565(color0, palette[0]);
+		UnpackRgb565(color1, palette[1]);
+		for (int c = 0; c < 3; ++c) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+		for (int i = 0; i < 16; ++i) {
+			int bestIndex = 0;
+			int bestDistance = INT32_MAX;
+			for (int p = 0; p < 4; ++p) {
+				int distance = 0;
+				for (int c = 0; c < 3; ++c) {
+					int d = static_cast<int>(rgba[i * 4 + c]) - palette[p][c];
+					distance += d * d;
+				}
+				if (distance < bestDistance) {
+					bestDistance = distance;
+					bestIndex = p;
+				}
+			}
+			indices |= static_cast<uint32_t>(bestIndex) << (i * 2);
+		}
+	}
+
+	output[0] = static_cast<uint8_t>(color0 & 0xFF);
+	output[1] = static_cast<uint8_t>(color0 >> 8);
+	output[2] = static_cast<uint8_t>(color1 & 0xFF);
+	output[3] = static_cast<uint8_t>(color1 >> 8);
+	std::memcpy(output + 4, &indices, sizeof(indices));
+}
+
+// αのブロックを8バイトに圧縮する(8段階モード)
+void CompressAlphaBlock(const uint8_t* rgba, uint8_t* output) {
+	int minAlpha = 255;
+	int maxAlpha = 0;
+	for (int i = 0; i < 16; ++i) {
+		minAlpha = (std::min)(minAlpha, static_cast<int>(rgba[i * 4 + 3]));
+		maxAlpha = (std::max)(maxAlpha, static_cast<int>(rgba[i * 4 + 3]));
+	}
+	output[0] = static_cast<uint8_t>(maxAlpha);
+	output[1] = static_cast<uint8_t>(minAlpha);
+
+	uint64_t indices = 0;
+	if (maxAlpha != minAlpha) {
+		int palette[8];
+		palette[0] = maxAlpha;
+		palette[1] = minAlpha;
+		for (int p = 1; p < 7; ++p) {
+			palette[p + 1] = ((7 - p) * maxAlpha + p * minAlpha) / 7;
+		}
+		for (int i = 0; i < 16; ++i) {
+			int alpha = rgba[i * 4 + 3];
+			int bestIndex = 0;
+			int bestDistance = INT32_MAX;
+			for (int p = 0; p < 8; ++p) {
+				int distance = std::abs(alpha - palette[p]);
+				if (distance < bestDistance) {
+					bestDistance = distance;
+					bestIndex = p;
+				}
+			}
+			indices |= static_cast<uint64_t>(bestIndex) << (i * 3);
+		}
+	}
+	for (int i = 0; i < 6; ++i) {
+		output[2 + i] = static_cast<uint8_t>(indices >> (i * 8));
+	}
+}
+
+// 色のブロックを展開してRGBに書く(αは触らない)
+void DecompressColorBlock(const uint8_t* block, uint8_t* rgba) {
+	uint16_t color0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+	uint16_t color1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+	uint32_t indices = 0;
+	std::memcpy(&indices, block + 4, sizeof(indices));
+
+	int palette[4][3];
+	UnpackRgb565(color0, palette[0]);
+	UnpackRgb565(color1, palette[1]);
+	for (int c = 0; c < 3; ++c) {
+		if (color0 > color1) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		} else {
+			// 3色モード(圧縮側では書かないが、他のツールのDDSを読めるようにする)
+			palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+			palette[3][c] = 0;
+		}
+	}
+	for (int i = 0; i < 16; ++i) {
+		const int* color = palette[(indices >> (i * 2)) & 3];
+		for (int c = 0; c < 3; ++c) {
+			rgba[i * 4 + c] = static_cast<uint8_t>(color[c]);
+		}
+	}
+}
+
+// 画像からブロックを切り出す。端の画素は複製して埋める
+void FetchBlock(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, uint8_t* block) {
+	for (uint32_t y = 0; y < 4; ++y) {
+		uint32_t sy = (std::min)(blockY * 4 + y, height - 1);
+		for (uint32_t x = 0; x < 4; ++x) {
+			uint32_t sx = (std::min)(blockX * 4 + x, width - 1);
+			std::memcpy(block + (y * 4 + x) * 4, rgba + (static_cast<size_t>(sy) * width + sx) * 4, 4);
+		}
+	}
+}
+
+} // namespace
+
+uint32_t GetBlockSize(BlockFormat format) { return format == BlockFormat::kBC1 ? 8 : 16; }
+
+void CompressBlockBC1(const uint8_t* rgba, uint8_t* output) { CompressColorBlock(rgba, output); }
+
+void CompressBlockBC3(const uint8_t* rgba, uint8_t* output) {
+	CompressAlphaBlock(rgba, output);
+	CompressColorBlock(rgba, output + 8);
+}
+
+std::vector<uint8_t> CompressImage(const uint8_t* rgba, uint32_t width, uint32_t height, BlockFormat format, uint32_t threadCount) {
+	uint32_t blocksX = (std::max)((width + 3) / 4, 1u);
+	uint32_t blocksY = (std::max)((height + 3) / 4, 1u);
+	uint32_t blockSize = GetBlockSize(format);
+	std::vector<uint8_t> output(static_cast<size_t>(blocksX) * blocksY * blockSize);
+
+	if (threadCount == 0) {
+		threadCount = (std::max)(std::thread::hardware_concurrency(), 1u);
+	}
+	threadCount = (std::min)(threadCount, blocksY);
+
+	// ブロック同士は独立しているので、ブロック行を早い者勝ちで取り合う
+	std::atomic<uint32_t> nextRow = 0;
+	auto worker = [&]() {
+		uint8_t block[64];
+		for (uint32_t by = nextRow++; by < blocksY; by = nextRow++) {
+			for (uint32_t bx = 0; bx < blocksX; ++bx) {
+				FetchBlock(rgba, width, height, bx, by, block);
+				uint8_t* dst = output.data() + (static_cast<size_t>(by) * blocksX + bx) * blockSize;
+				if (format == BlockFormat::kBC1) {
+					CompressBlockBC1(block, dst);
+				} else {
+					CompressBlockBC3(block, dst);
+				}
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (uint32_t i = 1; i < threadCount; ++i) {
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	return output;
+}
+
+void DecompressBlockBC1(const uint8_t* block, uint8_t* rgba) {
+	DecompressColorBlock(block, rgba);
+	uint16_t color0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+	uint16_t color1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+	uint32_t indices = 0;
+	std::memcpy(&indices, block + 4, sizeof(indices));
+	for (int i = 0; i < 16; ++i) {
+		// 3色モードの4番目だけが透明の黒
+		rgba[i * 4 + 3] = color0 <= color1 && ((indices >> (i * 2)) & 3) == 3 ? 0 : 255;
+	}
+}
+
+void DecompressBlockBC3(const uint8_t* block, uint8_t* rgba) {
+	DecompressColorBlock(block + 8, rgba);
+	int palette[8];
+	palette[0] = block[0];
+	palette[1] = block[1];
+	if (palette[0] > palette[1]) {
+		for (int p = 1; p < 7; ++p) {
+			palette[p + 1] = ((7 - p) * palette[0] + p * palette[1]) / 7;
+		}
+	} else {
+		for (int p = 1; p < 5; ++p) {
+			palette[p + 1] = ((5 - p) * palette[0] + p * palette[1]) / 5;
+		}
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+	uint64_t indices = 0;
+	for (int i = 0; i < 6; ++i) {
+		indices |= static_cast<uint64_t>(block[2 + i]) << (i * 8);
+	}
+	for (int i = 0; i < 16; ++i) {
+		rgba[i * 4 + 3] = static_cast<uint8_t>(palette[(indices >> (i * 3)) & 7]);
+	}
+}
+
+bool IsOpaque(const uint8_t* rgba, size_t pixelCount) {
+	for (size_t i = 0; i < pixelCount; ++i) {
+		if (rgba[i * 4 + 3] != 255) {
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// ブロック圧縮形式
+/// </summary>
+enum class BlockFormat {
+	kBC1, //!< RGB(αなし)。4x4ブロックあたり8バイト
+	kBC3, //!< RGBA。4x4ブロックあたり16バイト
+};
+
+/// <summary>
+/// 1ブロック(4x4画素)のバイト数
+/// </summary>
+uint32_t GetBlockSize(BlockFormat format);
+
+/// <summary>
+/// 4x4画素のBC1圧縮。αは無視し、常に不透明の4色モードで書く
+/// </summary>
+/// <param name="rgba">16画素分のRGBA8</param>
+/// <param name="output">8バイトの出力先</param>
+void CompressBlockBC1(const uint8_t* rgba, uint8_t* output);
+
+/// <summary>
+/// 4x4画素のBC3圧縮
+/// </summary>
+/// <param name="rgba">16画素分のRGBA8</param>
+/// <param name="output">16バイトの出力先</param>
+void CompressBlockBC3(const uint8_t* rgba, uint8_t* output);
+
+/// <summary>
+/// BC1ブロックの展開(テストとツールでの誤差の確認用)
+/// </summary>
+/// <param name="block">8バイトのブロック</param>
+/// <param name="rgba">16画素分のRGBA8の出力先</param>
+void DecompressBlockBC1(const uint8_t* block, uint8_t* rgba);
+
+/// <summary>
+/// BC3ブロックの展開(テストとツールでの誤差の確認用)
+/// </summary>
+/// <param name="block">16バイトのブロック</param>
+/// <param name="rgba">16画素分のRGBA8の出力先</param>
+void DecompressBlockBC3(const uint8_t* block, uint8_t* rgba);
+
+/// <summary>
+/// すべての画素が不透明か(BC1で足りるかの判定)
+/// </summary>
+/// <param name="rgba">RGBA8の画素</param>
+/// <param name="pixelCount">画素数</param>
+/// <returns>αがすべて255ならtrue</returns>
+bool IsOpaque(const uint8_t* rgba, size_t pixelCount);
+
+/// <summary>
+/// 画像全体のブロック圧縮。ブロック行を複数スレッドに分けて処理する
+/// </summary>
+/// <param name="rgba">RGBA8の画素(行間の詰め物なし)</param>
+/// <param name="width">幅</param>
+/// <param name="height">高さ</param>
+/// <param name="format">圧縮形式</param>
+/// <param name="threadCount">スレッド数。0ならハードウェアスレッド数</param>
+/// <returns>圧縮したブロック列</returns>
+std::vector<uint8_t> CompressImage(const uint8_t* rgba, uint32_t width, uint32_t height, BlockFormat format, uint32_t threadCount = 0);
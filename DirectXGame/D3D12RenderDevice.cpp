@@ -0,0 +1,366 @@
+#include "D3D12RenderDevice.h"
+#include <algorithm>
+#include <base\DirectXCommon.h>
+#include <base\TextureManager.h>
+#include <cassert>
+#include <cstring>
+#include <d3dcompiler.h>
+#include <d3dx12.h>
+#include <string>
+#include <vector>
+
+#pragma comment(lib, "d3dcompiler.lib")
+
+using namespace Microsoft::WRL;
+using namespace KamataEngine;
+
+namespace {
+
+/// <summary>
+/// シェーダのコンパイル
+/// </summary>
+ComPtr<ID3DBlob> CompileShader(const std::wstring& filePath, const char* target) {
+	ComPtr<ID3DBlob> blob;
+	ComPtr<ID3DBlob> errorBlob;
+	HRESULT result = D3DCompileFromFile(
+	    filePath.c_str(), nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, "main", target, D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION, 0, &blob, &errorBlob);
+	if (FAILED(result)) {
+		// エラー内容を出力ウィンドウに表示
+		if (errorBlob) {
+			std::string errstr(static_cast<const char*>(errorBlob->GetBufferPointer()), errorBlob->GetBufferSize());
+			OutputDebugStringA(errstr.c_str());
+		}
+		return nullptr;
+	}
+	return blob;
+}
+
+/// <summary>
+/// ブレンド設定(Sprite::BlendModeの定義に合わせる)
+/// </summary>
+D3D12_RENDER_TARGET_BLEND_DESC MakeBlendDesc(RenderBlendMode blendMode) {
+	D3D12_RENDER_TARGET_BLEND_DESC blenddesc{};
+	blenddesc.RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
+	blenddesc.BlendEnable = blendMode != RenderBlendMode::kNone;
+	blenddesc.BlendOpAlpha = D3D12_BLEND_OP_ADD;
+	blenddesc.SrcBlendAlpha = D3D12_BLEND_ONE;
+	blenddesc.DestBlendAlpha = D3D12_BLEND_ZERO;
+	blenddesc.LogicOp = D3D12_LOGIC_OP_NOOP;
+
+	switch (blendMode) {
+	case RenderBlendMode::kNone:
+	case RenderBlendMode::kNormal:
+	default:
+		blenddesc.BlendOp = D3D12_BLEND_OP_ADD;
+		blenddesc.SrcBlend = D3D12_BLEND_SRC_ALPHA;
+		blenddesc.DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+		break;
+	case RenderBlendMode::kAdd:
+		blenddesc.BlendOp = D3D12_BLEND_OP_ADD;
+		blenddesc.SrcBlend = D3D12_BLEND_SRC_ALPHA;
+		blenddesc.DestBlend = D3D12_BLEND_ONE;
+		break;
+	case RenderBlendMode::kSubtract:
+		blenddesc.BlendOp = D3D12_BLEND_OP_REV_SUBTRACT;
+		blenddesc.SrcBlend = D3D12_BLEND_SRC_ALPHA;
+		blenddesc.DestBlend = D3D12_BLEND_ONE;
+		break;
+	case RenderBlendMode::kMultiply:
+		blenddesc.BlendOp = D3D12_BLEND_OP_ADD;
+		blenddesc.SrcBlend = D3D12_BLEND_ZERO;
+		blenddesc.DestBlend = D3D12_BLEND_SRC_COLOR;
+		break;
+	case RenderBlendMode::kScreen:
+		blenddesc.BlendOp = D3D12_BLEND_OP_ADD;
+		blenddesc.SrcBlend = D3D12_BLEND_INV_DEST_COLOR;
+		blenddesc.DestBlend = D3D12_BLEND_ONE;
+		break;
+	case RenderBlendMode::kExclusion:
+		blenddesc.BlendOp = D3D12_BLEND_OP_ADD;
+		blenddesc.SrcBlend = D3D12_BLEND_INV_DEST_COLOR;
+		blenddesc.DestBlend = D3D12_BLEND_INV_SRC_COLOR;
+		break;
+	}
+	return blenddesc;
+}
+
+} // namespace
+
+/// <summary>
+/// D3D12のバッファ
+/// </summary>
+class D3D12RenderDevice::Buffer : public RenderBuffer {
+public:
+	Buffer(D3D12RenderDevice* device, ComPtr<ID3D12Resource> resource, size_t size, BufferUsage usage) : device_(device), resource_(resource), size_(size), usage_(usage) {
+		if (usage_ == BufferUsage::kUpload) {
+			// アップロードバッファは常時マップしておく
+			D3D12_RANGE readRange{0, 0};
+			HRESULT result = resource_->Map(0, &readRange, reinterpret_cast<void**>(&mapped_));
+			assert(SUCCEEDED(result));
+			(void)result;
+		}
+	}
+	~Buffer() override {
+		if (mapped_) {
+			resource_->Unmap(0, nullptr);
+		}
+	}
+
+	void Write(size_t offset, const void* data, size_t size) override {
+		assert(mapped_ && offset + size <= size_);
+		std::memcpy(mapped_ + offset, data, size);
+		device_->currentCounters_.bytesWritten += size;
+	}
+
+	void* GetMappedAddress() override { return mapped_; }
+	void NotifyWritten(size_t size) override { device_->currentCounters_.bytesWritten += size; }
+	uint64_t GetGpuAddress() const override { return resource_->GetGPUVirtualAddress(); }
+	size_t GetSize() const override { return size_; }
+	BufferUsage GetUsage() const override { return usage_; }
+
+	// リソースの取得
+	ID3D12Resource* GetResource() const { return resource_.Get(); }
+
+private:
+	D3D12RenderDevice* device_;
+	ComPtr<ID3D12Resource> resource_;
+	size_t size_;
+	BufferUsage usage_;
+	uint8_t* mapped_ = nullptr;
+};
+
+/// <summary>
+/// D3D12の描画コマンドリスト
+/// </summary>
+class D3D12RenderDevice::CommandList : public RenderCommandList {
+public:
+	explicit CommandList(D3D12RenderDevice* device) : device_(device) {}
+
+	void SetPipeline(PipelineHandle pipeline) override {
+		ID3D12GraphicsCommandList* commandList = Get();
+		commandList->SetGraphicsRootSignature(device_->rootSignature_.Get());
+		commandList->SetPipelineState(device_->pipelines_[pipeline].Get());
+		commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		++device_->currentCounters_.pipelineChanges;
+	}
+
+	void SetVertexBuffer(const VertexBufferView& view) override {
+		D3D12_VERTEX_BUFFER_VIEW vbView{view.address, view.size, view.stride};
+		Get()->IASetVertexBuffers(0, 1, &vbView);
+		++device_->currentCounters_.bufferBindings;
+	}
+
+	void SetIndexBuffer(const IndexBufferView& view) override {
+		D3D12_INDEX_BUFFER_VIEW ibView{view.address, view.size, DXGI_FORMAT_R16_UINT};
+		Get()->IASetIndexBuffer(&ibView);
+		++device_->currentCounters_.bufferBindings;
+	}
+
+	void SetConstantBuffer(uint64_t address) override {
+		Get()->SetGraphicsRootConstantBufferView(0, address);
+		++device_->currentCounters_.bufferBindings;
+	}
+
+	void SetTexture(uint32_t textureHandle) override {
+		TextureManager::GetInstance()->SetGraphicsRootDescriptorTable(Get(), 1, textureHandle);
+		++device_->currentCounters_.textureChanges;
+	}
+
+	void SetStructuredBuffer(uint64_t address) override {
+		Get()->SetGraphicsRootShaderResourceView(2, address);
+		++device_->currentCounters_.bufferBindings;
+	}
+
+	void DrawInstanced(uint32_t vertexCountPerInstance, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance) override {
+		Get()->DrawInstanced(vertexCountPerInstance, instanceCount, startVertex, startInstance);
+		CountDraw(vertexCountPerInstance, instanceCount);
+	}
+
+	void DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance) override {
+		Get()->DrawIndexedInstanced(indexCountPerInstance, instanceCount, startIndex, baseVertex, startInstance);
+		CountDraw(indexCountPerInstance, instanceCount);
+	}
+
+	void CopyBuffer(RenderBuffer* dst, size_t dstOffset, RenderBuffer* src, size_t srcOffset, size_t size) override {
+		ID3D12Resource* dstResource = static_cast<Buffer*>(dst)->GetResource();
+		ID3D12GraphicsCommandList* commandList = Get();
+		// COMMONから暗黙にCOPY_DESTへ昇格するので、コピー後に読み取り状態へ遷移させる
+		commandList->CopyBufferRegion(dstResource, dstOffset, static_cast<Buffer*>(src)->GetResource(), srcOffset, size);
+		CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(dstResource, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ);
+		commandList->ResourceBarrier(1, &barrier);
+		device_->currentCounters_.bytesCopied += size;
+	}
+
+	void CopyBuffers(const BufferCopy* copies, size_t count) override {
+		ID3D12GraphicsCommandList* commandList = Get();
+		std::vector<CD3DX12_RESOURCE_BARRIER> barriers;
+		std::vector<ID3D12Resource*> destinations;
+		for (size_t i = 0; i < count; ++i) {
+			const BufferCopy& copy = copies[i];
+			ID3D12Resource* dstResource = static_cast<Buffer*>(copy.dst)->GetResource();
+			commandList->CopyBufferRegion(dstResource, copy.dstOffset, static_cast<Buffer*>(copy.src)->GetResource(), copy.srcOffset, copy.size);
+			device_->currentCounters_.bytesCopied += copy.size;
+			// 同じコピー先に続けてコピーできるよう、遷移は全部のコピーの後にまとめる
+			if (std::find(destinations.begin(), destinations.end(), dstResource) == destinations.end()) {
+				destinations.push_back(dstResource);
+				barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(dstResource, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ));
+			}
+		}
+		if (!barriers.empty()) {
+			commandList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+		}
+	}
+
+private:
+	ID3D12GraphicsCommandList* Get() const { return device_->dxCommon_->GetCommandList(); }
+
+	void CountDraw(uint32_t vertexCount, uint32_t instanceCount) {
+		++device_->currentCounters_.drawCalls;
+		device_->currentCounters_.vertices += uint64_t(vertexCount) * instanceCount;
+		device_->currentCounters_.instances += instanceCount;
+	}
+
+	D3D12RenderDevice* device_;
+};
+
+D3D12RenderDevice::D3D12RenderDevice(DirectXCommon* dxCommon, const std::wstring& shaderDirectory)
+    : dxCommon_(dxCommon), shaderDirectory_(shaderDirectory), commandList_(std::make_unique<CommandList>(this)) {
+	CreateRootSignature();
+	CreateCompletionMarker();
+}
+
+D3D12RenderDevice::~D3D12RenderDevice() = default;
+
+void D3D12RenderDevice::CreateCompletionMarker() {
+	if (FAILED(dxCommon_->GetCommandList()->QueryInterface(IID_PPV_ARGS(&markerCommandList_)))) {
+		return;
+	}
+	CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_READBACK);
+	CD3DX12_RESOURCE_DESC resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(sizeof(uint32_t));
+	HRESULT result = dxCommon_->GetDevice()->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&completionBuffer_));
+	void* mapped = nullptr;
+	if (FAILED(result) || FAILED(completionBuffer_->Map(0, nullptr, &mapped))) {
+		completionBuffer_.Reset();
+		markerCommandList_.Reset();
+		return;
+	}
+	// コミット済みリソースは0で初期化されている(まだどのフレームも完了していない)
+	completedValue_ = static_cast<const volatile uint32_t*>(mapped);
+}
+
+void D3D12RenderDevice::CreateRootSignature() {
+	// [0]定数バッファ(b0) [1]テクスチャ(t0) [2]構造化バッファ(t1)
+	CD3DX12_DESCRIPTOR_RANGE descRangeSRV;
+	descRangeSRV.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0);
+
+	CD3DX12_ROOT_PARAMETER rootparams[3];
+	rootparams[0].InitAsConstantBufferView(0, 0, D3D12_SHADER_VISIBILITY_ALL);
+	rootparams[1].InitAsDescriptorTable(1, &descRangeSRV, D3D12_SHADER_VISIBILITY_PIXEL);
+	rootparams[2].InitAsShaderResourceView(1, 0, D3D12_SHADER_VISIBILITY_VERTEX);
+
+	CD3DX12_STATIC_SAMPLER_DESC samplerDesc(0, D3D12_FILTER_MIN_MAG_MIP_LINEAR, D3D12_TEXTURE_ADDRESS_MODE_CLAMP, D3D12_TEXTURE_ADDRESS_MODE_CLAMP, D3D12_TEXTURE_ADDRESS_MODE_CLAMP);
+
+	CD3DX12_ROOT_SIGNATURE_DESC rootSignatureDesc;
+	rootSignatureDesc.Init(_countof(rootparams), rootparams, 1, &samplerDesc, D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+
+	ComPtr<ID3DBlob> rootSigBlob;
+	ComPtr<ID3DBlob> errorBlob;
+	HRESULT result = D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, &rootSigBlob, &errorBlob);
+	assert(SUCCEEDED(result));
+	result = dxCommon_->GetDevice()->CreateRootSignature(0, rootSigBlob->GetBufferPointer(), rootSigBlob->GetBufferSize(), IID_PPV_ARGS(&rootSignature_));
+	assert(SUCCEEDED(result));
+}
+
+std::unique_ptr<RenderBuffer> D3D12RenderDevice::CreateBuffer(size_t size, BufferUsage usage) {
+	CD3DX12_HEAP_PROPERTIES heapProps(usage == BufferUsage::kUpload ? D3D12_HEAP_TYPE_UPLOAD : D3D12_HEAP_TYPE_DEFAULT);
+	CD3DX12_RESOURCE_DESC resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(size);
+	D3D12_RESOURCE_STATES state = usage == BufferUsage::kUpload ? D3D12_RESOURCE_STATE_GENERIC_READ : D3D12_RESOURCE_STATE_COMMON;
+
+	ComPtr<ID3D12Resource> resource;
+	HRESULT result = dxCommon_->GetDevice()->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &resourceDesc, state, nullptr, IID_PPV_ARGS(&resource));
+	if (FAILED(result)) {
+		return nullptr;
+	}
+	currentCounters_.bytesAllocated += size;
+	return std::make_unique<Buffer>(this, resource, size, usage);
+}
+
+PipelineHandle D3D12RenderDevice::CreatePipeline(const PipelineDesc& desc) {
+	ComPtr<ID3DBlob> vsBlob = CompileShader(shaderDirectory_ + desc.vertexShader, "vs_5_0");
+	ComPtr<ID3DBlob> psBlob = CompileShader(shaderDirectory_ + desc.pixelShader, "ps_5_0");
+	if (!vsBlob || !psBlob) {
+		return kInvalidPipeline;
+	}
+
+	// 頂点レイアウト
+	D3D12_INPUT_ELEMENT_DESC inputLayout[] = {
+	    {"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT,    0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+	    {"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT,       0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+	    {"COLOR",    0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+	};
+
+	// グラフィックスパイプラインの流れを設定
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC gpipeline{};
+	gpipeline.pRootSignature = rootSignature_.Get();
+	gpipeline.VS = CD3DX12_SHADER_BYTECODE(vsBlob.Get());
+	gpipeline.PS = CD3DX12_SHADER_BYTECODE(psBlob.Get());
+	gpipeline.SampleMask = D3D12_DEFAULT_SAMPLE_MASK;
+	gpipeline.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+	gpipeline.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+	// 2D描画なので深度は使わない
+	gpipeline.DepthStencilState.DepthEnable = false;
+	gpipeline.DSVFormat = DXGI_FORMAT_D32_FLOAT;
+	gpipeline.BlendState.RenderTarget[0] = MakeBlendDesc(desc.blendMode);
+	if (desc.inputLayout == InputLayout::kPosUvColor) {
+		gpipeline.InputLayout.pInputElementDescs = inputLayout;
+		gpipeline.InputLayout.NumElements = _countof(inputLayout);
+	}
+	gpipeline.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+	gpipeline.NumRenderTargets = 1;
+	gpipeline.RTVFormats[0] = desc.sRGB ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+	gpipeline.SampleDesc.Count = 1;
+
+	ComPtr<ID3D12PipelineState> pipelineState;
+	HRESULT result = dxCommon_->GetDevice()->CreateGraphicsPipelineState(&gpipeline, IID_PPV_ARGS(&pipelineState));
+	if (FAILED(result)) {
+		return kInvalidPipeline;
+	}
+	pipelines_.push_back(pipelineState);
+	return static_cast<PipelineHandle>(pipelines_.size() - 1);
+}
+
+RenderCommandList* D3D12RenderDevice::GetCommandList() { return commandList_.get(); }
+
+bool D3D12RenderDevice::GetTextureSize(uint32_t textureHandle, uint32_t& width, uint32_t& height) const {
+	D3D12_RESOURCE_DESC resDesc = TextureManager::GetInstance()->GetResoureDesc(textureHandle);
+	if (resDesc.Width == 0 || resDesc.Height == 0) {
+		return false;
+	}
+	width = static_cast<uint32_t>(resDesc.Width);
+	height = resDesc.Height;
+	return true;
+}
+
+void D3D12RenderDevice::BeginFrame() { ++frameIndex_; }
+
+uint64_t D3D12RenderDevice::GetCompletedFrameIndex() const {
+	if (completedValue_ == nullptr) {
+		// 書き込み先を作れなかったときは、待たずに進むフレーム数から見積もる
+		return frameIndex_ > kFramesInFlight ? frameIndex_ - kFramesInFlight : 0;
+	}
+	// 完了したフレームは記録中のフレームより後にならず、2^32フレームも遅れないので下位32bitの差から戻す
+	uint32_t lag = static_cast<uint32_t>(frameIndex_) - *completedValue_;
+	return frameIndex_ - lag;
+}
+
+void D3D12RenderDevice::EndFrame() {
+	// このフレームの描画コマンドが全部終わったら、GPUがフレーム番号を書き込む
+	if (markerCommandList_) {
+		D3D12_WRITEBUFFERIMMEDIATE_PARAMETER parameter = {completionBuffer_->GetGPUVirtualAddress(), static_cast<UINT>(frameIndex_)};
+		D3D12_WRITEBUFFERIMMEDIATE_MODE mode = D3D12_WRITEBUFFERIMMEDIATE_MODE_MARKER_OUT;
+		markerCommandList_->WriteBufferImmediate(1, &parameter, &mode);
+	}
+	frameCounters_ = currentCounters_;
+	totalCounters_ += currentCounters_;
+	currentCounters_ = {};
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "RenderDevice.h"
+#include <d3d12.h>
+#include <vector>
+#include <wrl.h>
+
+namespace KamataEngine {
+class DirectXCommon;
+}
+
+/// <summary>
+/// D3D12描画デバイス
+/// DirectXCommonのデバイスと描画コマンドリストをRenderDeviceとして公開する
+/// </summary>
+class D3D12RenderDevice : public RenderDevice {
+public:
+	// GPUの完了を待たずに進むフレーム数
+	static const uint32_t kFramesInFlight = 3;
+
+	/// <summary>
+	/// コンストラクタ
+	/// </summary>
+	/// <param name="dxCommon">DirectX汎用</param>
+	/// <param name="shaderDirectory">シェーダの格納ディレクトリ</param>
+	explicit D3D12RenderDevice(KamataEngine::DirectXCommon* dxCommon, const std::wstring& shaderDirectory = L"Resources/shaders/");
+	~D3D12RenderDevice() override;
+
+	std::unique_ptr<RenderBuffer> CreateBuffer(size_t size, BufferUsage usage) override;
+	PipelineHandle CreatePipeline(const PipelineDesc& desc) override;
+	RenderCommandList* GetCommandList() override;
+	bool GetTextureSize(uint32_t textureHandle, uint32_t& width, uint32_t& height) const override;
+	void BeginFrame() override;
+	void EndFrame() override;
+	uint64_t GetFrameIndex() const override { return frameIndex_; }
+	uint64_t GetCompletedFrameIndex() const override;
+	const RenderCounters& GetFrameCounters() const override { return frameCounters_; }
+	const RenderCounters& GetTotalCounters() const override { return totalCounters_; }
+
+private:
+	class Buffer;
+	class CommandList;
+	friend class Buffer;
+	friend class CommandList;
+
+	// 共通ルートシグネチャの生成
+	void CreateRootSignature();
+	// フレームの完了をGPUから書き込ませるバッファの生成
+	void CreateCompletionMarker();
+
+	// DirectX汎用
+	KamataEngine::DirectXCommon* dxCommon_;
+	// シェーダの格納ディレクトリ
+	std::wstring shaderDirectory_;
+	// 共通ルートシグネチャ
+	Microsoft::WRL::ComPtr<ID3D12RootSignature> rootSignature_;
+	// 生成済みのパイプライン
+	std::vector<Microsoft::WRL::ComPtr<ID3D12PipelineState>> pipelines_;
+	// コマンドリスト
+	std::unique_ptr<CommandList> commandList_;
+	// 記録中の描画統計
+	RenderCounters currentCounters_;
+	RenderCounters frameCounters_;
+	RenderCounters totalCounters_;
+	uint64_t frameIndex_ = 0;
+	// GPUが描画コマンドを終えたフレーム番号(下位32bit)の書き込み先。エンジンのキューとフェンスは公開されていないので、
+	// フレームの最後にWriteBufferImmediateで書き込ませてフェンスの代わりにする
+	Microsoft::WRL::ComPtr<ID3D12Resource> completionBuffer_;
+	Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList2> markerCommandList_;
+	const volatile uint32_t* completedValue_ = nullptr;
+};
@@ -0,0 +1,194 @@
+#include "FrameTelemetry.h"
+#include <algorithm>
+#include <base\WinApp.h>
+#include <cmath>
+#include <fstream>
+
+#ifdef USE_IMGUI
+#include <imgui.h>
+#endif
+
+namespace {
+
+float ToMilliseconds(std::chrono::steady_clock::duration duration) { return std::chrono::duration<float, std::milli>(duration).count(); }
+
+} // namespace
+
+FrameTelemetry* FrameTelemetry::GetInstance() {
+	static FrameTelemetry instance;
+	return &instance;
+}
+
+void FrameTelemetry::Initialize(uint32_t refreshRate, uint32_t frameRateLimit) {
+	if (refreshRate == 0) {
+		refreshRate = QueryRefreshRate();
+	}
+	// 高リフレッシュレートのディスプレイでもエンジンが上限で待つので、実際に狙う間隔は遅い方になる
+	uint32_t targetRate = frameRateLimit == 0 ? refreshRate : (std::min)(refreshRate, frameRateLimit);
+	targetInterval_ = 1000.0f / static_cast<float>(targetRate);
+	histogram_.fill(0);
+	samples_.clear();
+	samples_.reserve(kMaxSamples);
+	sampleCursor_ = 0;
+	hasLastPresent_ = false;
+	pendingPreDrawTime_ = 0.0f;
+	frameCount_ = 0;
+	totalInterval_ = 0.0;
+	totalJitter_ = 0.0;
+	totalPreDrawTime_ = 0.0;
+	totalPostDrawTime_ = 0.0;
+	maxInterval_ = 0.0f;
+	lastInterval_ = 0.0f;
+	missedVsyncCount_ = 0;
+}
+
+uint32_t FrameTelemetry::QueryRefreshRate() {
+	HWND hwnd = KamataEngine::WinApp::GetInstance()->GetHwnd();
+	MONITORINFOEXW monitorInfo{};
+	monitorInfo.cbSize = sizeof(monitorInfo);
+	if (hwnd == nullptr || !GetMonitorInfoW(MonitorFromWindow(hwnd, MONITOR_DEFAULTTOPRIMARY), &monitorInfo)) {
+		return kFallbackRefreshRate;
+	}
+	DEVMODEW devMode{};
+	devMode.dmSize = sizeof(devMode);
+	// 0と1はハードウェアの既定値を表すので使わない
+	if (!EnumDisplaySettingsW(monitorInfo.szDevice, ENUM_CURRENT_SETTINGS, &devMode) || devMode.dmDisplayFrequency <= 1) {
+		return kFallbackRefreshRate;
+	}
+	return devMode.dmDisplayFrequency;
+}
+
+void FrameTelemetry::BeginPreDraw() { preDrawBegin_ = Clock::now(); }
+
+void FrameTelemetry::EndPreDraw() { pendingPreDrawTime_ = ToMilliseconds(Clock::now() - preDrawBegin_); }
+
+void FrameTelemetry::BeginPostDraw() { postDrawBegin_ = Clock::now(); }
+
+void FrameTelemetry::EndPostDraw() {
+	Clock::time_point now = Clock::now();
+	float postDrawTime = ToMilliseconds(now - postDrawBegin_);
+	// 最初のフレームは間隔が取れないので計測しない
+	if (hasLastPresent_) {
+		Record(ToMilliseconds(now - lastPresent_), pendingPreDrawTime_, postDrawTime);
+	}
+	lastPresent_ = now;
+	hasLastPresent_ = true;
+}
+
+void FrameTelemetry::Record(float presentInterval, float preDrawTime, float postDrawTime) {
+	// 負の値(とNaN)をヒストグラムの区間番号に変換すると未定義動作になるので0に丸める
+	if (!(presentInterval >= 0.0f)) {
+		presentInterval = 0.0f;
+	}
+	Sample sample;
+	sample.frameIndex = frameCount_;
+	sample.presentInterval = presentInterval;
+	sample.preDrawTime = preDrawTime;
+	sample.postDrawTime = postDrawTime;
+	// 目標間隔の半分を超えて遅れた分を取りこぼしたフレームとみなす
+	sample.missedVsync = static_cast<uint32_t>((std::max)(0.0f, std::floor(presentInterval / targetInterval_ + 0.5f) - 1.0f));
+
+	// 上限超えも変換前に丸める(size_tに収まらない値の変換も未定義動作)
+	float bucket = (std::min)(presentInterval * 1000.0f / kBucketWidthUs, static_cast<float>(kBucketCount - 1));
+	++histogram_[static_cast<size_t>(bucket)];
+
+	if (frameCount_ > 0) {
+		totalJitter_ += std::fabs(presentInterval - lastInterval_);
+	}
+	lastInterval_ = presentInterval;
+	maxInterval_ = (std::max)(maxInterval_, presentInterval);
+	totalInterval_ += presentInterval;
+	totalPreDrawTime_ += preDrawTime;
+	totalPostDrawTime_ += postDrawTime;
+	missedVsyncCount_ += sample.missedVsync;
+	++frameCount_;
+
+	if (samples_.size() < kMaxSamples) {
+		samples_.push_back(sample);
+	} else {
+		samples_[sampleCursor_] = sample;
+	}
+	sampleCursor_ = (sampleCursor_ + 1) % kMaxSamples;
+}
+
+float FrameTelemetry::Percentile(float ratio) const {
+	if (frameCount_ == 0) {
+		return 0.0f;
+	}
+	uint64_t target = static_cast<uint64_t>(std::ceil(static_cast<double>(frameCount_) * ratio));
+	uint64_t count = 0;
+	for (uint32_t i = 0; i < kBucketCount; ++i) {
+		count += histogram_[i];
+		if (count >= target) {
+			// 区間の上端を返す。上限超えをまとめた最後の区間や最大値を含む区間では上端が実測を超えるので最大値で抑える
+			return (std::min)(static_cast<float>((i + 1) * kBucketWidthUs) / 1000.0f, maxInterval_);
+		}
+	}
+	return maxInterval_;
+}
+
+FrameTelemetry::Summary FrameTelemetry::GetSummary() const {
+	Summary summary;
+	summary.frameCount = frameCount_;
+	if (frameCount_ == 0) {
+		return summary;
+	}
+	double count = static_cast<double>(frameCount_);
+	summary.average = static_cast<float>(totalInterval_ / count);
+	summary.p50 = Percentile(0.50f);
+	summary.p95 = Percentile(0.95f);
+	summary.p99 = Percentile(0.99f);
+	summary.max = maxInterval_;
+	summary.jitter = frameCount_ > 1 ? static_cast<float>(totalJitter_ / (count - 1.0)) : 0.0f;
+	summary.averagePreDrawTime = static_cast<float>(totalPreDrawTime_ / count);
+	summary.averagePostDrawTime = static_cast<float>(totalPostDrawTime_ / count);
+	summary.missedVsyncCount = missedVsyncCount_;
+	return summary;
+}
+
+bool FrameTelemetry::ExportCsv(const std::string& filePath) const {
+	std::ofstream file(filePath);
+	if (!file) {
+		return false;
+	}
+	file << "frame,present_interval_ms,predraw_ms,postdraw_ms,missed_vsync\n";
+	// 古い順に出力する
+	size_t start = samples_.size() < kMaxSamples ? 0 : sampleCursor_;
+	for (size_t i = 0; i < samples_.size(); ++i) {
+		const Sample& sample = samples_[(start + i) % samples_.size()];
+		file << sample.frameIndex << ',' << sample.presentInterval << ',' << sample.preDrawTime << ',' << sample.postDrawTime << ',' << sample.missedVsync << '\n';
+	}
+	return static_cast<bool>(file);
+}
+
+bool FrameTelemetry::AppendSummaryCsv(const std::string& filePath, const std::string& label) const {
+	bool writeHeader = !std::ifstream(filePath).good();
+	std::ofstream file(filePath, std::ios::app);
+	if (!file) {
+		return false;
+	}
+	if (writeHeader) {
+		file << "label,frames,avg_ms,p50_ms,p95_ms,p99_ms,max_ms,jitter_ms,predraw_ms,postdraw_ms,missed_vsync\n";
+	}
+	Summary s = GetSummary();
+	file << label << ',' << s.frameCount << ',' << s.average << ',' << s.p50 << ',' << s.p95 << ',' << s.p99 << ',' << s.max << ',' << s.jitter << ',' << s.averagePreDrawTime << ','
+	     << s.averagePostDrawTime << ',' << s.missedVsyncCount << '\n';
+	return static_cast<bool>(file);
+}
+
+void FrameTelemetry::DrawImGui() {
+#ifdef USE_IMGUI
+	Summary s = GetSummary();
+	ImGui::Begin("Frame Telemetry");
+	ImGui::Text("Frames : %llu", static_cast<unsigned long long>(s.frameCount));
+	ImGui::Text("Avg %.2f / p50 %.2f / p95 %.2f / p99 %.2f / max %.2f ms", s.average, s.p50, s.p95, s.p99, s.max);
+	ImGui::Text("Jitter : %.3f ms", s.jitter);
+	ImGui::Text("PreDraw : %.3f ms  PostDraw : %.3f ms", s.averagePreDrawTime, s.averagePostDrawTime);
+	ImGui::Text("Missed vsync : %llu", static_cast<unsigned long long>(s.missedVsyncCount));
+	if (ImGui::Button("Export CSV")) {
+		ExportCsv("frame_telemetry.csv");
+		AppendSummaryCsv("frame_telemetry_summary.csv", __DATE__ " " __TIME__);
+	}
+	ImGui::End();
+#endif
+}
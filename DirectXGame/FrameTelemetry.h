@@ -0,0 +1,159 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// フレームペーシングと遅延の計測
+/// フレーム時間のヒストグラム、Present間隔の揺らぎ、待機時間の内訳、垂直同期の取りこぼしを集計する
+/// </summary>
+class FrameTelemetry {
+public:
+	// ヒストグラムの1区間の幅(マイクロ秒)
+	static const uint32_t kBucketWidthUs = 250;
+	// ヒストグラムの区間数(最後の区間は上限超えをまとめる)
+	static const uint32_t kBucketCount = 400;
+	// CSV出力用に保持するフレーム数
+	static const uint32_t kMaxSamples = 3600;
+	// リフレッシュレートが取得できないときに使う値(Hz)
+	static const uint32_t kFallbackRefreshRate = 60;
+	// エンジン(DirectXCommon::PostDraw)が固定しているフレームレートの上限(Hz)
+	static const uint32_t kEngineFrameRateLimit = 60;
+
+	/// <summary>
+	/// 1フレーム分の計測値(ミリ秒)
+	/// </summary>
+	struct Sample {
+		uint64_t frameIndex = 0;
+		// 前フレームのPresentからの間隔
+		float presentInterval = 0.0f;
+		// 描画前処理の時間(フレーム遅延待機オブジェクトの待ちを含む)
+		float preDrawTime = 0.0f;
+		// 描画後処理の時間(Present、フェンス待ち、リフレッシュレート調整を含む)
+		float postDrawTime = 0.0f;
+		// 目標のフレーム間隔(垂直同期かエンジンのフレームレート上限の遅い方)を取りこぼした回数
+		uint32_t missedVsync = 0;
+	};
+
+	/// <summary>
+	/// 集計結果(ミリ秒)
+	/// </summary>
+	struct Summary {
+		uint64_t frameCount = 0;
+		float average = 0.0f;
+		float p50 = 0.0f;
+		float p95 = 0.0f;
+		float p99 = 0.0f;
+		float max = 0.0f;
+		// 連続するPresent間隔の差の絶対値の平均
+		float jitter = 0.0f;
+		float averagePreDrawTime = 0.0f;
+		float averagePostDrawTime = 0.0f;
+		uint64_t missedVsyncCount = 0;
+	};
+
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static FrameTelemetry* GetInstance();
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="refreshRate">ディスプレイのリフレッシュレート(Hz)。0ならウィンドウのあるディスプレイから取得する</param>
+	/// <param name="frameRateLimit">エンジンが抑えているフレームレート(Hz)。0なら上限なし。目標のフレーム間隔はリフレッシュレートとの遅い方になる</param>
+	void Initialize(uint32_t refreshRate = 0, uint32_t frameRateLimit = kEngineFrameRateLimit);
+
+	// 目標のフレーム間隔(ミリ秒)の取得
+	float GetTargetInterval() const { return targetInterval_; }
+
+	/// <summary>
+	/// ウィンドウのあるディスプレイの現在のリフレッシュレートの取得
+	/// </summary>
+	/// <returns>リフレッシュレート(Hz)。取得できなければkFallbackRefreshRate</returns>
+	static uint32_t QueryRefreshRate();
+
+	// 描画前処理の開始
+	void BeginPreDraw();
+	// 描画前処理の終了
+	void EndPreDraw();
+	// 描画後処理の開始
+	void BeginPostDraw();
+	// 描画後処理の終了。1フレーム分の計測を確定する
+	void EndPostDraw();
+
+	/// <summary>
+	/// 計測値を直接記録する(テストや外部計測用)
+	/// </summary>
+	/// <param name="presentInterval">Present間隔(ミリ秒)</param>
+	/// <param name="preDrawTime">描画前処理の時間(ミリ秒)</param>
+	/// <param name="postDrawTime">描画後処理の時間(ミリ秒)</param>
+	void Record(float presentInterval, float preDrawTime, float postDrawTime);
+
+	/// <summary>
+	/// 集計結果の取得
+	/// </summary>
+	/// <returns>集計結果</returns>
+	Summary GetSummary() const;
+
+	// 直近のフレームの計測値の取得
+	const std::vector<Sample>& GetSamples() const { return samples_; }
+
+	/// <summary>
+	/// 保持しているフレーム毎の計測値をCSVで書き出す
+	/// </summary>
+	/// <param name="filePath">出力先</param>
+	/// <returns>成否</returns>
+	bool ExportCsv(const std::string& filePath) const;
+
+	/// <summary>
+	/// 集計結果をCSVの1行として追記する(ビルド間の比較用)
+	/// </summary>
+	/// <param name="filePath">出力先</param>
+	/// <param name="label">ビルド名などの識別子</param>
+	/// <returns>成否</returns>
+	bool AppendSummaryCsv(const std::string& filePath, const std::string& label) const;
+
+	/// <summary>
+	/// ImGuiでの集計結果表示
+	/// </summary>
+	void DrawImGui();
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	FrameTelemetry() = default;
+	~FrameTelemetry() = default;
+	FrameTelemetry(const FrameTelemetry&) = delete;
+	const FrameTelemetry& operator=(const FrameTelemetry&) = delete;
+
+	// ヒストグラムから百分位数を求める(区間の上端。最大値を超えた値は返さない)
+	float Percentile(float ratio) const;
+
+	// 目標のフレーム間隔(ミリ秒)
+	float targetInterval_ = 1000.0f / 60.0f;
+	// フレーム時間のヒストグラム
+	std::array<uint64_t, kBucketCount> histogram_{};
+	// フレーム毎の計測値(リングバッファ)
+	std::vector<Sample> samples_;
+	// 次に書き込むサンプル位置
+	size_t sampleCursor_ = 0;
+	// 計測中の時刻
+	Clock::time_point preDrawBegin_;
+	Clock::time_point postDrawBegin_;
+	Clock::time_point lastPresent_;
+	bool hasLastPresent_ = false;
+	float pendingPreDrawTime_ = 0.0f;
+	// 累計値
+	uint64_t frameCount_ = 0;
+	double totalInterval_ = 0.0;
+	double totalJitter_ = 0.0;
+	double totalPreDrawTime_ = 0.0;
+	double totalPostDrawTime_ = 0.0;
+	float maxInterval_ = 0.0f;
+	float lastInterval_ = 0.0f;
+	uint64_t missedVsyncCount_ = 0;
+};
@@ -0,0 +1,55 @@
+#include "GameLoop.h"
+#include <algorithm>
+
+GameLoop* GameLoop::GetInstance() {
+	static GameLoop instance;
+	return &instance;
+}
+
+void GameLoop::Initialize(float fixedDeltaTime, uint32_t maxStepsPerFrame) {
+	fixedDeltaTime_ = fixedDeltaTime;
+	fixedStep_ = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<float>(fixedDeltaTime));
+	maxStepsPerFrame_ = (std::max)(maxStepsPerFrame, 1u);
+	accumulator_ = std::chrono::nanoseconds::zero();
+	previousTime_ = std::chrono::steady_clock::now();
+	tickCount_ = 0;
+	stepsThisFrame_ = 0;
+	droppedTickCount_ = 0;
+}
+
+void GameLoop::BeginFrame() {
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	Advance(std::chrono::duration_cast<std::chrono::nanoseconds>(now - previousTime_));
+	previousTime_ = now;
+}
+
+void GameLoop::Advance(std::chrono::nanoseconds elapsed) {
+	stepsThisFrame_ = 0;
+	accumulator_ += (std::max)(elapsed, std::chrono::nanoseconds::zero());
+
+	// 処理落ちで更新が追いつかなくなる連鎖を防ぐため、上限を超えた分は捨てる
+	const std::chrono::nanoseconds limit = fixedStep_ * maxStepsPerFrame_;
+	if (accumulator_ >= limit + fixedStep_) {
+		std::chrono::nanoseconds excess = accumulator_ - limit;
+		droppedTickCount_ += excess / fixedStep_;
+		accumulator_ = limit + excess % fixedStep_;
+	}
+}
+
+bool GameLoop::Step() {
+	if (accumulator_ < fixedStep_ || stepsThisFrame_ >= maxStepsPerFrame_) {
+		return false;
+	}
+	accumulator_ -= fixedStep_;
+	++tickCount_;
+	++stepsThisFrame_;
+	return true;
+}
+
+float GameLoop::GetAlpha() const {
+	if (fixedStep_.count() <= 0) {
+		return 0.0f;
+	}
+	float alpha = static_cast<float>(accumulator_.count()) / static_cast<float>(fixedStep_.count());
+	return std::clamp(alpha, 0.0f, 1.0f);
+}
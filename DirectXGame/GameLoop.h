@@ -0,0 +1,89 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+/// <summary>
+/// 固定タイムステップのゲームループ
+/// シミュレーションは一定周期で進め、描画は補間係数で前後のティックを補間する
+/// </summary>
+class GameLoop {
+public:
+	// 固定更新の既定周期(60Hz)
+	static constexpr float kDefaultFixedDeltaTime = 1.0f / 60.0f;
+	// 1フレームで実行する固定更新回数の既定上限
+	static constexpr uint32_t kDefaultMaxStepsPerFrame = 5;
+
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static GameLoop* GetInstance();
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="fixedDeltaTime">固定更新の周期(秒)</param>
+	/// <param name="maxStepsPerFrame">1フレームで実行する固定更新の上限。超えた分は切り捨てる</param>
+	void Initialize(float fixedDeltaTime = kDefaultFixedDeltaTime, uint32_t maxStepsPerFrame = kDefaultMaxStepsPerFrame);
+
+	/// <summary>
+	/// フレーム開始。前フレームからの実時間を計測して蓄積する
+	/// </summary>
+	void BeginFrame();
+
+	/// <summary>
+	/// 経過時間を直接与えて蓄積する(リプレイやテストで決定的に進める用)
+	/// </summary>
+	/// <param name="elapsed">経過時間</param>
+	void Advance(std::chrono::nanoseconds elapsed);
+
+	/// <summary>
+	/// 固定更新を1回分消費する
+	/// </summary>
+	/// <returns>固定更新を実行すべきならtrue</returns>
+	bool Step();
+
+	/// <summary>
+	/// 描画用の補間係数の取得
+	/// </summary>
+	/// <returns>直前のティックから次のティックまでの割合[0,1)</returns>
+	float GetAlpha() const;
+
+	/// <summary>
+	/// 固定更新の周期の取得
+	/// </summary>
+	/// <returns>周期(秒)</returns>
+	float GetFixedDeltaTime() const { return fixedDeltaTime_; }
+
+	// 累計ティック数の取得
+	uint64_t GetTickCount() const { return tickCount_; }
+
+	// 今フレームで実行したティック数の取得
+	uint32_t GetStepsThisFrame() const { return stepsThisFrame_; }
+
+	// 上限により切り捨てたティック数の累計の取得
+	uint64_t GetDroppedTickCount() const { return droppedTickCount_; }
+
+private:
+	GameLoop() = default;
+	~GameLoop() = default;
+	GameLoop(const GameLoop&) = delete;
+	const GameLoop& operator=(const GameLoop&) = delete;
+
+	// 固定更新の周期(秒)
+	float fixedDeltaTime_ = kDefaultFixedDeltaTime;
+	// 固定更新の周期
+	std::chrono::nanoseconds fixedStep_{};
+	// 1フレームの固定更新の上限
+	uint32_t maxStepsPerFrame_ = kDefaultMaxStepsPerFrame;
+	// 未消費の経過時間
+	std::chrono::nanoseconds accumulator_{};
+	// 前フレームの開始時刻
+	std::chrono::steady_clock::time_point previousTime_;
+	// 累計ティック数
+	uint64_t tickCount_ = 0;
+	// 今フレームのティック数
+	uint32_t stepsThisFrame_ = 0;
+	// 切り捨てたティック数の累計
+	uint64_t droppedTickCount_ = 0;
+};
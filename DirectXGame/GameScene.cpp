@@ -1,9 +1,38 @@
 #include "GameScene.h"
+#include "GameLoop.h"
+#include <numbers>
 
 using namespace KamataEngine;
 
-void GameScene::Initialize() {}
+GameScene::~GameScene() {
+	TextureCache::GetInstance()->Release(textureHandle_);
+	delete model_;
+}
 
-void GameScene::Update() {}
+void GameScene::Initialize(RenderDevice* renderDevice) {
+	renderDevice_ = renderDevice;
+	model_ = Model::Create();
+	textureHandle_ = TextureCache::GetInstance()->Acquire("uvChecker.png");
+	camera_.Initialize();
+	worldTransform_.Initialize();
+	interpolator_.Reset(worldTransform_);
+}
 
-void GameScene::Draw() {}
+void GameScene::Update() {
+	// 固定周期で回す。角度は[-π,π]に収めるので、πをまたぐティックは補間側で近い向きに回る
+	const float pi = std::numbers::pi_v<float>;
+	worldTransform_.rotation_.y += kRotationSpeed * GameLoop::GetInstance()->GetFixedDeltaTime();
+	if (worldTransform_.rotation_.y > pi) {
+		worldTransform_.rotation_.y -= 2.0f * pi;
+	}
+	interpolator_.Capture(worldTransform_);
+}
+
+void GameScene::Draw() {
+	// 表示はティックの間を補間した位置で行う(シミュレーションの状態は変えない)
+	interpolator_.Apply(worldTransform_, GameLoop::GetInstance()->GetAlpha());
+
+	Model::PreDraw(DirectXCommon::GetInstance()->GetCommandList());
+	model_->Draw(worldTransform_, camera_, TextureCache::GetInstance()->GetTextureHandle(textureHandle_));
+	Model::PostDraw();
+}
@@ -1,14 +1,37 @@
 #pragma once
 #include "KamataEngine.h"
+#include "RenderDevice.h"
+#include "Scene.h"
+#include "TextureCache.h"
+#include "TransformInterpolator.h"
 
 // ゲームシーン
-class GameScene {
+class GameScene : public Scene {
 public:
+	// 1秒あたりの回転角(ラジアン)
+	static constexpr float kRotationSpeed = 2.0f;
+
+	// デストラクタ
+	~GameScene() override;
+
 	// 初期化
-	void Initialize();
-	// 更新
-	void Update();
-	// 描画
-	void Draw();
+	void Initialize(RenderDevice* renderDevice) override;
+	// 更新(固定周期で呼ばれる)
+	void Update() override;
+	// 描画(前後のティックを補間して描く)
+	void Draw() override;
 
+private:
+	// 描画デバイス(D3D12またはヌル)
+	RenderDevice* renderDevice_ = nullptr;
+	// 3Dモデル
+	KamataEngine::Model* model_ = nullptr;
+	// モデルに貼るテクスチャ(TextureCacheのハンドル)
+	uint32_t textureHandle_ = TextureCache::kInvalidHandle;
+	// カメラ
+	KamataEngine::Camera camera_;
+	// ワールド変換データ
+	KamataEngine::WorldTransform worldTransform_;
+	// 固定ティック間の補間
+	TransformInterpolator interpolator_;
 };
@@ -0,0 +1,121 @@
+#include "GpuProfiler.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <base\DirectXCommon.h>
+#include <cassert>
+#include <d3dx12.h>
+
+using namespace KamataEngine;
+
+GpuProfiler* GpuProfiler::GetInstance() {
+	static GpuProfiler instance;
+	return &instance;
+}
+
+void GpuProfiler::Initialize(DirectXCommon* dxCommon) {
+	dxCommon_ = dxCommon;
+	ID3D12Device* device = dxCommon_->GetDevice();
+	HRESULT result = S_FALSE;
+
+	ring_.Initialize(kFramesInFlight, kMaxQueriesPerFrame);
+
+	// クエリヒープの生成
+	D3D12_QUERY_HEAP_DESC queryHeapDesc{};
+	queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+	queryHeapDesc.Count = ring_.GetQueryCount();
+	result = device->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&queryHeap_));
+	assert(SUCCEEDED(result));
+
+	// 読み戻し用バッファの生成
+	CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_READBACK);
+	CD3DX12_RESOURCE_DESC resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(sizeof(uint64_t) * ring_.GetQueryCount());
+	result = device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&readbackBuffer_));
+	assert(SUCCEEDED(result));
+
+	// コマンドキューはDirectXCommonの内部にあるため、同じ種類のキューを作って周波数を得る
+	Microsoft::WRL::ComPtr<ID3D12CommandQueue> queue;
+	D3D12_COMMAND_QUEUE_DESC queueDesc{};
+	queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+	result = device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&queue));
+	assert(SUCCEEDED(result));
+	result = queue->GetTimestampFrequency(&frequency_);
+	assert(SUCCEEDED(result));
+
+	frameIndex_ = 0;
+}
+
+void GpuProfiler::Finalize() {
+	queryHeap_.Reset();
+	readbackBuffer_.Reset();
+	dxCommon_ = nullptr;
+}
+
+void GpuProfiler::BeginFrame() {
+	if (!queryHeap_) {
+		return;
+	}
+
+	// kFramesInFlightフレーム前の結果はGPUで完了しているので、待たずに読める
+	uint64_t oldest = 0;
+	if (frameIndex_ >= kFramesInFlight - 1 && ring_.GetOldestPendingFrame(oldest)) {
+		uint64_t completedFrame = frameIndex_ - (kFramesInFlight - 1);
+		if (oldest <= completedFrame) {
+			D3D12_RANGE readRange{0, sizeof(uint64_t) * ring_.GetQueryCount()};
+			uint64_t* timestamps = nullptr;
+			results_.clear();
+			if (SUCCEEDED(readbackBuffer_->Map(0, &readRange, reinterpret_cast<void**>(&timestamps)))) {
+				ring_.Collect(completedFrame, timestamps, results_);
+				D3D12_RANGE writeRange{0, 0};
+				readbackBuffer_->Unmap(0, &writeRange);
+			}
+
+			// GPUとCPUの時刻は同期していないため、記録したフレームの最初のタイムスタンプを基準に並べる
+			Profiler* profiler = Profiler::GetInstance();
+			for (size_t first = 0; first < results_.size();) {
+				size_t last = first;
+				uint64_t origin = results_[first].beginTick;
+				for (; last < results_.size() && results_[last].frameIndex == results_[first].frameIndex; ++last) {
+					origin = (std::min)(origin, results_[last].beginTick);
+				}
+				for (size_t i = first; i < last; ++i) {
+					const GpuTimestampRing::Result& zone = results_[i];
+					int64_t begin = zone.cpuFrameBegin + static_cast<int64_t>(static_cast<double>(zone.beginTick - origin) * 1.0e9 / static_cast<double>(frequency_));
+					int64_t end = zone.cpuFrameBegin + static_cast<int64_t>(static_cast<double>(zone.endTick - origin) * 1.0e9 / static_cast<double>(frequency_));
+					profiler->RecordGpuZone(zone.name, begin, end, zone.depth);
+				}
+				first = last;
+			}
+		}
+	}
+
+	ring_.BeginFrame(frameIndex_, Profiler::Now());
+}
+
+void GpuProfiler::EndFrame() {
+	if (!queryHeap_) {
+		return;
+	}
+	uint32_t queryOffset = 0;
+	uint32_t queryCount = 0;
+	ring_.EndFrame(queryOffset, queryCount);
+	if (queryCount > 0) {
+		dxCommon_->GetCommandList()->ResolveQueryData(queryHeap_.Get(), D3D12_QUERY_TYPE_TIMESTAMP, queryOffset, queryCount, readbackBuffer_.Get(), sizeof(uint64_t) * queryOffset);
+	}
+	++frameIndex_;
+}
+
+uint32_t GpuProfiler::BeginMarker(ID3D12GraphicsCommandList* commandList, const char* name) {
+	uint32_t queryIndex = 0;
+	uint32_t marker = ring_.BeginMarker(name, queryIndex);
+	if (marker != GpuTimestampRing::kInvalidMarker) {
+		commandList->EndQuery(queryHeap_.Get(), D3D12_QUERY_TYPE_TIMESTAMP, queryIndex);
+	}
+	return marker;
+}
+
+void GpuProfiler::EndMarker(ID3D12GraphicsCommandList* commandList, uint32_t marker) {
+	uint32_t queryIndex = 0;
+	if (marker != GpuTimestampRing::kInvalidMarker && ring_.EndMarker(marker, queryIndex)) {
+		commandList->EndQuery(queryHeap_.Get(), D3D12_QUERY_TYPE_TIMESTAMP, queryIndex);
+	}
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include "GpuTimestampRing.h"
+#include "Profiler.h"
+#include <d3d12.h>
+#include <vector>
+#include <wrl.h>
+
+namespace KamataEngine {
+class DirectXCommon;
+}
+
+/// <summary>
+/// GPUタイムスタンプによるパス毎の計測
+/// 結果は数フレーム後にストールなしで回収し、Profilerのトラックとして積む
+/// </summary>
+class GpuProfiler {
+public:
+	// 結果を待つフレーム数
+	static const uint32_t kFramesInFlight = 3;
+	// 1フレームで使うクエリの上限
+	static const uint32_t kMaxQueriesPerFrame = 128;
+
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static GpuProfiler* GetInstance();
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="dxCommon">DirectX汎用</param>
+	void Initialize(KamataEngine::DirectXCommon* dxCommon);
+
+	/// <summary>
+	/// 終了処理
+	/// </summary>
+	void Finalize();
+
+	/// <summary>
+	/// フレーム開始(PreDrawの後に呼ぶ)。完了済みフレームの結果を回収する
+	/// </summary>
+	void BeginFrame();
+
+	/// <summary>
+	/// フレーム終了(PostDrawの前に呼ぶ)。クエリを読み戻し用バッファに解決する
+	/// </summary>
+	void EndFrame();
+
+	/// <summary>
+	/// 区間開始
+	/// </summary>
+	/// <param name="commandList">コマンドリスト</param>
+	/// <param name="name">区間名(文字列リテラル)</param>
+	/// <returns>マーカー番号</returns>
+	uint32_t BeginMarker(ID3D12GraphicsCommandList* commandList, const char* name);
+
+	/// <summary>
+	/// 区間終了
+	/// </summary>
+	/// <param name="commandList">コマンドリスト</param>
+	/// <param name="marker">BeginMarkerの戻り値</param>
+	void EndMarker(ID3D12GraphicsCommandList* commandList, uint32_t marker);
+
+	// クエリ管理の取得
+	const GpuTimestampRing& GetRing() const { return ring_; }
+
+private:
+	GpuProfiler() = default;
+	~GpuProfiler() = default;
+	GpuProfiler(const GpuProfiler&) = delete;
+	const GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+	// DirectX汎用
+	KamataEngine::DirectXCommon* dxCommon_ = nullptr;
+	// タイムスタンプ用クエリヒープ
+	Microsoft::WRL::ComPtr<ID3D12QueryHeap> queryHeap_;
+	// 読み戻し用バッファ
+	Microsoft::WRL::ComPtr<ID3D12Resource> readbackBuffer_;
+	// タイムスタンプの周波数(Hz)
+	uint64_t frequency_ = 0;
+	// クエリ管理
+	GpuTimestampRing ring_;
+	// 回収結果の作業領域
+	std::vector<GpuTimestampRing::Result> results_;
+	// フレーム番号
+	uint64_t frameIndex_ = 0;
+};
+
+/// <summary>
+/// スコープの開始から終了までをGPU区間として記録する
+/// </summary>
+class GpuProfileScope {
+public:
+	GpuProfileScope(ID3D12GraphicsCommandList* commandList, const char* name) : commandList_(commandList), marker_(GpuProfiler::GetInstance()->BeginMarker(commandList, name)) {}
+	~GpuProfileScope() { GpuProfiler::GetInstance()->EndMarker(commandList_, marker_); }
+	GpuProfileScope(const GpuProfileScope&) = delete;
+	GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+
+private:
+	ID3D12GraphicsCommandList* commandList_;
+	uint32_t marker_;
+};
+
+// GPU計測のマクロ。USE_PROFILERが未定義のビルドでは消える
+#ifdef USE_PROFILER
+#define GPU_PROFILE_SCOPE(commandList, name) GpuProfileScope PROFILER_CONCAT(gpuProfileScope_, __LINE__)(commandList, name)
+#else
+#define GPU_PROFILE_SCOPE(commandList, name) ((void)0)
+#endif
@@ -0,0 +1,105 @@
+#include "GpuTimestampRing.h"
+
+void GpuTimestampRing::Initialize(uint32_t framesInFlight, uint32_t maxQueriesPerFrame) {
+	framesInFlight_ = framesInFlight == 0 ? 1 : framesInFlight;
+	// 開始と終了で2つずつ使うので偶数に揃える
+	maxQueriesPerFrame_ = (maxQueriesPerFrame + 1) & ~1u;
+	slots_.assign(framesInFlight_, Slot{});
+	for (Slot& slot : slots_) {
+		slot.markers.reserve(maxQueriesPerFrame_ / 2);
+	}
+	currentSlot_ = 0;
+	overflowCount_ = 0;
+	droppedFrameCount_ = 0;
+}
+
+GpuTimestampRing::Slot* GpuTimestampRing::CurrentSlot() {
+	if (slots_.empty() || !slots_[currentSlot_].recording) {
+		return nullptr;
+	}
+	return &slots_[currentSlot_];
+}
+
+void GpuTimestampRing::BeginFrame(uint64_t frameIndex, int64_t cpuFrameBegin) {
+	if (slots_.empty()) {
+		return;
+	}
+	currentSlot_ = static_cast<uint32_t>(frameIndex % framesInFlight_);
+	Slot& slot = slots_[currentSlot_];
+	if (slot.pending) {
+		++droppedFrameCount_;
+	}
+	slot.frameIndex = frameIndex;
+	slot.cpuFrameBegin = cpuFrameBegin;
+	slot.queryCount = 0;
+	slot.depth = 0;
+	slot.recording = true;
+	slot.pending = false;
+	slot.markers.clear();
+}
+
+uint32_t GpuTimestampRing::BeginMarker(const char* name, uint32_t& queryIndex) {
+	Slot* slot = CurrentSlot();
+	if (slot == nullptr) {
+		return kInvalidMarker;
+	}
+	// この区間の終了クエリと、開いている区間の終了クエリの分も残っていなければ記録しない
+	if (slot->queryCount + slot->depth + 2 > maxQueriesPerFrame_) {
+		++overflowCount_;
+		return kInvalidMarker;
+	}
+	queryIndex = currentSlot_ * maxQueriesPerFrame_ + slot->queryCount++;
+	slot->markers.push_back({name, queryIndex, kInvalidMarker, slot->depth++});
+	return static_cast<uint32_t>(slot->markers.size() - 1);
+}
+
+bool GpuTimestampRing::EndMarker(uint32_t marker, uint32_t& queryIndex) {
+	Slot* slot = CurrentSlot();
+	// 二重の終了は受け付けない(開いている区間の分しかクエリを残していない)
+	if (slot == nullptr || marker >= slot->markers.size() || slot->markers[marker].endQuery != kInvalidMarker) {
+		return false;
+	}
+	queryIndex = currentSlot_ * maxQueriesPerFrame_ + slot->queryCount++;
+	slot->markers[marker].endQuery = queryIndex;
+	--slot->depth;
+	return true;
+}
+
+void GpuTimestampRing::EndFrame(uint32_t& queryOffset, uint32_t& queryCount) {
+	queryOffset = 0;
+	queryCount = 0;
+	Slot* slot = CurrentSlot();
+	if (slot == nullptr) {
+		return;
+	}
+	slot->recording = false;
+	slot->pending = slot->queryCount > 0;
+	queryOffset = currentSlot_ * maxQueriesPerFrame_;
+	queryCount = slot->queryCount;
+}
+
+void GpuTimestampRing::Collect(uint64_t completedFrame, const uint64_t* timestamps, std::vector<Result>& results) {
+	for (Slot& slot : slots_) {
+		if (!slot.pending || slot.frameIndex > completedFrame) {
+			continue;
+		}
+		for (const Marker& marker : slot.markers) {
+			if (marker.endQuery == kInvalidMarker) {
+				continue;
+			}
+			results.push_back({marker.name, timestamps[marker.beginQuery], timestamps[marker.endQuery], marker.depth, slot.frameIndex, slot.cpuFrameBegin});
+		}
+		slot.pending = false;
+	}
+}
+
+bool GpuTimestampRing::GetOldestPendingFrame(uint64_t& frameIndex) const {
+	bool found = false;
+	for (const Slot& slot : slots_) {
+		if (slot.pending && (!found || slot.frameIndex < frameIndex)) {
+			frameIndex = slot.frameIndex;
+			found = true;
+		}
+	}
+	return found;
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// GPUタイムスタンプクエリの割り当てと遅延回収の管理
+/// グラフィックスAPIに依存しないので、偽のクロックで検証できる
+/// </summary>
+class GpuTimestampRing {
+public:
+	// 無効なマーカー番号
+	static constexpr uint32_t kInvalidMarker = UINT32_MAX;
+
+	/// <summary>
+	/// 回収した計測結果
+	/// </summary>
+	struct Result {
+		// 区間名
+		const char* name = nullptr;
+		// 開始タイムスタンプ(GPUティック)
+		uint64_t beginTick = 0;
+		// 終了タイムスタンプ(GPUティック)
+		uint64_t endTick = 0;
+		// 入れ子の深さ
+		uint32_t depth = 0;
+		// 記録したフレーム番号
+		uint64_t frameIndex = 0;
+		// 記録したフレームのCPU開始時刻
+		int64_t cpuFrameBegin = 0;
+	};
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="framesInFlight">結果を待つ間に記録を続けるフレーム数</param>
+	/// <param name="maxQueriesPerFrame">1フレームで使うクエリの上限</param>
+	void Initialize(uint32_t framesInFlight, uint32_t maxQueriesPerFrame);
+
+	/// <summary>
+	/// フレーム開始。回収されていない古いフレームのスロットは破棄して再利用する
+	/// </summary>
+	/// <param name="frameIndex">フレーム番号</param>
+	/// <param name="cpuFrameBegin">CPU側のフレーム開始時刻</param>
+	void BeginFrame(uint64_t frameIndex, int64_t cpuFrameBegin);
+
+	/// <summary>
+	/// 区間開始のクエリを割り当てる
+	/// </summary>
+	/// <param name="name">区間名</param>
+	/// <param name="queryIndex">発行するクエリ番号</param>
+	/// <returns>マーカー番号。開いている区間を閉じる分を残してクエリが足りなければkInvalidMarker</returns>
+	uint32_t BeginMarker(const char* name, uint32_t& queryIndex);
+
+	/// <summary>
+	/// 区間終了のクエリを割り当てる
+	/// </summary>
+	/// <param name="marker">BeginMarkerの戻り値</param>
+	/// <param name="queryIndex">発行するクエリ番号</param>
+	/// <returns>発行すべきならtrue。終了済みのマーカーならfalse</returns>
+	bool EndMarker(uint32_t marker, uint32_t& queryIndex);
+
+	/// <summary>
+	/// フレーム終了。解決(Resolve)すべきクエリ範囲を返す
+	/// </summary>
+	/// <param name="queryOffset">先頭のクエリ番号</param>
+	/// <param name="queryCount">クエリ数</param>
+	void EndFrame(uint32_t& queryOffset, uint32_t& queryCount);
+
+	/// <summary>
+	/// 完了したフレームの結果を回収する
+	/// </summary>
+	/// <param name="completedFrame">GPUで完了済みの最新フレーム番号</param>
+	/// <param name="timestamps">全クエリ分のタイムスタンプ(クエリ番号で引く)</param>
+	/// <param name="results">回収結果の追加先</param>
+	void Collect(uint64_t completedFrame, const uint64_t* timestamps, std::vector<Result>& results);
+
+	/// <summary>
+	/// 未回収のフレームのうち最も古いフレーム番号
+	/// </summary>
+	/// <param name="frameIndex">フレーム番号</param>
+	/// <returns>未回収のフレームがあればtrue</returns>
+	bool GetOldestPendingFrame(uint64_t& frameIndex) const;
+
+	// 全クエリ数の取得
+	uint32_t GetQueryCount() const { return framesInFlight_ * maxQueriesPerFrame_; }
+
+	// クエリ不足で記録できなかったマーカー数の取得
+	uint64_t GetOverflowCount() const { return overflowCount_; }
+
+	// 回収前に上書きされたフレーム数の取得
+	uint64_t GetDroppedFrameCount() const { return droppedFrameCount_; }
+
+private:
+	// マーカー
+	struct Marker {
+		const char* name = nullptr;
+		uint32_t beginQuery = 0;
+		uint32_t endQuery = kInvalidMarker;
+		uint32_t depth = 0;
+	};
+
+	// フレーム毎のスロット
+	struct Slot {
+		uint64_t frameIndex = 0;
+		int64_t cpuFrameBegin = 0;
+		uint32_t queryCount = 0;
+		uint32_t depth = 0;
+		// 記録中ならtrue
+		bool recording = false;
+		// 解決待ちならtrue
+		bool pending = false;
+		std::vector<Marker> markers;
+	};
+
+	// 記録中のスロット
+	Slot* CurrentSlot();
+
+	uint32_t framesInFlight_ = 0;
+	uint32_t maxQueriesPerFrame_ = 0;
+	std::vector<Slot> slots_;
+	uint32_t currentSlot_ = 0;
+	uint64_t overflowCount_ = 0;
+	uint64_t droppedFrameCount_ = 0;
+};
@@ -0,0 +1,12 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/// <summary>
+/// xxHash64によるハッシュ値の計算
+/// </summary>
+/// <param name="data">データ</param>
+/// <param name="size">バイト数</param>
+/// <param name="seed">シード</param>
+/// <returns>ハッシュ値</returns>
+uint64_t XXHash64(const void* data, size_t size, uint64_t seed = 0);
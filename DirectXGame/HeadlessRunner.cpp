@@ -0,0 +1,41 @@
+#include "HeadlessRunner.h"
+#include "GameLoop.h"
+#include "NullRenderDevice.h"
+#include <chrono>
+#include <fstream>
+
+int HeadlessRunner::Run(std::unique_ptr<Scene> scene, uint32_t frameCount, const std::string& csvPath) {
+	std::ofstream file(csvPath);
+	if (!file) {
+		return 1;
+	}
+	file << "frame,cpu_ms,ticks,draw_calls,vertices,instances,pipeline_changes,texture_changes,buffer_bindings,bytes_written,validation_errors\n";
+
+	NullRenderDevice renderDevice;
+	scene->Initialize(&renderDevice);
+
+	// 実時間ではなく1フレームに固定更新1回分ずつ進め、実行のたびに同じ結果にする
+	GameLoop* gameLoop = GameLoop::GetInstance();
+	gameLoop->Initialize();
+	std::chrono::nanoseconds frameTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<float>(gameLoop->GetFixedDeltaTime()));
+
+	for (uint32_t frame = 0; frame < frameCount; ++frame) {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		gameLoop->Advance(frameTime);
+		while (gameLoop->Step()) {
+			scene->Update();
+		}
+		renderDevice.BeginFrame();
+		scene->Draw();
+		renderDevice.EndFrame();
+		float cpuTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		const RenderCounters& c = renderDevice.GetFrameCounters();
+		file << frame << ',' << cpuTime << ',' << gameLoop->GetStepsThisFrame() << ',' << c.drawCalls << ',' << c.vertices << ',' << c.instances << ',' << c.pipelineChanges << ','
+		     << c.textureChanges << ',' << c.bufferBindings << ',' << c.bytesWritten << ',' << c.validationErrors << '\n';
+	}
+
+	// シーンのバッファはデバイスより先に解放する
+	scene.reset();
+	return file && renderDevice.GetTotalCounters().validationErrors == 0 ? 0 : 1;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "Scene.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/// <summary>
+/// ヘッドレス実行
+/// ウィンドウとGPUを使わず、NullRenderDeviceでシーンを決定的な固定ステップで回して、
+/// フレームごとのCPU時間と描画統計をCSVに書き出す。RenderDeviceだけで描くシーンを渡すこと(エンジンは初期化しない)
+/// </summary>
+class HeadlessRunner {
+public:
+	// 既定のフレーム数
+	static const uint32_t kDefaultFrameCount = 600;
+
+	/// <summary>
+	/// 実行
+	/// </summary>
+	/// <param name="scene">シーン(初期化前のもの。デバイスより先にここで解放する)</param>
+	/// <param name="frameCount">フレーム数</param>
+	/// <param name="csvPath">フレームごとの統計の出力先</param>
+	/// <returns>終了コード。描画命令の検証で不正があったか、出力に失敗したら1</returns>
+	static int Run(std::unique_ptr<Scene> scene, uint32_t frameCount = kDefaultFrameCount, const std::string& csvPath = "headless.csv");
+};
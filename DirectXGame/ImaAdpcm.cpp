@@ -0,0 +1,158 @@
+#include "ImaAdpcm.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const int16_t kStepTable[89] = {
+    7,    8,    9,    10,   11,   12,   13,   14,   16,   17,   19,   21,   23,   25,   28,   31,   34,    37,    41,    45,    50,    55,    60,    66,    73,    80,    88,    97,    107,    118,
+    130,  143,  157,  173,  190,  209,  230,  253,  279,  307,  337,  371,  408,  449,  494,  544,  598,   658,   724,   796,   876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,   2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767};
+
+const int8_t kIndexTable[16] = {-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8};
+
+// チャンネルごとのデコーダの状態
+struct DecoderState {
+	int32_t predictor;
+	int32_t stepIndex;
+
+	int16_t Decode(uint8_t nibble) {
+		int32_t step = kStepTable[stepIndex];
+		int32_t diff = step >> 3;
+		if (nibble & 4) {
+			diff += step;
+		}
+		if (nibble & 2) {
+			diff += step >> 1;
+		}
+		if (nibble & 1) {
+			diff += step >> 2;
+		}
+		predictor += (nibble & 8) ? -diff : diff;
+		predictor = std::clamp(predictor, -32768, 32767);
+		stepIndex = std::clamp(stepIndex + kIndexTable[nibble], 0, 88);
+		return static_cast<int16_t>(predictor);
+	}
+};
+
+} // namespace
+
+uint32_t GetImaAdpcmSamplesPerBlock(const WaveFormat& format) {
+	if (format.formatTag != WaveFormat::kImaAdpcm || format.bitsPerSample != 4 || (format.channels != 1 && format.channels != 2) || format.blockAlign <= 4u * format.channels) {
+		return 0;
+	}
+	// ヘッダのサンプル1つと、残りのバイトに2サンプルずつ
+	uint32_t computed = (format.blockAlign - 4u * format.channels) * 2 / format.channels + 1;
+	if (format.extra.size() >= 2) {
+		uint16_t samplesPerBlock = 0;
+		std::memcpy(&samplesPerBlock, format.extra.data(), 2);
+		if (samplesPerBlock != 0 && samplesPerBlock <= computed) {
+			return samplesPerBlock;
+		}
+	}
+	return computed;
+}
+
+WaveFormat MakeImaAdpcmOutputFormat(const WaveFormat& format) {
+	WaveFormat output;
+	output.formatTag = WaveFormat::kPcm;
+	output.channels = format.channels;
+	output.sampleRate = format.sampleRate;
+	output.bitsPerSample = 16;
+	output.blockAlign = static_cast<uint16_t>(format.channels * 2);
+	output.avgBytesPerSec = format.sampleRate * output.blockAlign;
+	return output;
+}
+
+uint32_t DecodeImaAdpcmBlock(const uint8_t* block, size_t blockSize, uint32_t channels, uint32_t samplesPerBlock, int16_t* pcm) {
+	size_t headerSize = 4 * channels;
+	if (blockSize < headerSize) {
+		return 0;
+	}
+
+	// ブロックヘッダ: チャンネルごとに先頭サンプル(16bit)とステップ位置(8bit)と予約(8bit)
+	DecoderState states[2];
+	for (uint32_t c = 0; c < channels; ++c) {
+		int16_t predictor;
+		std::memcpy(&predictor, block + c * 4, 2);
+		states[c] = {predictor, (std::min)(static_cast<int32_t>(block[c * 4 + 2]), 88)};
+		pcm[c] = predictor;
+	}
+
+	// 短いブロックは入っている分だけ。ステレオは8バイトの組で両チャンネルが揃うので、欠けた組は読まない
+	size_t dataSize = blockSize - headerSize;
+	size_t dataFrames = channels == 1 ? dataSize * 2 : dataSize / 8 * 8;
+	uint32_t frames = (std::min)(samplesPerBlock, static_cast<uint32_t>(dataFrames + 1));
+	if (channels == 1) {
+		for (uint32_t i = 1; i < frames; ++i) {
+			uint8_t byte = block[headerSize + (i - 1) / 2];
+			pcm[i] = states[0].Decode((i - 1) & 1 ? byte >> 4 : byte & 0x0F);
+		}
+	} else {
+		// ステレオはチャンネルごとに4バイト(8サンプル)ずつ交互に並ぶ
+		for (uint32_t i = 1; i < frames; ++i) {
+			uint32_t index = i - 1;
+			for (uint32_t c = 0; c < 2; ++c) {
+				uint8_t byte = block[headerSize + (index / 8) * 8 + c * 4 + (index % 8) / 2];
+				pcm[i * 2 + c] = states[c].Decode(index & 1 ? byte >> 4 : byte & 0x0F);
+			}
+		}
+	}
+	return frames;
+}
+
+bool DecodeImaAdpcm(const WaveFormat& format, const uint8_t* data, size_t size, std::vector<int16_t>& pcm) {
+	uint32_t samplesPerBlock = GetImaAdpcmSamplesPerBlock(format);
+	if (samplesPerBlock == 0) {
+		return false;
+	}
+	size_t blockCount = (size + format.blockAlign - 1) / format.blockAlign;
+	pcm.resize(blockCount * samplesPerBlock * format.channels);
+	size_t frames = 0;
+	for (size_t offset = 0; offset < size; offset += format.blockAlign) {
+		size_t blockSize = (std::min)(static_cast<size_t>(format.blockAlign), size - offset);
+		frames += DecodeImaAdpcmBlock(data + offset, blockSize, format.channels, samplesPerBlock, pcm.data() + frames * format.channels);
+	}
+	pcm.resize(frames * format.channels);
+	return true;
+}
+
+ImaAdpcmSource::ImaAdpcmSource(std::unique_ptr<AudioStreamSource> source) : source_(std::move(source)) {
+	const WaveFormat& input = source_->GetFormat();
+	samplesPerBlock_ = GetImaAdpcmSamplesPerBlock(input);
+	format_ = MakeImaAdpcmOutputFormat(input);
+	block_.resize(input.blockAlign);
+	decoded_.resize(static_cast<size_t>(samplesPerBlock_) * input.channels);
+}
+
+size_t ImaAdpcmSource::Read(uint8_t* dst, size_t size) {
+	if (!IsValid()) {
+		return 0;
+	}
+	size -= size % format_.blockAlign;
+	size_t written = 0;
+	while (written < size) {
+		// 前回デコードした残りを先に出す
+		if (decodedBegin_ == decodedEnd_) {
+			size_t read = source_->Read(block_.data(), block_.size());
+			if (read == 0) {
+				break;
+			}
+			uint32_t frames = DecodeImaAdpcmBlock(block_.data(), read, format_.channels, samplesPerBlock_, decoded_.data());
+			decodedBegin_ = 0;
+			decodedEnd_ = static_cast<size_t>(frames) * format_.channels;
+			continue;
+		}
+		size_t bytes = (std::min)((decodedEnd_ - decodedBegin_) * sizeof(int16_t), size - written);
+		std::memcpy(dst + written, decoded_.data() + decodedBegin_, bytes);
+		decodedBegin_ += bytes / sizeof(int16_t);
+		written += bytes;
+	}
+	return written;
+}
+
+bool ImaAdpcmSource::Rewind() {
+	decodedBegin_ = 0;
+	decodedEnd_ = 0;
+	return source_->Rewind();
+}
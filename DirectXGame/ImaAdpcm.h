@@ -0,0 +1,69 @@
+#pragma once
+#include "AudioStreamSource.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/// <summary>
+/// IMA-ADPCMの1ブロックあたりのサンプル数(チャンネルあたり)
+/// </summary>
+/// <param name="format">IMA-ADPCMの波形フォーマット</param>
+/// <returns>サンプル数。形式が不正なら0</returns>
+uint32_t GetImaAdpcmSamplesPerBlock(const WaveFormat& format);
+
+/// <summary>
+/// IMA-ADPCMをデコードした後の16bitリニアPCMの波形フォーマット
+/// </summary>
+WaveFormat MakeImaAdpcmOutputFormat(const WaveFormat& format);
+
+/// <summary>
+/// IMA-ADPCMの1ブロックのデコード
+/// </summary>
+/// <param name="block">ブロック</param>
+/// <param name="blockSize">ブロックのバイト数(最後のブロックはblockAlignより短いことがある)</param>
+/// <param name="channels">チャンネル数(1か2)</param>
+/// <param name="samplesPerBlock">1ブロックあたりのサンプル数</param>
+/// <param name="pcm">出力先(チャンネル交互の16bit、samplesPerBlock * channels個)</param>
+/// <returns>デコードしたサンプル数(チャンネルあたり)</returns>
+uint32_t DecodeImaAdpcmBlock(const uint8_t* block, size_t blockSize, uint32_t channels, uint32_t samplesPerBlock, int16_t* pcm);
+
+/// <summary>
+/// IMA-ADPCMのデータ全体のデコード(読み込み時デコード用)
+/// </summary>
+/// <param name="format">IMA-ADPCMの波形フォーマット</param>
+/// <param name="data">dataチャンクの中身</param>
+/// <param name="size">バイト数</param>
+/// <param name="pcm">出力先(チャンネル交互の16bit)</param>
+/// <returns>成否</returns>
+bool DecodeImaAdpcm(const WaveFormat& format, const uint8_t* data, size_t size, std::vector<int16_t>& pcm);
+
+/// <summary>
+/// IMA-ADPCMの音源を読みながら16bitリニアPCMにデコードする音源(ストリーミング用)
+/// </summary>
+class ImaAdpcmSource : public AudioStreamSource {
+public:
+	/// <summary>
+	/// コンストラクタ
+	/// </summary>
+	/// <param name="source">IMA-ADPCMの音源(ブロック単位で読める)</param>
+	explicit ImaAdpcmSource(std::unique_ptr<AudioStreamSource> source);
+
+	// 使える形式か(モノラルかステレオのIMA-ADPCM)
+	bool IsValid() const { return samplesPerBlock_ != 0; }
+
+	const WaveFormat& GetFormat() const override { return format_; }
+	size_t Read(uint8_t* dst, size_t size) override;
+	bool Rewind() override;
+
+private:
+	std::unique_ptr<AudioStreamSource> source_;
+	WaveFormat format_;
+	uint32_t samplesPerBlock_ = 0;
+	// 読み出したブロック
+	std::vector<uint8_t> block_;
+	// デコード済みで未出力のPCM
+	std::vector<int16_t> decoded_;
+	size_t decodedBegin_ = 0;
+	size_t decodedEnd_ = 0;
+};
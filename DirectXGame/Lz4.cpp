@@ -0,0 +1,180 @@
+#include "Lz4.h"
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// 一致の最小長
+const size_t kMinMatch = 4;
+// 末尾のこのバイト数はリテラルにする
+const size_t kLastLiterals = 5;
+// 一致はブロック末尾からこのバイト数より前で始める
+const size_t kMatchFindLimit = 12;
+// 一致を探す距離の上限
+const size_t kMaxDistance = 65535;
+// ハッシュ表の大きさ(ビット)
+const uint32_t kHashBits = 16;
+
+uint32_t Read32(const uint8_t* p) {
+	uint32_t value;
+	std::memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+uint32_t Hash(uint32_t sequence) { return (sequence * 2654435761u) >> (32 - kHashBits); }
+
+// 長さの延長部分(255を並べて残りを書く)
+uint8_t* WriteLength(uint8_t* op, size_t length) {
+	while (length >= 255) {
+		*op++ = 255;
+		length -= 255;
+	}
+	*op++ = static_cast<uint8_t>(length);
+	return op;
+}
+
+} // namespace
+
+size_t LZ4CompressBound(size_t size) { return size + size / 255 + 16; }
+
+size_t LZ4Compress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstCapacity) {
+	uint8_t* op = dst;
+	uint8_t* const opEnd = dst + dstCapacity;
+	const uint8_t* anchor = src;
+	const uint8_t* const srcEnd = src + srcSize;
+
+	// 1つの列(リテラル+一致)を書き出す。matchLengthが0なら最後のリテラルだけ
+	auto emit = [&](const uint8_t* literalEnd, size_t offset, size_t matchLength) {
+		size_t literalLength = static_cast<size_t>(literalEnd - anchor);
+		size_t worst = 1 + literalLength / 255 + 1 + literalLength + 2 + (matchLength >= kMinMatch ? (matchLength - kMinMatch) / 255 + 1 : 0);
+		if (static_cast<size_t>(opEnd - op) < worst) {
+			return false;
+		}
+		uint8_t* token = op++;
+		*token = static_cast<uint8_t>((literalLength < 15 ? literalLength : 15) << 4);
+		if (literalLength >= 15) {
+			op = WriteLength(op, literalLength - 15);
+		}
+		std::memcpy(op, anchor, literalLength);
+		op += literalLength;
+		if (matchLength == 0) {
+			return true;
+		}
+		*op++ = static_cast<uint8_t>(offset);
+		*op++ = static_cast<uint8_t>(offset >> 8);
+		size_t code = matchLength - kMinMatch;
+		*token |= static_cast<uint8_t>(code < 15 ? code : 15);
+		if (code >= 15) {
+			op = WriteLength(op, code - 15);
+		}
+		return true;
+	};
+
+	if (srcSize > kMatchFindLimit) {
+		std::vector<uint32_t> table(size_t(1) << kHashBits, UINT32_MAX);
+		const uint8_t* const matchLimit = srcEnd - kLastLiterals;
+		const uint8_t* const searchLimit = srcEnd - kMatchFindLimit;
+		const uint8_t* ip = src;
+		while (ip < searchLimit) {
+			uint32_t sequence = Read32(ip);
+			uint32_t& slot = table[Hash(sequence)];
+			const uint8_t* candidate = slot != UINT32_MAX ? src + slot : nullptr;
+			slot = static_cast<uint32_t>(ip - src);
+			if (!candidate || static_cast<size_t>(ip - candidate) > kMaxDistance || Read32(candidate) != sequence) {
+				++ip;
+				continue;
+			}
+
+			// 前方へ一致を伸ばす(末尾のリテラル分は残す)
+			const uint8_t* matchEnd = ip + kMinMatch;
+			const uint8_t* candidateEnd = candidate + kMinMatch;
+			while (matchEnd < matchLimit && *matchEnd == *candidateEnd) {
+				++matchEnd;
+				++candidateEnd;
+			}
+			// 後方へも伸ばす
+			while (ip > anchor && candidate > src && ip[-1] == candidate[-1]) {
+				--ip;
+				--candidate;
+			}
+			if (!emit(ip, static_cast<size_t>(ip - candidate), static_cast<size_t>(matchEnd - ip))) {
+				return 0;
+			}
+			ip = matchEnd;
+			anchor = ip;
+			// 一致の途中の位置も表に登録しておく
+			if (ip - 2 >= src && ip < searchLimit) {
+				table[Hash(Read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - src);
+			}
+		}
+	}
+
+	if (!emit(srcEnd, 0, 0)) {
+		return 0;
+	}
+	return static_cast<size_t>(op - dst);
+}
+
+bool LZ4Decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) {
+	const uint8_t* ip = src;
+	const uint8_t* const ipEnd = src + srcSize;
+	uint8_t* op = dst;
+	uint8_t* const opEnd = dst + dstSize;
+
+	// 長さの延長部分の読み取り
+	auto readLength = [&](size_t& length) {
+		uint8_t byte;
+		do {
+			if (ip >= ipEnd) {
+				return false;
+			}
+			byte = *ip++;
+			length += byte;
+		} while (byte == 255);
+		return true;
+	};
+
+	while (ip < ipEnd) {
+		uint8_t token = *ip++;
+		size_t literalLength = token >> 4;
+		if (literalLength == 15 && !readLength(literalLength)) {
+			return false;
+		}
+		if (static_cast<size_t>(ipEnd - ip) < literalLength || static_cast<size_t>(opEnd - op) < literalLength) {
+			return false;
+		}
+		std::memcpy(op, ip, literalLength);
+		ip += literalLength;
+		op += literalLength;
+
+		// 最後の列はリテラルだけ
+		if (ip == ipEnd) {
+			break;
+		}
+
+		if (ipEnd - ip < 2) {
+			return false;
+		}
+		size_t offset = ip[0] | (size_t(ip[1]) << 8);
+		ip += 2;
+		size_t matchLength = token & 15;
+		if (matchLength == 15 && !readLength(matchLength)) {
+			return false;
+		}
+		matchLength += kMinMatch;
+		if (offset == 0 || offset > static_cast<size_t>(op - dst) || static_cast<size_t>(opEnd - op) < matchLength) {
+			return false;
+		}
+		// 重なりのあるコピー(offsetが長さより短いと繰り返しになる)を1バイトずつ行う
+		const uint8_t* match = op - offset;
+		if (offset >= matchLength) {
+			std::memcpy(op, match, matchLength);
+			op += matchLength;
+		} else {
+			for (size_t i = 0; i < matchLength; ++i) {
+				*op++ = match[i];
+			}
+		}
+	}
+	return op == opEnd;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/// <summary>
+/// LZ4ブロック形式の圧縮後の最大バイト数
+/// </summary>
+/// <param name="size">圧縮前のバイト数</param>
+/// <returns>最大バイト数</returns>
+size_t LZ4CompressBound(size_t size);
+
+/// <summary>
+/// LZ4ブロック形式での圧縮
+/// </summary>
+/// <param name="src">入力</param>
+/// <param name="srcSize">入力のバイト数</param>
+/// <param name="dst">出力先(LZ4CompressBoundのバイト数があれば必ず収まる)</param>
+/// <param name="dstCapacity">出力先のバイト数</param>
+/// <returns>圧縮後のバイト数。収まらなければ0</returns>
+size_t LZ4Compress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstCapacity);
+
+/// <summary>
+/// LZ4ブロック形式の展開。不正な入力では出力先の外に書き込まずに失敗する
+/// </summary>
+/// <param name="src">入力</param>
+/// <param name="srcSize">入力のバイト数</param>
+/// <param name="dst">出力先</param>
+/// <param name="dstSize">展開後のバイト数(ちょうどこのバイト数になる必要がある)</param>
+/// <returns>成否</returns>
+bool LZ4Decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
@@ -0,0 +1,115 @@
+#include "MappedFile.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <filesystem>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() { Close(); }
+
+bool MappedFile::Open(const std::string& filePath) {
+	Close();
+#ifdef _WIN32
+	std::wstring path = std::filesystem::path(filePath).wstring();
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER fileSize{};
+	if (!GetFileSizeEx(file, &fileSize)) {
+		CloseHandle(file);
+		return false;
+	}
+	file_ = file;
+	size_ = static_cast<size_t>(fileSize.QuadPart);
+	open_ = true;
+	// 空のファイルはマップできないので開いただけにする
+	if (size_ == 0) {
+		return true;
+	}
+	mapping_ = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping_) {
+		Close();
+		return false;
+	}
+	data_ = static_cast<const uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+	if (!data_) {
+		Close();
+		return false;
+	}
+	return true;
+#else
+	int fd = open(filePath.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat status {};
+	if (fstat(fd, &status) != 0) {
+		close(fd);
+		return false;
+	}
+	fd_ = fd;
+	size_ = static_cast<size_t>(status.st_size);
+	open_ = true;
+	if (size_ == 0) {
+		return true;
+	}
+	void* address = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (address == MAP_FAILED) {
+		Close();
+		return false;
+	}
+	data_ = static_cast<const uint8_t*>(address);
+	return true;
+#endif
+}
+
+void MappedFile::Close() {
+#ifdef _WIN32
+	if (data_) {
+		UnmapViewOfFile(data_);
+	}
+	if (mapping_) {
+		CloseHandle(mapping_);
+		mapping_ = nullptr;
+	}
+	if (file_) {
+		CloseHandle(file_);
+		file_ = nullptr;
+	}
+#else
+	if (data_) {
+		munmap(const_cast<uint8_t*>(data_), size_);
+	}
+	if (fd_ >= 0) {
+		close(fd_);
+		fd_ = -1;
+	}
+#endif
+	data_ = nullptr;
+	size_ = 0;
+	open_ = false;
+}
+
+void MappedFile::Prefetch(size_t offset, size_t size) const {
+	if (!data_ || offset >= size_) {
+		return;
+	}
+	size = (std::min)(size, size_ - offset);
+#ifdef _WIN32
+	WIN32_MEMORY_RANGE_ENTRY range{const_cast<uint8_t*>(data_ + offset), size};
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+	// madviseはページ境界から指定する
+	uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+	uintptr_t begin = reinterpret_cast<uintptr_t>(data_ + offset) & ~(pageSize - 1);
+	uintptr_t end = reinterpret_cast<uintptr_t>(data_ + offset + size);
+	madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED);
+#endif
+}
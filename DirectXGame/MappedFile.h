@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/// <summary>
+/// 読み取り専用でメモリマップしたファイル
+/// Windowsではファイルマッピング、それ以外ではmmapを使う
+/// </summary>
+class MappedFile {
+public:
+	MappedFile() = default;
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	const MappedFile& operator=(const MappedFile&) = delete;
+
+	/// <summary>
+	/// ファイルを開いてマップする
+	/// </summary>
+	/// <param name="filePath">ファイルパス</param>
+	/// <returns>成否</returns>
+	bool Open(const std::string& filePath);
+
+	/// <summary>
+	/// マップの解除
+	/// </summary>
+	void Close();
+
+	/// <summary>
+	/// 範囲を先読みするようOSに伝える(ヒントなので無視されることがある)
+	/// </summary>
+	/// <param name="offset">先頭</param>
+	/// <param name="size">バイト数</param>
+	void Prefetch(size_t offset, size_t size) const;
+
+	// 先頭アドレス(空のファイルではnullptr)
+	const uint8_t* GetData() const { return data_; }
+	// バイト数
+	size_t GetSize() const { return size_; }
+	// 開いているか
+	bool IsOpen() const { return open_; }
+
+private:
+#ifdef _WIN32
+	void* file_ = nullptr;
+	void* mapping_ = nullptr;
+#else
+	int fd_ = -1;
+#endif
+	const uint8_t* data_ = nullptr;
+	size_t size_ = 0;
+	bool open_ = false;
+};
@@ -0,0 +1,238 @@
+#include "MipResidencyManager.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+void MipResidencyManager::Initialize(uint64_t budgetBytes, uint32_t hysteresisFrames) {
+	textures_.clear();
+	freeIds_.clear();
+	budgetBytes_ = budgetBytes;
+	hysteresisFrames_ = hysteresisFrames;
+	residentBytes_ = 0;
+	projectedBytes_ = 0;
+	statistics_ = {};
+}
+
+uint32_t MipResidencyManager::Register(uint32_t width, uint32_t height, const std::vector<uint64_t>& mipBytes, uint32_t tailMip) {
+	if (mipBytes.empty()) {
+		return kInvalidId;
+	}
+	uint32_t id = 0;
+	if (!freeIds_.empty()) {
+		id = freeIds_.back();
+		freeIds_.pop_back();
+	} else {
+		id = static_cast<uint32_t>(textures_.size());
+		textures_.emplace_back();
+	}
+
+	Texture& texture = textures_[id];
+	texture = {};
+	texture.used = true;
+	texture.width = width;
+	texture.height = height;
+	texture.tailMip = (std::min)(tailMip, static_cast<uint32_t>(mipBytes.size()) - 1);
+	texture.bytesFrom.assign(mipBytes.size() + 1, 0);
+	for (size_t mip = mipBytes.size(); mip-- > 0;) {
+		texture.bytesFrom[mip] = texture.bytesFrom[mip + 1] + mipBytes[mip];
+	}
+	texture.residentMip = texture.tailMip;
+	texture.targetMip = texture.tailMip;
+	texture.desiredMip = texture.tailMip;
+	residentBytes_ += texture.bytesFrom[texture.residentMip];
+	projectedBytes_ += texture.bytesFrom[texture.targetMip];
+	return id;
+}
+
+void MipResidencyManager::Unregister(uint32_t id) {
+	Texture& texture = textures_[id];
+	if (!texture.used) {
+		return;
+	}
+	residentBytes_ -= GetChargedBytes(texture);
+	projectedBytes_ -= texture.bytesFrom[texture.targetMip];
+	texture = {};
+	freeIds_.push_back(id);
+}
+
+void MipResidencyManager::RequestUsage(uint32_t id, float screenWidth, float screenHeight) {
+	Texture& texture = textures_[id];
+	texture.screenWidth = (std::max)(texture.screenWidth, screenWidth);
+	texture.screenHeight = (std::max)(texture.screenHeight, screenHeight);
+}
+
+uint32_t MipResidencyManager::ComputeDesiredMip(const Texture& texture) {
+	if (texture.screenWidth <= 0.0f || texture.screenHeight <= 0.0f) {
+		return texture.tailMip;
+	}
+	// テクセルと画素が1対1以上になる最も粗いミップ。詳細が必要な軸に合わせる
+	float ratio = (std::min)(texture.width / texture.screenWidth, texture.height / texture.screenHeight);
+	if (ratio <= 1.0f) {
+		return 0;
+	}
+	uint32_t mip = static_cast<uint32_t>(std::floor(std::log2(ratio)));
+	return (std::min)(mip, texture.tailMip);
+}
+
+uint64_t MipResidencyManager::GetChargedBytes(const Texture& texture) {
+	uint64_t bytes = texture.bytesFrom[texture.residentMip];
+	if (texture.targetMip != texture.residentMip) {
+		bytes += texture.bytesFrom[texture.targetMip];
+	}
+	return bytes;
+}
+
+void MipResidencyManager::SetTargetMip(uint32_t id, uint32_t mip, std::vector<Change>& changes) {
+	Texture& texture = textures_[id];
+	if (mip == texture.targetMip) {
+		return;
+	}
+	if (mip < texture.residentMip) {
+		++statistics_.streamIns;
+	} else if (mip > texture.residentMip) {
+		++statistics_.evictions;
+	}
+	residentBytes_ -= GetChargedBytes(texture);
+	projectedBytes_ = projectedBytes_ - texture.bytesFrom[texture.targetMip] + texture.bytesFrom[mip];
+	// 予算の確保で同じフレームに何段も動くことがあるので、変更前は最初の値のまま変更後だけ更新する
+	// (IDが一致すれば前のUpdateの位置が残っていても、このchangesの中の同じテクスチャの変更である)
+	if (texture.changeIndex < changes.size() && changes[texture.changeIndex].id == id) {
+		changes[texture.changeIndex].targetMip = mip;
+	} else {
+		texture.changeIndex = static_cast<uint32_t>(changes.size());
+		changes.push_back({id, texture.targetMip, mip});
+	}
+	texture.targetMip = mip;
+	texture.idleFrames = 0;
+	residentBytes_ += GetChargedBytes(texture);
+}
+
+bool MipResidencyManager::OnLoadCompleted(uint32_t id, uint32_t mip, bool succeeded) {
+	if (id >= textures_.size()) {
+		return false;
+	}
+	Texture& texture = textures_[id];
+	if (!texture.used || texture.targetMip == texture.residentMip || mip != texture.targetMip) {
+		return false;
+	}
+	residentBytes_ -= GetChargedBytes(texture);
+	if (succeeded) {
+		// 新しい段階に差し替わり、古い段階は解放された
+		texture.residentMip = mip;
+	} else {
+		// 今の段階のまま描き、しばらく待ってから要求し直す
+		projectedBytes_ = projectedBytes_ - texture.bytesFrom[texture.targetMip] + texture.bytesFrom[texture.residentMip];
+		texture.targetMip = texture.residentMip;
+		texture.retryFrames = hysteresisFrames_;
+		++statistics_.failedLoads;
+	}
+	residentBytes_ += GetChargedBytes(texture);
+	return true;
+}
+
+uint64_t MipResidencyManager::EvictFor(uint32_t requester, uint64_t bytes, std::vector<Change>& changes) {
+	// 粗い段階の読み込みが終わるまでは詳細な段階も残るので、空くのは完了後の見込み
+	uint64_t before = projectedBytes_;
+	auto freed = [&]() { return before - projectedBytes_; };
+
+	// まず必要以上に詳細なミップを落とす(ヒステリシスは無視する。読み込み中のものは完了を待つ)
+	for (uint32_t id = 0; id < textures_.size() && freed() < bytes; ++id) {
+		const Texture& texture = textures_[id];
+		if (id != requester && texture.used && texture.targetMip == texture.residentMip && texture.residentMip < texture.desiredMip) {
+			SetTargetMip(id, texture.desiredMip, changes);
+		}
+	}
+	if (freed() >= bytes) {
+		return freed();
+	}
+
+	// 次に優先度の低いものから1段ずつ粗くする
+	std::vector<uint32_t> victims;
+	for (uint32_t id = 0; id < textures_.size(); ++id) {
+		const Texture& texture = textures_[id];
+		if (id != requester && texture.used && texture.priority < textures_[requester].priority && texture.targetMip >= texture.residentMip && texture.targetMip < texture.tailMip) {
+			victims.push_back(id);
+		}
+	}
+	std::sort(victims.begin(), victims.end(), [this](uint32_t a, uint32_t b) { return textures_[a].priority < textures_[b].priority; });
+	for (uint32_t id : victims) {
+		while (freed() < bytes && textures_[id].targetMip < textures_[id].tailMip) {
+			SetTargetMip(id, textures_[id].targetMip + 1, changes);
+		}
+		if (freed() >= bytes) {
+			break;
+		}
+	}
+	return freed();
+}
+
+void MipResidencyManager::Update(std::vector<Change>& changes) {
+	changes.clear();
+
+	// 必要なミップを求め、粗くしてよいものはヒステリシスを過ぎてから落とす
+	using Candidate = std::pair<float, uint32_t>;
+	std::priority_queue<Candidate> candidates;
+	for (uint32_t id = 0; id < textures_.size(); ++id) {
+		Texture& texture = textures_[id];
+		if (!texture.used) {
+			continue;
+		}
+		texture.desiredMip = ComputeDesiredMip(texture);
+		texture.priority = texture.screenWidth * texture.screenHeight;
+		texture.screenWidth = 0.0f;
+		texture.screenHeight = 0.0f;
+
+		// 読み込み中は完了の報告を、失敗した後は待ち時間を過ぎるのを待つ
+		if (texture.targetMip != texture.residentMip) {
+			continue;
+		}
+		if (texture.retryFrames > 0) {
+			--texture.retryFrames;
+			continue;
+		}
+
+		if (texture.desiredMip < texture.residentMip) {
+			texture.idleFrames = 0;
+			candidates.push({texture.priority, id});
+		} else if (texture.desiredMip > texture.residentMip) {
+			if (++texture.idleFrames >= hysteresisFrames_) {
+				SetTargetMip(id, texture.desiredMip, changes);
+			}
+		} else {
+			texture.idleFrames = 0;
+		}
+	}
+
+	// 画面上で大きいものから予算の範囲で詳細なミップを読み込む
+	while (!candidates.empty()) {
+		uint32_t id = candidates.top().second;
+		candidates.pop();
+		const Texture& texture = textures_[id];
+		// 優先度の高いものの予算の確保で既に落とされた
+		if (texture.targetMip != texture.residentMip) {
+			continue;
+		}
+
+		uint64_t required = projectedBytes_ + texture.bytesFrom[texture.desiredMip] - texture.bytesFrom[texture.residentMip];
+		if (required > budgetBytes_) {
+			EvictFor(id, required - budgetBytes_, changes);
+		}
+
+		// 足りなければ収まるところまで妥協する。読み込み中は今の段階も残るので、完了後の見込みと今の常駐の両方が予算に収まる段階にする
+		// (他のテクスチャを落とした分が空くのはその読み込みの完了後なので、足りなければ次のフレーム以降に上げ直す)
+		auto fits = [&](uint32_t mip) {
+			return projectedBytes_ + texture.bytesFrom[mip] - texture.bytesFrom[texture.residentMip] <= budgetBytes_ && residentBytes_ + texture.bytesFrom[mip] <= budgetBytes_;
+		};
+		uint32_t target = texture.desiredMip;
+		while (target < texture.residentMip && !fits(target)) {
+			++target;
+		}
+		if (target != texture.desiredMip) {
+			++statistics_.budgetMisses;
+		}
+		SetTargetMip(id, target, changes);
+	}
+
+	// 行って戻っただけの変更を除く
+	std::erase_if(changes, [](const Change& change) { return change.previousMip == change.targetMip; });
+}
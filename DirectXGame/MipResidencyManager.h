@@ -0,0 +1,154 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// ミップマップの常駐管理
+/// 描画側が報告する画面上の大きさから各テクスチャに必要なミップを求め、
+/// メモリ予算の範囲で優先度の高いものから詳細なミップを常駐させる。
+/// 粗いミップへ落とすのは一定フレーム不要が続いてから(予算が足りないときを除く)。
+/// 決めた段階は読み込みの要求(Change)として出し、実際に常駐するのは読み込み側がOnLoadCompletedで完了を報告してから。
+/// 差し替えの間は今の段階と新しい段階の両方が常駐するので、その分も常駐バイト数に数える。
+/// 読み込みに失敗したら今の段階に戻し、ヒステリシスと同じフレーム数だけ待ってから要求し直す
+/// </summary>
+class MipResidencyManager {
+public:
+	// 無効なID
+	static const uint32_t kInvalidId = UINT32_MAX;
+	// 既定の予算(バイト)
+	static const uint64_t kDefaultBudget = 128ull * 1024 * 1024;
+	// 既定のヒステリシス(フレーム)
+	static const uint32_t kDefaultHysteresisFrames = 30;
+
+	/// <summary>
+	/// 読み込む段階の変更(Updateの出力)。1回のUpdateで同じテクスチャは1つにまとめる
+	/// </summary>
+	struct Change {
+		uint32_t id = kInvalidId;
+		// 変更前の最も詳細な常駐ミップ
+		uint32_t previousMip = 0;
+		// 読み込む最も詳細なミップ(完了をOnLoadCompletedで報告する)
+		uint32_t targetMip = 0;
+	};
+
+	/// <summary>
+	/// 統計
+	/// </summary>
+	struct Statistics {
+		// 詳細なミップを読み込んだ回数
+		uint64_t streamIns = 0;
+		// 粗いミップに落とした回数
+		uint64_t evictions = 0;
+		// 予算が足りず必要なミップまで上げられなかった回数
+		uint64_t budgetMisses = 0;
+		// 読み込みに失敗した回数
+		uint64_t failedLoads = 0;
+	};
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="budgetBytes">予算(バイト)</param>
+	/// <param name="hysteresisFrames">不要になってから粗いミップに落とすまでのフレーム数</param>
+	void Initialize(uint64_t budgetBytes = kDefaultBudget, uint32_t hysteresisFrames = kDefaultHysteresisFrames);
+
+	/// <summary>
+	/// テクスチャの登録。最初は最も粗いミップ(tailMip)だけが常駐している扱い
+	/// </summary>
+	/// <param name="width">ミップ0の幅</param>
+	/// <param name="height">ミップ0の高さ</param>
+	/// <param name="mipBytes">ミップごとのバイト数(0が最大)</param>
+	/// <param name="tailMip">常に常駐させる最も粗い段階</param>
+	/// <returns>ID</returns>
+	uint32_t Register(uint32_t width, uint32_t height, const std::vector<uint64_t>& mipBytes, uint32_t tailMip);
+
+	/// <summary>
+	/// テクスチャの登録解除
+	/// </summary>
+	/// <param name="id">ID</param>
+	void Unregister(uint32_t id);
+
+	/// <summary>
+	/// 使用の報告。同じフレームで複数回報告された場合は大きい方を使う
+	/// </summary>
+	/// <param name="id">ID</param>
+	/// <param name="screenWidth">画面上の幅(ピクセル)</param>
+	/// <param name="screenHeight">画面上の高さ(ピクセル)</param>
+	void RequestUsage(uint32_t id, float screenWidth, float screenHeight);
+
+	/// <summary>
+	/// フレームの終わりに常駐させる段階を決め直す。読み込み中のテクスチャは完了の報告まで決め直さない
+	/// </summary>
+	/// <param name="changes">読み込む段階が変わったテクスチャ(テクスチャごとに最終的な段階を1つ)</param>
+	void Update(std::vector<Change>& changes);
+
+	/// <summary>
+	/// 読み込みの完了の報告。成功なら常駐ミップを進め、失敗なら要求を取り消す
+	/// </summary>
+	/// <param name="id">ID</param>
+	/// <param name="mip">読み込んだ段階(Change::targetMip)</param>
+	/// <param name="succeeded">成否</param>
+	/// <returns>今の要求に対する報告だったか(取り消し済みの要求や登録解除後ならfalse)</returns>
+	bool OnLoadCompleted(uint32_t id, uint32_t mip, bool succeeded);
+
+	// 必要なミップ(最後のUpdateの時点)
+	uint32_t GetDesiredMip(uint32_t id) const { return textures_[id].desiredMip; }
+	// 最も詳細な常駐ミップ(読み込みが完了した段階)
+	uint32_t GetResidentMip(uint32_t id) const { return textures_[id].residentMip; }
+	// 読み込みを要求している段階(読み込み中でなければ常駐ミップと同じ)
+	uint32_t GetTargetMip(uint32_t id) const { return textures_[id].targetMip; }
+	// 読み込み中か
+	bool IsLoading(uint32_t id) const { return textures_[id].targetMip != textures_[id].residentMip; }
+	// 常駐しているバイト数(差し替え中は両方の段階を数える)
+	uint64_t GetResidentBytes() const { return residentBytes_; }
+	// 読み込み中の要求がすべて完了した後の常駐バイト数
+	uint64_t GetProjectedBytes() const { return projectedBytes_; }
+	// 予算
+	uint64_t GetBudget() const { return budgetBytes_; }
+	void SetBudget(uint64_t budgetBytes) { budgetBytes_ = budgetBytes; }
+	const Statistics& GetStatistics() const { return statistics_; }
+
+private:
+	struct Texture {
+		bool used = false;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t tailMip = 0;
+		uint32_t residentMip = 0;
+		uint32_t targetMip = 0;
+		uint32_t desiredMip = 0;
+		// ミップiから末尾までのバイト数
+		std::vector<uint64_t> bytesFrom;
+		// このフレームで報告された画面上の大きさ
+		float screenWidth = 0.0f;
+		float screenHeight = 0.0f;
+		// 画面上の面積(優先度)
+		float priority = 0.0f;
+		// 常駐ミップより粗くてよい状態が続いたフレーム数
+		uint32_t idleFrames = 0;
+		// 読み込みに失敗してから要求し直すまでの残りフレーム数
+		uint32_t retryFrames = 0;
+		// このUpdateでの変更の位置(Update中に何度変わっても1つにまとめる)
+		uint32_t changeIndex = UINT32_MAX;
+	};
+
+	// 画面上の大きさから必要なミップを求める
+	static uint32_t ComputeDesiredMip(const Texture& texture);
+
+	// 常駐しているバイト数(読み込み中は今の段階と新しい段階の両方)
+	static uint64_t GetChargedBytes(const Texture& texture);
+
+	// 読み込む段階の変更
+	void SetTargetMip(uint32_t id, uint32_t mip, std::vector<Change>& changes);
+
+	// 他のテクスチャを粗くして予算を空ける(読み込みの完了後に空く見込みのバイト数を返す)
+	uint64_t EvictFor(uint32_t requester, uint64_t bytes, std::vector<Change>& changes);
+
+	std::vector<Texture> textures_;
+	std::vector<uint32_t> freeIds_;
+	uint64_t budgetBytes_ = kDefaultBudget;
+	uint32_t hysteresisFrames_ = kDefaultHysteresisFrames;
+	uint64_t residentBytes_ = 0;
+	uint64_t projectedBytes_ = 0;
+	Statistics statistics_;
+};
@@ -0,0 +1,317 @@
+#include "NullRenderDevice.h"
+#include <cstring>
+
+namespace {
+
+// ヌルデバイスのGPUアドレスの配置単位
+const uint64_t kAddressAlignment = 0x10000;
+
+// ルート引数(RenderCommandListのルートパラメータ番号に対応するビット)
+const uint32_t kRootConstantBuffer = 1 << 0;
+const uint32_t kRootTexture = 1 << 1;
+const uint32_t kRootStructuredBuffer = 1 << 2;
+
+} // namespace
+
+/// <summary>
+/// ヌルデバイスのバッファ。内容はCPUメモリに保持する
+/// </summary>
+class NullRenderDevice::Buffer : public RenderBuffer {
+public:
+	Buffer(NullRenderDevice* device, size_t size, BufferUsage usage, uint64_t address) : device_(device), storage_(size), usage_(usage), address_(address) {}
+	~Buffer() override { device_->buffers_.erase(address_); }
+
+	void Write(size_t offset, const void* data, size_t size) override {
+		if (usage_ != BufferUsage::kUpload) {
+			device_->ReportError("Write to a default buffer");
+			return;
+		}
+		if (offset + size > storage_.size()) {
+			device_->ReportError("Write out of buffer range");
+			return;
+		}
+		std::memcpy(storage_.data() + offset, data, size);
+		device_->currentCounters_.bytesWritten += size;
+	}
+
+	void* GetMappedAddress() override {
+		if (usage_ != BufferUsage::kUpload) {
+			device_->ReportError("Map of a default buffer");
+			return nullptr;
+		}
+		return storage_.data();
+	}
+
+	void NotifyWritten(size_t size) override { device_->currentCounters_.bytesWritten += size; }
+
+	uint64_t GetGpuAddress() const override { return address_; }
+	size_t GetSize() const override { return storage_.size(); }
+	BufferUsage GetUsage() const override { return usage_; }
+
+	// 内容の取得
+	uint8_t* GetData() { return storage_.data(); }
+
+private:
+	NullRenderDevice* device_;
+	std::vector<uint8_t> storage_;
+	BufferUsage usage_;
+	uint64_t address_;
+};
+
+/// <summary>
+/// ヌルデバイスのコマンドリスト。状態を検証して統計を数える
+/// </summary>
+class NullRenderDevice::CommandList : public RenderCommandList {
+public:
+	explicit CommandList(NullRenderDevice* device) : device_(device) {}
+
+	// フレーム開始時に状態を初期化する
+	void Reset() {
+		pipeline_ = kInvalidPipeline;
+		vertexBuffer_ = {};
+		indexBuffer_ = {};
+		texture_ = UINT32_MAX;
+		rootArguments_ = 0;
+		staleRootArguments_ = 0;
+	}
+
+	void SetPipeline(PipelineHandle pipeline) override {
+		if (!CheckRecording()) {
+			return;
+		}
+		if (pipeline >= device_->pipelines_.size()) {
+			device_->ReportError("SetPipeline with an invalid handle");
+			return;
+		}
+		if (pipeline != pipeline_) {
+			++device_->currentCounters_.pipelineChanges;
+		}
+		pipeline_ = pipeline;
+		// D3D12の実装はルートシグネチャを設定し直すので、それまでのルート引数は無効になる
+		staleRootArguments_ |= rootArguments_;
+		rootArguments_ = 0;
+	}
+
+	void SetVertexBuffer(const VertexBufferView& view) override {
+		if (!CheckRecording()) {
+			return;
+		}
+		if (!device_->IsValidRange(view.address, view.size) || view.stride == 0) {
+			device_->ReportError("SetVertexBuffer with an invalid view");
+			return;
+		}
+		vertexBuffer_ = view;
+		++device_->currentCounters_.bufferBindings;
+	}
+
+	void SetIndexBuffer(const IndexBufferView& view) override {
+		if (!CheckRecording()) {
+			return;
+		}
+		if (!device_->IsValidRange(view.address, view.size)) {
+			device_->ReportError("SetIndexBuffer with an invalid view");
+			return;
+		}
+		indexBuffer_ = view;
+		++device_->currentCounters_.bufferBindings;
+	}
+
+	void SetConstantBuffer(uint64_t address) override {
+		if (!CheckRecording()) {
+			return;
+		}
+		if (!device_->IsValidRange(address, 1)) {
+			device_->ReportError("SetConstantBuffer with an invalid address");
+			return;
+		}
+		BindRootArgument(kRootConstantBuffer, "SetConstantBuffer before SetPipeline");
+		++device_->currentCounters_.bufferBindings;
+	}
+
+	void SetTexture(uint32_t textureHandle) override {
+		if (!CheckRecording()) {
+			return;
+		}
+		BindRootArgument(kRootTexture, "SetTexture before SetPipeline");
+		if (textureHandle != texture_) {
+			++device_->currentCounters_.textureChanges;
+		}
+		texture_ = textureHandle;
+	}
+
+	void SetStructuredBuffer(uint64_t address) override {
+		if (!CheckRecording()) {
+			return;
+		}
+		if (!device_->IsValidRange(address, 1)) {
+			device_->ReportError("SetStructuredBuffer with an invalid address");
+			return;
+		}
+		BindRootArgument(kRootStructuredBuffer, "SetStructuredBuffer before SetPipeline");
+		++device_->currentCounters_.bufferBindings;
+	}
+
+	void DrawInstanced(uint32_t vertexCountPerInstance, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance) override {
+		(void)startInstance;
+		if (!CheckDraw()) {
+			return;
+		}
+		if (device_->pipelines_[pipeline_].inputLayout != InputLayout::kNone &&
+		    (vertexBuffer_.size == 0 || uint64_t(startVertex + vertexCountPerInstance) * vertexBuffer_.stride > vertexBuffer_.size)) {
+			device_->ReportError("DrawInstanced reads past the vertex buffer");
+			return;
+		}
+		CountDraw(vertexCountPerInstance, instanceCount);
+	}
+
+	void DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance) override {
+		(void)baseVertex;
+		(void)startInstance;
+		if (!CheckDraw()) {
+			return;
+		}
+		if (indexBuffer_.size == 0 || uint64_t(startIndex + indexCountPerInstance) * sizeof(uint16_t) > indexBuffer_.size) {
+			device_->ReportError("DrawIndexedInstanced reads past the index buffer");
+			return;
+		}
+		if (device_->pipelines_[pipeline_].inputLayout != InputLayout::kNone && vertexBuffer_.size == 0) {
+			device_->ReportError("DrawIndexedInstanced without a vertex buffer");
+			return;
+		}
+		CountDraw(indexCountPerInstance, instanceCount);
+	}
+
+	void CopyBuffer(RenderBuffer* dst, size_t dstOffset, RenderBuffer* src, size_t srcOffset, size_t size) override {
+		if (!CheckRecording()) {
+			return;
+		}
+		if (dst == nullptr || src == nullptr || dst->GetUsage() != BufferUsage::kDefault || dstOffset + size > dst->GetSize() || srcOffset + size > src->GetSize()) {
+			device_->ReportError("CopyBuffer with an invalid range");
+			return;
+		}
+		std::memcpy(static_cast<Buffer*>(dst)->GetData() + dstOffset, static_cast<Buffer*>(src)->GetData() + srcOffset, size);
+		device_->currentCounters_.bytesCopied += size;
+	}
+
+	void CopyBuffers(const BufferCopy* copies, size_t count) override {
+		for (size_t i = 0; i < count; ++i) {
+			CopyBuffer(copies[i].dst, copies[i].dstOffset, copies[i].src, copies[i].srcOffset, copies[i].size);
+		}
+	}
+
+private:
+	bool CheckRecording() {
+		if (!device_->inFrame_) {
+			device_->ReportError("Command recorded outside of a frame");
+			return false;
+		}
+		return true;
+	}
+
+	bool CheckDraw() {
+		if (!CheckRecording()) {
+			return false;
+		}
+		if (pipeline_ == kInvalidPipeline) {
+			device_->ReportError("Draw without a pipeline");
+			return false;
+		}
+		if (staleRootArguments_ != 0) {
+			device_->ReportError("Draw with root arguments set before the last SetPipeline");
+			return false;
+		}
+		return true;
+	}
+
+	// ルート引数の設定を記録する。パイプラインより先に設定したものはルートシグネチャの設定で消える
+	void BindRootArgument(uint32_t rootArgument, const char* message) {
+		if (pipeline_ == kInvalidPipeline) {
+			device_->ReportError(message);
+			return;
+		}
+		rootArguments_ |= rootArgument;
+		staleRootArguments_ &= ~rootArgument;
+	}
+
+	void CountDraw(uint32_t vertexCount, uint32_t instanceCount) {
+		++device_->currentCounters_.drawCalls;
+		device_->currentCounters_.vertices += uint64_t(vertexCount) * instanceCount;
+		device_->currentCounters_.instances += instanceCount;
+	}
+
+	NullRenderDevice* device_;
+	PipelineHandle pipeline_ = kInvalidPipeline;
+	VertexBufferView vertexBuffer_;
+	IndexBufferView indexBuffer_;
+	uint32_t texture_ = UINT32_MAX;
+	// 今のパイプラインを設定した後に設定したルート引数
+	uint32_t rootArguments_ = 0;
+	// パイプラインの設定で無効になり、まだ設定し直していないルート引数
+	uint32_t staleRootArguments_ = 0;
+};
+
+NullRenderDevice::NullRenderDevice() : commandList_(std::make_unique<CommandList>(this)) {}
+
+NullRenderDevice::~NullRenderDevice() = default;
+
+std::unique_ptr<RenderBuffer> NullRenderDevice::CreateBuffer(size_t size, BufferUsage usage) {
+	uint64_t address = nextAddress_;
+	nextAddress_ += (size + kAddressAlignment - 1) / kAddressAlignment * kAddressAlignment + kAddressAlignment;
+	std::unique_ptr<Buffer> buffer = std::make_unique<Buffer>(this, size, usage, address);
+	buffers_[address] = buffer.get();
+	currentCounters_.bytesAllocated += size;
+	return buffer;
+}
+
+PipelineHandle NullRenderDevice::CreatePipeline(const PipelineDesc& desc) {
+	pipelines_.push_back(desc);
+	return static_cast<PipelineHandle>(pipelines_.size() - 1);
+}
+
+RenderCommandList* NullRenderDevice::GetCommandList() { return commandList_.get(); }
+
+bool NullRenderDevice::GetTextureSize(uint32_t textureHandle, uint32_t& width, uint32_t& height) const {
+	auto it = textureSizes_.find(textureHandle);
+	if (it == textureSizes_.end()) {
+		return false;
+	}
+	width = it->second.first;
+	height = it->second.second;
+	return true;
+}
+
+void NullRenderDevice::BeginFrame() {
+	if (inFrame_) {
+		ReportError("BeginFrame called twice");
+	}
+	inFrame_ = true;
+	++frameIndex_;
+	commandList_->Reset();
+}
+
+void NullRenderDevice::EndFrame() {
+	if (!inFrame_) {
+		ReportError("EndFrame without BeginFrame");
+	}
+	inFrame_ = false;
+	// GPUが無いので記録した時点で完了とみなす
+	completedFrameIndex_ = frameIndex_;
+
+	frameCounters_ = currentCounters_;
+	totalCounters_ += currentCounters_;
+	currentCounters_ = {};
+}
+
+void NullRenderDevice::ReportError(const std::string& message) {
+	++currentCounters_.validationErrors;
+	lastError_ = message;
+}
+
+bool NullRenderDevice::IsValidRange(uint64_t address, uint64_t size) const {
+	std::map<uint64_t, Buffer*>::const_iterator it = buffers_.upper_bound(address);
+	if (it == buffers_.begin()) {
+		return false;
+	}
+	--it;
+	return address + size <= it->first + it->second->GetSize();
+}
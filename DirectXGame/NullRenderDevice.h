@@ -0,0 +1,66 @@
+#pragma once
+#include "RenderDevice.h"
+#include <map>
+#include <utility>
+#include <vector>
+
+/// <summary>
+/// ヌル描画デバイス
+/// GPUを使わずに命令を記録・検証し、描画統計だけを数える。ヘッドレスでのCPU計測用
+/// 生成したバッファはデバイスより先に解放すること
+/// </summary>
+class NullRenderDevice : public RenderDevice {
+public:
+	NullRenderDevice();
+	~NullRenderDevice() override;
+
+	std::unique_ptr<RenderBuffer> CreateBuffer(size_t size, BufferUsage usage) override;
+	PipelineHandle CreatePipeline(const PipelineDesc& desc) override;
+	RenderCommandList* GetCommandList() override;
+	bool GetTextureSize(uint32_t textureHandle, uint32_t& width, uint32_t& height) const override;
+	void BeginFrame() override;
+	void EndFrame() override;
+	uint64_t GetFrameIndex() const override { return frameIndex_; }
+	uint64_t GetCompletedFrameIndex() const override { return completedFrameIndex_; }
+	const RenderCounters& GetFrameCounters() const override { return frameCounters_; }
+	const RenderCounters& GetTotalCounters() const override { return totalCounters_; }
+
+	// 最後に検出した不正の内容の取得
+	const std::string& GetLastError() const { return lastError_; }
+
+	// GetTextureSizeで返すテクスチャの大きさの登録(GPUが無いので呼び出し側が与える)
+	void SetTextureSize(uint32_t textureHandle, uint32_t width, uint32_t height) { textureSizes_[textureHandle] = {width, height}; }
+
+	// 生成済みのパイプライン設定の取得。無効なハンドルならnullptr
+	const PipelineDesc* GetPipelineDesc(PipelineHandle pipeline) const { return pipeline < pipelines_.size() ? &pipelines_[pipeline] : nullptr; }
+
+private:
+	class Buffer;
+	class CommandList;
+	friend class Buffer;
+	friend class CommandList;
+
+	// 不正の記録
+	void ReportError(const std::string& message);
+	// アドレス範囲がいずれかのバッファに収まっているか
+	bool IsValidRange(uint64_t address, uint64_t size) const;
+
+	// 生成済みのバッファ(GPUアドレス順)
+	std::map<uint64_t, Buffer*> buffers_;
+	// 次に割り当てるGPUアドレス
+	uint64_t nextAddress_ = 0x10000;
+	// 生成済みのパイプライン
+	std::vector<PipelineDesc> pipelines_;
+	// 登録されたテクスチャの大きさ
+	std::map<uint32_t, std::pair<uint32_t, uint32_t>> textureSizes_;
+	// コマンドリスト
+	std::unique_ptr<CommandList> commandList_;
+	// 記録中の描画統計
+	RenderCounters currentCounters_;
+	RenderCounters frameCounters_;
+	RenderCounters totalCounters_;
+	uint64_t frameIndex_ = 0;
+	uint64_t completedFrameIndex_ = 0;
+	bool inFrame_ = false;
+	std::string lastError_;
+};
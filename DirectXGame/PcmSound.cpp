@@ -0,0 +1,56 @@
+#include "PcmSound.h"
+#include "ImaAdpcm.h"
+#include <algorithm>
+#include <cstring>
+
+std::unique_ptr<AudioStreamSource> OpenSoundStream(const std::string& filePath) {
+	auto file = std::make_unique<WaveFileSource>();
+	if (!file->Open(filePath)) {
+		return nullptr;
+	}
+	const WaveFormat& format = file->GetFormat();
+	if (format.formatTag == WaveFormat::kImaAdpcm) {
+		auto decoder = std::make_unique<ImaAdpcmSource>(std::move(file));
+		return decoder->IsValid() ? std::move(decoder) : nullptr;
+	}
+	return file;
+}
+
+bool LoadPcmSound(const std::string& filePath, PcmSound& sound) {
+	std::unique_ptr<AudioStreamSource> source = OpenSoundStream(filePath);
+	if (!source) {
+		return false;
+	}
+	sound.format = source->GetFormat();
+	sound.data.clear();
+
+	// 終端まで読む。バッファは足りなくなったら倍に広げる
+	size_t size = 0;
+	sound.data.resize(64 * 1024);
+	while (true) {
+		if (sound.data.size() - size < sound.format.blockAlign * 1024u) {
+			sound.data.resize(sound.data.size() * 2);
+		}
+		size_t read = source->Read(sound.data.data() + size, sound.data.size() - size);
+		if (read == 0) {
+			break;
+		}
+		size += read;
+	}
+	sound.data.resize(size);
+	sound.data.shrink_to_fit();
+	return true;
+}
+
+size_t PcmMemorySource::Read(uint8_t* dst, size_t size) {
+	size = (std::min)(size, sound_->data.size() - position_);
+	size -= size % sound_->format.blockAlign;
+	std::memcpy(dst, sound_->data.data() + position_, size);
+	position_ += size;
+	return size;
+}
+
+bool PcmMemorySource::Rewind() {
+	position_ = 0;
+	return true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "AudioStreamSource.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// メモリ上のリニアPCM音声(短い効果音向け)
+/// </summary>
+struct PcmSound {
+	WaveFormat format;
+	std::vector<uint8_t> data;
+};
+
+/// <summary>
+/// 音声ファイルを開いてリニアPCMを返す音源を作る。IMA-ADPCMは読みながらデコードする
+/// </summary>
+/// <param name="filePath">WAVファイルのパス</param>
+/// <returns>音源。開けなければnullptr</returns>
+std::unique_ptr<AudioStreamSource> OpenSoundStream(const std::string& filePath);
+
+/// <summary>
+/// 音声ファイルを読み込んでリニアPCMにする。IMA-ADPCMは読み込み時にデコードする
+/// </summary>
+/// <param name="filePath">WAVファイルのパス</param>
+/// <param name="sound">出力先</param>
+/// <returns>成否</returns>
+bool LoadPcmSound(const std::string& filePath, PcmSound& sound);
+
+/// <summary>
+/// メモリ上のPCMを読み出す音源。同じ音声を複数の再生で共有できる
+/// </summary>
+class PcmMemorySource : public AudioStreamSource {
+public:
+	explicit PcmMemorySource(std::shared_ptr<const PcmSound> sound) : sound_(std::move(sound)) {}
+
+	const WaveFormat& GetFormat() const override { return sound_->format; }
+	size_t Read(uint8_t* dst, size_t size) override;
+	bool Rewind() override;
+
+private:
+	std::shared_ptr<const PcmSound> sound_;
+	size_t position_ = 0;
+};
@@ -0,0 +1,197 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+
+#ifdef USE_IMGUI
+#include <imgui.h>
+#endif
+
+namespace {
+
+// 計測の基準時刻
+const std::chrono::steady_clock::time_point kEpoch = std::chrono::steady_clock::now();
+
+// 呼び出しスレッドの入れ子の深さ
+thread_local uint32_t tDepth = 0;
+
+// JSON文字列として出力できるようにエスケープする
+std::string EscapeJson(const char* text) {
+	std::string result;
+	for (const char* c = text; *c != '\0'; ++c) {
+		if (*c == '"' || *c == '\\') {
+			result.push_back('\\');
+		}
+		result.push_back(*c);
+	}
+	return result;
+}
+
+} // namespace
+
+/// <summary>
+/// 呼び出しスレッドのリングバッファ
+/// スレッドの終了時に破棄されるので、そこでバッファを終了済みにしてBeginFrameに回収させる
+/// </summary>
+struct ThreadBufferOwner {
+	Profiler::ThreadBuffer* buffer = nullptr;
+
+	~ThreadBufferOwner() {
+		if (buffer != nullptr) {
+			buffer->retired.store(true, std::memory_order_release);
+		}
+	}
+};
+
+namespace {
+thread_local ThreadBufferOwner tThreadBuffer;
+} // namespace
+
+Profiler* Profiler::GetInstance() {
+	static Profiler instance;
+	return &instance;
+}
+
+Profiler::Profiler() {
+	static const char kDefaultExportPath[] = "profile_trace.json";
+	std::copy(std::begin(kDefaultExportPath), std::end(kDefaultExportPath), exportPath_.begin());
+	current_.begin = Now();
+}
+
+int64_t Profiler::Now() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - kEpoch).count(); }
+
+Profiler::ThreadBuffer* Profiler::GetThreadBuffer() {
+	if (tThreadBuffer.buffer == nullptr) {
+		std::lock_guard<std::mutex> lock(registryMutex_);
+		std::unique_ptr<ThreadBuffer> buffer = std::make_unique<ThreadBuffer>();
+		buffer->threadId = nextThreadId_++;
+		tThreadBuffer.buffer = buffer.get();
+		threadBuffers_.push_back(std::move(buffer));
+	}
+	return tThreadBuffer.buffer;
+}
+
+size_t Profiler::GetThreadBufferCount() {
+	std::lock_guard<std::mutex> lock(registryMutex_);
+	return threadBuffers_.size();
+}
+
+void Profiler::RecordZone(const char* name, int64_t begin, int64_t end, uint32_t depth) {
+	ThreadBuffer* buffer = GetThreadBuffer();
+	uint64_t head = buffer->head.load(std::memory_order_relaxed);
+	Slot& slot = buffer->ring[head & (kRingSize - 1)];
+	slot.sequence.store(head * 2 + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.name.store(name, std::memory_order_relaxed);
+	slot.begin.store(begin, std::memory_order_relaxed);
+	slot.end.store(end, std::memory_order_relaxed);
+	slot.depth.store(depth, std::memory_order_relaxed);
+	slot.sequence.store(head * 2 + 2, std::memory_order_release);
+	buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::RecordGpuZone(const char* name, int64_t begin, int64_t end, uint32_t depth) { current_.zones.push_back({name, begin, end, kGpuThreadId, depth}); }
+
+void Profiler::BeginFrame() {
+	int64_t now = Now();
+	current_.end = now;
+
+	{
+		std::lock_guard<std::mutex> lock(registryMutex_);
+		for (std::unique_ptr<ThreadBuffer>& buffer : threadBuffers_) {
+			// 終了の印を先に読む。終了済みなら最後の書き込みまで見えているので、回収し終えたら破棄できる
+			bool retired = buffer->retired.load(std::memory_order_acquire);
+			uint64_t head = buffer->head.load(std::memory_order_acquire);
+			// 回収が間に合わず上書きされた分は捨てる
+			if (head - buffer->tail > kRingSize) {
+				droppedZoneCount_ += head - buffer->tail - kRingSize;
+				buffer->tail = head - kRingSize;
+			}
+			for (; buffer->tail < head; ++buffer->tail) {
+				// 読んでいる間に上書きされた要素(番号が前後で変わったもの)は捨てる
+				const Slot& slot = buffer->ring[buffer->tail & (kRingSize - 1)];
+				uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+				Zone zone{slot.name.load(std::memory_order_relaxed), slot.begin.load(std::memory_order_relaxed), slot.end.load(std::memory_order_relaxed), buffer->threadId,
+				          slot.depth.load(std::memory_order_relaxed)};
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (sequence != buffer->tail * 2 + 2 || slot.sequence.load(std::memory_order_relaxed) != sequence) {
+					++droppedZoneCount_;
+					continue;
+				}
+				current_.zones.push_back(zone);
+			}
+			if (retired) {
+				buffer.reset();
+			}
+		}
+		std::erase(threadBuffers_, nullptr);
+	}
+	std::sort(current_.zones.begin(), current_.zones.end(), [](const Zone& a, const Zone& b) { return a.threadId != b.threadId ? a.threadId < b.threadId : a.begin < b.begin; });
+
+	history_.push_back(std::move(current_));
+	if (history_.size() > kHistoryFrames) {
+		history_.pop_front();
+	}
+	current_ = Frame{};
+	current_.index = history_.back().index + 1;
+	current_.begin = now;
+}
+
+bool Profiler::ExportChromeTrace(const std::string& filePath) const {
+	std::ofstream file(filePath);
+	if (!file) {
+		return false;
+	}
+
+	// 時刻はマイクロ秒単位で出力する
+	file << "{\"traceEvents\":[\n";
+	bool first = true;
+	for (const Frame& frame : history_) {
+		for (const Zone& zone : frame.zones) {
+			file << (first ? "" : ",\n") << "{\"name\":\"" << EscapeJson(zone.name) << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << zone.threadId << ",\"ts\":" << static_cast<double>(zone.begin) / 1000.0
+			     << ",\"dur\":" << static_cast<double>(zone.end - zone.begin) / 1000.0 << "}";
+			first = false;
+		}
+		// フレーム境界をインスタントイベントとして出力
+		file << (first ? "" : ",\n") << "{\"name\":\"Frame " << frame.index << "\",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":0,\"ts\":" << static_cast<double>(frame.begin) / 1000.0 << "}";
+		first = false;
+	}
+	file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	return static_cast<bool>(file);
+}
+
+void Profiler::DrawImGui() {
+#ifdef USE_IMGUI
+	const Frame* frame = GetLastFrame();
+	ImGui::Begin("Profiler");
+	if (frame) {
+		ImGui::Text("Frame %llu : %.3f ms", static_cast<unsigned long long>(frame->index), static_cast<double>(frame->end - frame->begin) / 1.0e6);
+		ImGui::Text("Dropped zones : %llu", static_cast<unsigned long long>(droppedZoneCount_));
+		ImGui::Separator();
+		for (const Zone& zone : frame->zones) {
+			char track[16];
+			if (zone.threadId == kGpuThreadId) {
+				snprintf(track, sizeof(track), "GPU");
+			} else {
+				snprintf(track, sizeof(track), "%u", zone.threadId);
+			}
+			ImGui::Text("[%s] %*s%s  %.3f ms", track, static_cast<int>(zone.depth * 2), "", zone.name, static_cast<double>(zone.end - zone.begin) / 1.0e6);
+		}
+	}
+	ImGui::Separator();
+	ImGui::InputText("File", exportPath_.data(), exportPath_.size());
+	if (ImGui::Button("Export Chrome Trace")) {
+		ExportChromeTrace(exportPath_.data());
+	}
+	ImGui::End();
+#endif
+}
+
+ProfileScope::ProfileScope(const char* name) : name_(name), begin_(Profiler::Now()), depth_(tDepth++) {}
+
+ProfileScope::~ProfileScope() {
+	--tDepth;
+	Profiler::GetInstance()->RecordZone(name_, begin_, Profiler::Now(), depth_);
+}
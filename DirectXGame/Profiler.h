@@ -0,0 +1,202 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// CPUフレームプロファイラ
+/// スコープ単位の計測区間(ゾーン)をスレッド毎のリングバッファに記録し、
+/// フレーム境界で回収してImGui表示やChromeトレース形式での出力に使う
+/// </summary>
+class Profiler {
+public:
+	// スレッド毎のリングバッファの要素数(2の累乗)
+	static const uint32_t kRingSize = 4096;
+	// 保持するフレーム履歴の数
+	static const uint32_t kHistoryFrames = 300;
+	// GPU区間に割り当てるスレッド番号
+	static const uint32_t kGpuThreadId = 1000;
+
+	/// <summary>
+	/// 計測区間
+	/// </summary>
+	struct Zone {
+		// 区間名(文字列リテラルを想定)
+		const char* name = nullptr;
+		// 開始時刻(ナノ秒)
+		int64_t begin = 0;
+		// 終了時刻(ナノ秒)
+		int64_t end = 0;
+		// 記録したスレッドの番号
+		uint32_t threadId = 0;
+		// 入れ子の深さ
+		uint32_t depth = 0;
+	};
+
+	/// <summary>
+	/// 1フレーム分の計測結果
+	/// </summary>
+	struct Frame {
+		// フレーム番号
+		uint64_t index = 0;
+		// 開始時刻(ナノ秒)
+		int64_t begin = 0;
+		// 終了時刻(ナノ秒)
+		int64_t end = 0;
+		// 計測区間
+		std::vector<Zone> zones;
+	};
+
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static Profiler* GetInstance();
+
+	/// <summary>
+	/// 現在時刻の取得
+	/// </summary>
+	/// <returns>プロファイラ起動時からの経過時間(ナノ秒)</returns>
+	static int64_t Now();
+
+	/// <summary>
+	/// フレーム境界。前フレームのゾーンを全スレッドから回収する
+	/// </summary>
+	void BeginFrame();
+
+	/// <summary>
+	/// 計測区間の記録(呼び出したスレッドのリングバッファに積む)
+	/// </summary>
+	/// <param name="name">区間名</param>
+	/// <param name="begin">開始時刻</param>
+	/// <param name="end">終了時刻</param>
+	/// <param name="depth">入れ子の深さ</param>
+	void RecordZone(const char* name, int64_t begin, int64_t end, uint32_t depth);
+
+	/// <summary>
+	/// GPU区間の記録(BeginFrameと同じスレッドから呼ぶ)
+	/// 結果は数フレーム遅れて届くので、受け取ったフレームのGPUトラックとして積む
+	/// </summary>
+	/// <param name="name">区間名</param>
+	/// <param name="begin">開始時刻</param>
+	/// <param name="end">終了時刻</param>
+	/// <param name="depth">入れ子の深さ</param>
+	void RecordGpuZone(const char* name, int64_t begin, int64_t end, uint32_t depth);
+
+	/// <summary>
+	/// 直近に完了したフレームの取得
+	/// </summary>
+	/// <returns>計測結果。まだ無ければnullptr</returns>
+	const Frame* GetLastFrame() const { return history_.empty() ? nullptr : &history_.back(); }
+
+	// リングバッファ溢れで失われたゾーン数の取得
+	uint64_t GetDroppedZoneCount() const { return droppedZoneCount_; }
+
+	// 登録中のリングバッファの数の取得(終了したスレッドの分は回収し終えたBeginFrameで減る)
+	size_t GetThreadBufferCount();
+
+	/// <summary>
+	/// 保持しているフレーム履歴をChromeトレース形式(JSON)で書き出す
+	/// </summary>
+	/// <param name="filePath">出力先</param>
+	/// <returns>成否</returns>
+	bool ExportChromeTrace(const std::string& filePath) const;
+
+	/// <summary>
+	/// ImGuiでの計測結果表示
+	/// </summary>
+	void DrawImGui();
+
+private:
+	/// <summary>
+	/// リングバッファの要素
+	/// 回収中に所有スレッドが一周して上書きすることがあるので、書き込み番号で読み取りの途中の上書きを検出する(seqlock)
+	/// </summary>
+	struct Slot {
+		// 書き込み中は2*番号+1、書き終えたら2*番号+2
+		std::atomic<uint64_t> sequence = 0;
+		std::atomic<const char*> name = nullptr;
+		std::atomic<int64_t> begin = 0;
+		std::atomic<int64_t> end = 0;
+		std::atomic<uint32_t> depth = 0;
+	};
+
+	/// <summary>
+	/// スレッド毎のリングバッファ
+	/// 書き込みは所有スレッドのみ、読み出しはBeginFrameを呼ぶスレッドのみ
+	/// </summary>
+	struct ThreadBuffer {
+		std::array<Slot, kRingSize> ring;
+		// 書き込み済みの総数
+		std::atomic<uint64_t> head = 0;
+		// 回収済みの総数
+		uint64_t tail = 0;
+		// スレッド番号
+		uint32_t threadId = 0;
+		// 所有スレッドが終了したか(以降は書き込まれないので、回収し終えたら破棄する)
+		std::atomic<bool> retired = false;
+	};
+
+	// スレッド終了時にリングバッファを手放す
+	friend struct ThreadBufferOwner;
+
+	Profiler();
+	~Profiler() = default;
+	Profiler(const Profiler&) = delete;
+	const Profiler& operator=(const Profiler&) = delete;
+
+	/// <summary>
+	/// 呼び出しスレッドのリングバッファを取得(初回のみ登録する)
+	/// </summary>
+	ThreadBuffer* GetThreadBuffer();
+
+	// 登録済みのリングバッファ
+	std::vector<std::unique_ptr<ThreadBuffer>> threadBuffers_;
+	// 次に割り当てるスレッド番号(破棄したバッファの番号は使い回さない)
+	uint32_t nextThreadId_ = 0;
+	// 登録用の排他制御
+	std::mutex registryMutex_;
+	// フレーム履歴
+	std::deque<Frame> history_;
+	// 計測中のフレーム
+	Frame current_;
+	// 失われたゾーン数
+	uint64_t droppedZoneCount_ = 0;
+	// 出力ファイル名(ImGui入力用)
+	std::array<char, 128> exportPath_{};
+};
+
+/// <summary>
+/// スコープの開始から終了までをゾーンとして記録する
+/// </summary>
+class ProfileScope {
+public:
+	explicit ProfileScope(const char* name);
+	~ProfileScope();
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+	// 区間名
+	const char* name_;
+	// 開始時刻
+	int64_t begin_;
+	// 入れ子の深さ
+	uint32_t depth_;
+};
+
+// プロファイラのマクロ。USE_PROFILERが未定義のビルドでは消える
+#define PROFILER_CONCAT_INNER(a, b) a##b
+#define PROFILER_CONCAT(a, b)       PROFILER_CONCAT_INNER(a, b)
+#ifdef USE_PROFILER
+#define PROFILE_SCOPE(name)  ProfileScope PROFILER_CONCAT(profileScope_, __LINE__)(name)
+#define PROFILE_FRAME()      Profiler::GetInstance()->BeginFrame()
+#else
+#define PROFILE_SCOPE(name)  ((void)0)
+#define PROFILE_FRAME()      ((void)0)
+#endif
@@ -0,0 +1,228 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/// <summary>
+/// バッファの用途
+/// </summary>
+enum class BufferUsage {
+	kUpload,  //!< CPUから書き込む(常時マップ)
+	kDefault, //!< GPU専用。コピーで転送する
+};
+
+/// <summary>
+/// 頂点レイアウト
+/// </summary>
+enum class InputLayout {
+	kNone,         //!< 頂点バッファを使わない(SV_VertexIDから生成)
+	kPosUvColor,   //!< float3 POSITION, float2 TEXCOORD, float4 COLOR
+};
+
+/// <summary>
+/// ブレンドモード(Sprite::BlendModeと同じ並び)
+/// </summary>
+enum class RenderBlendMode {
+	kNone,
+	kNormal,
+	kAdd,
+	kSubtract,
+	kMultiply,
+	kScreen,
+	kExclusion,
+
+	kCount,
+};
+
+/// <summary>
+/// パイプライン生成設定
+/// ルートシグネチャは共通で [0]定数バッファ(b0) [1]テクスチャ(t0) [2]構造化バッファ(t1)
+/// </summary>
+struct PipelineDesc {
+	// 頂点シェーダのファイル名
+	std::wstring vertexShader;
+	// ピクセルシェーダのファイル名
+	std::wstring pixelShader;
+	// 頂点レイアウト
+	InputLayout inputLayout = InputLayout::kPosUvColor;
+	// ブレンドモード
+	RenderBlendMode blendMode = RenderBlendMode::kNormal;
+	// sRGBのレンダーターゲットに描くならtrue
+	bool sRGB = true;
+};
+
+// パイプラインのハンドル
+using PipelineHandle = uint32_t;
+// 無効なパイプラインのハンドル
+const PipelineHandle kInvalidPipeline = UINT32_MAX;
+
+/// <summary>
+/// 頂点バッファビュー
+/// </summary>
+struct VertexBufferView {
+	uint64_t address = 0;
+	uint32_t size = 0;
+	uint32_t stride = 0;
+};
+
+/// <summary>
+/// インデックスバッファビュー(16bit)
+/// </summary>
+struct IndexBufferView {
+	uint64_t address = 0;
+	uint32_t size = 0;
+};
+
+/// <summary>
+/// 描画統計
+/// </summary>
+struct RenderCounters {
+	uint64_t drawCalls = 0;
+	uint64_t vertices = 0;
+	uint64_t instances = 0;
+	uint64_t pipelineChanges = 0;
+	uint64_t textureChanges = 0;
+	uint64_t bufferBindings = 0;
+	// CPUからバッファに書き込んだバイト数
+	uint64_t bytesWritten = 0;
+	// GPU上でコピーしたバイト数
+	uint64_t bytesCopied = 0;
+	// 生成したバッファの総バイト数
+	uint64_t bytesAllocated = 0;
+	// 不正な状態での命令数
+	uint64_t validationErrors = 0;
+
+	RenderCounters& operator+=(const RenderCounters& other) {
+		drawCalls += other.drawCalls;
+		vertices += other.vertices;
+		instances += other.instances;
+		pipelineChanges += other.pipelineChanges;
+		textureChanges += other.textureChanges;
+		bufferBindings += other.bufferBindings;
+		bytesWritten += other.bytesWritten;
+		bytesCopied += other.bytesCopied;
+		bytesAllocated += other.bytesAllocated;
+		validationErrors += other.validationErrors;
+		return *this;
+	}
+};
+
+/// <summary>
+/// GPUバッファ
+/// </summary>
+class RenderBuffer {
+public:
+	virtual ~RenderBuffer() = default;
+
+	/// <summary>
+	/// CPUからの書き込み(kUploadのみ)
+	/// </summary>
+	/// <param name="offset">書き込み位置</param>
+	/// <param name="data">データ</param>
+	/// <param name="size">バイト数</param>
+	virtual void Write(size_t offset, const void* data, size_t size) = 0;
+
+	/// <summary>
+	/// マップ済みアドレスの取得(kUploadのみ)。直接書いた分はNotifyWrittenで申告する
+	/// </summary>
+	virtual void* GetMappedAddress() = 0;
+
+	/// <summary>
+	/// マップ済みアドレスに直接書き込んだバイト数を申告する
+	/// </summary>
+	virtual void NotifyWritten(size_t size) = 0;
+
+	// GPU仮想アドレスの取得
+	virtual uint64_t GetGpuAddress() const = 0;
+	// バイト数の取得
+	virtual size_t GetSize() const = 0;
+	// 用途の取得
+	virtual BufferUsage GetUsage() const = 0;
+};
+
+/// <summary>
+/// バッファ間のコピー1件
+/// </summary>
+struct BufferCopy {
+	RenderBuffer* dst = nullptr;
+	size_t dstOffset = 0;
+	RenderBuffer* src = nullptr;
+	size_t srcOffset = 0;
+	size_t size = 0;
+};
+
+/// <summary>
+/// 描画コマンドリスト
+/// </summary>
+class RenderCommandList {
+public:
+	virtual ~RenderCommandList() = default;
+
+	// パイプラインとルートシグネチャを設定する。ルート引数(定数バッファ、テクスチャ、構造化バッファ)はこの後に設定し直すこと
+	virtual void SetPipeline(PipelineHandle pipeline) = 0;
+	virtual void SetVertexBuffer(const VertexBufferView& view) = 0;
+	virtual void SetIndexBuffer(const IndexBufferView& view) = 0;
+	// ルートパラメータ0番に定数バッファを設定
+	virtual void SetConstantBuffer(uint64_t address) = 0;
+	// ルートパラメータ1番にTextureManagerのテクスチャを設定
+	virtual void SetTexture(uint32_t textureHandle) = 0;
+	// ルートパラメータ2番に構造化バッファを設定
+	virtual void SetStructuredBuffer(uint64_t address) = 0;
+	virtual void DrawInstanced(uint32_t vertexCountPerInstance, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance) = 0;
+	virtual void DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance) = 0;
+	virtual void CopyBuffer(RenderBuffer* dst, size_t dstOffset, RenderBuffer* src, size_t srcOffset, size_t size) = 0;
+	// まとめてコピーし、読み取り状態への遷移はコピー先ごとに1回にする
+	virtual void CopyBuffers(const BufferCopy* copies, size_t count) = 0;
+};
+
+/// <summary>
+/// 描画デバイス
+/// D3D12の実装とヘッドレス計測用のヌル実装を差し替えられるようにする
+/// </summary>
+class RenderDevice {
+public:
+	virtual ~RenderDevice() = default;
+
+	/// <summary>
+	/// バッファの生成
+	/// </summary>
+	/// <param name="size">バイト数</param>
+	/// <param name="usage">用途</param>
+	/// <returns>バッファ。失敗時はnullptr</returns>
+	virtual std::unique_ptr<RenderBuffer> CreateBuffer(size_t size, BufferUsage usage) = 0;
+
+	/// <summary>
+	/// パイプラインの生成
+	/// </summary>
+	/// <param name="desc">生成設定</param>
+	/// <returns>ハンドル。失敗時はkInvalidPipeline</returns>
+	virtual PipelineHandle CreatePipeline(const PipelineDesc& desc) = 0;
+
+	// 現在のフレームの描画コマンドリストの取得
+	virtual RenderCommandList* GetCommandList() = 0;
+
+	/// <summary>
+	/// テクスチャの大きさの取得
+	/// </summary>
+	/// <param name="textureHandle">TextureManagerのテクスチャハンドル</param>
+	/// <param name="width">幅の出力先</param>
+	/// <param name="height">高さの出力先</param>
+	/// <returns>成否。大きさが分からなければfalse</returns>
+	virtual bool GetTextureSize(uint32_t textureHandle, uint32_t& width, uint32_t& height) const = 0;
+
+	// フレーム開始(DirectXCommon::PreDrawの後)
+	virtual void BeginFrame() = 0;
+	// フレーム終了(DirectXCommon::PostDrawの前)
+	virtual void EndFrame() = 0;
+
+	// フレーム番号の取得
+	virtual uint64_t GetFrameIndex() const = 0;
+	// GPUで完了済みのフレーム番号の取得。1フレーム目が完了するまでは0
+	virtual uint64_t GetCompletedFrameIndex() const = 0;
+
+	// 直近に完了したフレームの描画統計の取得
+	virtual const RenderCounters& GetFrameCounters() const = 0;
+	// 累計の描画統計の取得
+	virtual const RenderCounters& GetTotalCounters() const = 0;
+};
@@ -0,0 +1,12 @@
+#pragma pack_matrix(row_major)
+
+cbuffer cbuff0 : register(b0) {
+	matrix mat; // 射影行列(頂点は画面座標で渡す)
+};
+
+// 頂点シェーダーからピクセルシェーダーへのやり取りに使用する構造体
+struct VSOutput {
+	float4 svpos : SV_POSITION; // システム用頂点座標
+	float2 uv : TEXCOORD;       // uv値
+	float4 color : COLOR;       // 色(RGBA)
+};
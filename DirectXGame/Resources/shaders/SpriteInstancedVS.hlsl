@@ -0,0 +1,38 @@
+#include "SpriteBatch.hlsli"
+
+// スプライト1枚分のインスタンス(SpriteBatch::Instanceと同じ並び)
+struct SpriteInstance {
+	float2 position;
+	float2 size;
+	float2 anchorPoint;
+	float rotation;
+	uint flags;  // bit0: 左右反転、bit1: 上下反転
+	uint2 uvRect; // 左、上、右、下を16bitずつ正規化した値
+	uint2 color;  // RGBAを16bitずつ半精度で詰めた値
+};
+
+StructuredBuffer<SpriteInstance> instances : register(t1); // 1番スロットに設定された構造化バッファ
+
+// 三角形2枚分の角の番号(0: 左下、1: 左上、2: 右下、3: 右上)
+static const uint kQuadCorners[6] = {0, 1, 2, 2, 1, 3};
+
+VSOutput main(uint vertexId : SV_VertexID, uint instanceId : SV_InstanceID) {
+	SpriteInstance instance = instances[instanceId];
+	uint corner = kQuadCorners[vertexId];
+	float2 side = float2(corner >= 2 ? 1.0f : 0.0f, (corner & 1) ? 0.0f : 1.0f);
+
+	// アンカーポイントを原点とした角。反転は原点を挟んで入れ替える(Spriteと同じ)
+	float2 local = (side - instance.anchorPoint) * instance.size;
+	local *= float2((instance.flags & 1) ? -1.0f : 1.0f, (instance.flags & 2) ? -1.0f : 1.0f);
+	float s = sin(instance.rotation);
+	float c = cos(instance.rotation);
+	float2 position = instance.position + float2(local.x * c - local.y * s, local.x * s + local.y * c);
+
+	float4 uvRect = float4(instance.uvRect.x & 0xFFFF, instance.uvRect.x >> 16, instance.uvRect.y & 0xFFFF, instance.uvRect.y >> 16) / 65535.0f;
+
+	VSOutput output; // ピクセルシェーダーに渡す値
+	output.svpos = mul(float4(position, 0.0f, 1.0f), mat);
+	output.uv = float2(side.x > 0.0f ? uvRect.z : uvRect.x, side.y > 0.0f ? uvRect.w : uvRect.y);
+	output.color = float4(f16tof32(instance.color.x), f16tof32(instance.color.x >> 16), f16tof32(instance.color.y), f16tof32(instance.color.y >> 16));
+	return output;
+}
\ No newline at end of file
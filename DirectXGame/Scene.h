@@ -0,0 +1,28 @@
+#pragma once
+
+class RenderDevice;
+
+/// <summary>
+/// シーン
+/// エンジンに依存しない入口。描画はRenderDeviceを通すので、D3D12でもヌル描画デバイスでも回せる
+/// </summary>
+class Scene {
+public:
+	virtual ~Scene() = default;
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="renderDevice">描画デバイス(シーンより長く生きること)</param>
+	virtual void Initialize(RenderDevice* renderDevice) = 0;
+
+	/// <summary>
+	/// 更新(固定周期で呼ばれる)
+	/// </summary>
+	virtual void Update() = 0;
+
+	/// <summary>
+	/// 描画(RenderDevice::BeginFrameとEndFrameの間で呼ばれる)
+	/// </summary>
+	virtual void Draw() = 0;
+};
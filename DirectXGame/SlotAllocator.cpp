@@ -0,0 +1,129 @@
+#include "SlotAllocator.h"
+#include <algorithm>
+#include <bit>
+
+namespace {
+
+// 指定ビット数の下位マスク
+uint64_t LowMask(uint32_t bitCount) { return bitCount >= 64 ? ~0ull : (1ull << bitCount) - 1; }
+
+} // namespace
+
+SlotAllocator::SlotAllocator(uint32_t slotsPerPage, uint32_t maxPages) : slotsPerPage_((std::min)((std::max)(slotsPerPage, 1u), kSlotsPerPage)), maxPages_(maxPages) {}
+
+bool SlotAllocator::AddPage() {
+	if (maxPages_ != 0 && pages_.size() >= maxPages_) {
+		return false;
+	}
+	Page page;
+	page.words.fill(0);
+	page.fullWords = 0;
+
+	// ページのスロット数を超える部分は最初から使用中にしておく
+	uint32_t usedWords = (slotsPerPage_ + kBitsPerWord - 1) / kBitsPerWord;
+	uint32_t tailBits = slotsPerPage_ % kBitsPerWord;
+	if (tailBits != 0) {
+		page.words[usedWords - 1] = ~LowMask(tailBits);
+	}
+	for (uint32_t i = usedWords; i < kBitsPerWord; ++i) {
+		page.words[i] = ~0ull;
+		page.fullWords |= 1ull << i;
+	}
+
+	uint32_t pageIndex = static_cast<uint32_t>(pages_.size());
+	pages_.push_back(page);
+	if (pageIndex / kBitsPerWord >= fullPages_.size()) {
+		fullPages_.push_back(0);
+	}
+	return true;
+}
+
+void SlotAllocator::MarkUsed(uint32_t pageIndex, uint32_t wordIndex, uint32_t bitIndex) {
+	Page& page = pages_[pageIndex];
+	page.words[wordIndex] |= 1ull << bitIndex;
+	if (page.words[wordIndex] == ~0ull) {
+		page.fullWords |= 1ull << wordIndex;
+		if (page.fullWords == ~0ull) {
+			fullPages_[pageIndex / kBitsPerWord] |= 1ull << (pageIndex % kBitsPerWord);
+		}
+	}
+	++usedCount_;
+}
+
+uint32_t SlotAllocator::Allocate() {
+	// 満杯でないページを探す
+	uint32_t pageIndex = kInvalidSlot;
+	for (size_t i = 0; i < fullPages_.size(); ++i) {
+		uint64_t freePages = ~fullPages_[i];
+		if (i == fullPages_.size() - 1) {
+			freePages &= LowMask(static_cast<uint32_t>(pages_.size() - i * kBitsPerWord));
+		}
+		if (freePages != 0) {
+			pageIndex = static_cast<uint32_t>(i * kBitsPerWord + std::countr_zero(freePages));
+			break;
+		}
+	}
+	if (pageIndex == kInvalidSlot) {
+		if (!AddPage()) {
+			return kInvalidSlot;
+		}
+		pageIndex = static_cast<uint32_t>(pages_.size() - 1);
+	}
+
+	Page& page = pages_[pageIndex];
+	uint32_t wordIndex = static_cast<uint32_t>(std::countr_zero(~page.fullWords));
+	uint32_t bitIndex = static_cast<uint32_t>(std::countr_zero(~page.words[wordIndex]));
+	MarkUsed(pageIndex, wordIndex, bitIndex);
+	return pageIndex * slotsPerPage_ + wordIndex * kBitsPerWord + bitIndex;
+}
+
+bool SlotAllocator::Free(uint32_t slot) {
+	// 使用中でない番号を解放すると使用数と満杯の要約が狂うので、ここで弾く
+	if (!Test(slot)) {
+		return false;
+	}
+	uint32_t pageIndex = slot / slotsPerPage_;
+	uint32_t localIndex = slot % slotsPerPage_;
+	Page& page = pages_[pageIndex];
+	uint32_t wordIndex = localIndex / kBitsPerWord;
+	uint64_t bit = 1ull << (localIndex % kBitsPerWord);
+	page.words[wordIndex] &= ~bit;
+	page.fullWords &= ~(1ull << wordIndex);
+	fullPages_[pageIndex / kBitsPerWord] &= ~(1ull << (pageIndex % kBitsPerWord));
+	--usedCount_;
+	return true;
+}
+
+bool SlotAllocator::Reserve(uint32_t slot) {
+	uint32_t pageIndex = slot / slotsPerPage_;
+	while (pageIndex >= pages_.size()) {
+		if (!AddPage()) {
+			return false;
+		}
+	}
+	if (Test(slot)) {
+		return false;
+	}
+	uint32_t localIndex = slot % slotsPerPage_;
+	MarkUsed(pageIndex, localIndex / kBitsPerWord, localIndex % kBitsPerWord);
+	return true;
+}
+
+bool SlotAllocator::Test(uint32_t slot) const {
+	uint32_t pageIndex = slot / slotsPerPage_;
+	if (pageIndex >= pages_.size()) {
+		return false;
+	}
+	uint32_t localIndex = slot % slotsPerPage_;
+	return (pages_[pageIndex].words[localIndex / kBitsPerWord] >> (localIndex % kBitsPerWord)) & 1;
+}
+
+void SlotAllocator::Reset() {
+	uint32_t pageCount = GetPageCount();
+	pages_.clear();
+	fullPages_.clear();
+	usedCount_ = 0;
+	for (uint32_t i = 0; i < pageCount; ++i) {
+		AddPage();
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// 2段ビットマップによるスロット割り当て
+/// 使用中フラグのワードと「満杯のワード」を示す要約ワードをビット走査するので、
+/// 割り当てと解放はスロット数によらず定数時間。ページを足すことで上限を超えて拡張できる
+/// </summary>
+class SlotAllocator {
+public:
+	// 1ワードのビット数
+	static constexpr uint32_t kBitsPerWord = 64;
+	// 1ページのスロット数(要約ワード1つで管理できる数)
+	static constexpr uint32_t kSlotsPerPage = kBitsPerWord * kBitsPerWord;
+	// 割り当て失敗
+	static constexpr uint32_t kInvalidSlot = UINT32_MAX;
+
+	/// <summary>
+	/// コンストラクタ
+	/// </summary>
+	/// <param name="slotsPerPage">1ページのスロット数(kSlotsPerPage以下)</param>
+	/// <param name="maxPages">ページ数の上限。0なら無制限</param>
+	explicit SlotAllocator(uint32_t slotsPerPage = kSlotsPerPage, uint32_t maxPages = 0);
+
+	/// <summary>
+	/// 空きスロットの割り当て。空きが無ければページを追加する
+	/// </summary>
+	/// <returns>スロット番号(ページ番号 * ページのスロット数 + ページ内番号)。失敗時はkInvalidSlot</returns>
+	uint32_t Allocate();
+
+	/// <summary>
+	/// スロットの解放
+	/// </summary>
+	/// <param name="slot">スロット番号</param>
+	/// <returns>使用中だったか(割り当てていない番号や二重解放では何もせずfalse)</returns>
+	bool Free(uint32_t slot);
+
+	/// <summary>
+	/// 指定したスロットを使用中にする(固定番号の予約用)
+	/// </summary>
+	/// <param name="slot">スロット番号</param>
+	/// <returns>空いていればtrue</returns>
+	bool Reserve(uint32_t slot);
+
+	// 使用中か
+	bool Test(uint32_t slot) const;
+
+	// 全スロットの解放(ページは残す)
+	void Reset();
+
+	// 1ページのスロット数の取得
+	uint32_t GetSlotsPerPage() const { return slotsPerPage_; }
+	// ページ数の取得
+	uint32_t GetPageCount() const { return static_cast<uint32_t>(pages_.size()); }
+	// 使用中のスロット数の取得
+	uint32_t GetUsedCount() const { return usedCount_; }
+	// 割り当て可能な総スロット数の取得
+	uint32_t GetCapacity() const { return GetPageCount() * slotsPerPage_; }
+
+private:
+	/// <summary>
+	/// ページ
+	/// </summary>
+	struct Page {
+		// スロットの使用中フラグ(1が使用中)
+		std::array<uint64_t, kBitsPerWord> words;
+		// 満杯のワードのフラグ(1が満杯)
+		uint64_t fullWords;
+	};
+
+	// ページの追加
+	bool AddPage();
+	// ページ内の使用中フラグを立て、満杯になったら要約を更新する
+	void MarkUsed(uint32_t pageIndex, uint32_t wordIndex, uint32_t bitIndex);
+
+	uint32_t slotsPerPage_;
+	uint32_t maxPages_;
+	std::vector<Page> pages_;
+	// 満杯のページのフラグ(1が満杯)
+	std::vector<uint64_t> fullPages_;
+	uint32_t usedCount_ = 0;
+};
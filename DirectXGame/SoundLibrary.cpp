@@ -0,0 +1,231 @@
+#include "SoundLibrary.h"
+#include <algorithm>
+
+namespace {
+
+// ハンドルは下位16bitが枠の番号、上位16bitが世代
+uint32_t MakeHandle(uint32_t index, uint16_t generation) { return static_cast<uint32_t>(generation) << 16 | index; }
+
+// 音声が使うメモリ量
+size_t CalculateMemorySize(const MixerSound& sound) { return sizeof(MixerSound) + sound.samples.capacity() * sizeof(float); }
+
+} // namespace
+
+SoundLibrary* SoundLibrary::GetInstance() {
+	static SoundLibrary instance;
+	return &instance;
+}
+
+void SoundLibrary::Initialize(const std::string& directoryPath) {
+	Finalize();
+	std::lock_guard<std::mutex> lock(mutex_);
+	directoryPath_ = directoryPath;
+}
+
+void SoundLibrary::Finalize() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	// 枠は残して世代を進める。終了処理の前のハンドルが、初期化し直した後に同じ枠へ入った別の音声を指さないように
+	freeSlots_.clear();
+	for (uint32_t i = static_cast<uint32_t>(slots_.size()); i > 0; --i) {
+		Slot& slot = slots_[i - 1];
+		if (slot.sound) {
+			slot.sound.reset();
+			slot.fileName.clear();
+			slot.refCount = 0;
+			++slot.generation;
+		}
+		// 小さい番号から使うよう逆順に積む
+		freeSlots_.push_back(i - 1);
+	}
+	indices_.clear();
+	memoryUsage_ = 0;
+}
+
+uint32_t SoundLibrary::Load(const std::string& fileName) {
+	std::vector<uint32_t> handles;
+	return LoadAll({fileName}, handles) ? handles[0] : kInvalidHandle;
+}
+
+bool SoundLibrary::LoadAll(const std::vector<std::string>& fileNames, std::vector<uint32_t>& handles) {
+	handles.clear();
+
+	// まだ無いものだけをロックの外で読み込む。1つでも読めなければ何も登録しない
+	std::vector<std::shared_ptr<const MixerSound>> decoded(fileNames.size());
+	while (true) {
+		std::vector<size_t> missing;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			for (size_t i = 0; i < fileNames.size(); ++i) {
+				if (!decoded[i] && indices_.count(fileNames[i]) == 0) {
+					missing.push_back(i);
+				}
+			}
+			if (missing.empty()) {
+				// すべて揃っていれば、他のスレッドから途中の状態が見えないよう1回のロックの中でまとめて登録する
+				handles.reserve(fileNames.size());
+				for (size_t i = 0; i < fileNames.size(); ++i) {
+					uint32_t handle = AddRef(fileNames[i]);
+					if (handle == kInvalidHandle) {
+						handle = Register(fileNames[i], std::move(decoded[i]));
+					}
+					if (handle == kInvalidHandle) {
+						// 登録した分を戻す
+						for (uint32_t registered : handles) {
+							Release(registered);
+						}
+						handles.clear();
+						return false;
+					}
+					handles.push_back(handle);
+				}
+				return true;
+			}
+		}
+
+		// デコードはロックを持たずに行う。その間に他のスレッドが解放したものは、次の確認で見つけて読み直す
+		for (size_t i : missing) {
+			decoded[i] = Decode(fileNames[i]);
+			if (!decoded[i]) {
+				return false;
+			}
+		}
+	}
+}
+
+void SoundLibrary::Unload(uint32_t handle) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	Release(handle);
+}
+
+void SoundLibrary::UnloadAll(const std::vector<uint32_t>& handles) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	for (uint32_t handle : handles) {
+		Release(handle);
+	}
+}
+
+std::shared_ptr<const MixerSound> SoundLibrary::Get(uint32_t handle) const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	const Slot* slot = Find(handle);
+	return slot ? slot->sound : nullptr;
+}
+
+size_t SoundLibrary::GetMemorySize(uint32_t handle) const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	const Slot* slot = Find(handle);
+	return slot ? CalculateMemorySize(*slot->sound) : 0;
+}
+
+uint32_t SoundLibrary::GetSoundCount() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return static_cast<uint32_t>(indices_.size());
+}
+
+size_t SoundLibrary::GetMemoryUsage() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return memoryUsage_;
+}
+
+std::shared_ptr<const MixerSound> SoundLibrary::Decode(const std::string& fileName) const {
+	PcmSound pcm;
+	if (!LoadPcmSound(directoryPath_ + fileName, pcm)) {
+		return nullptr;
+	}
+	return CreateMixerSound(pcm);
+}
+
+uint32_t SoundLibrary::AddRef(const std::string& fileName) {
+	auto it = indices_.find(fileName);
+	if (it == indices_.end()) {
+		return kInvalidHandle;
+	}
+	Slot& slot = slots_[it->second];
+	++slot.refCount;
+	return MakeHandle(it->second, slot.generation);
+}
+
+uint32_t SoundLibrary::Register(const std::string& fileName, std::shared_ptr<const MixerSound> sound) {
+	uint32_t index = 0;
+	if (!freeSlots_.empty()) {
+		index = freeSlots_.back();
+		freeSlots_.pop_back();
+	} else if (slots_.size() < kMaxSounds) {
+		index = static_cast<uint32_t>(slots_.size());
+		slots_.emplace_back();
+	} else {
+		return kInvalidHandle;
+	}
+
+	Slot& slot = slots_[index];
+	memoryUsage_ += CalculateMemorySize(*sound);
+	slot.sound = std::move(sound);
+	slot.fileName = fileName;
+	slot.refCount = 1;
+	indices_[fileName] = index;
+	return MakeHandle(index, slot.generation);
+}
+
+SoundLibrary::Slot* SoundLibrary::Find(uint32_t handle) {
+	// 枠が使い回されていれば世代が合わないので、古いハンドルは無視される
+	uint32_t index = handle & 0xFFFF;
+	if (index >= slots_.size() || !slots_[index].sound || slots_[index].generation != handle >> 16) {
+		return nullptr;
+	}
+	return &slots_[index];
+}
+
+const SoundLibrary::Slot* SoundLibrary::Find(uint32_t handle) const { return const_cast<SoundLibrary*>(this)->Find(handle); }
+
+void SoundLibrary::Release(uint32_t handle) {
+	Slot* slot = Find(handle);
+	if (!slot || --slot->refCount > 0) {
+		return;
+	}
+	memoryUsage_ -= CalculateMemorySize(*slot->sound);
+	indices_.erase(slot->fileName);
+	slot->sound.reset();
+	slot->fileName.clear();
+	++slot->generation;
+	freeSlots_.push_back(handle & 0xFFFF);
+}
+
+bool SoundBank::Load(const std::vector<std::string>& fileNames) {
+	// 同じ名前を重ねて参照しないよう重複を除く
+	std::vector<std::string> uniqueNames;
+	for (const std::string& fileName : fileNames) {
+		if (std::find(uniqueNames.begin(), uniqueNames.end(), fileName) == uniqueNames.end()) {
+			uniqueNames.push_back(fileName);
+		}
+	}
+
+	SoundLibrary* library = SoundLibrary::GetInstance();
+	std::vector<uint32_t> handles;
+	if (!library->LoadAll(uniqueNames, handles)) {
+		return false;
+	}
+	// 新しい分を登録してから前の分を解放するので、共有している音声は読み直さない
+	Unload();
+	for (size_t i = 0; i < uniqueNames.size(); ++i) {
+		handles_[uniqueNames[i]] = handles[i];
+		memoryUsage_ += library->GetMemorySize(handles[i]);
+	}
+	return true;
+}
+
+void SoundBank::Unload() {
+	std::vector<uint32_t> handles;
+	handles.reserve(handles_.size());
+	for (const auto& [fileName, handle] : handles_) {
+		handles.push_back(handle);
+	}
+	SoundLibrary::GetInstance()->UnloadAll(handles);
+	handles_.clear();
+	memoryUsage_ = 0;
+}
+
+uint32_t SoundBank::GetHandle(const std::string& fileName) const {
+	auto it = handles_.find(fileName);
+	return it != handles_.end() ? it->second : SoundLibrary::kInvalidHandle;
+}
+
+std::shared_ptr<const MixerSound> SoundBank::Get(const std::string& fileName) const { return SoundLibrary::GetInstance()->Get(GetHandle(fileName)); }
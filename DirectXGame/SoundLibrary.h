@@ -0,0 +1,146 @@
+#pragma once
+#include "AudioMixer.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// ミキサーで鳴らす音声の置き場
+/// 枠は空きリストで使い回し、ハンドルには世代を持たせるので、解放済みの音声を指す古いハンドルはnullptrになる。
+/// 同じファイルは参照カウントで共有する
+/// </summary>
+class SoundLibrary {
+public:
+	// 無効なハンドル
+	static const uint32_t kInvalidHandle = UINT32_MAX;
+	// 置いておける音声の数
+	static const uint32_t kMaxSounds = 0xFFFF;
+
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static SoundLibrary* GetInstance();
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="directoryPath">サウンド格納ディレクトリ</param>
+	void Initialize(const std::string& directoryPath = "Resources/");
+
+	/// <summary>
+	/// 終了処理。すべての音声を解放する(それまでのハンドルは初期化し直した後も無効のまま)
+	/// </summary>
+	void Finalize();
+
+	/// <summary>
+	/// 音声の読み込み。読み込み済みなら参照を増やして同じハンドルを返す
+	/// </summary>
+	/// <param name="fileName">WAVファイル名</param>
+	/// <returns>ハンドル。失敗時はkInvalidHandle</returns>
+	uint32_t Load(const std::string& fileName);
+
+	/// <summary>
+	/// 読み込んだ音声をまとめて登録する。途中で失敗したら何も登録しない
+	/// </summary>
+	/// <param name="fileNames">WAVファイル名</param>
+	/// <param name="handles">ハンドルの出力先(fileNamesと同じ順)</param>
+	/// <returns>成否</returns>
+	bool LoadAll(const std::vector<std::string>& fileNames, std::vector<uint32_t>& handles);
+
+	/// <summary>
+	/// 参照を減らし、なくなったら枠を空ける。再生中のボイスは鳴り終えるまで音声を持っている
+	/// </summary>
+	/// <param name="handle">ハンドル</param>
+	void Unload(uint32_t handle);
+
+	/// <summary>
+	/// まとめて参照を減らす
+	/// </summary>
+	/// <param name="handles">ハンドル</param>
+	void UnloadAll(const std::vector<uint32_t>& handles);
+
+	// 音声の取得。解放済みならnullptr
+	std::shared_ptr<const MixerSound> Get(uint32_t handle) const;
+	// 音声のメモリ量(バイト)。解放済みなら0
+	size_t GetMemorySize(uint32_t handle) const;
+	// 置いている音声の数
+	uint32_t GetSoundCount() const;
+	// 置いている音声のメモリ量の合計(バイト)
+	size_t GetMemoryUsage() const;
+
+private:
+	SoundLibrary() = default;
+	~SoundLibrary() = default;
+	SoundLibrary(const SoundLibrary&) = delete;
+	const SoundLibrary& operator=(const SoundLibrary&) = delete;
+
+	struct Slot {
+		std::shared_ptr<const MixerSound> sound;
+		std::string fileName;
+		uint32_t refCount = 0;
+		// 枠を使い回すたびに増やす。ハンドルの上位16bit
+		uint16_t generation = 0;
+	};
+
+	// ファイルを読み込んでミキサー用に変換する(ロックの外で呼ぶ)
+	std::shared_ptr<const MixerSound> Decode(const std::string& fileName) const;
+	// 登録済みの音声の参照を増やす。なければkInvalidHandle
+	uint32_t AddRef(const std::string& fileName);
+	// 新しい枠に登録する
+	uint32_t Register(const std::string& fileName, std::shared_ptr<const MixerSound> sound);
+	// ハンドルが指す枠。解放済みならnullptr
+	Slot* Find(uint32_t handle);
+	const Slot* Find(uint32_t handle) const;
+	// 参照を減らす
+	void Release(uint32_t handle);
+
+	std::string directoryPath_;
+	mutable std::mutex mutex_;
+	std::vector<Slot> slots_;
+	// 空いている枠の番号
+	std::vector<uint32_t> freeSlots_;
+	// ファイル名から枠の番号への対応
+	std::unordered_map<std::string, uint32_t> indices_;
+	size_t memoryUsage_ = 0;
+};
+
+/// <summary>
+/// まとめて読み込み、まとめて解放する音声のグループ(ステージごとの効果音など)
+/// 破棄するときに解放する
+/// </summary>
+class SoundBank {
+public:
+	SoundBank() = default;
+	~SoundBank() { Unload(); }
+	SoundBank(const SoundBank&) = delete;
+	SoundBank& operator=(const SoundBank&) = delete;
+
+	/// <summary>
+	/// 読み込み。すべて読めたときだけ登録し、読み込み済みの分は先に解放する
+	/// </summary>
+	/// <param name="fileNames">WAVファイル名</param>
+	/// <returns>成否</returns>
+	bool Load(const std::vector<std::string>& fileNames);
+
+	/// <summary>
+	/// 解放
+	/// </summary>
+	void Unload();
+
+	// ファイル名からハンドルを引く。含まれていなければkInvalidHandle
+	uint32_t GetHandle(const std::string& fileName) const;
+	// 音声の取得。含まれていなければnullptr
+	std::shared_ptr<const MixerSound> Get(const std::string& fileName) const;
+	// 音声の数
+	size_t GetSoundCount() const { return handles_.size(); }
+	// 音声のメモリ量の合計(バイト)。他のバンクと共有している分も含む
+	size_t GetMemoryUsage() const { return memoryUsage_; }
+
+private:
+	std::unordered_map<std::string, uint32_t> handles_;
+	size_t memoryUsage_ = 0;
+};
@@ -0,0 +1,180 @@
+#include "SpatialAudio.h"
+#include <3d\Camera.h>
+#include <3d\WorldTransform.h>
+#include <algorithm>
+
+using namespace KamataEngine;
+
+namespace {
+
+// ハンドルは下位16bitが枠の番号、上位16bitが世代
+uint32_t MakeHandle(uint32_t index, uint16_t generation) { return static_cast<uint32_t>(generation) << 16 | index; }
+
+// 置いておける発音体の数
+const uint32_t kMaxEmitters = 0xFFFF;
+
+} // namespace
+
+SpatialAudio* SpatialAudio::GetInstance() {
+	static SpatialAudio instance;
+	return &instance;
+}
+
+void SpatialAudio::Initialize(AudioMixer* mixer) {
+	Finalize();
+	mixer_ = mixer;
+}
+
+void SpatialAudio::Finalize() {
+	for (Emitter& emitter : emitters_) {
+		StopVoices(emitter);
+	}
+	emitters_.clear();
+	freeEmitters_.clear();
+	spatializer_.Resize(0);
+	listener_ = nullptr;
+	hasListenerPosition_ = false;
+	listenerState_ = {};
+	audibleCount_ = 0;
+	mixer_ = nullptr;
+}
+
+uint32_t SpatialAudio::CreateEmitter(const WorldTransform* worldTransform, float minDistance, float maxDistance) {
+	uint32_t index = 0;
+	if (!freeEmitters_.empty()) {
+		index = freeEmitters_.back();
+		freeEmitters_.pop_back();
+	} else if (emitters_.size() < kMaxEmitters) {
+		index = static_cast<uint32_t>(emitters_.size());
+		emitters_.emplace_back();
+		spatializer_.Resize(emitters_.size());
+	} else {
+		return kInvalidHandle;
+	}
+
+	Emitter& emitter = emitters_[index];
+	emitter.worldTransform = worldTransform;
+	emitter.minDistance = minDistance;
+	emitter.maxDistance = maxDistance;
+	// 使い回した枠に前の発音体の位置と速度が残っていると、最初のフレームでドップラー効果がずれる
+	std::fill(emitter.position, emitter.position + 3, 0.0f);
+	std::fill(emitter.velocity, emitter.velocity + 3, 0.0f);
+	emitter.hasPosition = false;
+	emitter.audible = false;
+	return MakeHandle(index, emitter.generation);
+}
+
+void SpatialAudio::DestroyEmitter(uint32_t emitter) {
+	Emitter* target = Find(emitter);
+	if (!target) {
+		return;
+	}
+	StopVoices(*target);
+	target->worldTransform = nullptr;
+	++target->generation;
+	// 空いた枠は最大距離0にして計算結果が常に聞こえないようにする
+	const float zero[3] = {};
+	spatializer_.SetEmitter(emitter & 0xFFFF, zero, zero, 0.0f, 0.0f);
+	freeEmitters_.push_back(emitter & 0xFFFF);
+}
+
+uint32_t SpatialAudio::Play(uint32_t emitter, std::shared_ptr<const MixerSound> sound, bool loopFlag, float volume, uint8_t priority) {
+	Emitter* target = Find(emitter);
+	if (!target || !mixer_) {
+		return AudioMixer::kInvalidHandle;
+	}
+	// 次のUpdateまでは前回の計算結果で鳴らす
+	size_t index = emitter & 0xFFFF;
+	float gain = target->audible ? spatializer_.GetGain(index) : 0.0f;
+	float pan = target->audible ? spatializer_.GetPan(index) : 0.0f;
+	float pitch = target->audible ? spatializer_.GetPitch(index) : 1.0f;
+	uint32_t handle = mixer_->Play(std::move(sound), AudioMixer::Bus::kSfx, loopFlag, volume * gain, pitch, priority);
+	if (handle == AudioMixer::kInvalidHandle) {
+		return handle;
+	}
+	mixer_->SetPan(handle, pan);
+	target->voices.push_back({handle, volume});
+	return handle;
+}
+
+void SpatialAudio::Update(float deltaTime) {
+	// 聴取者はカメラの位置と、ビュー行列の1列目(カメラの右方向)
+	if (listener_) {
+		const float position[3] = {listener_->translation_.x, listener_->translation_.y, listener_->translation_.z};
+		if (hasListenerPosition_ && deltaTime > 0.0f) {
+			for (int axis = 0; axis < 3; ++axis) {
+				listenerState_.velocity[axis] = (position[axis] - listenerState_.position[axis]) / deltaTime;
+			}
+		}
+		std::copy(position, position + 3, listenerState_.position);
+		listenerState_.right[0] = listener_->matView.m[0][0];
+		listenerState_.right[1] = listener_->matView.m[1][0];
+		listenerState_.right[2] = listener_->matView.m[2][0];
+		hasListenerPosition_ = true;
+	}
+
+	// 発音体の位置を集めて速度を求める
+	for (uint32_t i = 0; i < emitters_.size(); ++i) {
+		Emitter& emitter = emitters_[i];
+		if (!emitter.worldTransform) {
+			continue;
+		}
+		const Matrix4x4& matWorld = emitter.worldTransform->matWorld_;
+		const float position[3] = {matWorld.m[3][0], matWorld.m[3][1], matWorld.m[3][2]};
+		if (emitter.hasPosition && deltaTime > 0.0f) {
+			for (int axis = 0; axis < 3; ++axis) {
+				emitter.velocity[axis] = (position[axis] - emitter.position[axis]) / deltaTime;
+			}
+		}
+		std::copy(position, position + 3, emitter.position);
+		emitter.hasPosition = true;
+		spatializer_.SetEmitter(i, emitter.position, emitter.velocity, emitter.minDistance, emitter.maxDistance);
+	}
+
+	// 全発音体をまとめて計算する
+	spatializer_.Process(listenerState_, dopplerScale_);
+
+	// 聞こえる発音体のボイスだけ毎フレーム更新し、聞こえなくなった発音体は一度だけ音量0にする
+	audibleCount_ = 0;
+	for (uint32_t i = 0; i < emitters_.size(); ++i) {
+		Emitter& emitter = emitters_[i];
+		if (!emitter.worldTransform) {
+			continue;
+		}
+		bool audible = spatializer_.IsAudible(i);
+		audibleCount_ += audible ? 1 : 0;
+
+		// 鳴り終えたボイスを外す
+		auto end = std::remove_if(emitter.voices.begin(), emitter.voices.end(), [this](const EmitterVoice& voice) { return !mixer_->IsPlaying(voice.handle); });
+		emitter.voices.erase(end, emitter.voices.end());
+
+		if (audible) {
+			for (const EmitterVoice& voice : emitter.voices) {
+				mixer_->SetParameters(voice.handle, voice.volume * spatializer_.GetGain(i), spatializer_.GetPan(i), spatializer_.GetPitch(i));
+			}
+		} else if (emitter.audible) {
+			for (const EmitterVoice& voice : emitter.voices) {
+				mixer_->SetVolume(voice.handle, 0.0f);
+			}
+		}
+		emitter.audible = audible;
+	}
+}
+
+SpatialAudio::Emitter* SpatialAudio::Find(uint32_t emitter) {
+	// 枠が使い回されていれば世代が合わないので、古いハンドルは無視される
+	uint32_t index = emitter & 0xFFFF;
+	if (index >= emitters_.size() || !emitters_[index].worldTransform || emitters_[index].generation != emitter >> 16) {
+		return nullptr;
+	}
+	return &emitters_[index];
+}
+
+void SpatialAudio::StopVoices(Emitter& emitter) {
+	if (mixer_) {
+		for (const EmitterVoice& voice : emitter.voices) {
+			mixer_->Stop(voice.handle);
+		}
+	}
+	emitter.voices.clear();
+}
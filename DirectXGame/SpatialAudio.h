@@ -0,0 +1,135 @@
+#pragma once
+#include "AudioMixer.h"
+#include "AudioSpatializer.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace KamataEngine {
+class Camera;
+class WorldTransform;
+} // namespace KamataEngine
+
+/// <summary>
+/// 3Dサウンド
+/// WorldTransformに結び付けた発音体とカメラを聴取者として、毎フレーム距離による音量・左右の定位・ドップラー効果を
+/// ミキサーのボイスに反映する。聞こえる距離の外にある発音体は音量0にして、ミキサー側で仮想ボイスにさせる
+/// </summary>
+class SpatialAudio {
+public:
+	// 無効なハンドル
+	static const uint32_t kInvalidHandle = UINT32_MAX;
+	// これより近ければ減衰しない距離の既定値
+	static constexpr float kDefaultMinDistance = 1.0f;
+	// これより遠ければ聞こえない距離の既定値
+	static constexpr float kDefaultMaxDistance = 50.0f;
+
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static SpatialAudio* GetInstance();
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="mixer">ボイスを鳴らすミキサー</param>
+	void Initialize(AudioMixer* mixer);
+
+	/// <summary>
+	/// 終了処理。発音体のボイスをすべて止める
+	/// </summary>
+	void Finalize();
+
+	/// <summary>
+	/// 発音体の作成。worldTransformはDestroyEmitterまで有効にしておくこと
+	/// </summary>
+	/// <param name="worldTransform">位置を取るワールド変換(matWorld_の平行移動成分を使う)</param>
+	/// <param name="minDistance">これより近ければ減衰しない距離</param>
+	/// <param name="maxDistance">これより遠ければ聞こえない距離</param>
+	/// <returns>ハンドル</returns>
+	uint32_t CreateEmitter(const KamataEngine::WorldTransform* worldTransform, float minDistance = kDefaultMinDistance, float maxDistance = kDefaultMaxDistance);
+
+	/// <summary>
+	/// 発音体の破棄。鳴らしているボイスは止める
+	/// </summary>
+	/// <param name="emitter">発音体のハンドル</param>
+	void DestroyEmitter(uint32_t emitter);
+
+	/// <summary>
+	/// 発音体から鳴らす
+	/// </summary>
+	/// <param name="emitter">発音体のハンドル</param>
+	/// <param name="sound">音声</param>
+	/// <param name="loopFlag">ループ再生フラグ</param>
+	/// <param name="volume">距離で減衰させる前のボリューム</param>
+	/// <param name="priority">優先度</param>
+	/// <returns>ミキサーの再生ハンドル。失敗時はAudioMixer::kInvalidHandle</returns>
+	uint32_t Play(uint32_t emitter, std::shared_ptr<const MixerSound> sound, bool loopFlag = false, float volume = 1.0f, uint8_t priority = AudioMixer::kDefaultPriority);
+
+	// 聴取者にするカメラの設定(nullptrなら原点で+X方向が右)
+	void SetListener(const KamataEngine::Camera* camera) { listener_ = camera; }
+	// ドップラー効果の強さの設定(0で無効)
+	void SetDopplerScale(float dopplerScale) { dopplerScale_ = dopplerScale; }
+
+	/// <summary>
+	/// 毎フレームの更新。位置から速度を求め、全発音体をまとめて計算してボイスに反映する
+	/// </summary>
+	/// <param name="deltaTime">前回の更新からの経過時間(秒)。0なら速度は前回のまま</param>
+	void Update(float deltaTime);
+
+	// ボイスを鳴らすミキサー
+	AudioMixer* GetMixer() const { return mixer_; }
+	// 発音体の数
+	uint32_t GetEmitterCount() const { return static_cast<uint32_t>(emitters_.size() - freeEmitters_.size()); }
+	// 聞こえる距離にある発音体の数
+	uint32_t GetAudibleEmitterCount() const { return audibleCount_; }
+
+private:
+	SpatialAudio() = default;
+	~SpatialAudio() = default;
+	SpatialAudio(const SpatialAudio&) = delete;
+	const SpatialAudio& operator=(const SpatialAudio&) = delete;
+
+	// 発音体から鳴らしているボイス
+	struct EmitterVoice {
+		uint32_t handle;
+		// 距離で減衰させる前のボリューム
+		float volume;
+	};
+
+	struct Emitter {
+		const KamataEngine::WorldTransform* worldTransform = nullptr;
+		// 枠を使い回すたびに増やす。ハンドルの上位16bit
+		uint16_t generation = 0;
+		float minDistance = kDefaultMinDistance;
+		float maxDistance = kDefaultMaxDistance;
+		// 前回の位置と、そこから求めた速度
+		float position[3] = {};
+		float velocity[3] = {};
+		// 位置を一度でも取ったか(最初のフレームは速度を0にする)
+		bool hasPosition = false;
+		// 前回聞こえる距離にあったか
+		bool audible = false;
+		std::vector<EmitterVoice> voices;
+	};
+
+	// ハンドルが指す発音体。破棄済みならnullptr
+	Emitter* Find(uint32_t emitter);
+	// 発音体のボイスをすべて止める
+	void StopVoices(Emitter& emitter);
+
+	AudioMixer* mixer_ = nullptr;
+	const KamataEngine::Camera* listener_ = nullptr;
+	float dopplerScale_ = 1.0f;
+	// 聴取者の前回の位置と速度
+	AudioSpatializer::Listener listenerState_;
+	bool hasListenerPosition_ = false;
+
+	std::vector<Emitter> emitters_;
+	// 空いている発音体の番号
+	std::vector<uint32_t> freeEmitters_;
+	// 発音体と同じ番号で計算する
+	AudioSpatializer spatializer_;
+	uint32_t audibleCount_ = 0;
+};
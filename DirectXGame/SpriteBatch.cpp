@@ -0,0 +1,477 @@
+#include "SpriteBatch.h"
+#include "BatchSprite.h"
+#include <algorithm>
+#include <base\WinApp.h>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SPRITE_BATCH_USE_SSE2
+#endif
+
+using namespace KamataEngine;
+
+namespace {
+
+// 定数バッファとリングの領域のアラインメント
+const size_t kAlignment = 256;
+// 1スプライトあたりの頂点数とインデックス数
+const uint32_t kVerticesPerSprite = 4;
+const uint32_t kIndicesPerSprite = 6;
+// 四角形は左下、左上、右下、右上の順なので(0,1,2)(2,1,3)の2枚の三角形にする
+const uint16_t kQuadIndices[kIndicesPerSprite] = {0, 1, 2, 2, 1, 3};
+
+static_assert(sizeof(SpriteBatch::Vertex) == sizeof(float) * 9, "Vertex must match InputLayout::kPosUvColor");
+static_assert(sizeof(SpriteBatch::Instance) == 48, "Instance must match SpriteInstance in SpriteInstancedVS.hlsl");
+
+// 1スプライトあたりの書き込みバイト数
+size_t GetSpriteBytes(SpriteBatch::Mode mode) { return mode == SpriteBatch::Mode::kInstanced ? sizeof(SpriteBatch::Instance) : kVerticesPerSprite * sizeof(SpriteBatch::Vertex); }
+
+// 1フレームに使うリングのバイト数
+size_t CalculateFrameBytes(uint32_t maxSprites, SpriteBatch::Mode mode) { return kAlignment + (size_t(maxSprites) * GetSpriteBytes(mode) + kAlignment - 1) / kAlignment * kAlignment; }
+
+// 単精度から半精度への変換(最近接偶数丸め)
+uint16_t FloatToHalf(float value) {
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	uint32_t sign = (bits >> 16) & 0x8000;
+	uint32_t exponent = (bits >> 23) & 0xFF;
+	uint32_t mantissa = bits & 0x7FFFFF;
+	if (exponent == 0xFF) {
+		// 無限大とNaN
+		return static_cast<uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+	}
+	int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+	if (halfExponent >= 0x1F) {
+		return static_cast<uint16_t>(sign | 0x7C00);
+	}
+	uint32_t shift = 13;
+	uint32_t half = 0;
+	if (halfExponent <= 0) {
+		// 非正規化数。小さすぎれば0
+		if (halfExponent < -10) {
+			return static_cast<uint16_t>(sign);
+		}
+		mantissa |= 0x800000;
+		shift = static_cast<uint32_t>(14 - halfExponent);
+	} else {
+		half = static_cast<uint32_t>(halfExponent) << 10;
+	}
+	half |= mantissa >> shift;
+	// 繰り上がりが指数に及んでも正しい値(最大値を超えれば無限大)になる
+	uint32_t remainder = mantissa & ((1u << shift) - 1);
+	uint32_t halfway = 1u << (shift - 1);
+	if (remainder > halfway || (remainder == halfway && (half & 1))) {
+		++half;
+	}
+	return static_cast<uint16_t>(sign | half);
+}
+
+// アンカーポイントから見た範囲(左、上、右、下)。回転していれば最も遠い角までを半径とする円に外接する正方形
+void CalculateBounds(const SpriteBatch::SpriteDesc& sprite, float bounds[4]) {
+	float left = (0.0f - sprite.anchorPoint.x) * sprite.size.x;
+	float right = (1.0f - sprite.anchorPoint.x) * sprite.size.x;
+	float top = (0.0f - sprite.anchorPoint.y) * sprite.size.y;
+	float bottom = (1.0f - sprite.anchorPoint.y) * sprite.size.y;
+	if (sprite.rotation != 0.0f) {
+		float radius = std::sqrt((std::max)(left * left, right * right) + (std::max)(top * top, bottom * bottom));
+		bounds[0] = bounds[1] = -radius;
+		bounds[2] = bounds[3] = radius;
+		return;
+	}
+	// 回転していなければ反転を考えた矩形そのもの
+	if (sprite.isFlipX) {
+		left = -left;
+		right = -right;
+	}
+	if (sprite.isFlipY) {
+		top = -top;
+		bottom = -bottom;
+	}
+	bounds[0] = (std::min)(left, right);
+	bounds[1] = (std::min)(top, bottom);
+	bounds[2] = (std::max)(left, right);
+	bounds[3] = (std::max)(top, bottom);
+}
+
+// 範囲が画面に掛かるか
+bool IsInsideScreen(const Vector2& position, const float bounds[4], float screenWidth, float screenHeight) {
+	return position.x + bounds[2] >= 0.0f && position.x + bounds[0] <= screenWidth && position.y + bounds[3] >= 0.0f && position.y + bounds[1] <= screenHeight;
+}
+
+// 0～1を16bitに正規化する
+uint16_t FloatToUnorm16(float value) { return static_cast<uint16_t>(std::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f); }
+
+// テクスチャ座標の範囲(左、上、右、下)。テクスチャの大きさが分からなければ全体
+void CalculateUvRect(const SpriteBatch::SpriteDesc& sprite, uint32_t textureWidth, uint32_t textureHeight, float uvRect[4]) {
+	if (textureWidth == 0 || textureHeight == 0 || sprite.texSize.x == 0.0f || sprite.texSize.y == 0.0f) {
+		uvRect[0] = 0.0f;
+		uvRect[1] = 0.0f;
+		uvRect[2] = 1.0f;
+		uvRect[3] = 1.0f;
+		return;
+	}
+	uvRect[0] = sprite.texBase.x / textureWidth;
+	uvRect[1] = sprite.texBase.y / textureHeight;
+	uvRect[2] = (sprite.texBase.x + sprite.texSize.x) / textureWidth;
+	uvRect[3] = (sprite.texBase.y + sprite.texSize.y) / textureHeight;
+}
+
+} // namespace
+
+SpriteBatch::SpriteBatch(RenderDevice* device, uint32_t maxSprites, Mode mode)
+    : device_(device), maxSprites_(mode == Mode::kVertex ? (std::min)(maxSprites, kDefaultMaxSprites) : maxSprites), mode_(mode),
+      allocator_(CalculateFrameBytes(maxSprites_, mode) * (kBufferedFrames + 1)), screenWidth_(static_cast<float>(WinApp::kWindowWidth)),
+      screenHeight_(static_cast<float>(WinApp::kWindowHeight)) {
+	// 折り返しで捨てる末尾の分、1フレーム多めに確保する
+	ring_ = device_->CreateBuffer(allocator_.GetCapacity(), BufferUsage::kUpload);
+	std::fill(std::begin(pipelines_), std::end(pipelines_), kInvalidPipeline);
+
+	// インデックスは全スプライト共通で変わらないので、GPU専用のバッファに最初のEndで一度だけ転送する
+	// インスタンスはSV_VertexIDから展開するので使わない
+	if (mode_ == Mode::kVertex) {
+		size_t indexBytes = size_t(maxSprites_) * kIndicesPerSprite * sizeof(uint16_t);
+		indexBuffer_ = device_->CreateBuffer(indexBytes, BufferUsage::kDefault);
+		indexUpload_ = std::make_unique<UploadRingBuffer>(device_, indexBytes + UploadRingBuffer::kAlignment);
+	}
+
+	sprites_.reserve(maxSprites_);
+	sources_.reserve(maxSprites_);
+	spriteBatches_.reserve(maxSprites_);
+	order_.reserve(maxSprites_);
+}
+
+bool SpriteBatch::UploadIndices() {
+	size_t indexCount = size_t(maxSprites_) * kIndicesPerSprite;
+	uint16_t* indices = static_cast<uint16_t*>(indexUpload_->Allocate(indexBuffer_.get(), 0, indexCount * sizeof(uint16_t)));
+	if (!indices) {
+		return false;
+	}
+	for (uint32_t i = 0; i < maxSprites_; ++i) {
+		for (uint32_t j = 0; j < kIndicesPerSprite; ++j) {
+			indices[size_t(i) * kIndicesPerSprite + j] = static_cast<uint16_t>(i * kVerticesPerSprite + kQuadIndices[j]);
+		}
+	}
+	indexUploaded_ = true;
+	return true;
+}
+
+void SpriteBatch::SetScreenSize(float width, float height) {
+	screenWidth_ = width;
+	screenHeight_ = height;
+}
+
+void SpriteBatch::Begin() {
+	sprites_.clear();
+	sources_.clear();
+	droppedSprites_ = 0;
+	culledSprites_ = 0;
+}
+
+bool SpriteBatch::Draw(const SpriteDesc& sprite) {
+	if (cullingEnabled_ && !IsVisible(sprite, screenWidth_, screenHeight_)) {
+		++culledSprites_;
+		return true;
+	}
+	return Push(sprite, nullptr);
+}
+
+bool SpriteBatch::Draw(BatchSprite& sprite) {
+	if (cullingEnabled_) {
+		if (sprite.dirtyFlags_ & BatchSprite::kDirtyBounds) {
+			CalculateBounds(sprite.desc_, sprite.bounds_);
+			sprite.dirtyFlags_ &= ~BatchSprite::kDirtyBounds;
+		}
+		if (!IsInsideScreen(sprite.desc_.position, sprite.bounds_, screenWidth_, screenHeight_)) {
+			++culledSprites_;
+			return true;
+		}
+	}
+	return Push(sprite.desc_, &sprite);
+}
+
+bool SpriteBatch::Push(const SpriteDesc& sprite, BatchSprite* source) {
+	if (sprites_.size() >= maxSprites_) {
+		++droppedSprites_;
+		return false;
+	}
+	sprites_.push_back(sprite);
+	sources_.push_back(source);
+	return true;
+}
+
+void SpriteBatch::End() {
+	statistics_ = {};
+	statistics_.droppedSprites = droppedSprites_;
+	statistics_.culledSprites = culledSprites_;
+	if (sprites_.empty()) {
+		return;
+	}
+
+	// インデックスのコピーを描画より先に記録し、GPUがそのフレームを終えたら転送用のリングを解放する
+	if (indexUpload_) {
+		if (!indexUploaded_ && indexBuffer_ && !UploadIndices()) {
+			indexBuffer_.reset();
+		}
+		indexUpload_->Flush();
+		if (!indexBuffer_ || indexUpload_->GetUsedBytes() == 0) {
+			indexUpload_.reset();
+		}
+	}
+
+	// 今フレームの定数バッファと頂点(インスタンス)をリングから切り出す
+	uint32_t spriteCount = static_cast<uint32_t>(sprites_.size());
+	size_t dataBytes = size_t(spriteCount) * GetSpriteBytes(mode_);
+	uint64_t frameIndex = device_->GetFrameIndex();
+	allocator_.Reclaim(device_->GetCompletedFrameIndex());
+	size_t constantOffset = ring_ ? allocator_.Allocate(sizeof(float) * 16, kAlignment, frameIndex) : UploadRingAllocator::kInvalidOffset;
+	size_t dataOffset = constantOffset != UploadRingAllocator::kInvalidOffset ? allocator_.Allocate(dataBytes, kAlignment, frameIndex) : UploadRingAllocator::kInvalidOffset;
+	if (dataOffset == UploadRingAllocator::kInvalidOffset || (mode_ == Mode::kVertex && !indexBuffer_)) {
+		statistics_.droppedSprites += spriteCount;
+		sprites_.clear();
+		sources_.clear();
+		return;
+	}
+	uint8_t* mapped = static_cast<uint8_t*>(ring_->GetMappedAddress());
+
+	// 画面座標からクリップ座標への正射影行列(Spriteと同じ)
+	float* matProjection = reinterpret_cast<float*>(mapped + constantOffset);
+	std::fill(matProjection, matProjection + 16, 0.0f);
+	matProjection[0] = 2.0f / screenWidth_;
+	matProjection[5] = -2.0f / screenHeight_;
+	matProjection[10] = 1.0f;
+	matProjection[12] = -1.0f;
+	matProjection[13] = 1.0f;
+	matProjection[15] = 1.0f;
+
+	// スプライトをまとまりごとに数え、まとまりの順に書き込み位置を割り当てて並べる(同じまとまりの中では溜めた順)
+	batchCounts_.clear();
+	spriteBatches_.resize(spriteCount);
+	BatchKey lastKey = {};
+	uint32_t* lastCount = nullptr;
+	for (uint32_t i = 0; i < spriteCount; ++i) {
+		BatchKey key = {sprites_[i].layer, sprites_[i].blendMode, sprites_[i].textureHandle};
+		// 続けて同じまとまりを描くことが多いので、直前と同じなら探さない
+		if (!lastCount || !(key == lastKey)) {
+			lastKey = key;
+			lastCount = &batchCounts_[key];
+		}
+		++*lastCount;
+		spriteBatches_[i] = lastCount;
+	}
+	uint32_t offset = 0;
+	for (auto& [key, count] : batchCounts_) {
+		uint32_t batchSize = count;
+		count = offset;
+		offset += batchSize;
+	}
+	order_.resize(spriteCount);
+	for (uint32_t i = 0; i < spriteCount; ++i) {
+		order_[(*spriteBatches_[i])++] = i;
+	}
+
+	// 並べた順に書き込む。テクスチャの大きさはテクスチャが変わったときだけ引く
+	size_t spriteBytes = GetSpriteBytes(mode_);
+	uint32_t textureHandle = UINT32_MAX;
+	uint32_t textureWidth = 0;
+	uint32_t textureHeight = 0;
+	for (uint32_t i = 0; i < spriteCount; ++i) {
+		uint32_t index = order_[i];
+		const SpriteDesc& sprite = sprites_[index];
+		if (sprite.textureHandle != textureHandle) {
+			textureHandle = sprite.textureHandle;
+			if (!device_->GetTextureSize(textureHandle, textureWidth, textureHeight)) {
+				textureWidth = 0;
+				textureHeight = 0;
+			}
+		}
+		WriteSprite(sprite, sources_[index], textureWidth, textureHeight, mapped + dataOffset + i * spriteBytes);
+	}
+	ring_->NotifyWritten(sizeof(float) * 16 + dataBytes);
+	statistics_.bytesWritten = dataBytes;
+
+	// ブレンドモードとテクスチャが続く範囲ごとに1回描画する
+	RenderCommandList* commandList = device_->GetCommandList();
+	uint64_t dataAddress = ring_->GetGpuAddress() + dataOffset;
+	PipelineHandle currentPipeline = kInvalidPipeline;
+	uint32_t begin = 0;
+	while (begin < spriteCount) {
+		RenderBlendMode blendMode = sprites_[order_[begin]].blendMode;
+		uint32_t texture = sprites_[order_[begin]].textureHandle;
+		uint32_t end = begin + 1;
+		while (end < spriteCount && sprites_[order_[end]].blendMode == blendMode && sprites_[order_[end]].textureHandle == texture) {
+			++end;
+		}
+		PipelineHandle pipeline = GetPipeline(blendMode);
+		if (pipeline == kInvalidPipeline) {
+			statistics_.droppedSprites += end - begin;
+		} else {
+			if (pipeline != currentPipeline) {
+				// SetPipelineでルートシグネチャが設定し直されるので、ルート引数はその後に設定する
+				commandList->SetPipeline(pipeline);
+				commandList->SetConstantBuffer(ring_->GetGpuAddress() + constantOffset);
+				if (mode_ == Mode::kVertex && currentPipeline == kInvalidPipeline) {
+					commandList->SetVertexBuffer({dataAddress, static_cast<uint32_t>(dataBytes), sizeof(Vertex)});
+					commandList->SetIndexBuffer({indexBuffer_->GetGpuAddress(), static_cast<uint32_t>(indexBuffer_->GetSize())});
+				}
+				currentPipeline = pipeline;
+			}
+			commandList->SetTexture(texture);
+			if (mode_ == Mode::kInstanced) {
+				// SV_InstanceIDは開始インスタンスを含まないので、範囲の先頭をバッファの位置で渡す
+				commandList->SetStructuredBuffer(dataAddress + size_t(begin) * sizeof(Instance));
+				commandList->DrawInstanced(kIndicesPerSprite, end - begin, 0, 0);
+			} else {
+				commandList->DrawIndexedInstanced((end - begin) * kIndicesPerSprite, 1, begin * kIndicesPerSprite, 0, 0);
+			}
+			statistics_.sprites += end - begin;
+			++statistics_.batches;
+		}
+		begin = end;
+	}
+	sprites_.clear();
+	sources_.clear();
+}
+
+void SpriteBatch::WriteSprite(const SpriteDesc& sprite, BatchSprite* source, uint32_t textureWidth, uint32_t textureHeight, uint8_t* destination) {
+	uint32_t dirtyFlag = mode_ == Mode::kInstanced ? BatchSprite::kDirtyInstance : BatchSprite::kDirtyVertices;
+	if (source) {
+		// テクスチャの大きさが変わればテクスチャ座標から作り直す
+		if (source->textureWidth_ != textureWidth || source->textureHeight_ != textureHeight) {
+			source->textureWidth_ = textureWidth;
+			source->textureHeight_ = textureHeight;
+			source->dirtyFlags_ |= BatchSprite::kDirtyVertices | BatchSprite::kDirtyInstance;
+		}
+		if (!(source->dirtyFlags_ & dirtyFlag)) {
+			if (mode_ == Mode::kInstanced) {
+				std::memcpy(destination, &source->instance_, sizeof(Instance));
+			} else {
+				std::memcpy(destination, source->vertices_, sizeof(source->vertices_));
+			}
+			return;
+		}
+	}
+
+	// 常駐スプライトは手元で作ってからコピーする(書き込み先はアップロード用のメモリなので読み返さない)
+	float uvRect[4];
+	CalculateUvRect(sprite, textureWidth, textureHeight, uvRect);
+	if (mode_ == Mode::kInstanced) {
+		Instance* instance = source ? &source->instance_ : reinterpret_cast<Instance*>(destination);
+		PackInstance(sprite, uvRect, *instance);
+		if (source) {
+			std::memcpy(destination, instance, sizeof(Instance));
+		}
+	} else {
+		Vertex* vertices = source ? source->vertices_ : reinterpret_cast<Vertex*>(destination);
+		WriteQuad(sprite, uvRect, vertices);
+		if (source) {
+			std::memcpy(destination, vertices, sizeof(source->vertices_));
+		}
+	}
+	if (source) {
+		source->dirtyFlags_ &= ~dirtyFlag;
+	}
+	++statistics_.rewrites;
+}
+
+void SpriteBatch::WriteQuad(const SpriteDesc& sprite, const float uvRect[4], Vertex* vertices) {
+	// アンカーポイントを原点とした四隅。反転は原点を挟んで入れ替える(Spriteと同じ)
+	float left = (0.0f - sprite.anchorPoint.x) * sprite.size.x;
+	float right = (1.0f - sprite.anchorPoint.x) * sprite.size.x;
+	float top = (0.0f - sprite.anchorPoint.y) * sprite.size.y;
+	float bottom = (1.0f - sprite.anchorPoint.y) * sprite.size.y;
+	if (sprite.isFlipX) {
+		left = -left;
+		right = -right;
+	}
+	if (sprite.isFlipY) {
+		top = -top;
+		bottom = -bottom;
+	}
+	float cosine = 1.0f;
+	float sine = 0.0f;
+	if (sprite.rotation != 0.0f) {
+		cosine = std::cos(sprite.rotation);
+		sine = std::sin(sprite.rotation);
+	}
+	const float u[4] = {uvRect[0], uvRect[0], uvRect[2], uvRect[2]};
+	const float v[4] = {uvRect[3], uvRect[1], uvRect[3], uvRect[1]};
+	float* out = vertices[0].position;
+
+#ifdef SPRITE_BATCH_USE_SSE2
+	// 4頂点分の回転と平行移動をまとめて行い、転置して頂点ごとの(x, y, z, u)にする
+	__m128 localX = _mm_setr_ps(left, left, right, right);
+	__m128 localY = _mm_setr_ps(bottom, top, bottom, top);
+	__m128 cosines = _mm_set1_ps(cosine);
+	__m128 sines = _mm_set1_ps(sine);
+	__m128 x = _mm_add_ps(_mm_set1_ps(sprite.position.x), _mm_sub_ps(_mm_mul_ps(localX, cosines), _mm_mul_ps(localY, sines)));
+	__m128 y = _mm_add_ps(_mm_set1_ps(sprite.position.y), _mm_add_ps(_mm_mul_ps(localX, sines), _mm_mul_ps(localY, cosines)));
+	__m128 z = _mm_setzero_ps();
+	__m128 us = _mm_loadu_ps(u);
+	_MM_TRANSPOSE4_PS(x, y, z, us);
+	const __m128 rows[4] = {x, y, z, us};
+	// 後半は(v, r, g, b)とa
+	__m128 color = _mm_loadu_ps(&sprite.color.x);
+	__m128 shiftedColor = _mm_shuffle_ps(color, color, _MM_SHUFFLE(2, 1, 0, 0));
+	for (int i = 0; i < 4; ++i) {
+		_mm_storeu_ps(out, rows[i]);
+		_mm_storeu_ps(out + 4, _mm_move_ss(shiftedColor, _mm_set_ss(v[i])));
+		out[8] = sprite.color.w;
+		out += 9;
+	}
+#else
+	const float localX[4] = {left, left, right, right};
+	const float localY[4] = {bottom, top, bottom, top};
+	for (int i = 0; i < 4; ++i) {
+		out[0] = sprite.position.x + (localX[i] * cosine - localY[i] * sine);
+		out[1] = sprite.position.y + (localX[i] * sine + localY[i] * cosine);
+		out[2] = 0.0f;
+		out[3] = u[i];
+		out[4] = v[i];
+		out[5] = sprite.color.x;
+		out[6] = sprite.color.y;
+		out[7] = sprite.color.z;
+		out[8] = sprite.color.w;
+		out += 9;
+	}
+#endif
+}
+
+void SpriteBatch::PackInstance(const SpriteDesc& sprite, const float uvRect[4], Instance& instance) {
+	instance.position[0] = sprite.position.x;
+	instance.position[1] = sprite.position.y;
+	instance.size[0] = sprite.size.x;
+	instance.size[1] = sprite.size.y;
+	instance.anchorPoint[0] = sprite.anchorPoint.x;
+	instance.anchorPoint[1] = sprite.anchorPoint.y;
+	instance.rotation = sprite.rotation;
+	instance.flags = (sprite.isFlipX ? 1u : 0u) | (sprite.isFlipY ? 2u : 0u);
+	for (int i = 0; i < 4; ++i) {
+		instance.uvRect[i] = FloatToUnorm16(uvRect[i]);
+	}
+	instance.color[0] = FloatToHalf(sprite.color.x);
+	instance.color[1] = FloatToHalf(sprite.color.y);
+	instance.color[2] = FloatToHalf(sprite.color.z);
+	instance.color[3] = FloatToHalf(sprite.color.w);
+}
+
+bool SpriteBatch::IsVisible(const SpriteDesc& sprite, float screenWidth, float screenHeight) {
+	float bounds[4];
+	CalculateBounds(sprite, bounds);
+	return IsInsideScreen(sprite.position, bounds, screenWidth, screenHeight);
+}
+
+PipelineHandle SpriteBatch::GetPipeline(RenderBlendMode blendMode) {
+	size_t index = static_cast<size_t>(blendMode);
+	if (!pipelineCreated_[index]) {
+		PipelineDesc desc;
+		desc.vertexShader = mode_ == Mode::kInstanced ? L"SpriteInstancedVS.hlsl" : L"SpriteBatchVS.hlsl";
+		desc.pixelShader = L"SpriteBatchPS.hlsl";
+		desc.inputLayout = mode_ == Mode::kInstanced ? InputLayout::kNone : InputLayout::kPosUvColor;
+		desc.blendMode = blendMode;
+		pipelines_[index] = device_->CreatePipeline(desc);
+		pipelineCreated_[index] = true;
+	}
+	return pipelines_[index];
+}
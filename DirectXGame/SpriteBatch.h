@@ -0,0 +1,227 @@
+#pragma once
+#include "RenderDevice.h"
+#include "UploadRingAllocator.h"
+#include "UploadRingBuffer.h"
+#include <cstdint>
+#include <map>
+#include <math\Vector2.h>
+#include <math\Vector4.h>
+#include <memory>
+#include <vector>
+
+class BatchSprite;
+
+/// <summary>
+/// スプライトのバッチ描画
+/// 1フレーム分のスプライトを溜めておき、Endでテクスチャとブレンドモードが同じものをまとめて
+/// 1つの動的バッファに書き込み、まとまりごとに1回だけ描画する。画面外のスプライトは溜める前に除く。
+/// バッファには変換済みの四角形の頂点か、GPUで四角形に展開するインスタンスのどちらかを書く
+/// </summary>
+class SpriteBatch {
+public:
+	// 既定の1フレームあたりのスプライト数の上限(頂点番号が16bitに収まる数。kVertexではこれが最大)
+	static constexpr uint32_t kDefaultMaxSprites = 16384;
+	// GPUの完了を待たずに書き込めるフレーム数
+	static constexpr uint32_t kBufferedFrames = 3;
+
+	/// <summary>
+	/// 四角形の作り方
+	/// </summary>
+	enum class Mode {
+		kVertex,    //!< CPUで4頂点に変換して書き込む
+		kInstanced, //!< 48バイトのインスタンスを書き込み、頂点シェーダで展開する
+	};
+
+	/// <summary>
+	/// 頂点(InputLayout::kPosUvColor)
+	/// </summary>
+	struct Vertex {
+		float position[3];
+		float uv[2];
+		float color[4];
+	};
+
+	/// <summary>
+	/// インスタンス(SpriteInstancedVS.hlslのSpriteInstanceと同じ並び)
+	/// </summary>
+	struct Instance {
+		float position[2];
+		float size[2];
+		float anchorPoint[2];
+		float rotation;
+		// bit0: 左右反転、bit1: 上下反転
+		uint32_t flags;
+		// テクスチャ座標の範囲(左、上、右、下)を0～65535で正規化した値
+		uint16_t uvRect[4];
+		// 色(RGBA)の半精度浮動小数点数
+		uint16_t color[4];
+	};
+
+	/// <summary>
+	/// スプライト1枚分の描画設定(項目と既定値はSpriteに合わせる)
+	/// </summary>
+	struct SpriteDesc {
+		uint32_t textureHandle = 0;
+		// 座標(画面の左上が原点)
+		KamataEngine::Vector2 position{};
+		// 回転角(ラジアン)
+		float rotation = 0.0f;
+		// 大きさ
+		KamataEngine::Vector2 size = {100.0f, 100.0f};
+		// アンカーポイント
+		KamataEngine::Vector2 anchorPoint = {0.0f, 0.0f};
+		// 色(RGBA)
+		KamataEngine::Vector4 color = {1.0f, 1.0f, 1.0f, 1.0f};
+		// テクスチャの切り出し範囲(画素単位)。texSizeが0ならテクスチャ全体
+		KamataEngine::Vector2 texBase = {0.0f, 0.0f};
+		KamataEngine::Vector2 texSize = {0.0f, 0.0f};
+		bool isFlipX = false;
+		bool isFlipY = false;
+		RenderBlendMode blendMode = RenderBlendMode::kNormal;
+		// 描画順。小さいレイヤーから描き、同じレイヤー内ではまとめやすい順に並べ替える
+		int32_t layer = 0;
+	};
+
+	/// <summary>
+	/// 統計(直近のEnd)
+	/// </summary>
+	struct Statistics {
+		// 描画したスプライト数
+		uint32_t sprites = 0;
+		// 描画回数
+		uint32_t batches = 0;
+		// 上限やリングの空き不足で描画できなかったスプライト数
+		uint32_t droppedSprites = 0;
+		// 画面外で除いたスプライト数
+		uint32_t culledSprites = 0;
+		// 頂点またはインスタンスの書き込みバイト数
+		size_t bytesWritten = 0;
+		// 頂点(インスタンス)を作り直したスプライト数。BatchSpriteは変わったときだけ数える
+		uint32_t rewrites = 0;
+	};
+
+	/// <summary>
+	/// コンストラクタ
+	/// </summary>
+	/// <param name="device">描画デバイス</param>
+	/// <param name="maxSprites">1フレームあたりのスプライト数の上限</param>
+	/// <param name="mode">四角形の作り方</param>
+	explicit SpriteBatch(RenderDevice* device, uint32_t maxSprites = kDefaultMaxSprites, Mode mode = Mode::kVertex);
+
+	/// <summary>
+	/// 画面の大きさの設定(射影行列に使う)
+	/// </summary>
+	/// <param name="width">幅</param>
+	/// <param name="height">高さ</param>
+	void SetScreenSize(float width, float height);
+
+	// 画面外のスプライトを除くかの設定
+	void SetCullingEnabled(bool cullingEnabled) { cullingEnabled_ = cullingEnabled; }
+
+	/// <summary>
+	/// 溜めたスプライトを破棄してフレームを始める
+	/// </summary>
+	void Begin();
+
+	/// <summary>
+	/// スプライトを溜める
+	/// </summary>
+	/// <param name="sprite">描画設定</param>
+	/// <returns>成否。上限を超えたらfalse(画面外で除いた場合はtrue)</returns>
+	bool Draw(const SpriteDesc& sprite);
+
+	/// <summary>
+	/// 常駐スプライトを溜める。Endまで破棄や変更をしないこと
+	/// </summary>
+	/// <param name="sprite">常駐スプライト。設定が変わっていればEndで頂点(インスタンス)を作り直す</param>
+	/// <returns>成否。上限を超えたらfalse(画面外で除いた場合はtrue)</returns>
+	bool Draw(BatchSprite& sprite);
+
+	/// <summary>
+	/// 溜めたスプライトを頂点に変換して描画を記録する(RenderDevice::BeginFrameとEndFrameの間)
+	/// </summary>
+	void End();
+
+	/// <summary>
+	/// スプライトの4頂点を書き込む(左下、左上、右下、右上の順)
+	/// </summary>
+	/// <param name="sprite">描画設定</param>
+	/// <param name="uvRect">テクスチャ座標の範囲(左、上、右、下)</param>
+	/// <param name="vertices">書き込み先(4頂点)</param>
+	static void WriteQuad(const SpriteDesc& sprite, const float uvRect[4], Vertex* vertices);
+
+	/// <summary>
+	/// スプライトをインスタンスに詰める
+	/// </summary>
+	/// <param name="sprite">描画設定</param>
+	/// <param name="uvRect">テクスチャ座標の範囲(左、上、右、下)</param>
+	/// <param name="instance">書き込み先</param>
+	static void PackInstance(const SpriteDesc& sprite, const float uvRect[4], Instance& instance);
+
+	/// <summary>
+	/// スプライトが画面に掛かるか。回転していれば外接円を囲む正方形で判定する
+	/// </summary>
+	/// <param name="sprite">描画設定</param>
+	/// <param name="screenWidth">画面の幅</param>
+	/// <param name="screenHeight">画面の高さ</param>
+	/// <returns>画面に掛かればtrue</returns>
+	static bool IsVisible(const SpriteDesc& sprite, float screenWidth, float screenHeight);
+
+	// 統計の取得
+	const Statistics& GetStatistics() const { return statistics_; }
+	// 溜めているスプライト数
+	uint32_t GetSpriteCount() const { return static_cast<uint32_t>(sprites_.size()); }
+
+private:
+	// まとめる単位(この順に描画する)
+	struct BatchKey {
+		int32_t layer;
+		RenderBlendMode blendMode;
+		uint32_t textureHandle;
+
+		bool operator==(const BatchKey& other) const { return layer == other.layer && blendMode == other.blendMode && textureHandle == other.textureHandle; }
+		bool operator<(const BatchKey& other) const {
+			return layer != other.layer ? layer < other.layer : blendMode != other.blendMode ? blendMode < other.blendMode : textureHandle < other.textureHandle;
+		}
+	};
+
+	// 溜める
+	bool Push(const SpriteDesc& sprite, BatchSprite* source);
+	// 1枚分の頂点(インスタンス)を書き込む。常駐スプライトは変わっていなければ持っているものをコピーする
+	void WriteSprite(const SpriteDesc& sprite, BatchSprite* source, uint32_t textureWidth, uint32_t textureHeight, uint8_t* destination);
+	// 共通のインデックスを転送用のリングに書き込み、コピーを予約する
+	bool UploadIndices();
+	// ブレンドモードに応じたパイプライン(初めて使うときに生成する)
+	PipelineHandle GetPipeline(RenderBlendMode blendMode);
+
+	RenderDevice* device_;
+	uint32_t maxSprites_;
+	Mode mode_;
+	// 頂点またはインスタンスと定数バッファを切り出すリング(kBufferedFrames分)
+	std::unique_ptr<RenderBuffer> ring_;
+	UploadRingAllocator allocator_;
+	// 全スプライト共通のインデックス(kVertexのみ)
+	std::unique_ptr<RenderBuffer> indexBuffer_;
+	// インデックスの転送(GPUがコピーを終えたら解放する)
+	std::unique_ptr<UploadRingBuffer> indexUpload_;
+	bool indexUploaded_ = false;
+	PipelineHandle pipelines_[static_cast<size_t>(RenderBlendMode::kCount)];
+	// パイプラインの生成を試みたか(シェーダのエラーで毎フレーム作り直さないように)
+	bool pipelineCreated_[static_cast<size_t>(RenderBlendMode::kCount)] = {};
+	float screenWidth_;
+	float screenHeight_;
+	bool cullingEnabled_ = true;
+
+	std::vector<SpriteDesc> sprites_;
+	// スプライトごとの常駐スプライト(SpriteDescで溜めたものはnullptr)
+	std::vector<BatchSprite*> sources_;
+	// まとまりごとのスプライト数。並べ替えは比較ソートをせず、まとまりの数え上げで行う
+	std::map<BatchKey, uint32_t> batchCounts_;
+	// スプライトごとのまとまりの書き込み位置
+	std::vector<uint32_t*> spriteBatches_;
+	// 描画順のスプライト番号
+	std::vector<uint32_t> order_;
+	Statistics statistics_;
+	uint32_t droppedSprites_ = 0;
+	uint32_t culledSprites_ = 0;
+};
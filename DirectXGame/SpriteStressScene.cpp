@@ -0,0 +1,62 @@
+#include "SpriteStressScene.h"
+#include "GameLoop.h"
+#include <base\WinApp.h>
+
+using namespace KamataEngine;
+
+namespace {
+
+// 実行のたびに同じ配置にするための乱数(線形合同法)
+float NextRandom(uint32_t& state) {
+	state = state * 1664525u + 1013904223u;
+	return static_cast<float>(state >> 8) / static_cast<float>(1u << 24);
+}
+
+} // namespace
+
+SpriteStressScene::SpriteStressScene(uint32_t spriteCount, SpriteBatch::Mode mode) : spriteCount_(spriteCount), mode_(mode) {}
+
+void SpriteStressScene::Initialize(RenderDevice* renderDevice) {
+	spriteBatch_ = std::make_unique<SpriteBatch>(renderDevice, spriteCount_, mode_);
+	sprites_.assign(spriteCount_, BatchSprite());
+	velocities_.resize(spriteCount_);
+	uint32_t state = 12345;
+	for (uint32_t i = 0; i < spriteCount_; ++i) {
+		BatchSprite& sprite = sprites_[i];
+		sprite.SetTextureHandle(1 + i % kTextureCount);
+		sprite.SetPosition({NextRandom(state) * WinApp::kWindowWidth, NextRandom(state) * WinApp::kWindowHeight});
+		sprite.SetSize({16.0f, 16.0f});
+		sprite.SetAnchorPoint({0.5f, 0.5f});
+		sprite.SetColor({NextRandom(state), NextRandom(state), NextRandom(state), 1.0f});
+		velocities_[i] = {(NextRandom(state) - 0.5f) * 400.0f, (NextRandom(state) - 0.5f) * 400.0f};
+	}
+}
+
+void SpriteStressScene::Update() {
+	// 1/4は止めておき、変わらないスプライトの書き込みがコピーだけになるところも通す
+	const float deltaTime = GameLoop::GetInstance()->GetFixedDeltaTime();
+	for (uint32_t i = 0; i < spriteCount_; ++i) {
+		if (i % 4 == 0) {
+			continue;
+		}
+		Vector2 position = sprites_[i].GetPosition();
+		Vector2& velocity = velocities_[i];
+		position.x += velocity.x * deltaTime;
+		position.y += velocity.y * deltaTime;
+		if (position.x < 0.0f || position.x > WinApp::kWindowWidth) {
+			velocity.x = -velocity.x;
+		}
+		if (position.y < 0.0f || position.y > WinApp::kWindowHeight) {
+			velocity.y = -velocity.y;
+		}
+		sprites_[i].SetPosition(position);
+	}
+}
+
+void SpriteStressScene::Draw() {
+	spriteBatch_->Begin();
+	for (BatchSprite& sprite : sprites_) {
+		spriteBatch_->Draw(sprite);
+	}
+	spriteBatch_->End();
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "BatchSprite.h"
+#include "Scene.h"
+#include "SpriteBatch.h"
+#include <memory>
+#include <vector>
+
+/// <summary>
+/// スプライトの負荷シーン
+/// 画面内を跳ね回る多数のスプライトをSpriteBatchで描く。エンジンに依存しないので、ヘッドレス実行の計測に使う
+/// </summary>
+class SpriteStressScene : public Scene {
+public:
+	// 既定のスプライト数
+	static constexpr uint32_t kDefaultSpriteCount = 10000;
+	// 使い分けるテクスチャの数(まとまりの数)
+	static constexpr uint32_t kTextureCount = 4;
+
+	/// <summary>
+	/// コンストラクタ
+	/// </summary>
+	/// <param name="spriteCount">スプライト数</param>
+	/// <param name="mode">四角形の作り方</param>
+	explicit SpriteStressScene(uint32_t spriteCount = kDefaultSpriteCount, SpriteBatch::Mode mode = SpriteBatch::Mode::kInstanced);
+
+	void Initialize(RenderDevice* renderDevice) override;
+	void Update() override;
+	void Draw() override;
+
+	// 直近の描画の統計の取得
+	const SpriteBatch::Statistics& GetStatistics() const { return spriteBatch_->GetStatistics(); }
+
+private:
+	uint32_t spriteCount_;
+	SpriteBatch::Mode mode_;
+	std::unique_ptr<SpriteBatch> spriteBatch_;
+	std::vector<BatchSprite> sprites_;
+	// スプライトごとの速度(ピクセル/秒)
+	std::vector<KamataEngine::Vector2> velocities_;
+};
@@ -0,0 +1,77 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/// <summary>
+/// 単一の送り手と単一の受け手の間のロックフリーなキュー
+/// 送り手はTryPush、受け手はTryPopだけを呼ぶ。どちらも待たずに失敗を返す
+/// </summary>
+template<typename T> class SpscQueue {
+public:
+	/// <summary>
+	/// コンストラクタ
+	/// </summary>
+	/// <param name="capacity">入れておける要素数(2のべき乗に切り上げる)</param>
+	explicit SpscQueue(size_t capacity) {
+		size_t size = 1;
+		while (size < capacity) {
+			size <<= 1;
+		}
+		buffer_.resize(size);
+		mask_ = size - 1;
+	}
+
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	/// <summary>
+	/// 末尾に追加(送り手のスレッドから呼ぶ)
+	/// </summary>
+	/// <param name="value">追加する値。失敗したときは移動しない</param>
+	/// <returns>満杯ならfalse</returns>
+	bool TryPush(T&& value) {
+		size_t tail = tail_.load(std::memory_order_relaxed);
+		if (tail - head_.load(std::memory_order_acquire) > mask_) {
+			return false;
+		}
+		buffer_[tail & mask_] = std::move(value);
+		tail_.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	/// <summary>
+	/// 先頭を取り出す(受け手のスレッドから呼ぶ)
+	/// </summary>
+	/// <param name="value">取り出し先</param>
+	/// <returns>空ならfalse</returns>
+	bool TryPop(T& value) {
+		size_t head = head_.load(std::memory_order_relaxed);
+		if (head == tail_.load(std::memory_order_acquire)) {
+			return false;
+		}
+		// 要素が持つ参照はここで手放す
+		value = std::move(buffer_[head & mask_]);
+		buffer_[head & mask_] = T();
+		head_.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// 入れておける要素数
+	size_t GetCapacity() const { return mask_ + 1; }
+
+private:
+	// キャッシュラインの大きさ
+	static constexpr size_t kCacheLineSize = 64;
+
+	std::vector<T> buffer_;
+	size_t mask_ = 0;
+	// 受け手と送り手が別々に書き換えるので、キャッシュラインを分ける。
+	// alignasで揃えるとこのクラスを持つクラスまで詰め物の警告(C4324)が出るので、間を埋めて離す
+	char headPadding_[kCacheLineSize] = {};
+	std::atomic<size_t> head_{0};
+	char tailPadding_[kCacheLineSize - sizeof(std::atomic<size_t>)] = {};
+	std::atomic<size_t> tail_{0};
+	char endPadding_[kCacheLineSize - sizeof(std::atomic<size_t>)] = {};
+};
@@ -0,0 +1,247 @@
+#include "StreamingAudio.h"
+#include "PcmSound.h"
+#include <cassert>
+#include <vector>
+
+#pragma comment(lib, "xaudio2.lib")
+
+/// <summary>
+/// 1本のストリーム(ソースボイスとバッファリング)
+/// </summary>
+class StreamingAudio::Stream : public StreamingVoice, public IXAudio2VoiceCallback {
+public:
+	explicit Stream(std::condition_variable* dataNeeded) : dataNeeded_(dataNeeded) {}
+
+	bool Create(IXAudio2* xAudio2, std::unique_ptr<AudioStreamSource> source, bool loop, uint32_t bufferCount, size_t bufferSize) {
+		// 拡張部分を含めたWAVEFORMATEXを組み立てる
+		const WaveFormat& format = source->GetFormat();
+		std::vector<uint8_t> formatBytes(sizeof(WAVEFORMATEX) + format.extra.size());
+		WAVEFORMATEX* wfex = reinterpret_cast<WAVEFORMATEX*>(formatBytes.data());
+		wfex->wFormatTag = format.formatTag;
+		wfex->nChannels = format.channels;
+		wfex->nSamplesPerSec = format.sampleRate;
+		wfex->nAvgBytesPerSec = format.avgBytesPerSec;
+		wfex->nBlockAlign = format.blockAlign;
+		wfex->wBitsPerSample = format.bitsPerSample;
+		wfex->cbSize = static_cast<WORD>(format.extra.size());
+		std::copy(format.extra.begin(), format.extra.end(), formatBytes.begin() + sizeof(WAVEFORMATEX));
+
+		if (FAILED(xAudio2->CreateSourceVoice(&voice_, wfex, 0, XAUDIO2_DEFAULT_FREQ_RATIO, this))) {
+			return false;
+		}
+		ring_ = std::make_unique<StreamingRing>(std::move(source), this, loop, bufferCount, bufferSize);
+		return true;
+	}
+
+	void Destroy() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (voice_) {
+			// コールバックが終わるまで戻らない
+			voice_->DestroyVoice();
+			voice_ = nullptr;
+		}
+	}
+
+	// 読み出しスレッドから呼ぶ
+	void Pump() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (voice_) {
+			ring_->Pump();
+		}
+	}
+
+	IXAudio2SourceVoice* GetVoice() const { return voice_; }
+	bool NeedsData() const { return ring_->NeedsData(); }
+	bool IsFinished() const { return ring_->IsFinished(); }
+
+	bool SubmitBuffer(const uint8_t* data, size_t size, void* context, bool endOfStream) override {
+		XAUDIO2_BUFFER buffer{};
+		buffer.AudioBytes = static_cast<UINT32>(size);
+		buffer.pAudioData = data;
+		buffer.pContext = context;
+		buffer.Flags = endOfStream ? XAUDIO2_END_OF_STREAM : 0;
+		return SUCCEEDED(voice_->SubmitSourceBuffer(&buffer));
+	}
+
+	STDMETHOD_(void, OnVoiceProcessingPassStart)(THIS_ UINT32) override {}
+	STDMETHOD_(void, OnVoiceProcessingPassEnd)(THIS) override {}
+	STDMETHOD_(void, OnStreamEnd)(THIS) override {}
+	STDMETHOD_(void, OnBufferStart)(THIS_ void*) override {}
+	// バッファを返して読み出しスレッドを起こす(音声処理スレッドなのでロックは取らない)
+	STDMETHOD_(void, OnBufferEnd)(THIS_ void* pBufferContext) override {
+		ring_->OnBufferEnd(pBufferContext);
+		dataNeeded_->notify_one();
+	}
+	STDMETHOD_(void, OnLoopEnd)(THIS_ void*) override {}
+	STDMETHOD_(void, OnVoiceError)(THIS_ void*, HRESULT) override {}
+
+private:
+	std::condition_variable* dataNeeded_;
+	// Pumpと破棄の排他
+	std::mutex mutex_;
+	IXAudio2SourceVoice* voice_ = nullptr;
+	std::unique_ptr<StreamingRing> ring_;
+};
+
+StreamingAudio* StreamingAudio::GetInstance() {
+	static StreamingAudio instance;
+	return &instance;
+}
+
+void StreamingAudio::Initialize(const std::string& directoryPath) {
+	directoryPath_ = directoryPath;
+	HRESULT result = XAudio2Create(&xAudio2_, 0, XAUDIO2_DEFAULT_PROCESSOR);
+	assert(SUCCEEDED(result));
+	result = xAudio2_->CreateMasteringVoice(&masteringVoice_);
+	assert(SUCCEEDED(result));
+
+	stopping_ = false;
+	ioThread_ = std::thread([this] { IoThreadMain(); });
+}
+
+void StreamingAudio::Finalize() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = true;
+	}
+	dataNeeded_.notify_all();
+	if (ioThread_.joinable()) {
+		ioThread_.join();
+	}
+
+	for (auto& [handle, stream] : streams_) {
+		stream->Destroy();
+	}
+	streams_.clear();
+	if (masteringVoice_) {
+		masteringVoice_->DestroyVoice();
+		masteringVoice_ = nullptr;
+	}
+	xAudio2_.Reset();
+}
+
+uint32_t StreamingAudio::Play(const std::string& fileName, bool loopFlag, float volume) {
+	// IMA-ADPCMは読み出しスレッドでデコードしながら流す
+	std::unique_ptr<AudioStreamSource> source = OpenSoundStream(directoryPath_ + fileName);
+	if (!source) {
+		return kInvalidHandle;
+	}
+	return Play(std::move(source), loopFlag, volume);
+}
+
+uint32_t StreamingAudio::Play(std::unique_ptr<AudioStreamSource> source, bool loopFlag, float volume, uint32_t bufferCount, size_t bufferSize) {
+	auto stream = std::make_shared<Stream>(&dataNeeded_);
+	if (!stream->Create(xAudio2_.Get(), std::move(source), loopFlag, bufferCount, bufferSize)) {
+		return kInvalidHandle;
+	}
+	// 最初のバッファを埋めてから再生を始める
+	stream->Pump();
+	stream->GetVoice()->SetVolume(volume);
+	stream->GetVoice()->Start();
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	uint32_t handle = nextHandle_++;
+	streams_[handle] = std::move(stream);
+	return handle;
+}
+
+void StreamingAudio::Update() {
+	std::vector<std::shared_ptr<Stream>> finished;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (auto it = streams_.begin(); it != streams_.end();) {
+			if (it->second->IsFinished()) {
+				finished.push_back(std::move(it->second));
+				it = streams_.erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+	// DestroyVoiceはコールバックを待つので、ロックの外で行う
+	for (const std::shared_ptr<Stream>& stream : finished) {
+		stream->Destroy();
+	}
+}
+
+void StreamingAudio::Stop(uint32_t handle) {
+	std::shared_ptr<Stream> stream;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = streams_.find(handle);
+		if (it == streams_.end()) {
+			return;
+		}
+		stream = std::move(it->second);
+		streams_.erase(it);
+	}
+	stream->Destroy();
+}
+
+bool StreamingAudio::IsPlaying(uint32_t handle) {
+	std::shared_ptr<Stream> stream = Find(handle);
+	return stream && !stream->IsFinished();
+}
+
+void StreamingAudio::Pause(uint32_t handle) {
+	if (std::shared_ptr<Stream> stream = Find(handle)) {
+		stream->GetVoice()->Stop();
+	}
+}
+
+void StreamingAudio::Resume(uint32_t handle) {
+	if (std::shared_ptr<Stream> stream = Find(handle)) {
+		stream->GetVoice()->Start();
+	}
+}
+
+void StreamingAudio::SetVolume(uint32_t handle, float volume) {
+	if (std::shared_ptr<Stream> stream = Find(handle)) {
+		stream->GetVoice()->SetVolume(volume);
+	}
+}
+
+uint32_t StreamingAudio::GetStreamCount() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return static_cast<uint32_t>(streams_.size());
+}
+
+std::shared_ptr<StreamingAudio::Stream> StreamingAudio::Find(uint32_t handle) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto it = streams_.find(handle);
+	return it != streams_.end() ? it->second : nullptr;
+}
+
+void StreamingAudio::IoThreadMain() {
+	std::vector<std::shared_ptr<Stream>> pending;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			// 通知はロックを取らずに送られるので、取りこぼしに備えて短い間隔でも見直す
+			dataNeeded_.wait_for(lock, std::chrono::milliseconds(10), [this] {
+				if (stopping_) {
+					return true;
+				}
+				for (auto& [handle, stream] : streams_) {
+					if (stream->NeedsData()) {
+						return true;
+					}
+				}
+				return false;
+			});
+			if (stopping_) {
+				return;
+			}
+			pending.clear();
+			for (auto& [handle, stream] : streams_) {
+				if (stream->NeedsData()) {
+					pending.push_back(stream);
+				}
+			}
+		}
+		// ファイルの読み出しはロックの外で行う
+		for (const std::shared_ptr<Stream>& stream : pending) {
+			stream->Pump();
+		}
+	}
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include "StreamingRing.h"
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <wrl.h>
+#include <xaudio2.h>
+
+/// <summary>
+/// 長い曲のストリーミング再生
+/// WAVを丸ごと読み込まず、読み出しスレッドで少しずつ読んでXAudio2のソースボイスに投入する。
+/// AudioのXAudio2インスタンスは外から使えないので、専用のインスタンスとマスターボイスを持つ
+/// </summary>
+class StreamingAudio {
+public:
+	// 無効な再生ハンドル
+	static const uint32_t kInvalidHandle = UINT32_MAX;
+
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static StreamingAudio* GetInstance();
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="directoryPath">サウンド格納ディレクトリ(Audioと同じ)</param>
+	void Initialize(const std::string& directoryPath = "Resources/");
+
+	/// <summary>
+	/// 終了処理
+	/// </summary>
+	void Finalize();
+
+	/// <summary>
+	/// WAVファイルのストリーミング再生
+	/// </summary>
+	/// <param name="fileName">WAVファイル名(リニアPCMかIMA-ADPCM)</param>
+	/// <param name="loopFlag">ループ再生フラグ</param>
+	/// <param name="volume">ボリューム</param>
+	/// <returns>再生ハンドル。失敗時はkInvalidHandle</returns>
+	uint32_t Play(const std::string& fileName, bool loopFlag = false, float volume = 1.0f);
+
+	/// <summary>
+	/// 音源を指定したストリーミング再生
+	/// </summary>
+	/// <param name="source">音源</param>
+	/// <param name="loopFlag">ループ再生フラグ</param>
+	/// <param name="volume">ボリューム</param>
+	/// <param name="bufferCount">バッファ数(2以上)</param>
+	/// <param name="bufferSize">バッファのバイト数。小さくするほど遅延が減る</param>
+	/// <returns>再生ハンドル。失敗時はkInvalidHandle</returns>
+	uint32_t Play(std::unique_ptr<AudioStreamSource> source, bool loopFlag = false, float volume = 1.0f, uint32_t bufferCount = StreamingRing::kDefaultBufferCount,
+	              size_t bufferSize = StreamingRing::kDefaultBufferSize);
+
+	/// <summary>
+	/// 毎フレームの更新。再生し終えたボイスを片付ける
+	/// </summary>
+	void Update();
+
+	// 停止
+	void Stop(uint32_t handle);
+	// 再生中か(一時停止中を含む)
+	bool IsPlaying(uint32_t handle);
+	// 一時停止
+	void Pause(uint32_t handle);
+	// 一時停止からの再開
+	void Resume(uint32_t handle);
+	// 音量設定
+	void SetVolume(uint32_t handle, float volume);
+
+	// 再生中のストリーム数
+	uint32_t GetStreamCount();
+
+private:
+	class Stream;
+
+	StreamingAudio() = default;
+	~StreamingAudio() = default;
+	StreamingAudio(const StreamingAudio&) = delete;
+	const StreamingAudio& operator=(const StreamingAudio&) = delete;
+
+	// 読み出しスレッドの処理
+	void IoThreadMain();
+	// ストリームの取得
+	std::shared_ptr<Stream> Find(uint32_t handle);
+
+	Microsoft::WRL::ComPtr<IXAudio2> xAudio2_;
+	IXAudio2MasteringVoice* masteringVoice_ = nullptr;
+	std::string directoryPath_;
+
+	std::thread ioThread_;
+	std::mutex mutex_;
+	std::condition_variable dataNeeded_;
+	bool stopping_ = false;
+	std::unordered_map<uint32_t, std::shared_ptr<Stream>> streams_;
+	uint32_t nextHandle_ = 0;
+};
@@ -0,0 +1,84 @@
+#include "StreamingRing.h"
+#include <algorithm>
+
+StreamingRing::StreamingRing(std::unique_ptr<AudioStreamSource> source, StreamingVoice* voice, bool loop, uint32_t bufferCount, size_t bufferSize)
+    : source_(std::move(source)), voice_(voice), loop_(loop), freeCount_(bufferCount < 2 ? 2 : bufferCount) {
+	// 音源はブロック境界でしか返さないので、バッファもブロックの倍数にする(最低1ブロック)
+	size_t blockAlign = (std::max)(static_cast<size_t>(source_->GetFormat().blockAlign), size_t(1));
+	bufferSize = (std::max)(bufferSize / blockAlign, size_t(1)) * blockAlign;
+	buffers_.resize(freeCount_);
+	for (std::vector<uint8_t>& buffer : buffers_) {
+		buffer.resize(bufferSize);
+	}
+}
+
+uint32_t StreamingRing::Pump() {
+	uint32_t submitted = 0;
+	size_t blockAlign = (std::max)(static_cast<size_t>(GetFormat().blockAlign), size_t(1));
+	// 再生し終えたバッファは投入した順に戻ってくるので、先頭から順に埋めればよい
+	while (!endOfStream_ && freeCount_.load() > 0) {
+		std::vector<uint8_t>& buffer = buffers_[nextBuffer_];
+		size_t filled = 0;
+		bool endOfStream = false;
+		// 残りが1ブロックに満たなければ音源は0を返すので、終端と区別するためそこで投入する
+		// (ループで終端の短いブロックの後に先頭から埋めると、残りがブロック境界からずれる)
+		while (buffer.size() - filled >= blockAlign) {
+			size_t read = source_->Read(buffer.data() + filled, buffer.size() - filled);
+			if (read > 0) {
+				filled += read;
+				continue;
+			}
+			// 終端。ループならバッファの残りを先頭から埋める
+			if (!loop_ || !source_->Rewind()) {
+				endOfStream = true;
+				break;
+			}
+			read = source_->Read(buffer.data() + filled, buffer.size() - filled);
+			if (read == 0) {
+				// 空の音源はループさせない
+				endOfStream = true;
+				break;
+			}
+			filled += read;
+		}
+
+		if (filled == 0) {
+			// 直前に投入したバッファで終わっていた。最後の印を付けるため空のバッファは出さない
+			endOfStream_ = true;
+			break;
+		}
+
+		--freeCount_;
+		++queuedCount_;
+		if (endOfStream) {
+			endOfStream_ = true;
+		}
+		if (!voice_->SubmitBuffer(buffer.data(), filled, reinterpret_cast<void*>(static_cast<uintptr_t>(nextBuffer_)), endOfStream)) {
+			++freeCount_;
+			--queuedCount_;
+			endOfStream_ = true;
+			break;
+		}
+		nextBuffer_ = (nextBuffer_ + 1) % static_cast<uint32_t>(buffers_.size());
+		++submitted;
+		buffersSubmitted_.fetch_add(1, std::memory_order_relaxed);
+		bytesStreamed_.fetch_add(filled, std::memory_order_relaxed);
+	}
+	return submitted;
+}
+
+void StreamingRing::OnBufferEnd(void*) {
+	uint32_t queued = --queuedCount_;
+	++freeCount_;
+	if (queued == 0 && !endOfStream_) {
+		underruns_.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+StreamingRing::Statistics StreamingRing::GetStatistics() const {
+	Statistics statistics;
+	statistics.buffersSubmitted = buffersSubmitted_.load(std::memory_order_relaxed);
+	statistics.bytesStreamed = bytesStreamed_.load(std::memory_order_relaxed);
+	statistics.underruns = underruns_.load(std::memory_order_relaxed);
+	return statistics;
+}
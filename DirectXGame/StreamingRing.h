@@ -0,0 +1,95 @@
+#pragma once
+#include "AudioStreamSource.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/// <summary>
+/// ストリーミング再生の出力先(XAudio2のソースボイスなど)
+/// </summary>
+class StreamingVoice {
+public:
+	virtual ~StreamingVoice() = default;
+
+	/// <summary>
+	/// バッファの投入。再生し終えたらStreamingRing::OnBufferEndにcontextを渡して呼ぶこと
+	/// </summary>
+	/// <param name="data">波形データ(OnBufferEndまで有効)</param>
+	/// <param name="size">バイト数</param>
+	/// <param name="context">バッファの識別子</param>
+	/// <param name="endOfStream">最後のバッファか</param>
+	/// <returns>成否</returns>
+	virtual bool SubmitBuffer(const uint8_t* data, size_t size, void* context, bool endOfStream) = 0;
+};
+
+/// <summary>
+/// ストリーミング再生のバッファリング
+/// 少数のバッファを順に音源から埋めて出力先に投入し、再生し終えたバッファを再利用する。
+/// Pumpは読み出しスレッド、OnBufferEndは出力先のコールバックスレッドから呼ぶ
+/// </summary>
+class StreamingRing {
+public:
+	// 既定のバッファ数
+	static const uint32_t kDefaultBufferCount = 3;
+	// 既定のバッファのバイト数
+	static const size_t kDefaultBufferSize = 64 * 1024;
+
+	/// <summary>
+	/// 統計
+	/// </summary>
+	struct Statistics {
+		uint64_t buffersSubmitted = 0;
+		uint64_t bytesStreamed = 0;
+		// 再生待ちのバッファが尽きた回数
+		uint64_t underruns = 0;
+	};
+
+	/// <summary>
+	/// コンストラクタ
+	/// </summary>
+	/// <param name="source">音源</param>
+	/// <param name="voice">出力先</param>
+	/// <param name="loop">ループ再生するか</param>
+	/// <param name="bufferCount">バッファ数(2以上)</param>
+	/// <param name="bufferSize">バッファのバイト数(音源のblockAlignの倍数に切り下げる)</param>
+	StreamingRing(std::unique_ptr<AudioStreamSource> source, StreamingVoice* voice, bool loop, uint32_t bufferCount = kDefaultBufferCount, size_t bufferSize = kDefaultBufferSize);
+
+	/// <summary>
+	/// 空いているバッファを音源から埋めて投入する(読み出しスレッドから呼ぶ)
+	/// </summary>
+	/// <returns>投入したバッファ数</returns>
+	uint32_t Pump();
+
+	/// <summary>
+	/// バッファの再生終了の通知(出力先のコールバックから呼ぶ)
+	/// </summary>
+	/// <param name="context">SubmitBufferに渡した識別子</param>
+	void OnBufferEnd(void* context);
+
+	// 空いているバッファがあり、まだ投入するデータがあるか
+	bool NeedsData() const { return !endOfStream_ && freeCount_.load() > 0; }
+	// 最後のバッファまで再生し終えたか
+	bool IsFinished() const { return endOfStream_ && queuedCount_.load() == 0; }
+	// 音源の形式
+	const WaveFormat& GetFormat() const { return source_->GetFormat(); }
+	// 統計の取得
+	Statistics GetStatistics() const;
+
+private:
+	std::unique_ptr<AudioStreamSource> source_;
+	StreamingVoice* voice_;
+	bool loop_;
+	// バッファ(先頭から順に使い回す)
+	std::vector<std::vector<uint8_t>> buffers_;
+	// 次に埋めるバッファ
+	uint32_t nextBuffer_ = 0;
+	// 空いているバッファ数と再生待ちのバッファ数
+	std::atomic<uint32_t> freeCount_;
+	std::atomic<uint32_t> queuedCount_ = 0;
+	std::atomic<bool> endOfStream_ = false;
+	// 統計(OnBufferEndは出力先のコールバックスレッドなのでロックを取らない)
+	std::atomic<uint64_t> buffersSubmitted_{0};
+	std::atomic<uint64_t> bytesStreamed_{0};
+	std::atomic<uint64_t> underruns_{0};
+};
@@ -0,0 +1,170 @@
+#include "TextureAtlas.h"
+#include "TextureRegistry.h"
+#include <DirectXTex.h>
+#include <base\StringUtility.h>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using namespace KamataEngine;
+
+namespace {
+
+const char kAtlasDirectory[] = "atlas/";
+
+// ページ画像のファイル名(ディレクトリからの相対)
+std::string MakePageFileName(const std::string& name, uint32_t page) { return std::string(kAtlasDirectory) + name + "_" + std::to_string(page) + ".png"; }
+
+// 配置表のファイル名(ディレクトリからの相対)
+std::string MakeManifestFileName(const std::string& name) { return std::string(kAtlasDirectory) + name + ".atlas"; }
+
+double ElapsedMilliseconds(std::chrono::steady_clock::time_point begin) { return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count(); }
+
+} // namespace
+
+bool TextureAtlas::Build(
+    const std::string& name, const std::vector<std::string>& fileNames, uint32_t pageSize, uint32_t padding, const std::string& directoryPath, BuildStatistics* statistics) {
+	auto buildBegin = std::chrono::steady_clock::now();
+
+	// すべての画像をRGBA8にデコードする。sRGBの画像をUNORMに変換すると線形化されて暗くなるので、
+	// 色空間の指定は無視して保存されている値のまま扱う(ページも同じ値で書き出す)
+	std::vector<DirectX::ScratchImage> images(fileNames.size());
+	std::vector<AtlasPacker::Size> sizes(fileNames.size());
+	for (size_t i = 0; i < fileNames.size(); ++i) {
+		std::wstring filePath = ConvertStringMultiByteToWide(directoryPath + fileNames[i]);
+		DirectX::TexMetadata metadata{};
+		DirectX::ScratchImage decoded{};
+		HRESULT result = DirectX::LoadFromWICFile(filePath.c_str(), DirectX::WIC_FLAGS_IGNORE_SRGB, &metadata, decoded);
+		if (FAILED(result)) {
+			return false;
+		}
+		if (metadata.format == DXGI_FORMAT_R8G8B8A8_UNORM) {
+			images[i] = std::move(decoded);
+		} else {
+			result = DirectX::Convert(*decoded.GetImage(0, 0, 0), DXGI_FORMAT_R8G8B8A8_UNORM, DirectX::TEX_FILTER_DEFAULT, DirectX::TEX_THRESHOLD_DEFAULT, images[i]);
+			if (FAILED(result)) {
+				return false;
+			}
+		}
+		sizes[i] = {static_cast<uint32_t>(metadata.width), static_cast<uint32_t>(metadata.height)};
+	}
+
+	auto packBegin = std::chrono::steady_clock::now();
+	AtlasPacker::Result packed = AtlasPacker::Pack(sizes, pageSize, pageSize, padding);
+	double packMilliseconds = ElapsedMilliseconds(packBegin);
+	if (!packed.succeeded) {
+		return false;
+	}
+
+	// ページを合成して書き出す
+	std::filesystem::create_directories(directoryPath + kAtlasDirectory);
+	for (uint32_t page = 0; page < packed.pageCount; ++page) {
+		DirectX::ScratchImage pageImage{};
+		if (FAILED(pageImage.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, pageSize, pageSize, 1, 1))) {
+			return false;
+		}
+		const DirectX::Image* target = pageImage.GetImage(0, 0, 0);
+		std::memset(target->pixels, 0, target->slicePitch);
+		for (size_t i = 0; i < images.size(); ++i) {
+			if (packed.placements[i].page == page) {
+				AtlasPacker::Blit(target->pixels, pageSize, pageSize, images[i].GetPixels(), packed.placements[i], padding);
+			}
+		}
+		std::wstring pagePath = ConvertStringMultiByteToWide(directoryPath + MakePageFileName(name, page));
+		if (FAILED(DirectX::SaveToWICFile(*target, DirectX::WIC_FLAGS_NONE, DirectX::GetWICCodec(DirectX::WIC_CODEC_PNG), pagePath.c_str()))) {
+			return false;
+		}
+	}
+
+	// 配置表: 1行目にページ数、以降は「ページ x y 幅 高さ ファイル名」
+	std::ofstream manifest(directoryPath + MakeManifestFileName(name));
+	if (!manifest) {
+		return false;
+	}
+	manifest << packed.pageCount << "\n";
+	for (size_t i = 0; i < fileNames.size(); ++i) {
+		const AtlasPacker::Placement& placement = packed.placements[i];
+		manifest << placement.page << " " << placement.x << " " << placement.y << " " << placement.width << " " << placement.height << " " << fileNames[i] << "\n";
+	}
+
+	if (statistics) {
+		statistics->imageCount = static_cast<uint32_t>(fileNames.size());
+		statistics->pageCount = packed.pageCount;
+		statistics->efficiency = packed.efficiency;
+		statistics->packMilliseconds = packMilliseconds;
+		statistics->totalMilliseconds = ElapsedMilliseconds(buildBegin);
+	}
+	return true;
+}
+
+bool TextureAtlas::Load(const std::string& name, const std::string& directoryPath) {
+	std::ifstream manifest(directoryPath + MakeManifestFileName(name));
+	if (!manifest) {
+		return false;
+	}
+	uint32_t pageCount = 0;
+	manifest >> pageCount;
+
+	for (uint32_t pageHandle : pageHandles_) {
+		TextureRegistry::Unload(pageHandle);
+	}
+	pageHandles_.clear();
+	regions_.clear();
+	for (uint32_t page = 0; page < pageCount; ++page) {
+		pageHandles_.push_back(TextureRegistry::Load(MakePageFileName(name, page)));
+	}
+
+	std::string line;
+	while (std::getline(manifest, line)) {
+		std::istringstream stream(line);
+		uint32_t page = 0, x = 0, y = 0, width = 0, height = 0;
+		if (!(stream >> page >> x >> y >> width >> height) || page >= pageCount) {
+			continue;
+		}
+		std::string fileName;
+		std::getline(stream >> std::ws, fileName);
+
+		Region& region = regions_[fileName];
+		region.textureHandle = pageHandles_[page];
+		region.texBase = {static_cast<float>(x), static_cast<float>(y)};
+		region.texSize = {static_cast<float>(width), static_cast<float>(height)};
+	}
+	return true;
+}
+
+bool TextureAtlas::BuildOrLoad(const std::string& name, const std::vector<std::string>& fileNames, uint32_t pageSize, const std::string& directoryPath) {
+	namespace fs = std::filesystem;
+	std::error_code ec;
+	fs::path manifestPath = directoryPath + MakeManifestFileName(name);
+	bool upToDate = fs::exists(manifestPath, ec);
+	if (upToDate) {
+		fs::file_time_type manifestTime = fs::last_write_time(manifestPath, ec);
+		for (const std::string& fileName : fileNames) {
+			if (fs::last_write_time(directoryPath + fileName, ec) > manifestTime) {
+				upToDate = false;
+				break;
+			}
+		}
+	}
+	if (!upToDate && !Build(name, fileNames, pageSize, 1, directoryPath)) {
+		return false;
+	}
+	return Load(name, directoryPath);
+}
+
+const TextureAtlas::Region* TextureAtlas::Find(const std::string& fileName) const {
+	auto it = regions_.find(fileName);
+	return it != regions_.end() ? &it->second : nullptr;
+}
+
+bool TextureAtlas::Apply(Sprite* sprite, const std::string& fileName) const {
+	const Region* region = Find(fileName);
+	if (!region) {
+		return false;
+	}
+	sprite->SetTextureHandle(region->textureHandle);
+	sprite->SetTextureRect(region->texBase, region->texSize);
+	return true;
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include "AtlasPacker.h"
+#include "KamataEngine.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// テクスチャアトラス
+/// 小さな画像をページ画像にまとめ、スプライトごとのディスクリプタテーブル切り替えを減らす。
+/// Buildでページ(PNG)と配置表を書き出し、実行時はLoadで配置表を読んでページだけを読み込む
+/// </summary>
+class TextureAtlas {
+public:
+	// ページの既定の大きさ
+	static const uint32_t kDefaultPageSize = 1024;
+
+	/// <summary>
+	/// アトラス内の領域(Sprite::SetTextureRectにそのまま渡せる画素単位)
+	/// </summary>
+	struct Region {
+		uint32_t textureHandle = 0;
+		KamataEngine::Vector2 texBase{};
+		KamataEngine::Vector2 texSize{};
+	};
+
+	/// <summary>
+	/// 構築時の計測値
+	/// </summary>
+	struct BuildStatistics {
+		uint32_t imageCount = 0;
+		uint32_t pageCount = 0;
+		// ページ面積に対する画像面積の割合
+		float efficiency = 0.0f;
+		// 詰め込みにかかった時間(ミリ秒)
+		double packMilliseconds = 0.0;
+		// デコードから書き出しまでの時間(ミリ秒)
+		double totalMilliseconds = 0.0;
+	};
+
+	/// <summary>
+	/// ページと配置表の書き出し(オフライン向け)
+	/// </summary>
+	/// <param name="name">アトラス名。atlas/name_N.pngとatlas/name.atlasを書き出す</param>
+	/// <param name="fileNames">まとめる画像のファイル名</param>
+	/// <param name="pageSize">ページの幅と高さ</param>
+	/// <param name="padding">画像の周囲の余白</param>
+	/// <param name="directoryPath">画像のあるディレクトリ(TextureManagerと同じ)</param>
+	/// <param name="statistics">計測値の出力先(nullptrなら出力しない)</param>
+	/// <returns>成否</returns>
+	static bool Build(
+	    const std::string& name, const std::vector<std::string>& fileNames, uint32_t pageSize = kDefaultPageSize, uint32_t padding = 1, const std::string& directoryPath = "Resources/",
+	    BuildStatistics* statistics = nullptr);
+
+	/// <summary>
+	/// 配置表を読み、ページをTextureRegistry経由で読み込む(読み込み済みのページは手放す)
+	/// </summary>
+	/// <param name="name">アトラス名</param>
+	/// <param name="directoryPath">ディレクトリ(TextureManagerと同じ)</param>
+	/// <returns>成否</returns>
+	bool Load(const std::string& name, const std::string& directoryPath = "Resources/");
+
+	/// <summary>
+	/// 配置表が画像より古いか存在しなければ構築してから読み込む(実行時向け)
+	/// </summary>
+	/// <param name="name">アトラス名</param>
+	/// <param name="fileNames">まとめる画像のファイル名</param>
+	/// <param name="pageSize">ページの幅と高さ</param>
+	/// <param name="directoryPath">ディレクトリ(TextureManagerと同じ)</param>
+	/// <returns>成否</returns>
+	bool BuildOrLoad(const std::string& name, const std::vector<std::string>& fileNames, uint32_t pageSize = kDefaultPageSize, const std::string& directoryPath = "Resources/");
+
+	/// <summary>
+	/// 領域の検索
+	/// </summary>
+	/// <param name="fileName">元の画像のファイル名</param>
+	/// <returns>領域。含まれていなければnullptr</returns>
+	const Region* Find(const std::string& fileName) const;
+
+	/// <summary>
+	/// スプライトにテクスチャハンドルと切り出し範囲を設定する
+	/// </summary>
+	/// <param name="sprite">スプライト</param>
+	/// <param name="fileName">元の画像のファイル名</param>
+	/// <returns>領域が見つかったか</returns>
+	bool Apply(KamataEngine::Sprite* sprite, const std::string& fileName) const;
+
+	/// <summary>
+	/// ページのテクスチャハンドルの取得
+	/// </summary>
+	const std::vector<uint32_t>& GetPageHandles() const { return pageHandles_; }
+
+private:
+	std::vector<uint32_t> pageHandles_;
+	std::unordered_map<std::string, Region> regions_;
+};
@@ -0,0 +1,199 @@
+#include "TextureCache.h"
+#include "AssetIO.h"
+#include "Hash.h"
+#include "TextureCooker.h"
+#include "TextureRegistry.h"
+#include <DirectXTex.h>
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+// 拡張子が.ddsか
+bool HasDdsExtension(const std::string& fileName) {
+	if (fileName.size() < 4) {
+		return false;
+	}
+	std::string extension = fileName.substr(fileName.size() - 4);
+	for (char& c : extension) {
+		c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+	}
+	return extension == ".dds";
+}
+
+} // namespace
+
+TextureCache* TextureCache::GetInstance() {
+	static TextureCache instance;
+	return &instance;
+}
+
+void TextureCache::Initialize(const std::string& directoryPath, uint64_t budgetBytes) {
+	directoryPath_ = directoryPath;
+	budgetBytes_ = budgetBytes;
+	entries_.clear();
+	slots_.Reset();
+	nameMap_.clear();
+	contentMap_.clear();
+	lru_.clear();
+	statistics_ = {};
+}
+
+void TextureCache::Finalize() {
+	// 衝突した要素も含めて、割り当て済みのハンドルをすべて解放する
+	for (uint32_t handle = 0; handle < entries_.size(); ++handle) {
+		if (slots_.Test(handle)) {
+			TextureRegistry::Unload(entries_[handle].textureHandle);
+		}
+	}
+	Initialize(directoryPath_, budgetBytes_);
+}
+
+bool TextureCache::ComputeContentKey(const std::string& fileName, ContentKey& contentKey, uint64_t& sizeInBytes) const {
+	// デコードはTextureManager::Loadが行うので、ここではマップしたファイルの中身をそのままハッシュし、
+	// 大きさはヘッダだけから求める(デコードを2回しない)
+	AssetView view = AssetIO::GetInstance()->Map(directoryPath_ + fileName);
+	if (!view || view.GetSize() == 0) {
+		return false;
+	}
+
+	DirectX::TexMetadata metadata{};
+	HRESULT result = S_FALSE;
+	if (HasDdsExtension(fileName)) {
+		result = DirectX::GetMetadataFromDDSMemory(view.GetData(), view.GetSize(), DirectX::DDS_FLAGS_NONE, metadata);
+	} else {
+		result = DirectX::GetMetadataFromWICMemory(view.GetData(), view.GetSize(), DirectX::WIC_FLAGS_NONE, metadata);
+	}
+	if (FAILED(result)) {
+		return false;
+	}
+
+	contentKey = ContentKey{};
+	contentKey.fileSize = view.GetSize();
+	contentKey.format = static_cast<uint32_t>(metadata.format);
+	contentKey.width = static_cast<uint32_t>(metadata.width);
+	contentKey.height = static_cast<uint32_t>(metadata.height);
+	contentKey.depth = static_cast<uint32_t>(metadata.depth);
+	contentKey.arraySize = static_cast<uint32_t>(metadata.arraySize);
+	contentKey.mipLevels = static_cast<uint32_t>(metadata.mipLevels);
+	// ヘッダの情報を種にしてバイト列をハッシュする(形式や大きさの違う画像は必ず別のハッシュの系列になる)
+	const uint32_t header[] = {contentKey.format, contentKey.width, contentKey.height, contentKey.depth, contentKey.arraySize, contentKey.mipLevels};
+	uint64_t seed = XXHash64(header, sizeof(header));
+	contentKey.hash = XXHash64(view.GetData(), view.GetSize(), seed);
+	sizeInBytes = 0;
+	for (size_t mip = 0; mip < metadata.mipLevels; ++mip) {
+		size_t rowPitch = 0;
+		size_t slicePitch = 0;
+		DirectX::ComputePitch(metadata.format, (std::max)(metadata.width >> mip, size_t(1)), (std::max)(metadata.height >> mip, size_t(1)), rowPitch, slicePitch);
+		sizeInBytes += uint64_t(slicePitch) * metadata.arraySize * (std::max)(metadata.depth >> mip, size_t(1));
+	}
+	return true;
+}
+
+uint32_t TextureCache::Acquire(const std::string& fileName) {
+	// ファイル名で見つかればデコードせずに済む
+	auto nameIt = nameMap_.find(fileName);
+	if (nameIt != nameMap_.end()) {
+		++statistics_.hits;
+		AddRef(nameIt->second);
+		return nameIt->second;
+	}
+
+	// クック済みのDDSがあればそちらを読む
+	std::string loadFileName = TextureCooker::ResolveCookedFileName(directoryPath_, fileName);
+
+	ContentKey contentKey;
+	uint64_t sizeInBytes = 0;
+	if (!ComputeContentKey(loadFileName, contentKey, sizeInBytes)) {
+		return kInvalidHandle;
+	}
+
+	// 別名の同一画像。ハッシュだけが一致した別の画像は共有せず、この下で別に読み込む
+	auto contentIt = contentMap_.find(contentKey.hash);
+	bool collided = contentIt != contentMap_.end() && !(entries_[contentIt->second].contentKey == contentKey);
+	if (collided) {
+		++statistics_.collisions;
+	} else if (contentIt != contentMap_.end()) {
+		++statistics_.hits;
+		entries_[contentIt->second].fileNames.push_back(fileName);
+		nameMap_[fileName] = contentIt->second;
+		AddRef(contentIt->second);
+		return contentIt->second;
+	}
+
+	++statistics_.misses;
+	uint32_t handle = slots_.Allocate();
+	if (handle >= entries_.size()) {
+		entries_.resize(handle + 1);
+	}
+	Entry& entry = entries_[handle];
+	entry = Entry{};
+	entry.contentKey = contentKey;
+	entry.textureHandle = TextureRegistry::Load(loadFileName);
+	entry.sizeInBytes = sizeInBytes;
+	entry.fileNames.push_back(fileName);
+	nameMap_[fileName] = handle;
+	if (!collided) {
+		contentMap_[contentKey.hash] = handle;
+	}
+	statistics_.bytesResident += sizeInBytes;
+	++statistics_.texturesResident;
+
+	AddRef(handle);
+	EvictOverBudget();
+	return handle;
+}
+
+void TextureCache::AddRef(uint32_t handle) {
+	Entry& entry = entries_[handle];
+	if (entry.inLru) {
+		lru_.erase(entry.lruPosition);
+		entry.inLru = false;
+	}
+	++entry.refCount;
+}
+
+void TextureCache::Release(uint32_t handle) {
+	if (!IsValid(handle) || entries_[handle].refCount == 0) {
+		return;
+	}
+	Entry& entry = entries_[handle];
+	if (--entry.refCount == 0) {
+		entry.lruPosition = lru_.insert(lru_.end(), handle);
+		entry.inLru = true;
+		EvictOverBudget();
+	}
+}
+
+void TextureCache::SetBudget(uint64_t budgetBytes) {
+	budgetBytes_ = budgetBytes;
+	EvictOverBudget();
+}
+
+void TextureCache::EvictOverBudget() {
+	while (statistics_.bytesResident > budgetBytes_ && !lru_.empty()) {
+		Evict(lru_.front());
+	}
+}
+
+void TextureCache::Evict(uint32_t handle) {
+	Entry& entry = entries_[handle];
+	if (entry.inLru) {
+		lru_.erase(entry.lruPosition);
+		entry.inLru = false;
+	}
+	TextureRegistry::Unload(entry.textureHandle);
+	for (const std::string& fileName : entry.fileNames) {
+		nameMap_.erase(fileName);
+	}
+	// 衝突して別に読み込んだ要素はcontentMap_に載っていない
+	auto contentIt = contentMap_.find(entry.contentKey.hash);
+	if (contentIt != contentMap_.end() && contentIt->second == handle) {
+		contentMap_.erase(contentIt);
+	}
+	statistics_.bytesResident -= entry.sizeInBytes;
+	--statistics_.texturesResident;
+	++statistics_.evictions;
+	entry = Entry{};
+	slots_.Free(handle);
+}
@@ -0,0 +1,152 @@
+#pragma once
+#include "SlotAllocator.h"
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// 内容ハッシュで重複を排除するテクスチャキャッシュ
+/// ファイルの中身からハッシュを求め、別名の同一画像は同じテクスチャを共有する。
+/// ハッシュはデコード前のバイト列とヘッダの情報(形式、大きさ、ミップ数)から求める。デコード後の画素で比べるとデコードが2回になるためで、
+/// 代わりに同じ画像でも符号化の違うファイル(PNGの圧縮設定違いなど)は別のテクスチャになる。
+/// ハッシュが一致してもヘッダの情報とファイルの大きさが違えば衝突として別に読み込む。
+/// 参照カウントが0になったテクスチャはすぐには解放せず、VRAM予算を超えたら古い順に解放する。
+/// 解放はTextureRegistry経由なので、他のモジュールが同じファイルを使っていればTextureManagerには残る
+/// </summary>
+class TextureCache {
+public:
+	// 無効なハンドル
+	static const uint32_t kInvalidHandle = UINT32_MAX;
+	// 既定のVRAM予算(バイト)
+	static const uint64_t kDefaultBudget = 256ull * 1024 * 1024;
+
+	/// <summary>
+	/// 統計
+	/// </summary>
+	struct Statistics {
+		// ファイル名または内容が一致して再利用した回数
+		uint64_t hits = 0;
+		// 新しく読み込んだ回数
+		uint64_t misses = 0;
+		// 予算超過で解放した回数
+		uint64_t evictions = 0;
+		// ハッシュは一致したが中身が違った回数
+		uint64_t collisions = 0;
+		// 常駐しているバイト数
+		uint64_t bytesResident = 0;
+		// 常駐しているテクスチャ数
+		uint32_t texturesResident = 0;
+	};
+
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static TextureCache* GetInstance();
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="directoryPath">テクスチャを読み込むディレクトリ(TextureManagerと同じ)</param>
+	/// <param name="budgetBytes">VRAM予算(バイト)</param>
+	void Initialize(const std::string& directoryPath = "Resources/", uint64_t budgetBytes = kDefaultBudget);
+
+	/// <summary>
+	/// 終了処理。常駐しているテクスチャをすべて解放する
+	/// </summary>
+	void Finalize();
+
+	/// <summary>
+	/// テクスチャの取得(参照カウントを増やす)
+	/// </summary>
+	/// <param name="fileName">ファイル名</param>
+	/// <returns>キャッシュハンドル。失敗時はkInvalidHandle</returns>
+	uint32_t Acquire(const std::string& fileName);
+
+	/// <summary>
+	/// テクスチャの参照を手放す(参照カウントを減らす)
+	/// </summary>
+	/// <param name="handle">キャッシュハンドル</param>
+	void Release(uint32_t handle);
+
+	/// <summary>
+	/// 描画に使うテクスチャハンドルの取得
+	/// </summary>
+	/// <param name="handle">キャッシュハンドル</param>
+	/// <returns>TextureManagerのテクスチャハンドル。無効なハンドルなら0(TextureManagerの既定の白テクスチャ)</returns>
+	uint32_t GetTextureHandle(uint32_t handle) const { return IsValid(handle) ? entries_[handle].textureHandle : 0; }
+
+	// 参照カウントの取得(無効なハンドルなら0)
+	uint32_t GetRefCount(uint32_t handle) const { return IsValid(handle) ? entries_[handle].refCount : 0; }
+
+	// 読み込み済みの要素を指すハンドルか
+	bool IsValid(uint32_t handle) const { return handle < entries_.size() && slots_.Test(handle); }
+
+	/// <summary>
+	/// VRAM予算の設定。超えていれば直ちに解放する
+	/// </summary>
+	/// <param name="budgetBytes">予算(バイト)</param>
+	void SetBudget(uint64_t budgetBytes);
+
+	// 統計の取得
+	const Statistics& GetStatistics() const { return statistics_; }
+
+private:
+	// 内容の識別情報。ハッシュが衝突しても残りの項目で取り違えを防ぐ
+	struct ContentKey {
+		uint64_t hash = 0;
+		uint64_t fileSize = 0;
+		uint32_t format = 0;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t depth = 0;
+		uint32_t arraySize = 0;
+		uint32_t mipLevels = 0;
+		bool operator==(const ContentKey&) const = default;
+	};
+
+	// キャッシュの要素(内容ごとに1つ)
+	struct Entry {
+		ContentKey contentKey;
+		uint32_t textureHandle = 0;
+		uint64_t sizeInBytes = 0;
+		uint32_t refCount = 0;
+		// この内容を指しているファイル名
+		std::vector<std::string> fileNames;
+		// 参照されていない間の解放候補リスト内の位置
+		std::list<uint32_t>::iterator lruPosition;
+		bool inLru = false;
+	};
+
+	TextureCache() = default;
+	~TextureCache() = default;
+	TextureCache(const TextureCache&) = delete;
+	const TextureCache& operator=(const TextureCache&) = delete;
+
+	/// <summary>
+	/// ファイルの内容の識別情報と、ヘッダから求めたデコード後のバイト数を求める
+	/// </summary>
+	bool ComputeContentKey(const std::string& fileName, ContentKey& contentKey, uint64_t& sizeInBytes) const;
+
+	// 参照を1つ増やす
+	void AddRef(uint32_t handle);
+	// 予算を超えている間、参照されていないテクスチャを古い順に解放する
+	void EvictOverBudget();
+	// 要素の解放
+	void Evict(uint32_t handle);
+
+	std::string directoryPath_;
+	uint64_t budgetBytes_ = kDefaultBudget;
+	// 要素(キャッシュハンドルで引く)
+	std::vector<Entry> entries_;
+	SlotAllocator slots_;
+	// ファイル名からハンドルへの対応
+	std::unordered_map<std::string, uint32_t> nameMap_;
+	// 内容ハッシュからハンドルへの対応
+	std::unordered_map<uint64_t, uint32_t> contentMap_;
+	// 参照されていない要素(先頭ほど古い)
+	std::list<uint32_t> lru_;
+	Statistics statistics_;
+};
@@ -0,0 +1,349 @@
+#include "TextureCooker.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#include <DirectXTex.h>
+#endif
+
+namespace {
+
+// DDSファイルの識別子
+const uint32_t kDdsMagic = 0x20534444;
+
+// DDSヘッダのフラグ
+const uint32_t kDdsdCaps = 0x1;
+const uint32_t kDdsdHeight = 0x2;
+const uint32_t kDdsdWidth = 0x4;
+const uint32_t kDdsdPixelFormat = 0x1000;
+const uint32_t kDdsdMipMapCount = 0x20000;
+const uint32_t kDdsdLinearSize = 0x80000;
+const uint32_t kDdpfFourCC = 0x4;
+const uint32_t kDdsCapsComplex = 0x8;
+const uint32_t kDdsCapsTexture = 0x1000;
+const uint32_t kDdsCapsMipMap = 0x400000;
+
+// DDSのピクセル形式
+struct DdsPixelFormat {
+	uint32_t size;
+	uint32_t flags;
+	uint32_t fourCC;
+	uint32_t rgbBitCount;
+	uint32_t rBitMask;
+	uint32_t gBitMask;
+	uint32_t bBitMask;
+	uint32_t aBitMask;
+};
+
+// DDSヘッダ
+struct DdsHeader {
+	uint32_t size;
+	uint32_t flags;
+	uint32_t height;
+	uint32_t width;
+	uint32_t pitchOrLinearSize;
+	uint32_t depth;
+	uint32_t mipMapCount;
+	uint32_t reserved1[11];
+	DdsPixelFormat pixelFormat;
+	uint32_t caps;
+	uint32_t caps2;
+	uint32_t caps3;
+	uint32_t caps4;
+	uint32_t reserved2;
+};
+static_assert(sizeof(DdsHeader) == 124);
+
+constexpr uint32_t MakeFourCC(char a, char b, char c, char d) { return uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8) | (uint32_t(uint8_t(c)) << 16) | (uint32_t(uint8_t(d)) << 24); }
+
+// 2x2画素の平均で半分の大きさの画像を作る
+std::vector<uint8_t> Downsample(const std::vector<uint8_t>& source, uint32_t width, uint32_t height, uint32_t& newWidth, uint32_t& newHeight) {
+	newWidth = (std::max)(width / 2, 1u);
+	newHeight = (std::max)(height / 2, 1u);
+	std::vector<uint8_t> result(static_cast<size_t>(newWidth) * newHeight * 4);
+	for (uint32_t y = 0; y < newHeight; ++y) {
+		uint32_t y0 = (std::min)(y * 2, height - 1);
+		uint32_t y1 = (std::min)(y * 2 + 1, height - 1);
+		for (uint32_t x = 0; x < newWidth; ++x) {
+			uint32_t x0 = (std::min)(x * 2, width - 1);
+			uint32_t x1 = (std::min)(x * 2 + 1, width - 1);
+			for (uint32_t c = 0; c < 4; ++c) {
+				uint32_t sum = source[(static_cast<size_t>(y0) * width + x0) * 4 + c] + source[(static_cast<size_t>(y0) * width + x1) * 4 + c] +
+				               source[(static_cast<size_t>(y1) * width + x0) * 4 + c] + source[(static_cast<size_t>(y1) * width + x1) * 4 + c];
+				result[(static_cast<size_t>(y) * newWidth + x) * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+			}
+		}
+	}
+	return result;
+}
+
+// 拡張子を小文字で取り出す
+std::string GetLowerExtension(const std::filesystem::path& path) {
+	std::string extension = path.extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return static_cast<char>(tolower(static_cast<unsigned char>(c))); });
+	return extension;
+}
+
+} // namespace
+
+TextureCooker::CookedTexture TextureCooker::Cook(const uint8_t* rgba, uint32_t width, uint32_t height, BlockFormat format, bool generateMips, uint32_t threadCount) {
+	CookedTexture texture;
+	texture.format = format;
+	texture.width = width;
+	texture.height = height;
+
+	std::vector<uint8_t> level(rgba, rgba + static_cast<size_t>(width) * height * 4);
+	uint32_t levelWidth = width;
+	uint32_t levelHeight = height;
+	while (true) {
+		texture.mips.push_back(CompressImage(level.data(), levelWidth, levelHeight, format, threadCount));
+		if (!generateMips || (levelWidth == 1 && levelHeight == 1)) {
+			break;
+		}
+		level = Downsample(level, levelWidth, levelHeight, levelWidth, levelHeight);
+	}
+	return texture;
+}
+
+bool TextureCooker::WriteDds(const std::string& filePath, const CookedTexture& texture) {
+	std::ofstream file(filePath, std::ios::binary);
+	if (!file || texture.mips.empty()) {
+		return false;
+	}
+
+	DdsHeader header{};
+	header.size = sizeof(DdsHeader);
+	header.flags = kDdsdCaps | kDdsdHeight | kDdsdWidth | kDdsdPixelFormat | kDdsdLinearSize;
+	header.height = texture.height;
+	header.width = texture.width;
+	header.pitchOrLinearSize = static_cast<uint32_t>(texture.mips[0].size());
+	header.mipMapCount = static_cast<uint32_t>(texture.mips.size());
+	header.pixelFormat.size = sizeof(DdsPixelFormat);
+	header.pixelFormat.flags = kDdpfFourCC;
+	header.pixelFormat.fourCC = texture.format == BlockFormat::kBC1 ? MakeFourCC('D', 'X', 'T', '1') : MakeFourCC('D', 'X', 'T', '5');
+	header.caps = kDdsCapsTexture;
+	if (texture.mips.size() > 1) {
+		header.flags |= kDdsdMipMapCount;
+		header.caps |= kDdsCapsComplex | kDdsCapsMipMap;
+	}
+
+	file.write(reinterpret_cast<const char*>(&kDdsMagic), sizeof(kDdsMagic));
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	for (const std::vector<uint8_t>& mip : texture.mips) {
+		file.write(reinterpret_cast<const char*>(mip.data()), static_cast<std::streamsize>(mip.size()));
+	}
+	return static_cast<bool>(file);
+}
+
+bool TextureCooker::LoadTga(const std::string& filePath, std::vector<uint8_t>& rgba, uint32_t& width, uint32_t& height) {
+	std::ifstream file(filePath, std::ios::binary);
+	uint8_t header[18];
+	if (!file.read(reinterpret_cast<char*>(header), sizeof(header))) {
+		return false;
+	}
+	// カラーマップなしのフルカラー(2が非圧縮、10がRLE)だけを扱う
+	uint8_t idLength = header[0];
+	uint8_t colorMapType = header[1];
+	uint8_t imageType = header[2];
+	width = header[12] | (header[13] << 8);
+	height = header[14] | (header[15] << 8);
+	uint32_t bytesPerPixel = header[16] / 8;
+	bool topToBottom = (header[17] & 0x20) != 0;
+	if (colorMapType != 0 || (imageType != 2 && imageType != 10) || (bytesPerPixel != 3 && bytesPerPixel != 4) || width == 0 || height == 0) {
+		return false;
+	}
+	file.seekg(idLength, std::ios::cur);
+
+	size_t pixelCount = static_cast<size_t>(width) * height;
+	std::vector<uint8_t> bgra(pixelCount * bytesPerPixel);
+	if (imageType == 2) {
+		file.read(reinterpret_cast<char*>(bgra.data()), static_cast<std::streamsize>(bgra.size()));
+	} else {
+		// 先頭バイトの最上位ビットが1なら続く1画素の繰り返し、0なら生の画素の並び(下位7ビット+1が画素数)
+		for (size_t pixel = 0; pixel < pixelCount && file;) {
+			uint8_t packet = 0;
+			file.read(reinterpret_cast<char*>(&packet), 1);
+			size_t count = (std::min)(static_cast<size_t>(packet & 0x7F) + 1, pixelCount - pixel);
+			uint8_t* dst = bgra.data() + pixel * bytesPerPixel;
+			if (packet & 0x80) {
+				file.read(reinterpret_cast<char*>(dst), bytesPerPixel);
+				for (size_t i = 1; i < count; ++i) {
+					std::memcpy(dst + i * bytesPerPixel, dst, bytesPerPixel);
+				}
+			} else {
+				file.read(reinterpret_cast<char*>(dst), static_cast<std::streamsize>(count * bytesPerPixel));
+			}
+			pixel += count;
+		}
+	}
+	if (!file) {
+		return false;
+	}
+
+	// BGR(A)を左上からのRGBAに並べ替える
+	rgba.resize(pixelCount * 4);
+	for (uint32_t y = 0; y < height; ++y) {
+		uint32_t sourceY = topToBottom ? y : height - 1 - y;
+		for (uint32_t x = 0; x < width; ++x) {
+			const uint8_t* src = bgra.data() + (static_cast<size_t>(sourceY) * width + x) * bytesPerPixel;
+			uint8_t* dst = rgba.data() + (static_cast<size_t>(y) * width + x) * 4;
+			dst[0] = src[2];
+			dst[1] = src[1];
+			dst[2] = src[0];
+			dst[3] = bytesPerPixel == 4 ? src[3] : 255;
+		}
+	}
+	return true;
+}
+
+bool TextureCooker::CookFile(const std::string& sourcePath, const std::string& destinationPath, Format format) {
+#ifdef _WIN32
+	std::wstring source = std::filesystem::path(sourcePath).wstring();
+	std::wstring destination = std::filesystem::path(destinationPath).wstring();
+
+	DirectX::TexMetadata metadata{};
+	DirectX::ScratchImage image{};
+	HRESULT result = GetLowerExtension(sourcePath) == ".tga" ? DirectX::LoadFromTGAFile(source.c_str(), &metadata, image)
+	                                                         : DirectX::LoadFromWICFile(source.c_str(), DirectX::WIC_FLAGS_NONE, &metadata, image);
+	if (FAILED(result)) {
+		return false;
+	}
+
+	// 不透明な画像はαの無いBC1で半分の大きさにする
+	if (format == Format::kAuto) {
+		format = image.IsAlphaAllOpaque() ? Format::kBC1 : Format::kBC3;
+	}
+
+	// ミップマップ生成
+	DirectX::ScratchImage mipChain{};
+	result = DirectX::GenerateMipMaps(image.GetImages(), image.GetImageCount(), image.GetMetadata(), DirectX::TEX_FILTER_DEFAULT, 0, mipChain);
+	if (FAILED(result)) {
+		return false;
+	}
+
+	// ブロック圧縮。ブロック単位で独立しているので並列に処理させる
+	DXGI_FORMAT compressedFormat = DXGI_FORMAT_BC1_UNORM;
+	if (format == Format::kBC3) {
+		compressedFormat = DXGI_FORMAT_BC3_UNORM;
+	} else if (format == Format::kBC7) {
+		compressedFormat = DXGI_FORMAT_BC7_UNORM;
+	}
+	if (DirectX::IsSRGB(metadata.format)) {
+		compressedFormat = DirectX::MakeSRGB(compressedFormat);
+	}
+	DirectX::ScratchImage compressed{};
+	result = DirectX::Compress(mipChain.GetImages(), mipChain.GetImageCount(), mipChain.GetMetadata(), compressedFormat, DirectX::TEX_COMPRESS_PARALLEL, DirectX::TEX_THRESHOLD_DEFAULT, compressed);
+	if (FAILED(result)) {
+		return false;
+	}
+
+	result = DirectX::SaveToDDSFile(compressed.GetImages(), compressed.GetImageCount(), compressed.GetMetadata(), DirectX::DDS_FLAGS_NONE, destination.c_str());
+	if (FAILED(result)) {
+		return false;
+	}
+
+	// 大きなテクスチャはミップNから末尾までの分割ファイルも書き出し、粗い段階から順に読み込めるようにする
+	const DirectX::TexMetadata& compressedMetadata = compressed.GetMetadata();
+	size_t longEdge = (std::max)(compressedMetadata.width, compressedMetadata.height);
+	if (longEdge >= kStreamingMinSize) {
+		for (size_t mip = 1; mip < compressedMetadata.mipLevels && (longEdge >> mip) >= kStreamingTailSize; ++mip) {
+			DirectX::TexMetadata variantMetadata = compressedMetadata;
+			variantMetadata.width = (std::max)(compressedMetadata.width >> mip, size_t(1));
+			variantMetadata.height = (std::max)(compressedMetadata.height >> mip, size_t(1));
+			variantMetadata.mipLevels = compressedMetadata.mipLevels - mip;
+			std::wstring variant = std::filesystem::path(MakeMipVariantFileName(destinationPath, static_cast<uint32_t>(mip))).wstring();
+			result = DirectX::SaveToDDSFile(compressed.GetImages() + mip, variantMetadata.mipLevels, variantMetadata, DirectX::DDS_FLAGS_NONE, variant.c_str());
+			if (FAILED(result)) {
+				return false;
+			}
+		}
+	}
+	return true;
+#else
+	// DirectXTexの無い環境ではTGAだけを読み、BlockCompressionで圧縮する(BC7は無い)
+	std::vector<uint8_t> rgba;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	if (format == Format::kBC7 || GetLowerExtension(sourcePath) != ".tga" || !LoadTga(sourcePath, rgba, width, height)) {
+		return false;
+	}
+	if (format == Format::kAuto) {
+		format = IsOpaque(rgba.data(), rgba.size() / 4) ? Format::kBC1 : Format::kBC3;
+	}
+	CookedTexture texture = Cook(rgba.data(), width, height, format == Format::kBC1 ? BlockFormat::kBC1 : BlockFormat::kBC3);
+	if (!WriteDds(destinationPath, texture)) {
+		return false;
+	}
+
+	// Windowsと同じく、大きなテクスチャはミップNから末尾までの分割ファイルも書き出す
+	uint32_t longEdge = (std::max)(width, height);
+	if (longEdge >= kStreamingMinSize) {
+		for (uint32_t mip = 1; mip < texture.mips.size() && (longEdge >> mip) >= kStreamingTailSize; ++mip) {
+			CookedTexture variant;
+			variant.format = texture.format;
+			variant.width = (std::max)(width >> mip, 1u);
+			variant.height = (std::max)(height >> mip, 1u);
+			variant.mips.assign(texture.mips.begin() + mip, texture.mips.end());
+			if (!WriteDds(MakeMipVariantFileName(destinationPath, mip), variant)) {
+				return false;
+			}
+		}
+	}
+	return true;
+#endif
+}
+
+uint32_t TextureCooker::CookDirectory(const std::string& directoryPath, Format format) {
+	namespace fs = std::filesystem;
+	std::error_code ec;
+	uint32_t cookedCount = 0;
+	for (const fs::directory_entry& entry : fs::recursive_directory_iterator(directoryPath, ec)) {
+		if (!entry.is_regular_file()) {
+			continue;
+		}
+		std::string extension = GetLowerExtension(entry.path());
+		if (extension != ".png" && extension != ".jpg" && extension != ".jpeg" && extension != ".tga") {
+			continue;
+		}
+
+		fs::path destination = entry.path();
+		destination.replace_extension(".dds");
+		if (fs::exists(destination, ec) && fs::last_write_time(destination, ec) >= entry.last_write_time(ec)) {
+			continue;
+		}
+		if (CookFile(entry.path().string(), destination.string(), format)) {
+			++cookedCount;
+		}
+	}
+	return cookedCount;
+}
+
+std::string TextureCooker::ResolveCookedFileName(const std::string& directoryPath, const std::string& fileName) {
+	std::filesystem::path cooked(fileName);
+	cooked.replace_extension(".dds");
+	if (cooked.string() == fileName) {
+		return fileName;
+	}
+	// 元のファイルを編集した後でクックし直していなければ、古いDDSではなく元のファイルを使う(CookDirectoryと同じ判定)
+	std::filesystem::path cookedPath = std::filesystem::path(directoryPath) / cooked;
+	std::filesystem::path sourcePath = std::filesystem::path(directoryPath) / fileName;
+	std::error_code ec;
+	if (!std::filesystem::exists(cookedPath, ec)) {
+		return fileName;
+	}
+	if (std::filesystem::exists(sourcePath, ec) && std::filesystem::last_write_time(cookedPath, ec) < std::filesystem::last_write_time(sourcePath, ec)) {
+		return fileName;
+	}
+	return cooked.generic_string();
+}
+
+std::string TextureCooker::MakeMipVariantFileName(const std::string& fileName, uint32_t mip) {
+	if (mip == 0) {
+		return fileName;
+	}
+	std::filesystem::path variant(fileName);
+	variant.replace_extension(".mip" + std::to_string(mip) + variant.extension().string());
+	return variant.generic_string();
+}
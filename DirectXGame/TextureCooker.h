@@ -0,0 +1,102 @@
+#pragma once
+#include "BlockCompression.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// テクスチャの事前変換(クック)
+/// PNG/JPG/TGAをミップマップ付きのブロック圧縮DDSに変換し、実行時のWICデコードと非圧縮転送を省く
+/// DirectXTexの無い環境(Linuxのツール)ではTGAだけを読み、圧縮はBlockCompressionで行う
+/// </summary>
+class TextureCooker {
+public:
+	// ミップストリーミング用の分割ファイルを書き出す最小の大きさ(長辺)
+	static const uint32_t kStreamingMinSize = 512;
+	// 分割ファイルの最も粗い段階の大きさ(長辺)
+	static const uint32_t kStreamingTailSize = 128;
+
+	/// <summary>
+	/// 出力形式
+	/// </summary>
+	enum class Format {
+		kBC1, //!< 不透明・1bitα向け
+		kBC3, //!< α付き
+		kBC7, //!< 高品質(DirectXTexが必要)
+		kAuto, //!< 全画素が不透明ならBC1、そうでなければBC3
+	};
+
+	/// <summary>
+	/// クック結果
+	/// </summary>
+	struct CookedTexture {
+		BlockFormat format = BlockFormat::kBC1;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		// ミップレベルごとのブロック列(0が最大)
+		std::vector<std::vector<uint8_t>> mips;
+	};
+
+	/// <summary>
+	/// RGBA8画像からミップマップを作ってブロック圧縮する(DirectXTexを使わない実装)
+	/// </summary>
+	/// <param name="rgba">RGBA8の画素</param>
+	/// <param name="width">幅</param>
+	/// <param name="height">高さ</param>
+	/// <param name="format">圧縮形式</param>
+	/// <param name="generateMips">ミップマップを作るか</param>
+	/// <param name="threadCount">スレッド数。0なら自動</param>
+	/// <returns>クック結果</returns>
+	static CookedTexture Cook(const uint8_t* rgba, uint32_t width, uint32_t height, BlockFormat format, bool generateMips = true, uint32_t threadCount = 0);
+
+	/// <summary>
+	/// クック結果をDDSファイルに書き出す
+	/// </summary>
+	/// <param name="filePath">出力先</param>
+	/// <param name="texture">クック結果</param>
+	/// <returns>成否</returns>
+	static bool WriteDds(const std::string& filePath, const CookedTexture& texture);
+
+	/// <summary>
+	/// TGAファイルをRGBA8で読み込む(非圧縮とRLEの24/32bit)
+	/// </summary>
+	/// <param name="filePath">ファイルパス</param>
+	/// <param name="rgba">RGBA8の画素の出力先(左上から)</param>
+	/// <param name="width">幅</param>
+	/// <param name="height">高さ</param>
+	/// <returns>成否</returns>
+	static bool LoadTga(const std::string& filePath, std::vector<uint8_t>& rgba, uint32_t& width, uint32_t& height);
+
+	/// <summary>
+	/// 画像ファイルをDDSにクックする(DirectXTexがあれば読み込み・ミップ生成・圧縮をDirectXTexで行う)
+	/// </summary>
+	/// <param name="sourcePath">入力ファイル</param>
+	/// <param name="destinationPath">出力ファイル</param>
+	/// <param name="format">出力形式</param>
+	/// <returns>成否</returns>
+	static bool CookFile(const std::string& sourcePath, const std::string& destinationPath, Format format);
+
+	/// <summary>
+	/// ディレクトリ以下のPNG/JPG/TGAを同じ場所のDDSにクックする。DDSの方が新しければ飛ばす
+	/// </summary>
+	/// <param name="directoryPath">ディレクトリ</param>
+	/// <param name="format">出力形式</param>
+	/// <returns>クックしたファイル数</returns>
+	static uint32_t CookDirectory(const std::string& directoryPath, Format format);
+
+	/// <summary>
+	/// クック済みのDDSがあればそのファイル名を返す
+	/// </summary>
+	/// <param name="directoryPath">ディレクトリ</param>
+	/// <param name="fileName">元のファイル名</param>
+	/// <returns>DDSのファイル名。無いか元のファイルより古ければ元のファイル名</returns>
+	static std::string ResolveCookedFileName(const std::string& directoryPath, const std::string& fileName);
+
+	/// <summary>
+	/// ミップNから末尾までを収めた分割ファイルの名前(tex.dds → tex.mipN.dds)
+	/// </summary>
+	/// <param name="fileName">DDSのファイル名</param>
+	/// <param name="mip">先頭のミップ。0なら元のファイル名</param>
+	/// <returns>分割ファイルの名前</returns>
+	static std::string MakeMipVariantFileName(const std::string& fileName, uint32_t mip);
+};
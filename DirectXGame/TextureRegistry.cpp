@@ -0,0 +1,32 @@
+#include "TextureRegistry.h"
+#include <base\TextureManager.h>
+
+using namespace KamataEngine;
+
+uint32_t TextureRegistry::Load(const std::string& fileName) {
+	uint32_t textureHandle = TextureManager::Load(fileName);
+	++GetInstance()->refCounts_[textureHandle];
+	return textureHandle;
+}
+
+void TextureRegistry::Unload(uint32_t textureHandle) {
+	std::unordered_map<uint32_t, uint32_t>& refCounts = GetInstance()->refCounts_;
+	auto it = refCounts.find(textureHandle);
+	if (it == refCounts.end()) {
+		return;
+	}
+	if (--it->second == 0) {
+		refCounts.erase(it);
+		TextureManager::Unload(textureHandle);
+	}
+}
+
+TextureRegistry* TextureRegistry::GetInstance() {
+	static TextureRegistry instance;
+	return &instance;
+}
+
+uint32_t TextureRegistry::GetRefCount(uint32_t textureHandle) const {
+	auto it = refCounts_.find(textureHandle);
+	return it != refCounts_.end() ? it->second : 0;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+/// <summary>
+/// ゲーム側のテクスチャの参照カウント
+/// TextureManagerは同じファイル名に同じハンドルを返すので、あるモジュールがUnloadすると他のモジュールが
+/// 使っているテクスチャまで消える。ゲーム側の読み込みと解放はすべてここを通し、最後の参照が手放されたときだけUnloadする
+/// </summary>
+class TextureRegistry {
+public:
+	/// <summary>
+	/// 読み込み(参照カウントを増やす)
+	/// </summary>
+	/// <param name="fileName">ファイル名</param>
+	/// <returns>TextureManagerのテクスチャハンドル</returns>
+	static uint32_t Load(const std::string& fileName);
+
+	/// <summary>
+	/// 参照を手放す。0になればTextureManagerから解放する
+	/// </summary>
+	/// <param name="textureHandle">テクスチャハンドル</param>
+	static void Unload(uint32_t textureHandle);
+
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static TextureRegistry* GetInstance();
+
+	// 参照カウントの取得
+	uint32_t GetRefCount(uint32_t textureHandle) const;
+
+private:
+	TextureRegistry() = default;
+	~TextureRegistry() = default;
+	TextureRegistry(const TextureRegistry&) = delete;
+	const TextureRegistry& operator=(const TextureRegistry&) = delete;
+
+	// テクスチャハンドルから参照カウントへの対応
+	std::unordered_map<uint32_t, uint32_t> refCounts_;
+};
@@ -0,0 +1,118 @@
+#include "TextureStreamer.h"
+#include "TextureCooker.h"
+#include "TextureRegistry.h"
+#include <DirectXTex.h>
+#include <base\StringUtility.h>
+#include <algorithm>
+#include <filesystem>
+
+using namespace KamataEngine;
+
+TextureStreamer* TextureStreamer::GetInstance() {
+	static TextureStreamer instance;
+	return &instance;
+}
+
+void TextureStreamer::Initialize(const std::string& directoryPath, uint64_t budgetBytes) {
+	directoryPath_ = directoryPath;
+	residency_.Initialize(budgetBytes);
+	entries_.clear();
+	changes_.clear();
+}
+
+void TextureStreamer::Finalize() {
+	for (const Entry& entry : entries_) {
+		if (!entry.fileName.empty()) {
+			AssetStreamer::GetInstance()->Cancel(entry.request);
+			TextureRegistry::Unload(entry.textureHandle);
+		}
+	}
+	Initialize(directoryPath_, residency_.GetBudget());
+}
+
+uint32_t TextureStreamer::Register(const std::string& fileName) {
+	std::string cookedFileName = TextureCooker::ResolveCookedFileName(directoryPath_, fileName);
+	std::wstring filePath = ConvertStringMultiByteToWide(directoryPath_ + cookedFileName);
+
+	DirectX::TexMetadata metadata{};
+	HRESULT result = S_FALSE;
+	if (cookedFileName != fileName || std::filesystem::path(fileName).extension() == ".dds") {
+		result = DirectX::GetMetadataFromDDSFile(filePath.c_str(), DirectX::DDS_FLAGS_NONE, metadata);
+	} else {
+		result = DirectX::GetMetadataFromWICFile(filePath.c_str(), DirectX::WIC_FLAGS_NONE, metadata);
+	}
+	if (FAILED(result)) {
+		return kInvalidHandle;
+	}
+
+	// ミップごとのバイト数。WICの画像はミップ1段として扱う
+	std::vector<uint64_t> mipBytes;
+	for (size_t mip = 0; mip < metadata.mipLevels; ++mip) {
+		size_t rowPitch = 0;
+		size_t slicePitch = 0;
+		DirectX::ComputePitch(metadata.format, (std::max)(metadata.width >> mip, size_t(1)), (std::max)(metadata.height >> mip, size_t(1)), rowPitch, slicePitch);
+		mipBytes.push_back(slicePitch);
+	}
+
+	// 連続して存在する分割ファイルの最後を常駐の下限にする
+	uint32_t tailMip = 0;
+	std::error_code ec;
+	while (tailMip + 1 < mipBytes.size() && std::filesystem::exists(directoryPath_ + TextureCooker::MakeMipVariantFileName(cookedFileName, tailMip + 1), ec)) {
+		++tailMip;
+	}
+
+	uint32_t id = residency_.Register(static_cast<uint32_t>(metadata.width), static_cast<uint32_t>(metadata.height), mipBytes, tailMip);
+	if (id == kInvalidHandle) {
+		return kInvalidHandle;
+	}
+	if (entries_.size() <= id) {
+		entries_.resize(id + 1);
+	}
+	Entry& entry = entries_[id];
+	entry = Entry{};
+	entry.fileName = cookedFileName;
+	entry.textureHandle = TextureRegistry::Load(TextureCooker::MakeMipVariantFileName(cookedFileName, tailMip));
+	entry.loadedMip = residency_.GetResidentMip(id);
+	return id;
+}
+
+void TextureStreamer::Update() {
+	residency_.Update(changes_);
+
+	// 変更はテクスチャごとに最終的な段階1つなので、その分割ファイルだけを読む
+	for (const MipResidencyManager::Change& change : changes_) {
+		Entry& entry = entries_[change.id];
+		// 読み込み中の段階はもう要らない
+		if (entry.request != AssetStreamer::kInvalidRequest) {
+			AssetStreamer::GetInstance()->Cancel(entry.request);
+			entry.request = AssetStreamer::kInvalidRequest;
+		}
+		if (change.targetMip == entry.loadedMip) {
+			continue;
+		}
+		uint32_t id = change.id;
+		uint32_t mip = change.targetMip;
+		// 詳細にする方を先に読む。TextureManagerはファイルから読み直すので、アーカイブではなく同じファイルを先読みする
+		AssetStreamer::Priority priority = mip < entry.loadedMip ? AssetStreamer::Priority::kNormal : AssetStreamer::Priority::kLow;
+		entry.request = AssetStreamer::GetInstance()->Request(
+		    directoryPath_ + TextureCooker::MakeMipVariantFileName(entry.fileName, mip), priority, nullptr, [this, id, mip](bool succeeded, const AssetView&) { OnMipLoaded(id, mip, succeeded); },
+		    true);
+	}
+}
+
+void TextureStreamer::OnMipLoaded(uint32_t id, uint32_t mip, bool succeeded) {
+	Entry& entry = entries_[id];
+	entry.request = AssetStreamer::kInvalidRequest;
+	if (!succeeded) {
+		// 読めなければ今の段階のまま描く。常駐管理が要求を取り消し、しばらくしてから要求し直す
+		residency_.OnLoadCompleted(id, mip, false);
+		return;
+	}
+	// ファイルキャッシュに載っているので、TextureManagerの読み込みはデコードと転送だけになる。
+	// 新しい段階を読み込んでから古い段階を解放する
+	uint32_t previousHandle = entry.textureHandle;
+	entry.textureHandle = TextureRegistry::Load(TextureCooker::MakeMipVariantFileName(entry.fileName, mip));
+	entry.loadedMip = mip;
+	TextureRegistry::Unload(previousHandle);
+	residency_.OnLoadCompleted(id, mip, true);
+}
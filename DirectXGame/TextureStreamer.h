@@ -0,0 +1,92 @@
+#pragma once
+#include "AssetStreamer.h"
+#include "MipResidencyManager.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// ミップストリーミング
+/// TextureCookerが書き出した分割ファイル(tex.mipN.dds)を使い、最初は最も粗い段階だけを読み込む。
+/// 描画側が報告した画面上の大きさに応じて、より詳細な分割ファイルへ差し替える。
+/// 分割ファイルはAssetStreamerで先読みし、届いてから差し替える(それまでは今の段階で描く)
+/// </summary>
+class TextureStreamer {
+public:
+	// 無効なハンドル
+	static const uint32_t kInvalidHandle = MipResidencyManager::kInvalidId;
+
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static TextureStreamer* GetInstance();
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="directoryPath">テクスチャを読み込むディレクトリ(TextureManagerと同じ)</param>
+	/// <param name="budgetBytes">ストリーミング対象の予算(バイト)</param>
+	void Initialize(const std::string& directoryPath = "Resources/", uint64_t budgetBytes = MipResidencyManager::kDefaultBudget);
+
+	/// <summary>
+	/// 終了処理。読み込んだテクスチャをすべて解放する
+	/// </summary>
+	void Finalize();
+
+	/// <summary>
+	/// テクスチャの登録。分割ファイルがあれば最も粗い段階を、無ければ全体を読み込む
+	/// </summary>
+	/// <param name="fileName">ファイル名</param>
+	/// <returns>ハンドル。失敗時はkInvalidHandle</returns>
+	uint32_t Register(const std::string& fileName);
+
+	/// <summary>
+	/// 使用の報告(Sprite/Modelを描画する箇所から呼ぶ)
+	/// </summary>
+	/// <param name="handle">ハンドル</param>
+	/// <param name="screenWidth">画面上の幅(ピクセル)</param>
+	/// <param name="screenHeight">画面上の高さ(ピクセル)</param>
+	void RequestUsage(uint32_t handle, float screenWidth, float screenHeight) { residency_.RequestUsage(handle, screenWidth, screenHeight); }
+
+	/// <summary>
+	/// 毎フレームの更新。常駐させる段階を決め直し、分割ファイルの読み込みを要求する
+	/// (差し替えはAssetStreamer::Updateの完了通知で行う)
+	/// </summary>
+	void Update();
+
+	/// <summary>
+	/// 描画に使うテクスチャハンドルの取得(差し替えで変わるので毎フレーム取得する)
+	/// </summary>
+	/// <param name="handle">ハンドル</param>
+	/// <returns>TextureManagerのテクスチャハンドル</returns>
+	uint32_t GetTextureHandle(uint32_t handle) const { return entries_[handle].textureHandle; }
+
+	// 常駐管理の取得
+	const MipResidencyManager& GetResidency() const { return residency_; }
+
+private:
+	struct Entry {
+		// 元のDDSのファイル名
+		std::string fileName;
+		uint32_t textureHandle = 0;
+		// textureHandleの段階
+		uint32_t loadedMip = 0;
+		// 読み込み中の要求
+		AssetStreamer::RequestId request = AssetStreamer::kInvalidRequest;
+	};
+
+	TextureStreamer() = default;
+	~TextureStreamer() = default;
+	TextureStreamer(const TextureStreamer&) = delete;
+	const TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+	// 分割ファイルの先読みの完了(メインスレッド)
+	void OnMipLoaded(uint32_t id, uint32_t mip, bool succeeded);
+
+	std::string directoryPath_;
+	MipResidencyManager residency_;
+	// 常駐管理のIDで引く
+	std::vector<Entry> entries_;
+	std::vector<MipResidencyManager::Change> changes_;
+};
@@ -0,0 +1,66 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+ThreadPool::~ThreadPool() { Stop(); }
+
+void ThreadPool::Start(uint32_t threadCount) {
+	Stop();
+	if (threadCount == 0) {
+		threadCount = (std::max)(std::thread::hardware_concurrency(), 2u) - 1;
+	}
+	stopping_ = false;
+	for (uint32_t i = 0; i < threadCount; ++i) {
+		threads_.emplace_back(&ThreadPool::WorkerMain, this);
+	}
+}
+
+void ThreadPool::Stop() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = true;
+		jobs_.clear();
+	}
+	jobAvailable_.notify_all();
+	for (std::thread& thread : threads_) {
+		thread.join();
+	}
+	threads_.clear();
+	idle_.notify_all();
+}
+
+void ThreadPool::Submit(std::function<void()> job) {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		jobs_.push_back(std::move(job));
+	}
+	jobAvailable_.notify_one();
+}
+
+void ThreadPool::WaitIdle() {
+	std::unique_lock<std::mutex> lock(mutex_);
+	idle_.wait(lock, [this] { return (jobs_.empty() && activeJobs_ == 0) || threads_.empty(); });
+}
+
+void ThreadPool::WorkerMain() {
+	while (true) {
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			jobAvailable_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+			if (stopping_) {
+				return;
+			}
+			job = std::move(jobs_.front());
+			jobs_.pop_front();
+			++activeJobs_;
+		}
+		job();
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			--activeJobs_;
+			if (jobs_.empty() && activeJobs_ == 0) {
+				idle_.notify_all();
+			}
+		}
+	}
+}
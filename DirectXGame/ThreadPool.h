@@ -0,0 +1,60 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// ワーカースレッドのプール
+/// 投入されたジョブを先着順に空いているスレッドで実行する
+/// </summary>
+class ThreadPool {
+public:
+	ThreadPool() = default;
+	~ThreadPool();
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	/// <summary>
+	/// スレッドの起動
+	/// </summary>
+	/// <param name="threadCount">スレッド数。0ならハードウェアスレッド数-1(最低1)</param>
+	void Start(uint32_t threadCount = 0);
+
+	/// <summary>
+	/// 未実行のジョブを捨ててスレッドを終了する
+	/// </summary>
+	void Stop();
+
+	/// <summary>
+	/// ジョブの投入
+	/// </summary>
+	/// <param name="job">ジョブ</param>
+	void Submit(std::function<void()> job);
+
+	/// <summary>
+	/// 投入済みのジョブがすべて終わるまで待つ
+	/// </summary>
+	void WaitIdle();
+
+	// スレッド数の取得
+	uint32_t GetThreadCount() const { return static_cast<uint32_t>(threads_.size()); }
+	// 起動しているか(停止中は投入したジョブが実行されない)
+	bool IsRunning() const { return !threads_.empty(); }
+
+private:
+	// スレッドの処理
+	void WorkerMain();
+
+	std::vector<std::thread> threads_;
+	std::deque<std::function<void()>> jobs_;
+	std::mutex mutex_;
+	std::condition_variable jobAvailable_;
+	std::condition_variable idle_;
+	// 実行中のジョブ数
+	uint32_t activeJobs_ = 0;
+	bool stopping_ = false;
+};
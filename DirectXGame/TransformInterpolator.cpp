@@ -0,0 +1,39 @@
+#include "TransformInterpolator.h"
+#include <cmath>
+#include <numbers>
+
+using namespace KamataEngine;
+using namespace KamataEngine::MathUtility;
+
+namespace {
+
+Vector3 LerpVector3(const Vector3& a, const Vector3& b, float t) { return {Lerp(a.x, b.x, t), Lerp(a.y, b.y, t), Lerp(a.z, b.z, t)}; }
+
+// 角度の補間。差を[-π,π]に畳んで近い向きに回す(πをまたいだティックで逆回りしない)
+float LerpAngle(float a, float b, float t) { return a + std::remainder(b - a, 2.0f * std::numbers::pi_v<float>) * t; }
+
+Vector3 LerpAngles(const Vector3& a, const Vector3& b, float t) { return {LerpAngle(a.x, b.x, t), LerpAngle(a.y, b.y, t), LerpAngle(a.z, b.z, t)}; }
+
+} // namespace
+
+void TransformInterpolator::Reset(const WorldTransform& worldTransform) {
+	current_ = {worldTransform.scale_, worldTransform.rotation_, worldTransform.translation_};
+	previous_ = current_;
+}
+
+void TransformInterpolator::Capture(const WorldTransform& worldTransform) {
+	previous_ = current_;
+	current_ = {worldTransform.scale_, worldTransform.rotation_, worldTransform.translation_};
+}
+
+void TransformInterpolator::Apply(WorldTransform& worldTransform, float alpha) const {
+	Vector3 scale = LerpVector3(previous_.scale, current_.scale, alpha);
+	Vector3 rotation = LerpAngles(previous_.rotation, current_.rotation, alpha);
+	Vector3 translation = LerpVector3(previous_.translation, current_.translation, alpha);
+
+	worldTransform.matWorld_ = MakeScaleMatrix(scale) * MakeRotateXMatrix(rotation.x) * MakeRotateYMatrix(rotation.y) * MakeRotateZMatrix(rotation.z) * MakeTranslateMatrix(translation);
+	if (worldTransform.parent_) {
+		worldTransform.matWorld_ *= worldTransform.parent_->matWorld_;
+	}
+	worldTransform.TransferMatrix();
+}
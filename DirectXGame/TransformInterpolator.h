@@ -0,0 +1,43 @@
+#pragma once
+#include "KamataEngine.h"
+
+/// <summary>
+/// 固定ティック間のワールド変換補間
+/// ティック毎にシミュレーション結果を記録し、描画時に前後のティックを補間した行列を転送する
+/// </summary>
+class TransformInterpolator {
+public:
+	/// <summary>
+	/// 現在の状態で前後のティックを揃える(生成直後やワープ時に呼ぶ)
+	/// </summary>
+	/// <param name="worldTransform">ワールド変換データ</param>
+	void Reset(const KamataEngine::WorldTransform& worldTransform);
+
+	/// <summary>
+	/// 固定更新後の状態を記録する
+	/// </summary>
+	/// <param name="worldTransform">ワールド変換データ</param>
+	void Capture(const KamataEngine::WorldTransform& worldTransform);
+
+	/// <summary>
+	/// 補間した行列をワールド変換データに設定して転送する
+	/// シミュレーション用のスケール・回転・座標は書き換えない
+	/// 回転は各軸とも近い向きに補間する(1ティックでの回転はπ未満であること)
+	/// </summary>
+	/// <param name="worldTransform">ワールド変換データ</param>
+	/// <param name="alpha">補間係数</param>
+	void Apply(KamataEngine::WorldTransform& worldTransform, float alpha) const;
+
+private:
+	// 変換の状態
+	struct State {
+		KamataEngine::Vector3 scale = {1, 1, 1};
+		KamataEngine::Vector3 rotation = {0, 0, 0};
+		KamataEngine::Vector3 translation = {0, 0, 0};
+	};
+
+	// 直前のティックの状態
+	State previous_;
+	// 最新のティックの状態
+	State current_;
+};
@@ -0,0 +1,52 @@
+#include "UploadRingAllocator.h"
+
+UploadRingAllocator::UploadRingAllocator(size_t capacity) : capacity_(capacity) {}
+
+size_t UploadRingAllocator::Allocate(size_t size, size_t alignment, uint64_t frameIndex) {
+	if (size == 0 || size > capacity_) {
+		return kInvalidOffset;
+	}
+	if (frames_.empty()) {
+		// 空なら先頭から使い、折り返しを減らす
+		head_ = 0;
+		tail_ = 0;
+	}
+
+	size_t offset = (head_ + alignment - 1) & ~(alignment - 1);
+	if (frames_.empty() || head_ > tail_) {
+		// 使用中領域は[tail, head)。末尾に収まらなければ先頭の[0, tail)を使う
+		if (offset + size > capacity_) {
+			if (size > tail_ && !frames_.empty()) {
+				return kInvalidOffset;
+			}
+			offset = 0;
+		}
+	} else {
+		// 折り返し済みで空きは[head, tail)
+		if (offset + size > tail_) {
+			return kInvalidOffset;
+		}
+	}
+
+	head_ = offset + size;
+	if (!frames_.empty() && frames_.back().frameIndex == frameIndex) {
+		frames_.back().end = head_;
+	} else {
+		frames_.push_back({frameIndex, head_});
+	}
+	return offset;
+}
+
+void UploadRingAllocator::Reclaim(uint64_t completedFrameIndex) {
+	while (!frames_.empty() && frames_.front().frameIndex <= completedFrameIndex) {
+		tail_ = frames_.front().end;
+		frames_.pop_front();
+	}
+}
+
+size_t UploadRingAllocator::GetUsedBytes() const {
+	if (frames_.empty()) {
+		return 0;
+	}
+	return head_ > tail_ ? head_ - tail_ : capacity_ - tail_ + head_;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+/// <summary>
+/// フレーム単位で解放するリングバッファの領域割り当て
+/// 割り当てた領域には使用したフレーム番号を付け、GPUがそのフレームを完了したら末尾からまとめて解放する
+/// </summary>
+class UploadRingAllocator {
+public:
+	// 割り当て失敗
+	static constexpr size_t kInvalidOffset = SIZE_MAX;
+
+	/// <summary>
+	/// コンストラクタ
+	/// </summary>
+	/// <param name="capacity">リングのバイト数</param>
+	explicit UploadRingAllocator(size_t capacity);
+
+	/// <summary>
+	/// 領域の割り当て。末尾に収まらなければ先頭に戻る
+	/// </summary>
+	/// <param name="size">バイト数</param>
+	/// <param name="alignment">アラインメント(2の累乗)</param>
+	/// <param name="frameIndex">領域を使うフレーム番号(単調増加)</param>
+	/// <returns>オフセット。空きが無ければkInvalidOffset</returns>
+	size_t Allocate(size_t size, size_t alignment, uint64_t frameIndex);
+
+	/// <summary>
+	/// 完了したフレームの領域を解放する
+	/// </summary>
+	/// <param name="completedFrameIndex">GPUで完了済みのフレーム番号</param>
+	void Reclaim(uint64_t completedFrameIndex);
+
+	// 使用中のバイト数(折り返しで捨てた末尾を含む)
+	size_t GetUsedBytes() const;
+	// リングのバイト数
+	size_t GetCapacity() const { return capacity_; }
+
+private:
+	// フレームごとの割り当ての終端
+	struct FrameRecord {
+		uint64_t frameIndex;
+		size_t end;
+	};
+
+	size_t capacity_;
+	// 次に割り当てる位置
+	size_t head_ = 0;
+	// 最も古い使用中領域の先頭
+	size_t tail_ = 0;
+	std::deque<FrameRecord> frames_;
+};
@@ -0,0 +1,61 @@
+#include "UploadRingBuffer.h"
+#include <cstring>
+
+UploadRingBuffer::UploadRingBuffer(RenderDevice* device, size_t capacity)
+    : device_(device), ring_(device->CreateBuffer(capacity, BufferUsage::kUpload)), allocator_(capacity), windowBegin_(std::chrono::steady_clock::now()) {}
+
+bool UploadRingBuffer::Upload(RenderBuffer* dst, size_t dstOffset, const void* data, size_t size) {
+	void* destination = Allocate(dst, dstOffset, size);
+	if (!destination) {
+		return false;
+	}
+	std::memcpy(destination, data, size);
+	return true;
+}
+
+void* UploadRingBuffer::Allocate(RenderBuffer* dst, size_t dstOffset, size_t size) {
+	if (!ring_) {
+		return nullptr;
+	}
+	uint64_t frameIndex = device_->GetFrameIndex();
+	size_t offset = allocator_.Allocate(size, kAlignment, frameIndex);
+	if (offset == UploadRingAllocator::kInvalidOffset) {
+		// 完了したフレームの領域を回収してからもう一度試す
+		allocator_.Reclaim(device_->GetCompletedFrameIndex());
+		offset = allocator_.Allocate(size, kAlignment, frameIndex);
+		if (offset == UploadRingAllocator::kInvalidOffset) {
+			++statistics_.allocationFailures;
+			return nullptr;
+		}
+	}
+	pending_.push_back({dst, dstOffset, ring_.get(), offset, size});
+	ring_->NotifyWritten(size);
+	return static_cast<uint8_t*>(ring_->GetMappedAddress()) + offset;
+}
+
+void UploadRingBuffer::Flush() {
+	allocator_.Reclaim(device_->GetCompletedFrameIndex());
+
+	uint64_t bytes = 0;
+	for (const BufferCopy& copy : pending_) {
+		bytes += copy.size;
+	}
+	if (!pending_.empty()) {
+		device_->GetCommandList()->CopyBuffers(pending_.data(), pending_.size());
+		statistics_.copies += pending_.size();
+		++statistics_.submissions;
+		pending_.clear();
+	}
+	statistics_.bytesUploaded += bytes;
+	statistics_.lastFlushBytes = bytes;
+
+	// 1秒ごとに転送量を更新する
+	windowBytes_ += bytes;
+	auto now = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(now - windowBegin_).count();
+	if (seconds >= 1.0) {
+		statistics_.bytesPerSecond = windowBytes_ / seconds;
+		windowBytes_ = 0;
+		windowBegin_ = now;
+	}
+}
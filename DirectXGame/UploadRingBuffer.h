@@ -0,0 +1,84 @@
+#pragma once
+#include "RenderDevice.h"
+#include "UploadRingAllocator.h"
+#include <chrono>
+#include <memory>
+#include <vector>
+
+/// <summary>
+/// 常時マップしたアップロード用リングバッファ
+/// 転送ごとに中間リソースを作らず、リングから切り出した領域に書き込んでコピーを溜め、
+/// 1フレームに1回まとめて記録する。領域はGPUがそのフレームを完了したら再利用する
+/// </summary>
+class UploadRingBuffer {
+public:
+	// 既定のリングのバイト数
+	static const size_t kDefaultCapacity = 16 * 1024 * 1024;
+	// 領域のアラインメント
+	static const size_t kAlignment = 256;
+
+	/// <summary>
+	/// 統計
+	/// </summary>
+	struct Statistics {
+		// 累計の転送バイト数
+		uint64_t bytesUploaded = 0;
+		// 累計のコピー数
+		uint64_t copies = 0;
+		// コピーを記録した回数
+		uint64_t submissions = 0;
+		// リングに空きが無く失敗した回数
+		uint64_t allocationFailures = 0;
+		// 直近のFlushで記録したバイト数
+		uint64_t lastFlushBytes = 0;
+		// 直近1秒あたりの転送量(バイト/秒)
+		double bytesPerSecond = 0.0;
+	};
+
+	/// <summary>
+	/// コンストラクタ
+	/// </summary>
+	/// <param name="device">描画デバイス</param>
+	/// <param name="capacity">リングのバイト数</param>
+	explicit UploadRingBuffer(RenderDevice* device, size_t capacity = kDefaultCapacity);
+
+	/// <summary>
+	/// 転送の予約。データはリングにコピーされるので呼び出し後に破棄してよい
+	/// </summary>
+	/// <param name="dst">転送先(kDefault)</param>
+	/// <param name="dstOffset">転送先の位置</param>
+	/// <param name="data">データ</param>
+	/// <param name="size">バイト数</param>
+	/// <returns>成否。リングに空きが無ければfalse(次のフレームで再試行する)</returns>
+	bool Upload(RenderBuffer* dst, size_t dstOffset, const void* data, size_t size);
+
+	/// <summary>
+	/// 転送の予約。戻り値の領域にFlushまでに直接書き込む
+	/// </summary>
+	/// <param name="dst">転送先(kDefault)</param>
+	/// <param name="dstOffset">転送先の位置</param>
+	/// <param name="size">バイト数</param>
+	/// <returns>書き込み先。失敗時はnullptr</returns>
+	void* Allocate(RenderBuffer* dst, size_t dstOffset, size_t size);
+
+	/// <summary>
+	/// 溜めたコピーを現在のフレームのコマンドリストにまとめて記録する(BeginFrameの後、描画の前)
+	/// </summary>
+	void Flush();
+
+	// 統計の取得
+	const Statistics& GetStatistics() const { return statistics_; }
+	// 使用中のバイト数
+	size_t GetUsedBytes() const { return allocator_.GetUsedBytes(); }
+
+private:
+	RenderDevice* device_;
+	std::unique_ptr<RenderBuffer> ring_;
+	UploadRingAllocator allocator_;
+	// 記録待ちのコピー
+	std::vector<BufferCopy> pending_;
+	// 転送量の計測
+	std::chrono::steady_clock::time_point windowBegin_;
+	uint64_t windowBytes_ = 0;
+	Statistics statistics_;
+};
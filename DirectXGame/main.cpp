@@ -1,10 +1,52 @@
 #include <Windows.h>
 #include "KamataEngine.h"
 #include "GameScene.h"
+#include "AssetArchiveBuilder.h"
+#include "AssetIO.h"
+#include "AssetStreamer.h"
+#include "AsyncTextureLoader.h"
+#include "D3D12RenderDevice.h"
+#include "FrameTelemetry.h"
+#include "GameLoop.h"
+#include "GpuProfiler.h"
+#include "HeadlessRunner.h"
+#include "Profiler.h"
+#include "SoundLibrary.h"
+#include "SpatialAudio.h"
+#include "SpriteStressScene.h"
+#include "StreamingAudio.h"
+#include "TextureCache.h"
+#include "TextureCooker.h"
+#include "TextureStreamer.h"
 
 // Windowsアプリでのエントリーポイント(main関数)
-int WINAPI WinMain(_In_ HINSTANCE, _In_opt_ HINSTANCE, _In_ LPSTR, _In_ int) {
-	
+int WINAPI WinMain(_In_ HINSTANCE, _In_opt_ HINSTANCE, _In_ LPSTR lpCmdLine, _In_ int) {
+
+	// "--cook"指定時はテクスチャをDDSにクックして終了する(不透明ならBC1、α付きならBC3。"--bc7"でBC7)
+	if (strstr(lpCmdLine, "--cook") != nullptr) {
+		HRESULT result = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+		if (FAILED(result)) {
+			return 1;
+		}
+		TextureCooker::CookDirectory("Resources/", strstr(lpCmdLine, "--bc7") ? TextureCooker::Format::kBC7 : TextureCooker::Format::kAuto);
+		CoUninitialize();
+		return 0;
+	}
+
+	// "--pack"指定時はResources以下をアーカイブにまとめて終了する
+	if (strstr(lpCmdLine, "--pack") != nullptr) {
+		AssetArchiveBuilder builder;
+		builder.AddDirectory("Resources/");
+		return builder.Build("Resources.pak") ? 0 : 1;
+	}
+
+	// "--headless"指定時はウィンドウを作らず、ヌル描画デバイスでスプライトの負荷シーンを回して描画統計を書き出して終了する
+	// ("--frames=N"でフレーム数を指定)。GameSceneはエンジンで描くのでヘッドレスでは回せない
+	if (strstr(lpCmdLine, "--headless") != nullptr) {
+		const char* frames = strstr(lpCmdLine, "--frames=");
+		return HeadlessRunner::Run(std::make_unique<SpriteStressScene>(), frames ? static_cast<uint32_t>(strtoul(frames + strlen("--frames="), nullptr, 10)) : HeadlessRunner::kDefaultFrameCount);
+	}
+
 	// KamataEngineの初期化
 	KamataEngine::Initialize(L"LE2B_08_コイズミ_リョウ_AL3");
 
@@ -13,34 +55,179 @@ int WINAPI WinMain(_In_ HINSTANCE, _In_opt_ HINSTANCE, _In_ LPSTR, _In_ int) {
 	// DirectXCommonインスタンスの取得
 	DirectXCommon* dx_common = DirectXCommon::GetInstance();
 
+	// パック済みのアーカイブがあればResources以下の読み出しはそこから引く
+	AssetIO* assetIO = AssetIO::GetInstance();
+	assetIO->Mount("Resources.pak");
+	// アセットストリーミングの初期化
+	AssetStreamer* assetStreamer = AssetStreamer::GetInstance();
+	assetStreamer->Initialize();
+
+	// ストリーミング再生の初期化
+	StreamingAudio* streamingAudio = StreamingAudio::GetInstance();
+	streamingAudio->Initialize();
+	// ミキサー用の音声の置き場の初期化
+	SoundLibrary* soundLibrary = SoundLibrary::GetInstance();
+	soundLibrary->Initialize();
+	// ソフトウェアミキサーの出力をストリーミング再生で流す(4KBずつ4枚で約85msの遅延)
+	std::unique_ptr<AudioMixer> audioMixer = std::make_unique<AudioMixer>();
+	streamingAudio->Play(audioMixer->CreateOutputSource(), false, 1.0f, 4, 4 * 1024);
+	// 3Dサウンドの初期化
+	SpatialAudio* spatialAudio = SpatialAudio::GetInstance();
+	spatialAudio->Initialize(audioMixer.get());
+
+	// テクスチャの非同期読み込みの初期化
+	AsyncTextureLoader* asyncTextureLoader = AsyncTextureLoader::GetInstance();
+	asyncTextureLoader->Initialize();
+	// 内容で重複を排除するテクスチャキャッシュの初期化
+	TextureCache* textureCache = TextureCache::GetInstance();
+	textureCache->Initialize();
+	// ミップストリーミングの初期化
+	TextureStreamer* textureStreamer = TextureStreamer::GetInstance();
+	textureStreamer->Initialize();
+
+	// 描画デバイスの生成
+	std::unique_ptr<RenderDevice> renderDevice = std::make_unique<D3D12RenderDevice>(dx_common);
+
 	// ゲームシーンのインスタンスを作成
 	GameScene* gameScene = new GameScene();
 	// ゲームシーンの初期化
-	gameScene->Initialize();
+	gameScene->Initialize(renderDevice.get());
+
+	// 固定タイムステップのゲームループの初期化
+	GameLoop* gameLoop = GameLoop::GetInstance();
+	gameLoop->Initialize();
+
+	// フレームペーシング計測の初期化
+	FrameTelemetry* frameTelemetry = FrameTelemetry::GetInstance();
+	frameTelemetry->Initialize();
+
+#ifdef USE_PROFILER
+	// GPU計測の初期化
+	GpuProfiler* gpuProfiler = GpuProfiler::GetInstance();
+	gpuProfiler->Initialize(dx_common);
+#endif
 
 	// KamataEngineのメインループ
 	while (true) {
+		// プロファイラのフレーム境界
+		PROFILE_FRAME();
+
 		// エンジンの更新
-		if (KamataEngine::Update()) {
-			break;
+		{
+			PROFILE_SCOPE("KamataEngine::Update");
+			if (KamataEngine::Update()) {
+				break;
+			}
+		}
+
+		// 読み込みの終わったアセットの完了通知
+		{
+			PROFILE_SCOPE("AssetStreamer::Update");
+			assetStreamer->Update();
 		}
 
-		// ゲームシーンの更新
-		gameScene->Update();
+		// 再生し終えたストリームの片付け
+		streamingAudio->Update();
+
+		// 読み出しの終わったテクスチャの登録
+		{
+			PROFILE_SCOPE("AsyncTextureLoader::Update");
+			asyncTextureLoader->Update();
+		}
+
+		// 前フレームの描画で報告された使用状況からミップを差し替え
+		{
+			PROFILE_SCOPE("TextureStreamer::Update");
+			textureStreamer->Update();
+		}
+
+		// 蓄積した経過時間の分だけ固定周期でゲームシーンを更新
+		gameLoop->BeginFrame();
+		while (gameLoop->Step()) {
+			PROFILE_SCOPE("GameScene::Update");
+			gameScene->Update();
+		}
+
+		// 更新した発音体の位置をミキサーのボイスに反映
+		{
+			PROFILE_SCOPE("SpatialAudio::Update");
+			spatialAudio->Update(gameLoop->GetStepsThisFrame() * gameLoop->GetFixedDeltaTime());
+		}
+
+#ifdef USE_PROFILER
+		// プロファイラの表示
+		Profiler::GetInstance()->DrawImGui();
+#endif
+		frameTelemetry->DrawImGui();
 
 		// 描画開始
-		dx_common->PreDraw();
+		{
+			PROFILE_SCOPE("DirectXCommon::PreDraw");
+			frameTelemetry->BeginPreDraw();
+			dx_common->PreDraw();
+			frameTelemetry->EndPreDraw();
+		}
+		renderDevice->BeginFrame();
+#ifdef USE_PROFILER
+		gpuProfiler->BeginFrame();
+#endif
 
 		// ゲームシーンの描画
-		gameScene->Draw();
+		{
+			PROFILE_SCOPE("GameScene::Draw");
+			GPU_PROFILE_SCOPE(dx_common->GetCommandList(), "GameScene::Draw");
+			gameScene->Draw();
+		}
+
+#ifdef USE_PROFILER
+		gpuProfiler->EndFrame();
+#endif
+		renderDevice->EndFrame();
 
 		// 描画狩猟
-		dx_common->PostDraw();
+		{
+			PROFILE_SCOPE("DirectXCommon::PostDraw");
+			frameTelemetry->BeginPostDraw();
+			dx_common->PostDraw();
+			frameTelemetry->EndPostDraw();
+		}
 	}
 
 	// ゲームシーンの解放
 	delete gameScene;
 
+	// 描画デバイスの解放
+	renderDevice.reset();
+
+	// ミップストリーミングの終了処理
+	textureStreamer->Finalize();
+	// テクスチャキャッシュの終了処理
+	textureCache->Finalize();
+	// テクスチャの非同期読み込みの終了処理
+	asyncTextureLoader->Finalize();
+
+	// 3Dサウンドの終了処理
+	spatialAudio->Finalize();
+	// ストリーミング再生の終了処理(ミキサーの出力を読むストリームもここで止まる)
+	streamingAudio->Finalize();
+	audioMixer.reset();
+	// ミキサー用の音声の解放
+	soundLibrary->Finalize();
+
+	// アセットストリーミングの終了処理
+	assetStreamer->Finalize();
+	// アーカイブのマウント解除
+	assetIO->UnmountAll();
+
+#ifdef USE_PROFILER
+	// GPU計測の終了処理
+	gpuProfiler->Finalize();
+#ifndef USE_IMGUI
+	// ImGuiの無いReleaseでは書き出しボタンが無いので、終了時に直近の履歴を書き出す
+	Profiler::GetInstance()->ExportChromeTrace("profile_trace.json");
+#endif
+#endif
+
 	// KamataEngineの終了処理
 	KamataEngine::Finalize();
 
@@ -0,0 +1,128 @@
+#include "AssetArchiveBuilder.h"
+#include "AssetIO.h"
+#include "Test.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace {
+
+void WriteFile(const std::filesystem::path& path, const std::vector<uint8_t>& data) {
+	std::filesystem::create_directories(path.parent_path());
+	std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+std::vector<uint8_t> ReadFile(const std::filesystem::path& path) {
+	std::ifstream file(path, std::ios::binary);
+	return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// 縮まない雑音
+std::vector<uint8_t> CreateNoise(size_t size) {
+	std::vector<uint8_t> data(size);
+	uint32_t state = 3;
+	for (uint8_t& value : data) {
+		state = state * 1664525u + 1013904223u;
+		value = static_cast<uint8_t>(state >> 24);
+	}
+	return data;
+}
+
+bool Equals(const AssetView& view, const std::vector<uint8_t>& data) { return view && view.GetSize() == data.size() && std::equal(data.begin(), data.end(), view.GetData()); }
+
+} // namespace
+
+TEST(AssetArchive, BuildsAndMounts) {
+	// 縮むもの(LZ4で格納)、縮まないもの(そのまま格納)、空のファイル、サブディレクトリのファイルをまとめる
+	const std::filesystem::path root = std::filesystem::temp_directory_path() / "AssetArchiveTest";
+	std::filesystem::remove_all(root);
+	const std::vector<uint8_t> text(50000, 'a');
+	const std::vector<uint8_t> noise = CreateNoise(10000);
+	WriteFile(root / "Source/text.txt", text);
+	WriteFile(root / "Source/Cube/noise.bin", noise);
+	WriteFile(root / "Source/empty.bin", {});
+
+	AssetArchiveBuilder builder;
+	EXPECT_EQ(3u, builder.AddDirectory((root / "Source").string()));
+	const std::string archivePath = (root / "Assets.pak").string();
+	EXPECT_TRUE(builder.Build(archivePath));
+	EXPECT_EQ(3u, builder.GetStatistics().fileCount);
+	EXPECT_EQ(1u, builder.GetStatistics().compressedCount);
+	EXPECT_EQ(uint64_t{text.size() + noise.size()}, builder.GetStatistics().rawBytes);
+
+	// 索引は整列していて、中身は4KiB境界に置かれる
+	std::vector<uint8_t> bytes = ReadFile(archivePath);
+	EXPECT_EQ(uint64_t{bytes.size()}, builder.GetStatistics().archiveBytes);
+	AssetArchive archive;
+	EXPECT_TRUE(archive.Open(bytes));
+	EXPECT_EQ(3u, archive.GetEntryCount());
+	bool sorted = true;
+	bool aligned = true;
+	for (size_t i = 0; i < archive.GetIndex().size(); ++i) {
+		const AssetArchive::IndexEntry& entry = archive.GetIndex()[i];
+		sorted = sorted && (i == 0 || archive.GetIndex()[i - 1].hash <= entry.hash);
+		aligned = aligned && entry.offset % AssetArchive::kAlignment == 0;
+	}
+	EXPECT_TRUE(sorted);
+	EXPECT_TRUE(aligned);
+	// 名前は区切りと大文字小文字を区別しない
+	const AssetArchive::IndexEntry* entry = archive.Find("CUBE\\Noise.bin");
+	EXPECT_TRUE(entry != nullptr);
+	EXPECT_TRUE(entry != nullptr && entry->compression == AssetArchive::Compression::kNone);
+	EXPECT_TRUE(archive.Find("missing.bin") == nullptr);
+
+	// マウントすると、マウント先以下のパスはアーカイブから引く(ファイルを消しても読める)
+	std::filesystem::remove_all(root / "Source");
+	AssetIO* assetIO = AssetIO::GetInstance();
+	const std::string mountPoint = (root / "Resources/").generic_string();
+	EXPECT_TRUE(assetIO->Mount(archivePath, mountPoint));
+	EXPECT_EQ(archivePath, assetIO->FindArchive(mountPoint + "text.txt"));
+	EXPECT_EQ(std::string(), assetIO->FindArchive(mountPoint + "missing.txt"));
+	EXPECT_EQ(std::string(), assetIO->FindArchive((root / "text.txt").string()));
+	uint64_t archiveCount = assetIO->GetStatistics().archiveCount;
+	EXPECT_TRUE(Equals(assetIO->Map(mountPoint + "text.txt"), text));
+	EXPECT_TRUE(Equals(assetIO->Map(mountPoint + "cube/noise.bin"), noise));
+	EXPECT_EQ(archiveCount + 2, assetIO->GetStatistics().archiveCount);
+	EXPECT_FALSE(static_cast<bool>(assetIO->Map(mountPoint + "missing.txt")));
+
+	// 解除した後は引かないが、取得済みのビューは有効なまま
+	AssetView view = assetIO->Map(mountPoint + "cube/noise.bin");
+	assetIO->UnmountAll();
+	EXPECT_TRUE(Equals(view, noise));
+	EXPECT_EQ(std::string(), assetIO->FindArchive(mountPoint + "text.txt"));
+	EXPECT_FALSE(static_cast<bool>(assetIO->Map(mountPoint + "text.txt")));
+	view = AssetView();
+	std::filesystem::remove_all(root);
+}
+
+TEST(AssetArchive, RejectsCorruptIndex) {
+	const std::filesystem::path root = std::filesystem::temp_directory_path() / "AssetArchiveCorruptTest";
+	std::filesystem::remove_all(root);
+	WriteFile(root / "Source/a.bin", CreateNoise(5000));
+	AssetArchiveBuilder builder;
+	builder.AddDirectory((root / "Source").string());
+	const std::string archivePath = (root / "Assets.pak").string();
+	EXPECT_TRUE(builder.Build(archivePath));
+	std::vector<uint8_t> bytes = ReadFile(archivePath);
+	std::filesystem::remove_all(root);
+
+	AssetArchive archive;
+	EXPECT_TRUE(archive.Open(bytes));
+	// 途中で切れたもの、識別子の違うもの、範囲外を指す索引は開かない
+	EXPECT_FALSE(archive.Open(std::span<const uint8_t>(bytes.data(), bytes.size() - 1)));
+	EXPECT_FALSE(archive.Open(std::span<const uint8_t>(bytes.data(), 16)));
+	std::vector<uint8_t> wrongMagic = bytes;
+	wrongMagic[0] ^= 0xff;
+	EXPECT_FALSE(archive.Open(wrongMagic));
+	AssetArchive::Header header;
+	std::memcpy(&header, bytes.data(), sizeof(header));
+	std::vector<uint8_t> outOfRange = bytes;
+	AssetArchive::IndexEntry entry;
+	std::memcpy(&entry, bytes.data() + header.indexOffset, sizeof(entry));
+	entry.offset = bytes.size();
+	std::memcpy(outOfRange.data() + header.indexOffset, &entry, sizeof(entry));
+	EXPECT_FALSE(archive.Open(outOfRange));
+}
@@ -0,0 +1,174 @@
+#include "AudioMixer.h"
+#include "Test.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// 正解のWAV(UPDATE_GOLDEN環境変数を設定して実行すると書き直す)
+const char kGoldenFile[] = "Data/AudioMixerGolden.wav";
+// 正解との差の許容値(16bitの値)。コンパイラによる浮動小数点演算の違いを吸収する
+const int kGoldenTolerance = 2;
+
+// 16bitモノラルの音声を作る
+std::shared_ptr<const MixerSound> CreateSound(uint32_t sampleRate, uint32_t frameCount, float (*wave)(uint32_t frame, uint32_t sampleRate)) {
+	PcmSound pcm;
+	pcm.format.formatTag = WaveFormat::kPcm;
+	pcm.format.channels = 1;
+	pcm.format.sampleRate = sampleRate;
+	pcm.format.bitsPerSample = 16;
+	pcm.format.blockAlign = 2;
+	pcm.format.avgBytesPerSec = sampleRate * 2;
+	pcm.data.resize(static_cast<size_t>(frameCount) * 2);
+	for (uint32_t frame = 0; frame < frameCount; ++frame) {
+		int16_t sample = static_cast<int16_t>(std::lround(wave(frame, sampleRate) * 32767.0f));
+		std::memcpy(&pcm.data[frame * 2], &sample, 2);
+	}
+	return CreateMixerSound(pcm);
+}
+
+float Sine440(uint32_t frame, uint32_t sampleRate) { return 0.4f * static_cast<float>(std::sin(2.0 * 3.14159265358979 * 440.0 * frame / sampleRate)); }
+
+float Saw110(uint32_t frame, uint32_t sampleRate) {
+	double phase = 110.0 * frame / sampleRate;
+	return 0.3f * static_cast<float>(2.0 * (phase - std::floor(phase)) - 1.0);
+}
+
+float Constant(uint32_t, uint32_t) { return 0.5f; }
+
+float Silence(uint32_t, uint32_t) { return 0.0f; }
+
+// 出力を16bitで読み出す
+void Render(AudioStreamSource& output, uint32_t frameCount, std::vector<uint8_t>& data) {
+	size_t offset = data.size();
+	data.resize(offset + static_cast<size_t>(frameCount) * 4);
+	output.Read(data.data() + offset, static_cast<size_t>(frameCount) * 4);
+}
+
+} // namespace
+
+TEST(AudioMixer, MatchesGoldenWave) {
+	// サンプルレート変換、ピッチ、パン、音量の変化、停止、バスのローパスを順に通す
+	std::shared_ptr<const MixerSound> sine = CreateSound(44100, 44100, &Sine440);
+	std::shared_ptr<const MixerSound> saw = CreateSound(22050, 4000, &Saw110);
+	AudioMixer mixer;
+	std::unique_ptr<AudioStreamSource> output = mixer.CreateOutputSource();
+	std::vector<uint8_t> data;
+
+	uint32_t sfx = mixer.Play(sine, AudioMixer::Bus::kSfx, true);
+	mixer.Play(saw, AudioMixer::Bus::kBgm, false, 0.5f, 1.5f);
+	mixer.SetBusLowPass(AudioMixer::Bus::kBgm, 2000.0f);
+	Render(*output, 3000, data);
+	mixer.SetVolume(sfx, 0.2f);
+	mixer.SetPan(sfx, -0.75f);
+	Render(*output, 3000, data);
+	mixer.Play(sine, AudioMixer::Bus::kUi, false, 0.8f, 0.77f);
+	mixer.SetBusVolume(AudioMixer::Bus::kSfx, 0.5f);
+	Render(*output, 3000, data);
+	mixer.Stop(sfx);
+	Render(*output, 3000, data);
+
+	if (std::getenv("UPDATE_GOLDEN") != nullptr) {
+		EXPECT_TRUE(WriteWaveFile(kGoldenFile, output->GetFormat(), data.data(), data.size()));
+		return;
+	}
+
+	WaveFileSource golden;
+	EXPECT_TRUE(golden.Open(kGoldenFile));
+	EXPECT_EQ(uint64_t{data.size()}, golden.GetDataSize());
+	EXPECT_EQ(output->GetFormat().blockAlign, golden.GetFormat().blockAlign);
+	EXPECT_EQ(output->GetFormat().sampleRate, golden.GetFormat().sampleRate);
+	std::vector<uint8_t> expected(data.size());
+	expected.resize(golden.Read(expected.data(), expected.size()));
+	EXPECT_EQ(data.size(), expected.size());
+
+	int maxDifference = 0;
+	for (size_t i = 0; i + 1 < (std::min)(data.size(), expected.size()); i += 2) {
+		int16_t actualSample = 0;
+		int16_t expectedSample = 0;
+		std::memcpy(&actualSample, &data[i], 2);
+		std::memcpy(&expectedSample, &expected[i], 2);
+		maxDifference = (std::max)(maxDifference, std::abs(actualSample - expectedSample));
+	}
+	EXPECT_TRUE(maxDifference <= kGoldenTolerance);
+}
+
+TEST(AudioMixer, SameCommandsGiveSameOutput) {
+	// 同じ操作を同じフレーム位置で行えば、出力は毎回同じになる
+	std::shared_ptr<const MixerSound> sine = CreateSound(44100, 44100, &Sine440);
+	std::vector<uint8_t> data[2];
+	for (std::vector<uint8_t>& run : data) {
+		AudioMixer mixer;
+		std::unique_ptr<AudioStreamSource> output = mixer.CreateOutputSource();
+		uint32_t voice = mixer.Play(sine, AudioMixer::Bus::kSfx, true, 1.0f, 1.3f);
+		Render(*output, 1000, run);
+		mixer.SetParameters(voice, 0.3f, 0.5f, 0.9f);
+		Render(*output, 1000, run);
+	}
+	EXPECT_TRUE(data[0] == data[1]);
+}
+
+TEST(AudioMixer, RampsVolumeChanges) {
+	// 一定値の音を鳴らして音量を急に変えても、1フレームあたりの変化はランプの傾きに収まる
+	std::shared_ptr<const MixerSound> constant = CreateSound(48000, 48000, &Constant);
+	AudioMixer mixer;
+	uint32_t voice = mixer.Play(constant, AudioMixer::Bus::kSfx, true);
+	const uint32_t frameCount = 2048;
+	std::vector<float> samples(frameCount * 2 * 3);
+	mixer.Mix(samples.data(), frameCount);
+	mixer.SetVolume(voice, 0.0f);
+	mixer.Mix(samples.data() + frameCount * 2, frameCount);
+	mixer.SetVolume(voice, 1.0f);
+	mixer.Stop(voice);
+	mixer.Mix(samples.data() + frameCount * 4, frameCount);
+
+	// 鳴り始めは音声そのままなので、2フレーム目から見る(10msで0.5を動かす傾き)
+	EXPECT_NEAR(0.5, samples[0], 1e-4);
+	const float rampFrames = static_cast<float>(mixer.GetSampleRate() * AudioMixer::kRampMilliseconds / 1000);
+	const float maxStep = 0.5f / rampFrames * 1.01f;
+	float largestStep = 0.0f;
+	float previous = samples[0];
+	for (size_t i = 2; i < samples.size(); i += 2) {
+		largestStep = (std::max)(largestStep, std::fabs(samples[i] - previous));
+		previous = samples[i];
+	}
+	EXPECT_TRUE(largestStep <= maxStep);
+	// 音量を0にした後と停止した後は無音になる
+	EXPECT_NEAR(0.0, samples[frameCount * 4 - 2], 1e-6);
+	EXPECT_NEAR(0.0, samples.back(), 1e-6);
+	EXPECT_FALSE(mixer.IsPlaying(voice));
+}
+
+TEST(AudioMixer, RampsDownStolenVoice) {
+	// 枠が1つのミキサーで鳴っているボイスから枠を奪っても、奪われた方は急に消えずに絞られていく
+	std::shared_ptr<const MixerSound> constant = CreateSound(48000, 48000, &Constant);
+	std::shared_ptr<const MixerSound> silence = CreateSound(48000, 48000, &Silence);
+	AudioMixer mixer(48000, 1, 1);
+	uint32_t victim = mixer.Play(constant, AudioMixer::Bus::kSfx, true);
+	const uint32_t frameCount = 1024;
+	std::vector<float> samples(frameCount * 2 * 2);
+	mixer.Mix(samples.data(), frameCount);
+	uint32_t thief = mixer.Play(silence, AudioMixer::Bus::kSfx, true);
+	mixer.Mix(samples.data() + frameCount * 2, frameCount);
+
+	EXPECT_TRUE(thief != AudioMixer::kInvalidHandle);
+	EXPECT_FALSE(mixer.IsPlaying(victim));
+	EXPECT_TRUE(mixer.IsPlaying(thief));
+	AudioMixer::Statistics statistics = mixer.GetStatistics();
+	EXPECT_EQ(uint64_t{1}, statistics.steals);
+	EXPECT_EQ(uint64_t{1}, statistics.fadeOuts);
+	EXPECT_EQ(uint64_t{0}, statistics.fadeOutCuts);
+
+	// 1フレームあたりの変化は停止のランプの傾きに収まり、絞り切った後は無音になる
+	const float rampFrames = static_cast<float>(mixer.GetSampleRate() * AudioMixer::kRampMilliseconds / 1000);
+	const float maxStep = 0.5f / rampFrames * 1.01f;
+	float largestStep = 0.0f;
+	for (size_t i = 2; i < samples.size(); i += 2) {
+		largestStep = (std::max)(largestStep, std::fabs(samples[i] - samples[i - 2]));
+	}
+	EXPECT_TRUE(largestStep <= maxStep);
+	EXPECT_NEAR(0.5, samples[frameCount * 2 - 2], 1e-6);
+	EXPECT_NEAR(0.0, samples.back(), 1e-6);
+}
@@ -0,0 +1,84 @@
+#include "AudioSpatializer.h"
+#include "Test.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 位置と速度を乱数で決めた発音体を並べる(聴取者のすぐそば、最大距離の外、音速に近い速さを含む)
+void Scatter(AudioSpatializer& spatializer, size_t count, uint32_t seed) {
+	spatializer.Resize(count);
+	uint32_t state = seed;
+	auto next = [&state](float range) {
+		state = state * 1664525u + 1013904223u;
+		return ((state >> 8) / 16777216.0f * 2.0f - 1.0f) * range;
+	};
+	for (size_t i = 0; i < count; ++i) {
+		float position[3] = {next(120.0f), next(20.0f), next(120.0f)};
+		if (i % 17 == 0) {
+			position[0] = position[1] = position[2] = 0.0f;
+		}
+		float velocity[3] = {next(400.0f), next(10.0f), next(400.0f)};
+		spatializer.SetEmitter(i, position, velocity, 1.0f + (i % 5), 50.0f + (i % 7) * 10.0f);
+	}
+}
+
+} // namespace
+
+TEST(AudioSpatializer, SimdMatchesScalar) {
+	// 端数の出る数でSIMDと1つずつの計算を比べる。除算と平方根の誤差だけの違いに収まる
+	AudioSpatializer::Listener listener;
+	listener.position[0] = 3.0f;
+	listener.position[2] = -2.0f;
+	listener.velocity[0] = 20.0f;
+	listener.right[0] = 0.6f;
+	listener.right[2] = 0.8f;
+	for (size_t count : {size_t{1}, size_t{7}, size_t{2001}}) {
+		for (float dopplerScale : {0.0f, 1.0f, 2.5f}) {
+			AudioSpatializer simd;
+			AudioSpatializer scalar;
+			Scatter(simd, count, 11);
+			Scatter(scalar, count, 11);
+			simd.Process(listener, dopplerScale);
+			scalar.ProcessScalar(listener, dopplerScale);
+
+			float maxError = 0.0f;
+			bool sameAudibility = true;
+			for (size_t i = 0; i < count; ++i) {
+				maxError = (std::max)(maxError, std::fabs(simd.GetGain(i) - scalar.GetGain(i)));
+				maxError = (std::max)(maxError, std::fabs(simd.GetPan(i) - scalar.GetPan(i)));
+				maxError = (std::max)(maxError, std::fabs(simd.GetPitch(i) - scalar.GetPitch(i)));
+				sameAudibility = sameAudibility && simd.IsAudible(i) == scalar.IsAudible(i);
+			}
+			EXPECT_TRUE(maxError <= 1e-5f);
+			EXPECT_TRUE(sameAudibility);
+		}
+	}
+}
+
+TEST(AudioSpatializer, AttenuatesPansAndShiftsPitch) {
+	AudioSpatializer spatializer;
+	spatializer.Resize(4);
+	const float still[3] = {};
+	// 最小距離の内側、右に20m、最大距離の外、近づいてくるもの
+	const float near[3] = {0.5f, 0.0f, 0.0f};
+	const float right[3] = {20.0f, 0.0f, 0.0f};
+	const float far[3] = {0.0f, 0.0f, 200.0f};
+	const float ahead[3] = {0.0f, 0.0f, 10.0f};
+	const float approaching[3] = {0.0f, 0.0f, -34.3f};
+	spatializer.SetEmitter(0, near, still, 1.0f, 100.0f);
+	spatializer.SetEmitter(1, right, still, 1.0f, 100.0f);
+	spatializer.SetEmitter(2, far, still, 1.0f, 100.0f);
+	spatializer.SetEmitter(3, ahead, approaching, 1.0f, 100.0f);
+	AudioSpatializer::Listener listener;
+	spatializer.Process(listener);
+
+	EXPECT_NEAR(1.0, spatializer.GetGain(0), 1e-6);
+	// 距離に反比例し、最大距離に向けて絞る: 1/20 * (100 - 20) / 99
+	EXPECT_NEAR(1.0 / 20.0 * 80.0 / 99.0, spatializer.GetGain(1), 1e-6);
+	EXPECT_NEAR(1.0, spatializer.GetPan(1), 1e-6);
+	EXPECT_FALSE(spatializer.IsAudible(2));
+	// 音速の1/10で近づくと c / (c - c/10) 倍
+	EXPECT_NEAR(1.0 / 0.9, spatializer.GetPitch(3), 1e-4);
+	EXPECT_NEAR(1.0, spatializer.GetPitch(1), 1e-6);
+}
@@ -0,0 +1,137 @@
+#include "BlockCompression.h"
+#include "Test.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+namespace {
+
+// 画像を圧縮して展開し、成分ごとの最大誤差とRGBの二乗平均誤差を求める
+void MeasureError(const std::vector<uint8_t>& rgba, uint32_t width, uint32_t height, BlockFormat format, int& maxColorError, int& maxAlphaError, double& rmse) {
+	std::vector<uint8_t> compressed = CompressImage(rgba.data(), width, height, format, 1);
+	uint32_t blockSize = GetBlockSize(format);
+	maxColorError = 0;
+	maxAlphaError = 0;
+	double squaredSum = 0.0;
+	uint8_t block[64];
+	for (uint32_t by = 0; by < height / 4; ++by) {
+		for (uint32_t bx = 0; bx < width / 4; ++bx) {
+			const uint8_t* src = compressed.data() + (static_cast<size_t>(by) * (width / 4) + bx) * blockSize;
+			if (format == BlockFormat::kBC1) {
+				DecompressBlockBC1(src, block);
+			} else {
+				DecompressBlockBC3(src, block);
+			}
+			for (uint32_t i = 0; i < 16; ++i) {
+				const uint8_t* expected = rgba.data() + ((static_cast<size_t>(by) * 4 + i / 4) * width + bx * 4 + i % 4) * 4;
+				for (uint32_t c = 0; c < 3; ++c) {
+					int error = std::abs(expected[c] - block[i * 4 + c]);
+					maxColorError = (std::max)(maxColorError, error);
+					squaredSum += static_cast<double>(error) * error;
+				}
+				int alphaExpected = format == BlockFormat::kBC1 ? 255 : expected[3];
+				maxAlphaError = (std::max)(maxAlphaError, std::abs(alphaExpected - block[i * 4 + 3]));
+			}
+		}
+	}
+	rmse = std::sqrt(squaredSum / (static_cast<double>(width) * height * 3));
+}
+
+} // namespace
+
+TEST(BlockCompression, SolidBlocksStayWithin565Quantization) {
+	// 単色のブロックは565への丸めの誤差(赤と青は4、緑は2)に収まる
+	std::mt19937 random(3);
+	int maxError[3] = {};
+	for (int n = 0; n < 1000; ++n) {
+		uint8_t color[4] = {static_cast<uint8_t>(random()), static_cast<uint8_t>(random()), static_cast<uint8_t>(random()), 255};
+		uint8_t rgba[64];
+		for (int i = 0; i < 16; ++i) {
+			std::copy(color, color + 4, rgba + i * 4);
+		}
+		uint8_t block[8];
+		uint8_t decoded[64];
+		CompressBlockBC1(rgba, block);
+		DecompressBlockBC1(block, decoded);
+		for (int c = 0; c < 3; ++c) {
+			maxError[c] = (std::max)(maxError[c], std::abs(color[c] - decoded[c]));
+		}
+		EXPECT_EQ(255, decoded[3]);
+	}
+	EXPECT_TRUE(maxError[0] <= 4);
+	EXPECT_TRUE(maxError[1] <= 2);
+	EXPECT_TRUE(maxError[2] <= 4);
+}
+
+TEST(BlockCompression, AlphaErrorIsBoundedByPaletteStep) {
+	// BC3のαは最小と最大の間を7等分するので、誤差は段差の半分と丸めの1に収まる
+	std::mt19937 random(5);
+	bool withinBound = true;
+	for (int n = 0; n < 1000; ++n) {
+		uint8_t rgba[64];
+		for (int i = 0; i < 64; ++i) {
+			rgba[i] = static_cast<uint8_t>(random());
+		}
+		int minAlpha = 255;
+		int maxAlpha = 0;
+		for (int i = 0; i < 16; ++i) {
+			minAlpha = (std::min)(minAlpha, static_cast<int>(rgba[i * 4 + 3]));
+			maxAlpha = (std::max)(maxAlpha, static_cast<int>(rgba[i * 4 + 3]));
+		}
+		uint8_t block[16];
+		uint8_t decoded[64];
+		CompressBlockBC3(rgba, block);
+		DecompressBlockBC3(block, decoded);
+		int bound = (maxAlpha - minAlpha) / 14 + 1;
+		for (int i = 0; i < 16; ++i) {
+			withinBound = withinBound && std::abs(rgba[i * 4 + 3] - decoded[i * 4 + 3]) <= bound;
+		}
+	}
+	EXPECT_TRUE(withinBound);
+}
+
+TEST(BlockCompression, SmoothImageErrorBounds) {
+	// なだらかなグラデーションとαの傾斜の画像で、BC1とBC3の誤差が上限に収まるか
+	const uint32_t size = 64;
+	std::vector<uint8_t> rgba(size * size * 4);
+	for (uint32_t y = 0; y < size; ++y) {
+		for (uint32_t x = 0; x < size; ++x) {
+			uint8_t* pixel = &rgba[(y * size + x) * 4];
+			pixel[0] = static_cast<uint8_t>(x * 4);
+			pixel[1] = static_cast<uint8_t>(y * 4);
+			pixel[2] = static_cast<uint8_t>((x + y) * 2);
+			pixel[3] = static_cast<uint8_t>(255 - x * 2);
+		}
+	}
+	EXPECT_FALSE(IsOpaque(rgba.data(), size * size));
+
+	int maxColorError = 0;
+	int maxAlphaError = 0;
+	double rmse = 0.0;
+	MeasureError(rgba, size, size, BlockFormat::kBC1, maxColorError, maxAlphaError, rmse);
+	EXPECT_TRUE(maxColorError <= 12);
+	EXPECT_TRUE(rmse <= 4.0);
+	// BC1は不透明として展開される
+	EXPECT_EQ(0, maxAlphaError);
+
+	MeasureError(rgba, size, size, BlockFormat::kBC3, maxColorError, maxAlphaError, rmse);
+	EXPECT_TRUE(maxColorError <= 12);
+	EXPECT_TRUE(rmse <= 4.0);
+	EXPECT_TRUE(maxAlphaError <= 1);
+}
+
+TEST(BlockCompression, ThreadCountDoesNotChangeOutput) {
+	const uint32_t width = 70;
+	const uint32_t height = 38;
+	std::vector<uint8_t> rgba(width * height * 4);
+	std::mt19937 random(7);
+	for (uint8_t& value : rgba) {
+		value = static_cast<uint8_t>(random());
+	}
+	for (BlockFormat format : {BlockFormat::kBC1, BlockFormat::kBC3}) {
+		std::vector<uint8_t> single = CompressImage(rgba.data(), width, height, format, 1);
+		EXPECT_EQ(size_t{18 * 10 * GetBlockSize(format)}, single.size());
+		EXPECT_TRUE(single == CompressImage(rgba.data(), width, height, format, 4));
+	}
+}
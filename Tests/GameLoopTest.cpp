@@ -0,0 +1,108 @@
+#include "GameLoop.h"
+#include "Test.h"
+#include <chrono>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// GameLoop::Initializeと同じ変換で求めた固定更新の周期
+std::chrono::nanoseconds FixedStep(float fixedDeltaTime) { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<float>(fixedDeltaTime)); }
+
+// 経過時間を与えて固定更新を回し、実行したティック数を返す
+uint32_t RunFrame(GameLoop* gameLoop, std::chrono::nanoseconds elapsed) {
+	gameLoop->Advance(elapsed);
+	uint32_t steps = 0;
+	while (gameLoop->Step()) {
+		++steps;
+	}
+	return steps;
+}
+
+} // namespace
+
+TEST(GameLoop, OneStepPerFixedInterval) {
+	GameLoop* gameLoop = GameLoop::GetInstance();
+	// 2進数で割り切れる周期にして丸めの影響をなくす
+	gameLoop->Initialize(0.0625f);
+	const std::chrono::nanoseconds step = FixedStep(0.0625f);
+	EXPECT_EQ(62500000ll, static_cast<long long>(step.count()));
+
+	EXPECT_EQ(1u, RunFrame(gameLoop, step));
+	EXPECT_EQ(1u, gameLoop->GetStepsThisFrame());
+	EXPECT_EQ(uint64_t{1}, gameLoop->GetTickCount());
+	EXPECT_NEAR(0.0, gameLoop->GetAlpha(), 1e-6);
+}
+
+TEST(GameLoop, AccumulatesPartialFrames) {
+	GameLoop* gameLoop = GameLoop::GetInstance();
+	gameLoop->Initialize(0.0625f);
+	const std::chrono::nanoseconds step = FixedStep(0.0625f);
+
+	// 半分ずつ与えると2フレーム目で1回だけ進む
+	EXPECT_EQ(0u, RunFrame(gameLoop, step / 2));
+	EXPECT_NEAR(0.5, gameLoop->GetAlpha(), 1e-6);
+	EXPECT_EQ(1u, RunFrame(gameLoop, step / 2));
+	EXPECT_NEAR(0.0, gameLoop->GetAlpha(), 1e-6);
+
+	// 2.25周期分なら2回進み、残りが補間係数になる
+	EXPECT_EQ(2u, RunFrame(gameLoop, step * 9 / 4));
+	EXPECT_NEAR(0.25, gameLoop->GetAlpha(), 1e-6);
+	EXPECT_EQ(uint64_t{3}, gameLoop->GetTickCount());
+}
+
+TEST(GameLoop, IgnoresNegativeElapsed) {
+	GameLoop* gameLoop = GameLoop::GetInstance();
+	gameLoop->Initialize(0.0625f);
+	const std::chrono::nanoseconds step = FixedStep(0.0625f);
+
+	EXPECT_EQ(0u, RunFrame(gameLoop, step / 2));
+	EXPECT_EQ(0u, RunFrame(gameLoop, -1s));
+	EXPECT_NEAR(0.5, gameLoop->GetAlpha(), 1e-6);
+}
+
+TEST(GameLoop, DropsTicksBeyondTheLimit) {
+	GameLoop* gameLoop = GameLoop::GetInstance();
+	gameLoop->Initialize(0.0625f, 5);
+	const std::chrono::nanoseconds step = FixedStep(0.0625f);
+
+	// 1秒の処理落ちは16周期分。5回だけ進め、残りの11回は捨てる
+	EXPECT_EQ(5u, RunFrame(gameLoop, 1s));
+	EXPECT_EQ(uint64_t{11}, gameLoop->GetDroppedTickCount());
+	EXPECT_EQ(uint64_t{5}, gameLoop->GetTickCount());
+	EXPECT_NEAR(0.0, gameLoop->GetAlpha(), 1e-6);
+
+	// 6.875周期分なら1回だけ捨て、端数は次のフレームへ持ち越す
+	EXPECT_EQ(5u, RunFrame(gameLoop, step * 55 / 8));
+	EXPECT_EQ(uint64_t{12}, gameLoop->GetDroppedTickCount());
+	EXPECT_NEAR(0.875, gameLoop->GetAlpha(), 1e-6);
+}
+
+TEST(GameLoop, SameInputGivesSameTicks) {
+	// 60Hzで揺らぎのある経過時間を与えても、同じ入力なら毎回同じティック数と補間係数になる
+	const std::vector<std::chrono::nanoseconds> frames = {16ms, 17ms, 33ms, 1ms, 16666667ns, 50ms, 8ms, 0ns, 25ms, 16666666ns, 80ms, 16ms};
+	std::vector<uint32_t> steps[2];
+	std::vector<float> alphas[2];
+	GameLoop* gameLoop = GameLoop::GetInstance();
+	for (int run = 0; run < 2; ++run) {
+		gameLoop->Initialize();
+		for (int repeat = 0; repeat < 50; ++repeat) {
+			for (std::chrono::nanoseconds elapsed : frames) {
+				steps[run].push_back(RunFrame(gameLoop, elapsed));
+				alphas[run].push_back(gameLoop->GetAlpha());
+			}
+		}
+	}
+	EXPECT_TRUE(steps[0] == steps[1]);
+	EXPECT_TRUE(alphas[0] == alphas[1]);
+
+	// 捨てたティックがなければ、進んだ時間と経過時間の差は1周期未満
+	const std::chrono::nanoseconds step = FixedStep(GameLoop::kDefaultFixedDeltaTime);
+	std::chrono::nanoseconds total{};
+	for (std::chrono::nanoseconds elapsed : frames) {
+		total += elapsed * 50;
+	}
+	EXPECT_EQ(uint64_t{0}, gameLoop->GetDroppedTickCount());
+	EXPECT_EQ(static_cast<uint64_t>(total / step), gameLoop->GetTickCount());
+}
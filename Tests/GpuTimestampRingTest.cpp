@@ -0,0 +1,149 @@
+#include "GpuTimestampRing.h"
+#include "Test.h"
+#include <vector>
+
+namespace {
+
+// クエリが発行された順に一定間隔で進むGPUの時計の代わり
+class FakeGpuClock {
+public:
+	explicit FakeGpuClock(uint32_t queryCount) : timestamps_(queryCount, 0) {}
+
+	// クエリに現在時刻を書き込んで時計を進める
+	void Write(uint32_t queryIndex) {
+		timestamps_[queryIndex] = tick_;
+		tick_ += 10;
+	}
+
+	const uint64_t* GetTimestamps() const { return timestamps_.data(); }
+
+private:
+	std::vector<uint64_t> timestamps_;
+	uint64_t tick_ = 1000;
+};
+
+} // namespace
+
+TEST(GpuTimestampRing, ResolvesNestedMarkers) {
+	GpuTimestampRing ring;
+	ring.Initialize(3, 8);
+	FakeGpuClock clock(ring.GetQueryCount());
+	std::vector<GpuTimestampRing::Result> results;
+
+	for (uint64_t frame = 0; frame < 4; ++frame) {
+		ring.BeginFrame(frame, static_cast<int64_t>(frame) * 100);
+		uint32_t query = 0;
+		uint32_t outer = ring.BeginMarker("Outer", query);
+		clock.Write(query);
+		uint32_t inner = ring.BeginMarker("Inner", query);
+		clock.Write(query);
+		EXPECT_TRUE(ring.EndMarker(inner, query));
+		clock.Write(query);
+		EXPECT_TRUE(ring.EndMarker(outer, query));
+		clock.Write(query);
+		uint32_t queryOffset = 0;
+		uint32_t queryCount = 0;
+		ring.EndFrame(queryOffset, queryCount);
+		EXPECT_EQ(static_cast<uint32_t>(frame % 3) * 8, queryOffset);
+		EXPECT_EQ(4u, queryCount);
+
+		// 2フレーム遅れで完了する
+		if (frame >= 2) {
+			ring.Collect(frame - 2, clock.GetTimestamps(), results);
+		}
+	}
+
+	// フレーム0と1の結果が、開始した順に外側から届く
+	EXPECT_EQ(size_t{4}, results.size());
+	for (size_t i = 0; i < results.size(); ++i) {
+		const GpuTimestampRing::Result& result = results[i];
+		uint64_t frameStart = 1000 + result.frameIndex * 40;
+		EXPECT_EQ(uint64_t{i / 2}, result.frameIndex);
+		EXPECT_EQ(static_cast<int64_t>(result.frameIndex) * 100, result.cpuFrameBegin);
+		EXPECT_EQ(static_cast<uint32_t>(i % 2), result.depth);
+		if (result.depth == 0) {
+			EXPECT_EQ(frameStart, result.beginTick);
+			EXPECT_EQ(frameStart + 30, result.endTick);
+		} else {
+			EXPECT_EQ(frameStart + 10, result.beginTick);
+			EXPECT_EQ(frameStart + 20, result.endTick);
+		}
+	}
+	uint64_t oldest = 0;
+	EXPECT_TRUE(ring.GetOldestPendingFrame(oldest));
+	EXPECT_EQ(uint64_t{2}, oldest);
+	EXPECT_EQ(uint64_t{0}, ring.GetOverflowCount());
+	EXPECT_EQ(uint64_t{0}, ring.GetDroppedFrameCount());
+}
+
+TEST(GpuTimestampRing, KeepsEndQueriesForOpenMarkers) {
+	// 1フレーム4クエリ。2段まで開くと残りは閉じる分だけなので、3段目は記録しない
+	GpuTimestampRing ring;
+	ring.Initialize(2, 4);
+	FakeGpuClock clock(ring.GetQueryCount());
+	ring.BeginFrame(0, 0);
+
+	std::vector<uint32_t> queries;
+	uint32_t query = 0;
+	uint32_t a = ring.BeginMarker("A", query);
+	queries.push_back(query);
+	uint32_t b = ring.BeginMarker("B", query);
+	queries.push_back(query);
+	EXPECT_EQ(GpuTimestampRing::kInvalidMarker, ring.BeginMarker("C", query));
+	EXPECT_EQ(uint64_t{1}, ring.GetOverflowCount());
+	EXPECT_TRUE(ring.EndMarker(b, query));
+	queries.push_back(query);
+	// 残りの1つはAを閉じる分なので、新しい区間は開けない
+	EXPECT_EQ(GpuTimestampRing::kInvalidMarker, ring.BeginMarker("D", query));
+	EXPECT_TRUE(ring.EndMarker(a, query));
+	queries.push_back(query);
+
+	// 二重の終了はクエリを使わない
+	EXPECT_FALSE(ring.EndMarker(a, query));
+	EXPECT_FALSE(ring.EndMarker(b, query));
+	EXPECT_FALSE(ring.EndMarker(GpuTimestampRing::kInvalidMarker, query));
+
+	// 全部このフレームのスロットに収まっている
+	uint32_t queryOffset = 0;
+	uint32_t queryCount = 0;
+	ring.EndFrame(queryOffset, queryCount);
+	EXPECT_EQ(0u, queryOffset);
+	EXPECT_EQ(4u, queryCount);
+	for (uint32_t index : queries) {
+		EXPECT_TRUE(index < 4u);
+		clock.Write(index);
+	}
+
+	std::vector<GpuTimestampRing::Result> results;
+	ring.Collect(0, clock.GetTimestamps(), results);
+	EXPECT_EQ(size_t{2}, results.size());
+	EXPECT_EQ(uint64_t{2}, ring.GetOverflowCount());
+}
+
+TEST(GpuTimestampRing, DropsFramesOverwrittenBeforeCollect) {
+	GpuTimestampRing ring;
+	ring.Initialize(2, 2);
+	FakeGpuClock clock(ring.GetQueryCount());
+	for (uint64_t frame = 0; frame < 5; ++frame) {
+		ring.BeginFrame(frame, 0);
+		uint32_t query = 0;
+		uint32_t marker = ring.BeginMarker("Frame", query);
+		clock.Write(query);
+		EXPECT_TRUE(ring.EndMarker(marker, query));
+		clock.Write(query);
+		uint32_t queryOffset = 0;
+		uint32_t queryCount = 0;
+		ring.EndFrame(queryOffset, queryCount);
+	}
+	// 一度も回収しなかったので、フレーム2以降はスロットの再利用のたびに1フレームずつ捨てている
+	EXPECT_EQ(uint64_t{3}, ring.GetDroppedFrameCount());
+
+	// 完了していないフレームは回収しない
+	std::vector<GpuTimestampRing::Result> results;
+	ring.Collect(2, clock.GetTimestamps(), results);
+	EXPECT_EQ(size_t{0}, results.size());
+	ring.Collect(4, clock.GetTimestamps(), results);
+	EXPECT_EQ(size_t{2}, results.size());
+	uint64_t oldest = 0;
+	EXPECT_FALSE(ring.GetOldestPendingFrame(oldest));
+}
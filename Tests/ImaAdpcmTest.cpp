@@ -0,0 +1,75 @@
+#include "ImaAdpcm.h"
+#include "Test.h"
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace {
+
+// 正解はIMA-ADPCMの仕様どおりに書いた別の実装(Python)で求めた値
+// モノラル: 先頭1000、ステップ位置20、8バイト(16サンプル)
+const uint8_t kMonoBlock[] = {0xe8, 0x03, 0x14, 0x00, 0x07, 0x7f, 0x88, 0xf0, 0x3c, 0xa5, 0x19, 0xee};
+const int16_t kMonoPcm[] = {1000, 1093, 1106, 925, 1316, 1260, 1209, 1255, 624, -190, 576, 1670, 942, 545, 905, -518, -3040};
+
+// ステレオ: 左は先頭-2000、ステップ位置30。右は先頭32000、範囲外のステップ位置95(88に丸める)で飽和する
+const uint8_t kStereoBlock[] = {0x30, 0xf8, 0x1e, 0x00, 0x00, 0x7d, 0x5f, 0x00, 0x77, 0x77, 0x77, 0x77, 0x12, 0x34, 0x56, 0x78, 0x0f, 0xf0, 0x80, 0x08, 0x99, 0xaa, 0xbb, 0xcc};
+const int16_t kStereoPcm[] = {-2000, 32000,  -1757,  32767,  -1236,  32767,  -116,   32767,  2287,   32767,  7440,   32767,  18490,  32767,  32767,  28672,  32767,
+                              32767, -28669, 20481,  -24574, 9309,   -20850, -7619,  -32768, -23007, -28673, -32768, -32397, -32768, -32768, -32768, -29691, -32768};
+
+const uint32_t kSamplesPerBlock = 17;
+
+WaveFormat MakeFormat(uint16_t channels) {
+	WaveFormat format;
+	format.formatTag = WaveFormat::kImaAdpcm;
+	format.channels = channels;
+	format.sampleRate = 22050;
+	format.bitsPerSample = 4;
+	format.blockAlign = static_cast<uint16_t>(channels == 1 ? sizeof(kMonoBlock) : sizeof(kStereoBlock));
+	return format;
+}
+
+} // namespace
+
+TEST(ImaAdpcm, DecodesMonoBlockExactly) {
+	EXPECT_EQ(kSamplesPerBlock, GetImaAdpcmSamplesPerBlock(MakeFormat(1)));
+	std::vector<int16_t> pcm(kSamplesPerBlock, 0);
+	EXPECT_EQ(kSamplesPerBlock, DecodeImaAdpcmBlock(kMonoBlock, sizeof(kMonoBlock), 1, kSamplesPerBlock, pcm.data()));
+	EXPECT_TRUE(pcm == std::vector<int16_t>(std::begin(kMonoPcm), std::end(kMonoPcm)));
+
+	// 短いブロックは入っているバイトの分だけ(3バイトで6サンプルとヘッダの1サンプル)
+	std::vector<int16_t> shortPcm(kSamplesPerBlock, 0);
+	EXPECT_EQ(7u, DecodeImaAdpcmBlock(kMonoBlock, 7, 1, kSamplesPerBlock, shortPcm.data()));
+	EXPECT_TRUE(std::equal(shortPcm.begin(), shortPcm.begin() + 7, kMonoPcm));
+	// ヘッダだけなら先頭のサンプルだけ、ヘッダに満たなければ何も出さない
+	EXPECT_EQ(1u, DecodeImaAdpcmBlock(kMonoBlock, 4, 1, kSamplesPerBlock, shortPcm.data()));
+	EXPECT_EQ(0u, DecodeImaAdpcmBlock(kMonoBlock, 3, 1, kSamplesPerBlock, shortPcm.data()));
+}
+
+TEST(ImaAdpcm, DecodesStereoBlockExactly) {
+	EXPECT_EQ(kSamplesPerBlock, GetImaAdpcmSamplesPerBlock(MakeFormat(2)));
+	std::vector<int16_t> pcm(kSamplesPerBlock * 2, 0);
+	EXPECT_EQ(kSamplesPerBlock, DecodeImaAdpcmBlock(kStereoBlock, sizeof(kStereoBlock), 2, kSamplesPerBlock, pcm.data()));
+	EXPECT_TRUE(pcm == std::vector<int16_t>(std::begin(kStereoPcm), std::end(kStereoPcm)));
+
+	// 短いステレオのブロックは両チャンネルが揃った8バイトの組までで、欠けた組(5バイト)は読まない
+	std::vector<int16_t> shortPcm(kSamplesPerBlock * 2, 0);
+	EXPECT_EQ(9u, DecodeImaAdpcmBlock(kStereoBlock, 8 + 8 + 5, 2, kSamplesPerBlock, shortPcm.data()));
+	EXPECT_TRUE(std::equal(shortPcm.begin(), shortPcm.begin() + 18, kStereoPcm));
+	EXPECT_EQ(1u, DecodeImaAdpcmBlock(kStereoBlock, 8 + 7, 2, kSamplesPerBlock, shortPcm.data()));
+}
+
+TEST(ImaAdpcm, DecodesDataWithShortLastBlock) {
+	// 2ブロック目はブロックの途中で終わる(ファイルの最後のブロック)
+	std::vector<uint8_t> data(kStereoBlock, kStereoBlock + sizeof(kStereoBlock));
+	data.insert(data.end(), kStereoBlock, kStereoBlock + 16);
+	std::vector<int16_t> pcm;
+	EXPECT_TRUE(DecodeImaAdpcm(MakeFormat(2), data.data(), data.size(), pcm));
+	EXPECT_EQ(size_t{(kSamplesPerBlock + 9) * 2}, pcm.size());
+	EXPECT_TRUE(std::equal(std::begin(kStereoPcm), std::end(kStereoPcm), pcm.begin()));
+	EXPECT_TRUE(std::equal(pcm.begin() + kSamplesPerBlock * 2, pcm.end(), kStereoPcm));
+
+	// IMA-ADPCM以外は受け付けない
+	WaveFormat pcmFormat = MakeFormat(2);
+	pcmFormat.formatTag = WaveFormat::kPcm;
+	EXPECT_FALSE(DecodeImaAdpcm(pcmFormat, data.data(), data.size(), pcm));
+}
@@ -0,0 +1,84 @@
+#include "Lz4.h"
+#include "Test.h"
+#include <vector>
+
+namespace {
+
+// 縮みやすい繰り返しと縮まない雑音を混ぜたデータ
+std::vector<uint8_t> CreateData(size_t size) {
+	std::vector<uint8_t> data(size);
+	uint32_t state = 7;
+	for (size_t i = 0; i < size; ++i) {
+		state = state * 1664525u + 1013904223u;
+		data[i] = (i / 1024) % 2 == 0 ? static_cast<uint8_t>(i % 37) : static_cast<uint8_t>(state >> 24);
+	}
+	return data;
+}
+
+// 圧縮して展開し、元に戻るか
+bool RoundTrips(const std::vector<uint8_t>& data, size_t& compressedSize) {
+	std::vector<uint8_t> compressed(LZ4CompressBound(data.size()));
+	compressedSize = LZ4Compress(data.data(), data.size(), compressed.data(), compressed.size());
+	if (compressedSize == 0 && !data.empty()) {
+		return false;
+	}
+	std::vector<uint8_t> restored(data.size());
+	return LZ4Decompress(compressed.data(), compressedSize, restored.data(), restored.size()) && restored == data;
+}
+
+} // namespace
+
+TEST(Lz4, RoundTripsAnySize) {
+	// 最小の一致長や末尾の規則に掛かる小さい大きさと、ウィンドウ(64KiB)を超える大きさ
+	for (size_t size : {size_t{0}, size_t{1}, size_t{5}, size_t{12}, size_t{13}, size_t{100}, size_t{4096}, size_t{65536}, size_t{300000}}) {
+		size_t compressedSize = 0;
+		EXPECT_TRUE(RoundTrips(CreateData(size), compressedSize));
+		EXPECT_TRUE(compressedSize <= LZ4CompressBound(size));
+	}
+	// 同じ値の連続はよく縮む
+	std::vector<uint8_t> zeros(100000, 0);
+	size_t compressedSize = 0;
+	EXPECT_TRUE(RoundTrips(zeros, compressedSize));
+	EXPECT_TRUE(compressedSize < 1000);
+}
+
+TEST(Lz4, FailsWhenOutputDoesNotFit) {
+	std::vector<uint8_t> data = CreateData(4096);
+	std::vector<uint8_t> compressed(16);
+	EXPECT_EQ(size_t{0}, LZ4Compress(data.data(), data.size(), compressed.data(), compressed.size()));
+}
+
+TEST(Lz4, RejectsCorruptInput) {
+	std::vector<uint8_t> data = CreateData(20000);
+	std::vector<uint8_t> compressed(LZ4CompressBound(data.size()));
+	compressed.resize(LZ4Compress(data.data(), data.size(), compressed.data(), compressed.size()));
+	// 出力先の後ろに番兵を置き、失敗しても範囲外に書かないか確かめる
+	const size_t kGuard = 64;
+	std::vector<uint8_t> output(data.size() + kGuard, 0xcd);
+
+	// 展開後のバイト数が違えば失敗する
+	EXPECT_FALSE(LZ4Decompress(compressed.data(), compressed.size(), output.data(), data.size() - 1));
+	EXPECT_FALSE(LZ4Decompress(compressed.data(), compressed.size(), output.data(), data.size() + 1));
+	// 途中で切れた入力
+	EXPECT_FALSE(LZ4Decompress(compressed.data(), compressed.size() / 2, output.data(), data.size()));
+	EXPECT_FALSE(LZ4Decompress(compressed.data(), 0, output.data(), data.size()));
+
+	// 1バイトずつ壊す。成功しても失敗してもよいが、出力先の外には書かない
+	bool guardIntact = true;
+	for (size_t i = 0; i < compressed.size(); i += 7) {
+		std::vector<uint8_t> corrupt = compressed;
+		corrupt[i] ^= 0xff;
+		LZ4Decompress(corrupt.data(), corrupt.size(), output.data(), data.size());
+		for (size_t j = data.size(); j < output.size(); ++j) {
+			guardIntact = guardIntact && output[j] == 0xcd;
+		}
+	}
+	EXPECT_TRUE(guardIntact);
+
+	// 先頭より前を指す一致(リテラル1つの直後にオフセット2)
+	const uint8_t backReference[] = {0x10, 'a', 0x02, 0x00};
+	EXPECT_FALSE(LZ4Decompress(backReference, sizeof(backReference), output.data(), 20));
+	// オフセット0は不正
+	const uint8_t zeroOffset[] = {0x10, 'a', 0x00, 0x00};
+	EXPECT_FALSE(LZ4Decompress(zeroOffset, sizeof(zeroOffset), output.data(), 20));
+}
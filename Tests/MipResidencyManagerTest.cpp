@@ -0,0 +1,213 @@
+#include "MipResidencyManager.h"
+#include "Test.h"
+#include <map>
+
+namespace {
+
+// 64x64、4段(末尾はミップ3)のテクスチャのミップごとのバイト数
+const std::vector<uint64_t> kMipBytes = {4096, 1024, 256, 64};
+const uint64_t kAllMipsBytes = 4096 + 1024 + 256 + 64;
+
+// 同じテクスチャが2回以上出てこないか、変更後が読み込みを要求している段階と一致するか
+bool IsCoalesced(const MipResidencyManager& manager, const std::vector<MipResidencyManager::Change>& changes) {
+	std::map<uint32_t, int> counts;
+	for (const MipResidencyManager::Change& change : changes) {
+		if (++counts[change.id] > 1 || change.targetMip != manager.GetTargetMip(change.id) || change.previousMip == change.targetMip) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// 要求された読み込みをすべて完了させる(読み込み側の代わり)
+void CompleteLoads(MipResidencyManager& manager, const std::vector<MipResidencyManager::Change>& changes, bool succeeded = true) {
+	for (const MipResidencyManager::Change& change : changes) {
+		manager.OnLoadCompleted(change.id, change.targetMip, succeeded);
+	}
+}
+
+} // namespace
+
+TEST(MipResidencyManager, DesiredMipFollowsScreenSize) {
+	MipResidencyManager manager;
+	manager.Initialize(1ull << 20, 1);
+	uint32_t id = manager.Register(64, 64, kMipBytes, 3);
+	EXPECT_EQ(3u, manager.GetResidentMip(id));
+	EXPECT_EQ(uint64_t{64}, manager.GetResidentBytes());
+
+	std::vector<MipResidencyManager::Change> changes;
+	const float sizes[] = {64.0f, 100.0f, 32.0f, 20.0f, 16.0f, 4.0f};
+	const uint32_t mips[] = {0, 0, 1, 1, 2, 3};
+	for (size_t i = 0; i < std::size(sizes); ++i) {
+		manager.RequestUsage(id, sizes[i], sizes[i]);
+		manager.Update(changes);
+		CompleteLoads(manager, changes);
+		EXPECT_EQ(mips[i], manager.GetDesiredMip(id));
+	}
+
+	// 縦長に表示されたら詳細が必要な軸に合わせる
+	manager.RequestUsage(id, 8.0f, 64.0f);
+	manager.Update(changes);
+	EXPECT_EQ(0u, manager.GetDesiredMip(id));
+
+	// 報告がなければ末尾のミップでよい
+	manager.Update(changes);
+	EXPECT_EQ(3u, manager.GetDesiredMip(id));
+}
+
+TEST(MipResidencyManager, DropsOnlyAfterHysteresis) {
+	MipResidencyManager manager;
+	manager.Initialize(1ull << 20, 3);
+	uint32_t id = manager.Register(64, 64, kMipBytes, 3);
+	std::vector<MipResidencyManager::Change> changes;
+
+	// 詳細なミップはすぐに要求する。読み込みが終わるまでは末尾の段階も常駐している
+	manager.RequestUsage(id, 64.0f, 64.0f);
+	manager.Update(changes);
+	EXPECT_EQ(size_t{1}, changes.size());
+	EXPECT_TRUE(manager.IsLoading(id));
+	EXPECT_EQ(3u, manager.GetResidentMip(id));
+	EXPECT_EQ(kAllMipsBytes + 64, manager.GetResidentBytes());
+	EXPECT_EQ(kAllMipsBytes, manager.GetProjectedBytes());
+	CompleteLoads(manager, changes);
+	EXPECT_EQ(0u, manager.GetResidentMip(id));
+	EXPECT_EQ(kAllMipsBytes, manager.GetResidentBytes());
+
+	// 粗いミップへは3フレーム続いてから落とす
+	for (int frame = 0; frame < 2; ++frame) {
+		manager.Update(changes);
+		EXPECT_TRUE(changes.empty());
+		EXPECT_EQ(0u, manager.GetResidentMip(id));
+	}
+	manager.Update(changes);
+	EXPECT_EQ(size_t{1}, changes.size());
+	CompleteLoads(manager, changes);
+	EXPECT_EQ(3u, manager.GetResidentMip(id));
+	EXPECT_EQ(uint64_t{64}, manager.GetResidentBytes());
+	EXPECT_EQ(uint64_t{1}, manager.GetStatistics().streamIns);
+	EXPECT_EQ(uint64_t{1}, manager.GetStatistics().evictions);
+
+	// 途中でまた使われたら数え直す
+	manager.RequestUsage(id, 64.0f, 64.0f);
+	manager.Update(changes);
+	CompleteLoads(manager, changes);
+	manager.Update(changes);
+	manager.Update(changes);
+	manager.RequestUsage(id, 64.0f, 64.0f);
+	manager.Update(changes);
+	EXPECT_TRUE(changes.empty());
+	EXPECT_EQ(0u, manager.GetResidentMip(id));
+}
+
+TEST(MipResidencyManager, CoalescesChangesPerTexture) {
+	// 1枚分の全ミップと、もう1枚のミップ2まで(差し替え中に末尾と重なる分を含む)しか入らない予算
+	MipResidencyManager manager;
+	manager.Initialize(kAllMipsBytes + 256 + 64 + 64, 2);
+	uint32_t a = manager.Register(64, 64, kMipBytes, 3);
+	uint32_t b = manager.Register(64, 64, kMipBytes, 3);
+	std::vector<MipResidencyManager::Change> changes;
+
+	manager.RequestUsage(a, 63.0f, 63.0f);
+	manager.Update(changes);
+	EXPECT_TRUE(IsCoalesced(manager, changes));
+	CompleteLoads(manager, changes);
+	EXPECT_EQ(0u, manager.GetResidentMip(a));
+
+	// bの方が大きく表示されると、aは予算の確保で1段ずつ2段落とされるが変更は1つにまとまる
+	manager.RequestUsage(a, 63.0f, 63.0f);
+	manager.RequestUsage(b, 64.0f, 64.0f);
+	manager.Update(changes);
+	EXPECT_EQ(size_t{1}, changes.size());
+	EXPECT_TRUE(IsCoalesced(manager, changes));
+	EXPECT_EQ(a, changes[0].id);
+	EXPECT_EQ(0u, changes[0].previousMip);
+	EXPECT_EQ(2u, changes[0].targetMip);
+	EXPECT_EQ(uint64_t{2}, manager.GetStatistics().evictions);
+	// aの粗い段階が届くまでは詳細な段階も残るので、bはまだ読み込めない
+	EXPECT_EQ(3u, manager.GetTargetMip(b));
+	EXPECT_TRUE(manager.GetResidentBytes() <= manager.GetBudget());
+
+	CompleteLoads(manager, changes);
+	manager.RequestUsage(a, 63.0f, 63.0f);
+	manager.RequestUsage(b, 64.0f, 64.0f);
+	manager.Update(changes);
+	EXPECT_EQ(size_t{1}, changes.size());
+	EXPECT_EQ(0u, manager.GetTargetMip(b));
+	EXPECT_TRUE(manager.GetResidentBytes() <= manager.GetBudget());
+}
+
+TEST(MipResidencyManager, CompromisesWhenOverBudget) {
+	// 大きい方から読み込み、予算に収まらない分は粗いミップで妥協する
+	MipResidencyManager manager;
+	manager.Initialize(kAllMipsBytes + 256 + 64 + 64, 30);
+	uint32_t large = manager.Register(64, 64, kMipBytes, 3);
+	uint32_t small = manager.Register(64, 64, kMipBytes, 3);
+	std::vector<MipResidencyManager::Change> changes;
+
+	// largeの差し替え中はsmallの分が空いていない
+	manager.RequestUsage(large, 64.0f, 64.0f);
+	manager.RequestUsage(small, 63.0f, 63.0f);
+	manager.Update(changes);
+	EXPECT_TRUE(IsCoalesced(manager, changes));
+	EXPECT_EQ(0u, manager.GetTargetMip(large));
+	EXPECT_EQ(3u, manager.GetTargetMip(small));
+	EXPECT_EQ(uint64_t{1}, manager.GetStatistics().budgetMisses);
+	CompleteLoads(manager, changes);
+
+	manager.RequestUsage(large, 64.0f, 64.0f);
+	manager.RequestUsage(small, 63.0f, 63.0f);
+	manager.Update(changes);
+	EXPECT_EQ(2u, manager.GetTargetMip(small));
+	EXPECT_EQ(uint64_t{2}, manager.GetStatistics().budgetMisses);
+	EXPECT_EQ(manager.GetBudget(), manager.GetResidentBytes());
+	CompleteLoads(manager, changes);
+	EXPECT_EQ(0u, manager.GetResidentMip(large));
+	EXPECT_EQ(2u, manager.GetResidentMip(small));
+	EXPECT_EQ(kAllMipsBytes + 256 + 64, manager.GetResidentBytes());
+
+	// 登録解除で常駐バイト数を返す
+	manager.Unregister(large);
+	EXPECT_EQ(uint64_t{256 + 64}, manager.GetResidentBytes());
+}
+
+TEST(MipResidencyManager, RetriesAfterFailedLoad) {
+	// 読み込みに失敗したら予算を元に戻し、ヒステリシスの分待ってから要求し直す
+	MipResidencyManager manager;
+	manager.Initialize(1ull << 20, 3);
+	uint32_t id = manager.Register(64, 64, kMipBytes, 3);
+	std::vector<MipResidencyManager::Change> changes;
+
+	manager.RequestUsage(id, 64.0f, 64.0f);
+	manager.Update(changes);
+	EXPECT_EQ(size_t{1}, changes.size());
+	// 取り消し済みの段階の報告は無視する
+	EXPECT_FALSE(manager.OnLoadCompleted(id, 2, true));
+	EXPECT_TRUE(manager.OnLoadCompleted(id, 0, false));
+	EXPECT_FALSE(manager.IsLoading(id));
+	EXPECT_EQ(3u, manager.GetResidentMip(id));
+	EXPECT_EQ(uint64_t{64}, manager.GetResidentBytes());
+	EXPECT_EQ(uint64_t{64}, manager.GetProjectedBytes());
+	EXPECT_EQ(uint64_t{1}, manager.GetStatistics().failedLoads);
+
+	for (int frame = 0; frame < 3; ++frame) {
+		manager.RequestUsage(id, 64.0f, 64.0f);
+		manager.Update(changes);
+		EXPECT_TRUE(changes.empty());
+	}
+	manager.RequestUsage(id, 64.0f, 64.0f);
+	manager.Update(changes);
+	EXPECT_EQ(size_t{1}, changes.size());
+	CompleteLoads(manager, changes);
+	EXPECT_EQ(0u, manager.GetResidentMip(id));
+	EXPECT_EQ(kAllMipsBytes, manager.GetResidentBytes());
+
+	// 読み込み中に登録解除しても両方の段階の分を返す
+	manager.Update(changes);
+	manager.Update(changes);
+	manager.Update(changes);
+	EXPECT_TRUE(manager.IsLoading(id));
+	manager.Unregister(id);
+	EXPECT_EQ(uint64_t{0}, manager.GetResidentBytes());
+	EXPECT_EQ(uint64_t{0}, manager.GetProjectedBytes());
+	EXPECT_FALSE(manager.OnLoadCompleted(id, 3, true));
+}
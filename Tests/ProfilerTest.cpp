@@ -0,0 +1,39 @@
+#include "Profiler.h"
+#include "Test.h"
+#include <set>
+#include <thread>
+#include <vector>
+
+TEST(Profiler, ReclaimsBuffersOfExitedThreads) {
+	// 短命なスレッドで記録したゾーンを回収し、終了したスレッドのバッファは回収後に手放す
+	Profiler* profiler = Profiler::GetInstance();
+	profiler->BeginFrame();
+	const size_t bufferCount = profiler->GetThreadBufferCount();
+	std::set<uint32_t> threadIds;
+	for (int round = 0; round < 3; ++round) {
+		std::vector<std::thread> threads;
+		for (int t = 0; t < 8; ++t) {
+			threads.emplace_back([]() {
+				for (int i = 0; i < 10; ++i) {
+					ProfileScope outer("Outer");
+					ProfileScope inner("Inner");
+				}
+			});
+		}
+		for (std::thread& thread : threads) {
+			thread.join();
+		}
+		EXPECT_EQ(bufferCount + 8, profiler->GetThreadBufferCount());
+
+		profiler->BeginFrame();
+		const Profiler::Frame* frame = profiler->GetLastFrame();
+		EXPECT_EQ(size_t{160}, frame->zones.size());
+		for (const Profiler::Zone& zone : frame->zones) {
+			threadIds.insert(zone.threadId);
+		}
+		EXPECT_EQ(bufferCount, profiler->GetThreadBufferCount());
+	}
+	// 破棄したバッファのスレッド番号は使い回さない
+	EXPECT_EQ(size_t{24}, threadIds.size());
+	EXPECT_EQ(uint64_t{0}, profiler->GetDroppedZoneCount());
+}
@@ -0,0 +1,108 @@
+#include "SlotAllocator.h"
+#include "Test.h"
+#include <random>
+#include <set>
+
+TEST(SlotAllocator, AllocatesLowestFirstUpToTheLimit) {
+	// ワードの境界で割り切れないページの大きさでも順に埋まる
+	SlotAllocator allocator(100, 2);
+	bool inOrder = true;
+	for (uint32_t i = 0; i < 200; ++i) {
+		inOrder = inOrder && allocator.Allocate() == i;
+	}
+	EXPECT_TRUE(inOrder);
+	EXPECT_EQ(2u, allocator.GetPageCount());
+	EXPECT_EQ(200u, allocator.GetUsedCount());
+	EXPECT_EQ(SlotAllocator::kInvalidSlot, allocator.Allocate());
+
+	// 解放したスロットが次に再利用される
+	allocator.Free(150);
+	EXPECT_FALSE(allocator.Test(150));
+	EXPECT_EQ(150u, allocator.Allocate());
+	allocator.Free(3);
+	allocator.Free(120);
+	EXPECT_EQ(3u, allocator.Allocate());
+	EXPECT_EQ(120u, allocator.Allocate());
+}
+
+TEST(SlotAllocator, ReserveAddsPages) {
+	SlotAllocator allocator(64, 4);
+	EXPECT_TRUE(allocator.Reserve(130));
+	EXPECT_EQ(3u, allocator.GetPageCount());
+	EXPECT_TRUE(allocator.Test(130));
+	EXPECT_FALSE(allocator.Reserve(130));
+	// 上限の4ページまでは足すが、それを超える番号は予約できない
+	EXPECT_FALSE(allocator.Reserve(256));
+	EXPECT_EQ(4u, allocator.GetPageCount());
+	EXPECT_EQ(1u, allocator.GetUsedCount());
+	EXPECT_EQ(0u, allocator.Allocate());
+
+	// Resetでページは残したまま全部空く
+	allocator.Reset();
+	EXPECT_EQ(0u, allocator.GetUsedCount());
+	EXPECT_EQ(4u, allocator.GetPageCount());
+	EXPECT_FALSE(allocator.Test(130));
+}
+
+TEST(SlotAllocator, MatchesReferenceSetUnderChurn) {
+	// 割り当てと解放を乱数で繰り返し、std::setで持った正解と一致し続けるか
+	SlotAllocator allocator(1024);
+	std::set<uint32_t> used;
+	std::mt19937 random(1);
+	bool unique = true;
+	for (uint32_t i = 0; i < 3000; ++i) {
+		unique = used.insert(allocator.Allocate()).second && unique;
+	}
+	EXPECT_TRUE(unique);
+	EXPECT_EQ(3u, allocator.GetPageCount());
+
+	for (uint32_t i = 0; i < 100000; ++i) {
+		if (random() % 2 == 0 && !used.empty()) {
+			auto it = used.begin();
+			std::advance(it, random() % used.size());
+			allocator.Free(*it);
+			used.erase(it);
+		} else {
+			uint32_t slot = allocator.Allocate();
+			// 空きがあるうちは常に一番小さい空き番号を返す
+			uint32_t lowestFree = 0;
+			for (uint32_t s : used) {
+				if (s != lowestFree) {
+					break;
+				}
+				++lowestFree;
+			}
+			if (slot != lowestFree) {
+				EXPECT_EQ(lowestFree, slot);
+				break;
+			}
+			used.insert(slot);
+		}
+	}
+	EXPECT_EQ(static_cast<uint32_t>(used.size()), allocator.GetUsedCount());
+	bool allSet = true;
+	for (uint32_t slot : used) {
+		allSet = allSet && allocator.Test(slot);
+	}
+	EXPECT_TRUE(allSet);
+}
+
+TEST(SlotAllocator, IgnoresFreeOfUnallocatedSlots) {
+	// 二重解放や割り当てていない番号の解放では、使用数も満杯の要約も変わらない
+	SlotAllocator allocator(64, 2);
+	for (uint32_t i = 0; i < 128; ++i) {
+		allocator.Allocate();
+	}
+	EXPECT_TRUE(allocator.Free(70));
+	EXPECT_FALSE(allocator.Free(70));
+	EXPECT_FALSE(allocator.Free(500));
+	EXPECT_EQ(127u, allocator.GetUsedCount());
+	// 1ページ目は満杯のままなので、次の割り当ては解放した番号になる
+	EXPECT_EQ(70u, allocator.Allocate());
+	EXPECT_EQ(SlotAllocator::kInvalidSlot, allocator.Allocate());
+
+	allocator.Reset();
+	EXPECT_FALSE(allocator.Free(0));
+	EXPECT_EQ(0u, allocator.GetUsedCount());
+	EXPECT_EQ(0u, allocator.Allocate());
+}
@@ -0,0 +1,74 @@
+#include "SoundLibrary.h"
+#include "Test.h"
+#include <filesystem>
+#include <vector>
+
+namespace {
+
+// 16bitモノラルの無音のWAVを書き出す
+void WriteSilence(const std::filesystem::path& path, uint32_t frameCount) {
+	WaveFormat format;
+	format.formatTag = WaveFormat::kPcm;
+	format.channels = 1;
+	format.sampleRate = 22050;
+	format.bitsPerSample = 16;
+	format.blockAlign = 2;
+	format.avgBytesPerSec = 44100;
+	std::vector<uint8_t> data(static_cast<size_t>(frameCount) * 2);
+	WriteWaveFile(path.string(), format, data.data(), data.size());
+}
+
+} // namespace
+
+TEST(SoundLibrary, ReusesSlotsWithNewGenerations) {
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "SoundLibraryTest";
+	std::filesystem::create_directories(directory);
+	WriteSilence(directory / "a.wav", 1000);
+	WriteSilence(directory / "b.wav", 2000);
+	SoundLibrary* library = SoundLibrary::GetInstance();
+	library->Initialize(directory.string() + "/");
+
+	// 同じファイルは共有し、参照がなくなるまで残る
+	uint32_t a = library->Load("a.wav");
+	EXPECT_TRUE(a != SoundLibrary::kInvalidHandle);
+	EXPECT_EQ(a, library->Load("a.wav"));
+	EXPECT_EQ(1u, library->GetSoundCount());
+	library->Unload(a);
+	EXPECT_TRUE(library->Get(a) != nullptr);
+	library->Unload(a);
+	EXPECT_TRUE(library->Get(a) == nullptr);
+	EXPECT_EQ(size_t{0}, library->GetMemoryUsage());
+
+	// 空いた枠を使い回しても、古いハンドルは新しい音声を指さない
+	uint32_t b = library->Load("b.wav");
+	EXPECT_EQ(a & 0xFFFF, b & 0xFFFF);
+	EXPECT_TRUE(a != b);
+	EXPECT_TRUE(library->Get(a) == nullptr);
+	library->Unload(a);
+	EXPECT_TRUE(library->Get(b) != nullptr);
+
+	// 読めないファイルを含むバンクは何も登録しない
+	{
+		SoundBank bank;
+		EXPECT_FALSE(bank.Load({"a.wav", "missing.wav"}));
+		EXPECT_EQ(1u, library->GetSoundCount());
+		EXPECT_TRUE(bank.Load({"a.wav", "b.wav", "a.wav"}));
+		EXPECT_EQ(size_t{2}, bank.GetSoundCount());
+		EXPECT_EQ(library->GetMemoryUsage(), bank.GetMemoryUsage());
+	}
+	EXPECT_EQ(1u, library->GetSoundCount());
+
+	// 終了処理と初期化をやり直しても、前のハンドルは無効のまま
+	library->Finalize();
+	library->Initialize(directory.string() + "/");
+	uint32_t reloaded = library->Load("b.wav");
+	EXPECT_EQ(b & 0xFFFF, reloaded & 0xFFFF);
+	EXPECT_TRUE(library->Get(a) == nullptr);
+	EXPECT_TRUE(library->Get(b) == nullptr);
+	EXPECT_TRUE(library->Get(reloaded) != nullptr);
+	library->Unload(b);
+	EXPECT_EQ(1u, library->GetSoundCount());
+
+	library->Finalize();
+	std::filesystem::remove_all(directory);
+}
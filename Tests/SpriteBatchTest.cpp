@@ -0,0 +1,255 @@
+#include "BatchSprite.h"
+#include "NullRenderDevice.h"
+#include "SpriteBatch.h"
+#include "Test.h"
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 半精度浮動小数点数をfloatに戻す(PackInstanceの確認用)
+float HalfToFloat(uint16_t half) {
+	uint32_t exponent = (half >> 10) & 31;
+	uint32_t mantissa = half & 1023;
+	float value = 0.0f;
+	if (exponent == 0) {
+		value = std::ldexp(static_cast<float>(mantissa), -24);
+	} else if (exponent == 31) {
+		value = mantissa != 0 ? NAN : INFINITY;
+	} else {
+		value = std::ldexp(static_cast<float>(mantissa | 1024), static_cast<int>(exponent) - 25);
+	}
+	return (half & 0x8000) != 0 ? -value : value;
+}
+
+const float kFullUv[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+
+// 12000枚を3種類のテクスチャと2種類のブレンドモードで描き、統計と検証エラーを確かめる
+void DrawManySprites(SpriteBatch::Mode mode) {
+	NullRenderDevice device;
+	for (uint32_t textureHandle = 1; textureHandle <= 3; ++textureHandle) {
+		device.SetTextureSize(textureHandle, 64, 64);
+	}
+	SpriteBatch batch(&device, SpriteBatch::kDefaultMaxSprites, mode);
+	device.BeginFrame();
+	batch.Begin();
+	uint32_t visible = 0;
+	for (uint32_t i = 0; i < 12000; ++i) {
+		SpriteBatch::SpriteDesc sprite;
+		sprite.textureHandle = 1 + i % 3;
+		sprite.position = {static_cast<float>(i % 1500) - 100.0f, static_cast<float>(i % 800)};
+		sprite.size = {16.0f, 16.0f};
+		sprite.blendMode = i % 7 != 0 ? RenderBlendMode::kNormal : RenderBlendMode::kAdd;
+		visible += SpriteBatch::IsVisible(sprite, 1280.0f, 720.0f) ? 1 : 0;
+		EXPECT_TRUE(batch.Draw(sprite));
+	}
+	batch.End();
+	device.EndFrame();
+
+	const SpriteBatch::Statistics& statistics = batch.GetStatistics();
+	const RenderCounters& counters = device.GetFrameCounters();
+	EXPECT_EQ(visible, statistics.sprites);
+	EXPECT_EQ(12000u - visible, statistics.culledSprites);
+	EXPECT_EQ(0u, statistics.droppedSprites);
+	// テクスチャとブレンドモードの組み合わせごとに1回
+	EXPECT_EQ(6u, statistics.batches);
+	EXPECT_EQ(uint64_t{6}, counters.drawCalls);
+	if (mode == SpriteBatch::Mode::kInstanced) {
+		EXPECT_EQ(uint64_t{visible}, counters.instances);
+		EXPECT_EQ(size_t{visible} * sizeof(SpriteBatch::Instance), statistics.bytesWritten);
+		EXPECT_EQ(uint64_t{0}, counters.bytesCopied);
+	} else {
+		EXPECT_EQ(size_t{visible} * 4 * sizeof(SpriteBatch::Vertex), statistics.bytesWritten);
+		// 共通のインデックスは最初のフレームでGPU専用のバッファにコピーする
+		EXPECT_EQ(uint64_t{SpriteBatch::kDefaultMaxSprites} * 6 * sizeof(uint16_t), counters.bytesCopied);
+	}
+	EXPECT_EQ(uint64_t{0}, counters.validationErrors);
+	EXPECT_EQ(std::string(), device.GetLastError());
+
+	// 次のフレームはコピーしない
+	device.BeginFrame();
+	batch.Begin();
+	SpriteBatch::SpriteDesc sprite;
+	sprite.textureHandle = 1;
+	EXPECT_TRUE(batch.Draw(sprite));
+	batch.End();
+	device.EndFrame();
+	EXPECT_EQ(uint64_t{0}, device.GetFrameCounters().bytesCopied);
+	EXPECT_EQ(uint64_t{0}, device.GetFrameCounters().validationErrors);
+}
+
+} // namespace
+
+TEST(SpriteBatch, WritesQuadCorners) {
+	SpriteBatch::SpriteDesc sprite;
+	sprite.position = {10.0f, 20.0f};
+	sprite.size = {30.0f, 40.0f};
+	sprite.color = {0.1f, 0.2f, 0.3f, 0.4f};
+	const float uvRect[4] = {0.25f, 0.5f, 0.75f, 1.0f};
+	SpriteBatch::Vertex vertices[4];
+	SpriteBatch::WriteQuad(sprite, uvRect, vertices);
+
+	// 左下、左上、右下、右上
+	const float expected[4][4] = {
+	    {10.0f, 60.0f, 0.25f, 1.0f},
+	    {10.0f, 20.0f, 0.25f, 0.5f},
+	    {40.0f, 60.0f, 0.75f, 1.0f},
+	    {40.0f, 20.0f, 0.75f, 0.5f},
+	};
+	for (int i = 0; i < 4; ++i) {
+		EXPECT_NEAR(expected[i][0], vertices[i].position[0], 1e-4);
+		EXPECT_NEAR(expected[i][1], vertices[i].position[1], 1e-4);
+		EXPECT_NEAR(expected[i][2], vertices[i].uv[0], 1e-6);
+		EXPECT_NEAR(expected[i][3], vertices[i].uv[1], 1e-6);
+		EXPECT_NEAR(0.3, vertices[i].color[2], 1e-6);
+	}
+
+	// 左右反転はSpriteと同じく頂点の左右を入れ替え、アンカーポイントを中心に回転する
+	sprite.isFlipX = true;
+	sprite.anchorPoint = {0.5f, 0.5f};
+	sprite.rotation = 3.14159265f;
+	SpriteBatch::WriteQuad(sprite, uvRect, vertices);
+	EXPECT_NEAR(0.25, vertices[0].uv[0], 1e-6);
+	EXPECT_NEAR(-5.0, vertices[0].position[0], 1e-4);
+	EXPECT_NEAR(0.0, vertices[0].position[1], 1e-4);
+	EXPECT_NEAR(25.0, vertices[2].position[0], 1e-4);
+}
+
+TEST(SpriteBatch, PacksInstances) {
+	SpriteBatch::SpriteDesc sprite;
+	sprite.position = {10.0f, 20.0f};
+	sprite.size = {30.0f, 40.0f};
+	sprite.anchorPoint = {0.5f, 0.25f};
+	sprite.rotation = 1.5f;
+	sprite.isFlipY = true;
+	sprite.color = {1.0f, 0.5f, 2.5f, 0.333f};
+	const float uvRect[4] = {0.0f, 0.25f, 1.0f, 0.75f};
+	SpriteBatch::Instance instance;
+	SpriteBatch::PackInstance(sprite, uvRect, instance);
+
+	EXPECT_EQ(2u, instance.flags);
+	EXPECT_NEAR(30.0, instance.size[0], 0.0);
+	EXPECT_NEAR(1.5, instance.rotation, 0.0);
+	const uint16_t uv[4] = {0, 16384, 65535, 49151};
+	for (int i = 0; i < 4; ++i) {
+		EXPECT_EQ(uv[i], instance.uvRect[i]);
+	}
+	EXPECT_NEAR(2.5, HalfToFloat(instance.color[2]), 0.0);
+	EXPECT_NEAR(0.333, HalfToFloat(instance.color[3]), 1e-3);
+}
+
+TEST(SpriteBatch, ConvertsColorsToHalf) {
+	// 有限の半精度の値は全てそのまま戻る
+	uint32_t mismatches = 0;
+	for (uint32_t half = 0; half < 0x10000; ++half) {
+		if (((half >> 10) & 31) == 31) {
+			continue;
+		}
+		SpriteBatch::SpriteDesc sprite;
+		sprite.color = {HalfToFloat(static_cast<uint16_t>(half)), 0.0f, 0.0f, 0.0f};
+		SpriteBatch::Instance instance;
+		SpriteBatch::PackInstance(sprite, kFullUv, instance);
+		mismatches += instance.color[0] != half ? 1 : 0;
+	}
+	EXPECT_EQ(0u, mismatches);
+
+	// 中間は偶数へ丸め、範囲外は無限大、小さすぎる値は0、非正規化数も表せる
+	SpriteBatch::SpriteDesc sprite;
+	sprite.color = {1.0f + std::ldexp(1.0f, -11), 65520.0f, 1e-8f, std::ldexp(3.0f, -25)};
+	SpriteBatch::Instance instance;
+	SpriteBatch::PackInstance(sprite, kFullUv, instance);
+	EXPECT_EQ(uint16_t{0x3C00}, instance.color[0]);
+	EXPECT_EQ(uint16_t{0x7C00}, instance.color[1]);
+	EXPECT_EQ(uint16_t{0x0000}, instance.color[2]);
+	EXPECT_EQ(uint16_t{0x0002}, instance.color[3]);
+}
+
+TEST(SpriteBatch, CullsOffscreenSprites) {
+	SpriteBatch::SpriteDesc sprite;
+	sprite.size = {100.0f, 100.0f};
+	sprite.position = {-99.0f, 0.0f};
+	EXPECT_TRUE(SpriteBatch::IsVisible(sprite, 1280.0f, 720.0f));
+	sprite.position = {-101.0f, 0.0f};
+	EXPECT_FALSE(SpriteBatch::IsVisible(sprite, 1280.0f, 720.0f));
+	sprite.position = {1279.0f, 719.0f};
+	EXPECT_TRUE(SpriteBatch::IsVisible(sprite, 1280.0f, 720.0f));
+	sprite.position = {1281.0f, 0.0f};
+	EXPECT_FALSE(SpriteBatch::IsVisible(sprite, 1280.0f, 720.0f));
+
+	// 反転した矩形は左に伸びる
+	sprite.isFlipX = true;
+	sprite.position = {1.0f, 0.0f};
+	EXPECT_TRUE(SpriteBatch::IsVisible(sprite, 1280.0f, 720.0f));
+	sprite.position = {-1.0f, 0.0f};
+	EXPECT_FALSE(SpriteBatch::IsVisible(sprite, 1280.0f, 720.0f));
+
+	// 回転していればアンカーポイントから最も遠い角までの円で判定する
+	sprite.isFlipX = false;
+	sprite.rotation = 0.7f;
+	sprite.position = {-120.0f, 50.0f};
+	EXPECT_TRUE(SpriteBatch::IsVisible(sprite, 1280.0f, 720.0f));
+	sprite.position = {-150.0f, 50.0f};
+	EXPECT_FALSE(SpriteBatch::IsVisible(sprite, 1280.0f, 720.0f));
+}
+
+TEST(SpriteBatch, BatchesVertices) { DrawManySprites(SpriteBatch::Mode::kVertex); }
+
+TEST(SpriteBatch, BatchesInstances) { DrawManySprites(SpriteBatch::Mode::kInstanced); }
+
+TEST(SpriteBatch, DropsSpritesBeyondTheLimit) {
+	NullRenderDevice device;
+	device.SetTextureSize(1, 64, 64);
+	SpriteBatch batch(&device, 100);
+	device.BeginFrame();
+	batch.Begin();
+	SpriteBatch::SpriteDesc sprite;
+	sprite.textureHandle = 1;
+	uint32_t accepted = 0;
+	for (int i = 0; i < 150; ++i) {
+		accepted += batch.Draw(sprite) ? 1 : 0;
+	}
+	batch.End();
+	device.EndFrame();
+	EXPECT_EQ(100u, accepted);
+	EXPECT_EQ(100u, batch.GetStatistics().sprites);
+	EXPECT_EQ(50u, batch.GetStatistics().droppedSprites);
+	EXPECT_EQ(uint64_t{0}, device.GetFrameCounters().validationErrors);
+}
+
+TEST(SpriteBatch, RewritesOnlyChangedBatchSprites) {
+	for (SpriteBatch::Mode mode : {SpriteBatch::Mode::kVertex, SpriteBatch::Mode::kInstanced}) {
+		NullRenderDevice device;
+		device.SetTextureSize(1, 128, 128);
+		SpriteBatch batch(&device, 1000, mode);
+		std::vector<BatchSprite> sprites(500);
+		for (size_t i = 0; i < sprites.size(); ++i) {
+			sprites[i].SetTextureHandle(1);
+			sprites[i].SetPosition({static_cast<float>(i % 50) * 20.0f, static_cast<float>(i / 50) * 20.0f});
+			sprites[i].SetSize({16.0f, 16.0f});
+			sprites[i].SetTextureRect({0.0f, 0.0f}, {32.0f, 32.0f});
+		}
+		auto drawFrame = [&]() {
+			device.BeginFrame();
+			batch.Begin();
+			for (BatchSprite& sprite : sprites) {
+				batch.Draw(sprite);
+			}
+			batch.End();
+			device.EndFrame();
+			return batch.GetStatistics().rewrites;
+		};
+
+		EXPECT_EQ(500u, drawFrame());
+		EXPECT_EQ(0u, drawFrame());
+		// 同じ値の設定では作り直さない
+		sprites[7].SetPosition(sprites[7].GetPosition());
+		sprites[3].SetColor({1.0f, 0.0f, 0.0f, 1.0f});
+		sprites[4].SetRotation(0.5f);
+		EXPECT_EQ(2u, drawFrame());
+		// テクスチャの大きさが変わればテクスチャ座標から作り直す
+		device.SetTextureSize(1, 256, 256);
+		EXPECT_EQ(500u, drawFrame());
+		EXPECT_EQ(uint64_t{0}, device.GetTotalCounters().validationErrors);
+	}
+}
@@ -0,0 +1,139 @@
+#include "AudioMixer.h"
+#include "SpscQueue.h"
+#include "Test.h"
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+TEST(SpscQueue, KeepsOrderAndCapacity) {
+	SpscQueue<int> queue(5);
+	EXPECT_EQ(size_t{8}, queue.GetCapacity());
+	for (int i = 0; i < 8; ++i) {
+		EXPECT_TRUE(queue.TryPush(int(i)));
+	}
+	EXPECT_FALSE(queue.TryPush(8));
+	int value = -1;
+	for (int i = 0; i < 8; ++i) {
+		EXPECT_TRUE(queue.TryPop(value));
+		EXPECT_EQ(i, value);
+	}
+	EXPECT_FALSE(queue.TryPop(value));
+
+	// 取り出した要素の参照はキューに残らない
+	SpscQueue<std::shared_ptr<int>> pointers(2);
+	std::shared_ptr<int> pointer = std::make_shared<int>(1);
+	EXPECT_TRUE(pointers.TryPush(std::shared_ptr<int>(pointer)));
+	std::shared_ptr<int> popped;
+	EXPECT_TRUE(pointers.TryPop(popped));
+	popped.reset();
+	EXPECT_EQ(1l, pointer.use_count());
+}
+
+TEST(SpscQueue, TransfersAcrossThreads) {
+	// 送り手と受け手を別スレッドで回し、小さいキューで満杯と空を何度も通っても順序と中身が保たれるか
+	const uint64_t count = 1000000;
+	SpscQueue<uint64_t> queue(64);
+	std::thread producer([&]() {
+		for (uint64_t i = 0; i < count;) {
+			if (queue.TryPush(uint64_t(i))) {
+				++i;
+			} else {
+				std::this_thread::yield();
+			}
+		}
+	});
+	uint64_t expected = 0;
+	bool inOrder = true;
+	while (expected < count) {
+		uint64_t value = 0;
+		if (queue.TryPop(value)) {
+			inOrder = inOrder && value == expected;
+			++expected;
+		} else {
+			std::this_thread::yield();
+		}
+	}
+	producer.join();
+	EXPECT_TRUE(inOrder);
+	uint64_t value = 0;
+	EXPECT_FALSE(queue.TryPop(value));
+}
+
+TEST(SpscQueue, MixerCommandsUnderContention) {
+	// 4スレッドから再生、停止、音量変更を送りながら合成スレッドを回し、最後に全部の枠が空くか
+	PcmSound pcm;
+	pcm.format.formatTag = WaveFormat::kPcm;
+	pcm.format.channels = 1;
+	pcm.format.sampleRate = 44100;
+	pcm.format.bitsPerSample = 16;
+	pcm.format.blockAlign = 2;
+	pcm.format.avgBytesPerSec = 88200;
+	pcm.data.resize(4000);
+	for (size_t i = 0; i < 2000; ++i) {
+		int16_t sample = static_cast<int16_t>(12000 * std::sin(static_cast<double>(i) * 0.06));
+		std::memcpy(&pcm.data[i * 2], &sample, 2);
+	}
+	std::shared_ptr<const MixerSound> sound = CreateMixerSound(pcm);
+
+	const uint32_t slotCount = 64;
+	AudioMixer mixer(48000, slotCount, 16);
+	std::atomic<bool> mixing = true;
+	std::thread audio([&]() {
+		std::vector<float> buffer(512);
+		while (mixing) {
+			mixer.Mix(buffer.data(), 256);
+		}
+	});
+
+	std::atomic<uint64_t> plays = 0;
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; ++t) {
+		threads.emplace_back([&, t]() {
+			std::vector<uint32_t> handles;
+			for (int i = 0; i < 5000; ++i) {
+				uint32_t handle = mixer.Play(sound, AudioMixer::Bus::kSfx, i % 7 == 0, 0.5f, 1.0f + t * 0.1f);
+				if (handle == AudioMixer::kInvalidHandle) {
+					continue;
+				}
+				++plays;
+				handles.push_back(handle);
+				if (i % 3 == 0) {
+					mixer.SetVolume(handles[handles.size() / 2], 0.2f);
+				}
+				if (i % 2 == 0) {
+					mixer.Stop(handles.front());
+					handles.erase(handles.begin());
+				}
+			}
+			for (uint32_t handle : handles) {
+				mixer.Stop(handle);
+			}
+		});
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	mixing = false;
+	audio.join();
+
+	// あふれたコマンドは次の操作で送られるので、操作と合成を繰り返して停止のランプまで流し切る
+	std::vector<float> buffer(4096);
+	for (int i = 0; i < 50; ++i) {
+		mixer.SetBusVolume(AudioMixer::Bus::kSfx, 1.0f);
+		mixer.Mix(buffer.data(), 2048);
+	}
+	AudioMixer::Statistics statistics = mixer.GetStatistics();
+	EXPECT_TRUE(plays.load() > 0);
+	EXPECT_EQ(0u, statistics.pendingCommands);
+	EXPECT_EQ(0u, mixer.GetVoiceCount());
+
+	// 全部の枠が空いていれば、枠の数だけ鳴らしても奪わない
+	uint64_t steals = statistics.steals;
+	for (uint32_t i = 0; i < slotCount; ++i) {
+		EXPECT_TRUE(mixer.Play(sound, AudioMixer::Bus::kSfx, true) != AudioMixer::kInvalidHandle);
+	}
+	EXPECT_EQ(steals, mixer.GetStatistics().steals);
+	EXPECT_EQ(slotCount, mixer.GetVoiceCount());
+}
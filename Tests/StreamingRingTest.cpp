@@ -0,0 +1,199 @@
+#include "StreamingRing.h"
+#include "Test.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// 1サンプル4バイトの連番を返す音源
+class CounterSource : public AudioStreamSource {
+public:
+	explicit CounterSource(uint32_t sampleCount) : sampleCount_(sampleCount) {
+		format_.formatTag = WaveFormat::kPcm;
+		format_.channels = 2;
+		format_.bitsPerSample = 16;
+		format_.blockAlign = 4;
+	}
+	const WaveFormat& GetFormat() const override { return format_; }
+	size_t Read(uint8_t* dst, size_t size) override {
+		size_t count = (std::min)(size / 4, static_cast<size_t>(sampleCount_ - position_));
+		for (size_t i = 0; i < count; ++i) {
+			uint32_t value = position_++;
+			std::memcpy(dst + i * 4, &value, 4);
+		}
+		return count * 4;
+	}
+	bool Rewind() override {
+		position_ = 0;
+		return true;
+	}
+
+private:
+	WaveFormat format_;
+	uint32_t sampleCount_;
+	uint32_t position_ = 0;
+};
+
+// 投入されたバッファを溜めておき、テストから再生し終えたことにする出力先
+class FakeVoice : public StreamingVoice {
+public:
+	struct Buffer {
+		void* context;
+		std::vector<uint8_t> data;
+		bool endOfStream;
+	};
+
+	bool SubmitBuffer(const uint8_t* data, size_t size, void* context, bool endOfStream) override {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (failSubmit_) {
+			return false;
+		}
+		buffers_.push_back({context, std::vector<uint8_t>(data, data + size), endOfStream});
+		return true;
+	}
+
+	// 最も古いバッファを取り出す
+	bool Pop(Buffer& buffer) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (buffers_.empty()) {
+			return false;
+		}
+		buffer = std::move(buffers_.front());
+		buffers_.pop_front();
+		return true;
+	}
+
+	void SetFailSubmit(bool failSubmit) { failSubmit_ = failSubmit; }
+
+private:
+	std::mutex mutex_;
+	std::deque<Buffer> buffers_;
+	bool failSubmit_ = false;
+};
+
+// 投入されたバッファを全部再生し終えるまで回す。投入されたバイト数を返す
+// (blockAlignedは最後のバッファを除いてブロックの倍数だったか)
+uint64_t Drain(StreamingRing& ring, FakeVoice& voice, bool& endOfStream, bool& blockAligned) {
+	uint64_t bytes = 0;
+	endOfStream = false;
+	blockAligned = true;
+	while (!ring.IsFinished()) {
+		ring.Pump();
+		FakeVoice::Buffer buffer;
+		while (voice.Pop(buffer)) {
+			bytes += buffer.data.size();
+			blockAligned = blockAligned && (buffer.endOfStream || buffer.data.size() % ring.GetFormat().blockAlign == 0);
+			endOfStream = endOfStream || buffer.endOfStream;
+			ring.OnBufferEnd(buffer.context);
+		}
+	}
+	return bytes;
+}
+
+} // namespace
+
+TEST(StreamingRing, KeepsBuffersOnBlockBoundaries) {
+	// 24bitステレオ(6バイト/ブロック)のWAVを、ブロックの倍数でない大きさのバッファで流す
+	WaveFormat format;
+	format.formatTag = WaveFormat::kPcm;
+	format.channels = 2;
+	format.sampleRate = 48000;
+	format.bitsPerSample = 24;
+	format.blockAlign = 6;
+	format.avgBytesPerSec = 288000;
+	// dataチャンクの端数の3バイトは最後のバッファの末尾に付く
+	std::vector<uint8_t> data(288003, 1);
+	const std::string path = (std::filesystem::temp_directory_path() / "StreamingRingTest.wav").string();
+	EXPECT_TRUE(WriteWaveFile(path, format, data.data(), data.size()));
+
+	std::unique_ptr<WaveFileSource> source = std::make_unique<WaveFileSource>();
+	EXPECT_TRUE(source->Open(path));
+	FakeVoice voice;
+	StreamingRing ring(std::move(source), &voice, false, 3, 64 * 1024);
+	bool endOfStream = false;
+	bool blockAligned = false;
+	EXPECT_EQ(uint64_t{288003}, Drain(ring, voice, endOfStream, blockAligned));
+	EXPECT_TRUE(endOfStream);
+	EXPECT_TRUE(blockAligned);
+	EXPECT_EQ(uint64_t{288003}, ring.GetStatistics().bytesStreamed);
+	std::filesystem::remove(path);
+
+	// ブロックより小さいバッファは1ブロックに広げる
+	FakeVoice smallVoice;
+	StreamingRing smallRing(std::make_unique<CounterSource>(10), &smallVoice, false, 2, 3);
+	EXPECT_EQ(uint64_t{40}, Drain(smallRing, smallVoice, endOfStream, blockAligned));
+	EXPECT_EQ(uint64_t{10}, smallRing.GetStatistics().buffersSubmitted);
+}
+
+TEST(StreamingRing, StopsWhenSubmitFails) {
+	FakeVoice voice;
+	voice.SetFailSubmit(true);
+	StreamingRing ring(std::make_unique<CounterSource>(100000), &voice, true, 3, 4096);
+	EXPECT_EQ(0u, ring.Pump());
+	EXPECT_TRUE(ring.IsFinished());
+	EXPECT_FALSE(ring.NeedsData());
+}
+
+TEST(StreamingRing, CountsUnderruns) {
+	FakeVoice voice;
+	StreamingRing ring(std::make_unique<CounterSource>(100000), &voice, false, 3, 4096);
+	EXPECT_EQ(3u, ring.Pump());
+	// 読み出しが追いつかず、全部再生し終えてから埋めた
+	FakeVoice::Buffer buffer;
+	while (voice.Pop(buffer)) {
+		ring.OnBufferEnd(buffer.context);
+	}
+	EXPECT_EQ(uint64_t{1}, ring.GetStatistics().underruns);
+	EXPECT_TRUE(ring.NeedsData());
+}
+
+TEST(StreamingRing, StreamsInOrderAcrossThreads) {
+	// 読み出しスレッドでPumpし、このスレッドを出力先のコールバックとして連番が途切れず届くか
+	const uint32_t sampleCount = 100000;
+	for (bool loop : {false, true}) {
+		FakeVoice voice;
+		StreamingRing ring(std::make_unique<CounterSource>(sampleCount), &voice, loop, 3, 4096);
+		std::atomic<bool> stop = false;
+		std::thread reader([&]() {
+			while (!stop) {
+				if (ring.NeedsData()) {
+					ring.Pump();
+				} else {
+					std::this_thread::yield();
+				}
+			}
+		});
+
+		// ループなら3周分まで確かめる
+		const uint64_t limit = loop ? 3ull * sampleCount : sampleCount;
+		uint64_t samples = 0;
+		bool inOrder = true;
+		bool endOfStream = false;
+		while (inOrder && samples < limit && !ring.IsFinished()) {
+			FakeVoice::Buffer buffer;
+			if (!voice.Pop(buffer)) {
+				std::this_thread::yield();
+				continue;
+			}
+			for (size_t i = 0; i < buffer.data.size(); i += 4, ++samples) {
+				uint32_t value = 0;
+				std::memcpy(&value, &buffer.data[i], 4);
+				inOrder = inOrder && value == samples % sampleCount;
+			}
+			endOfStream = endOfStream || buffer.endOfStream;
+			ring.OnBufferEnd(buffer.context);
+		}
+		stop = true;
+		reader.join();
+
+		EXPECT_TRUE(inOrder);
+		EXPECT_TRUE(samples >= limit);
+		EXPECT_EQ(!loop, endOfStream);
+		EXPECT_EQ(!loop, ring.IsFinished());
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/// <summary>
+/// 最小限の単体テストの仕組み
+/// TEST(スイート名, テスト名)で関数を登録し、EXPECT系のマクロで失敗を記録する。失敗してもテストは最後まで続ける
+/// </summary>
+namespace Test {
+
+/// <summary>
+/// 登録されたテスト
+/// </summary>
+struct TestCase {
+	const char* suite;
+	const char* name;
+	void (*function)();
+};
+
+// 登録されたテストの一覧
+std::vector<TestCase>& GetTestCases();
+
+// 実行中のテストの失敗を記録する
+void ReportFailure(const char* file, int line, const std::string& message);
+
+/// <summary>
+/// 静的変数の初期化でテストを登録する
+/// </summary>
+struct Registrar {
+	Registrar(const char* suite, const char* name, void (*function)()) { GetTestCases().push_back({suite, name, function}); }
+};
+
+// 失敗時の表示用に値を文字列にする
+template<typename T> std::string ToString(const T& value) {
+	std::ostringstream stream;
+	if constexpr (sizeof(T) == 1 && std::is_integral_v<T>) {
+		// uint8_tなどを文字として出さない
+		stream << static_cast<int>(value);
+	} else {
+		stream << value;
+	}
+	return stream.str();
+}
+
+} // namespace Test
+
+#define TEST(suite, name)                                                                                                                                                                              \
+	static void suite##_##name();                                                                                                                                                                      \
+	static const Test::Registrar suite##_##name##_registrar(#suite, #name, &suite##_##name);                                                                                                          \
+	static void suite##_##name()
+
+#define EXPECT_TRUE(condition)                                                                                                                                                                         \
+	do {                                                                                                                                                                                               \
+		if (!(condition)) {                                                                                                                                                                            \
+			Test::ReportFailure(__FILE__, __LINE__, "EXPECT_TRUE(" #condition ")");                                                                                                                   \
+		}                                                                                                                                                                                              \
+	} while (0)
+
+#define EXPECT_FALSE(condition) EXPECT_TRUE(!(condition))
+
+#define EXPECT_EQ(expected, actual)                                                                                                                                                                    \
+	do {                                                                                                                                                                                               \
+		const auto& expectedValue = (expected);                                                                                                                                                        \
+		const auto& actualValue = (actual);                                                                                                                                                            \
+		if (!(expectedValue == actualValue)) {                                                                                                                                                         \
+			Test::ReportFailure(__FILE__, __LINE__, "EXPECT_EQ(" #expected ", " #actual "): " + Test::ToString(expectedValue) + " != " + Test::ToString(actualValue));                                \
+		}                                                                                                                                                                                              \
+	} while (0)
+
+#define EXPECT_NEAR(expected, actual, tolerance)                                                                                                                                                       \
+	do {                                                                                                                                                                                               \
+		const double expectedValue = static_cast<double>(expected);                                                                                                                                    \
+		const double actualValue = static_cast<double>(actual);                                                                                                                                        \
+		if (!(expectedValue - actualValue <= (tolerance) && actualValue - expectedValue <= (tolerance))) {                                                                                             \
+			Test::ReportFailure(__FILE__, __LINE__, "EXPECT_NEAR(" #expected ", " #actual "): " + Test::ToString(expectedValue) + " != " + Test::ToString(actualValue));                              \
+		}                                                                                                                                                                                              \
+	} while (0)
@@ -0,0 +1,44 @@
+#include "Test.h"
+#include <cstdio>
+#include <cstring>
+
+namespace Test {
+
+namespace {
+// 実行中のテストの失敗数
+uint32_t currentFailures = 0;
+} // namespace
+
+std::vector<TestCase>& GetTestCases() {
+	static std::vector<TestCase> testCases;
+	return testCases;
+}
+
+void ReportFailure(const char* file, int line, const std::string& message) {
+	std::printf("%s(%d): %s\n", file, line, message.c_str());
+	++currentFailures;
+}
+
+} // namespace Test
+
+// 引数にスイート名を与えるとそのスイートだけを実行する
+int main(int argc, char* argv[]) {
+	const char* suite = argc > 1 ? argv[1] : nullptr;
+	uint32_t runCount = 0;
+	uint32_t failedCount = 0;
+	for (const Test::TestCase& testCase : Test::GetTestCases()) {
+		if (suite != nullptr && std::strcmp(suite, testCase.suite) != 0) {
+			continue;
+		}
+		Test::currentFailures = 0;
+		testCase.function();
+		++runCount;
+		if (Test::currentFailures > 0) {
+			++failedCount;
+		}
+		std::printf("[%s] %s.%s\n", Test::currentFailures > 0 ? "FAILED" : "    OK", testCase.suite, testCase.name);
+	}
+	std::printf("%u tests, %u failed\n", runCount, failedCount);
+	// スイート名の綴り間違いで何も実行されないのも失敗にする
+	return runCount == 0 || failedCount > 0 ? 1 : 0;
+}
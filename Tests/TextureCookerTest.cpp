@@ -0,0 +1,98 @@
+#include "TextureCooker.h"
+#include "Test.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+// BGRAの32bitか、BGRの24bitのTGAを書く(rleなら同じ画素の並びを1つのパケットにする)
+void WriteTga(const std::filesystem::path& path, uint32_t width, uint32_t height, bool withAlpha, bool rle, uint8_t (*pixel)(uint32_t x, uint32_t y, uint32_t c)) {
+	uint32_t bytesPerPixel = withAlpha ? 4 : 3;
+	uint8_t header[18] = {};
+	header[2] = rle ? 10 : 2;
+	header[12] = static_cast<uint8_t>(width);
+	header[13] = static_cast<uint8_t>(width >> 8);
+	header[14] = static_cast<uint8_t>(height);
+	header[15] = static_cast<uint8_t>(height >> 8);
+	header[16] = static_cast<uint8_t>(bytesPerPixel * 8);
+	// 左上から
+	header[17] = 0x20;
+	std::ofstream file(path, std::ios::binary);
+	file.write(reinterpret_cast<const char*>(header), sizeof(header));
+	for (uint32_t y = 0; y < height; ++y) {
+		for (uint32_t x = 0; x < width; ++x) {
+			uint8_t bgra[4] = {pixel(x, y, 2), pixel(x, y, 1), pixel(x, y, 0), pixel(x, y, 3)};
+			if (rle) {
+				// 1画素ずつの生パケット
+				uint8_t packet = 0;
+				file.write(reinterpret_cast<const char*>(&packet), 1);
+			}
+			file.write(reinterpret_cast<const char*>(bgra), bytesPerPixel);
+		}
+	}
+}
+
+uint8_t Gradient(uint32_t x, uint32_t y, uint32_t c) { return c == 3 ? static_cast<uint8_t>(x * 8) : static_cast<uint8_t>(x * 4 + y * c); }
+
+// DDSヘッダのfourCCを読む
+uint32_t ReadFourCC(const std::filesystem::path& path) {
+	std::ifstream file(path, std::ios::binary);
+	uint8_t data[128] = {};
+	file.read(reinterpret_cast<char*>(data), sizeof(data));
+	uint32_t fourCC = 0;
+	std::memcpy(&fourCC, data + 84, 4);
+	return fourCC;
+}
+
+const uint32_t kDxt1 = 0x31545844;
+const uint32_t kDxt5 = 0x35545844;
+
+} // namespace
+
+TEST(TextureCooker, LoadsTgaTopDownAndBottomUp) {
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "TextureCookerTest.tga";
+	WriteTga(path, 5, 3, true, false, &Gradient);
+	std::vector<uint8_t> rgba;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	EXPECT_TRUE(TextureCooker::LoadTga(path.string(), rgba, width, height));
+	EXPECT_EQ(5u, width);
+	EXPECT_EQ(3u, height);
+	// (4, 2)の画素がRGBAの順で入る
+	const uint8_t* pixel = &rgba[(2 * 5 + 4) * 4];
+	EXPECT_EQ(Gradient(4, 2, 0), pixel[0]);
+	EXPECT_EQ(Gradient(4, 2, 1), pixel[1]);
+	EXPECT_EQ(Gradient(4, 2, 2), pixel[2]);
+	EXPECT_EQ(Gradient(4, 2, 3), pixel[3]);
+
+	// RLEの24bitはαが255になる
+	WriteTga(path, 5, 3, false, true, &Gradient);
+	EXPECT_TRUE(TextureCooker::LoadTga(path.string(), rgba, width, height));
+	EXPECT_EQ(Gradient(4, 2, 0), rgba[(2 * 5 + 4) * 4]);
+	EXPECT_EQ(255, rgba[(2 * 5 + 4) * 4 + 3]);
+	std::filesystem::remove(path);
+}
+
+TEST(TextureCooker, AutoPicksBC1ForOpaqueImages) {
+	// 不透明な画像はBC1、α付きはBC3になり、大きな画像は分割ファイルも書く
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "TextureCookerTest";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory);
+	WriteTga(directory / "opaque.tga", 512, 256, false, false, &Gradient);
+	WriteTga(directory / "alpha.tga", 32, 32, true, true, &Gradient);
+
+	EXPECT_EQ(2u, TextureCooker::CookDirectory(directory.string(), TextureCooker::Format::kAuto));
+	EXPECT_EQ(kDxt1, ReadFourCC(directory / "opaque.dds"));
+	EXPECT_EQ(kDxt5, ReadFourCC(directory / "alpha.dds"));
+	// 長辺512から128まで(ミップ1と2)
+	EXPECT_TRUE(std::filesystem::exists(directory / "opaque.mip1.dds"));
+	EXPECT_TRUE(std::filesystem::exists(directory / "opaque.mip2.dds"));
+	EXPECT_FALSE(std::filesystem::exists(directory / "opaque.mip3.dds"));
+	// 512x256のBC1でミップ10段(8バイト/ブロック)
+	EXPECT_EQ(uint64_t{128 + (128 * 64 + 64 * 32 + 32 * 16 + 16 * 8 + 8 * 4 + 4 * 2 + 2 * 1 + 1 + 1 + 1) * 8}, uint64_t{std::filesystem::file_size(directory / "opaque.dds")});
+
+	// DDSの方が新しければクックし直さない
+	EXPECT_EQ(0u, TextureCooker::CookDirectory(directory.string(), TextureCooker::Format::kAuto));
+	std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,106 @@
+#include "Test.h"
+#include "UploadRingAllocator.h"
+#include <vector>
+
+namespace {
+
+// GPUの代わりに完了済みのフレーム番号を進める
+struct FakeGpu {
+	uint64_t frameIndex = 1;
+	uint64_t completedFrameIndex = 0;
+
+	// 1フレーム進め、latencyフレーム前までを完了にする
+	void EndFrame(UploadRingAllocator& allocator, uint64_t latency) {
+		++frameIndex;
+		completedFrameIndex = frameIndex > latency ? frameIndex - latency - 1 : 0;
+		allocator.Reclaim(completedFrameIndex);
+	}
+};
+
+} // namespace
+
+TEST(UploadRingAllocator, AlignsOffsets) {
+	UploadRingAllocator allocator(4096);
+	EXPECT_EQ(size_t{0}, allocator.Allocate(10, 256, 1));
+	EXPECT_EQ(size_t{256}, allocator.Allocate(1, 256, 1));
+	EXPECT_EQ(size_t{260}, allocator.Allocate(4, 4, 1));
+	EXPECT_EQ(size_t{512}, allocator.Allocate(100, 512, 1));
+	// 詰め物も使用中に数える
+	EXPECT_EQ(size_t{612}, allocator.GetUsedBytes());
+	// 0バイトとリングより大きい割り当ては失敗する
+	EXPECT_EQ(UploadRingAllocator::kInvalidOffset, allocator.Allocate(0, 4, 1));
+	EXPECT_EQ(UploadRingAllocator::kInvalidOffset, allocator.Allocate(4097, 4, 1));
+}
+
+TEST(UploadRingAllocator, FailsWhenFullUntilReclaimed) {
+	UploadRingAllocator allocator(1024);
+	EXPECT_EQ(size_t{0}, allocator.Allocate(512, 256, 1));
+	EXPECT_EQ(size_t{512}, allocator.Allocate(512, 256, 2));
+	EXPECT_EQ(size_t{1024}, allocator.GetUsedBytes());
+	EXPECT_EQ(UploadRingAllocator::kInvalidOffset, allocator.Allocate(256, 256, 3));
+	// まだ完了していないフレームは回収しない
+	allocator.Reclaim(0);
+	EXPECT_EQ(UploadRingAllocator::kInvalidOffset, allocator.Allocate(256, 256, 3));
+	// 全部完了すれば空になり、先頭から使う
+	allocator.Reclaim(2);
+	EXPECT_EQ(size_t{0}, allocator.GetUsedBytes());
+	EXPECT_EQ(size_t{0}, allocator.Allocate(256, 256, 3));
+}
+
+TEST(UploadRingAllocator, ReclaimsPartiallyAndWraps) {
+	UploadRingAllocator allocator(1024);
+	EXPECT_EQ(size_t{0}, allocator.Allocate(300, 256, 1));
+	EXPECT_EQ(size_t{512}, allocator.Allocate(300, 256, 2));
+	// フレーム1だけ完了すると[0, 300)が空き、[300, 812)が残る
+	allocator.Reclaim(1);
+	EXPECT_EQ(size_t{512}, allocator.GetUsedBytes());
+	// 末尾の[812, 1024)に収まらないので先頭に戻る(捨てた末尾も使用中に数える)
+	EXPECT_EQ(size_t{0}, allocator.Allocate(256, 256, 3));
+	EXPECT_EQ(size_t{1024 - 300 + 256}, allocator.GetUsedBytes());
+	// 折り返した後は古い領域の手前までしか使えない
+	EXPECT_EQ(UploadRingAllocator::kInvalidOffset, allocator.Allocate(64, 256, 3));
+	EXPECT_EQ(size_t{256}, allocator.Allocate(44, 4, 3));
+	EXPECT_EQ(UploadRingAllocator::kInvalidOffset, allocator.Allocate(8, 4, 4));
+	// フレーム2が完了すれば[812, 1024)と先頭側が残る
+	allocator.Reclaim(2);
+	EXPECT_EQ(size_t{1024 - 812 + 300}, allocator.GetUsedBytes());
+	EXPECT_EQ(size_t{512}, allocator.Allocate(300, 256, 4));
+	EXPECT_EQ(UploadRingAllocator::kInvalidOffset, allocator.Allocate(1, 4, 4));
+	allocator.Reclaim(4);
+	EXPECT_EQ(size_t{0}, allocator.GetUsedBytes());
+}
+
+TEST(UploadRingAllocator, SteadyFramesNeverOverlapInFlightData) {
+	// 2フレーム遅れて完了するGPUで、大きさの違う割り当てを何周も続けても使用中の領域と重ならないか
+	const size_t capacity = 128 * 1024;
+	UploadRingAllocator allocator(capacity);
+	FakeGpu gpu;
+	struct Range {
+		uint64_t frameIndex;
+		size_t begin;
+		size_t end;
+	};
+	std::vector<Range> live;
+	bool overlapped = false;
+	uint32_t failures = 0;
+	for (uint32_t frame = 0; frame < 1000; ++frame) {
+		for (uint32_t i = 0; i < 4; ++i) {
+			size_t size = 1000 + (frame * 7919 + i * 104729) % 6000;
+			size_t offset = allocator.Allocate(size, 256, gpu.frameIndex);
+			if (offset == UploadRingAllocator::kInvalidOffset) {
+				++failures;
+				continue;
+			}
+			overlapped = overlapped || offset % 256 != 0 || offset + size > capacity;
+			for (const Range& range : live) {
+				overlapped = overlapped || (offset < range.end && range.begin < offset + size);
+			}
+			live.push_back({gpu.frameIndex, offset, offset + size});
+		}
+		gpu.EndFrame(allocator, 2);
+		std::erase_if(live, [&](const Range& range) { return range.frameIndex <= gpu.completedFrameIndex; });
+	}
+	EXPECT_FALSE(overlapped);
+	// 1フレームは最大で約29KB。使用中の3フレームと折り返しで捨てる末尾を足してもリングに収まるので失敗しない
+	EXPECT_EQ(0u, failures);
+}
@@ -0,0 +1,27 @@
+#include "TextureCooker.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// テクスチャのクックの入口(ゲーム本体の"--cook"と同じものをWindows以外でも回す。DirectXTexが無いのでTGAだけを読む)
+// 引数: ディレクトリ [--bc1|--bc3] 形式を固定する(既定は不透明ならBC1、α付きならBC3)
+int main(int argc, char* argv[]) {
+	std::string directoryPath = "Resources/";
+	TextureCooker::Format format = TextureCooker::Format::kAuto;
+	for (int i = 1; i < argc; ++i) {
+		const char* argument = argv[i];
+		if (std::strcmp(argument, "--bc1") == 0) {
+			format = TextureCooker::Format::kBC1;
+		} else if (std::strcmp(argument, "--bc3") == 0) {
+			format = TextureCooker::Format::kBC3;
+		} else if (std::strncmp(argument, "--", 2) == 0) {
+			std::fprintf(stderr, "unknown argument: %s\n", argument);
+			return 1;
+		} else {
+			directoryPath = argument;
+		}
+	}
+	uint32_t cookedCount = TextureCooker::CookDirectory(directoryPath, format);
+	std::printf("cooked %u textures\n", cookedCount);
+	return 0;
+}
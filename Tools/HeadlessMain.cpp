@@ -0,0 +1,31 @@
+#include "HeadlessRunner.h"
+#include "SpriteStressScene.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// ヘッドレス実行の入口(ゲーム本体の"--headless"と同じものをWindows以外でも回す)
+// --frames=N フレーム数 / --sprites=N スプライト数 / --vertex 頂点を書き込むモードで描く / --csv=パス 出力先
+int main(int argc, char* argv[]) {
+	uint32_t frameCount = HeadlessRunner::kDefaultFrameCount;
+	uint32_t spriteCount = SpriteStressScene::kDefaultSpriteCount;
+	SpriteBatch::Mode mode = SpriteBatch::Mode::kInstanced;
+	std::string csvPath = "headless.csv";
+	for (int i = 1; i < argc; ++i) {
+		const char* argument = argv[i];
+		if (std::strncmp(argument, "--frames=", 9) == 0) {
+			frameCount = static_cast<uint32_t>(std::strtoul(argument + 9, nullptr, 10));
+		} else if (std::strncmp(argument, "--sprites=", 10) == 0) {
+			spriteCount = static_cast<uint32_t>(std::strtoul(argument + 10, nullptr, 10));
+		} else if (std::strcmp(argument, "--vertex") == 0) {
+			mode = SpriteBatch::Mode::kVertex;
+		} else if (std::strncmp(argument, "--csv=", 6) == 0) {
+			csvPath = argument + 6;
+		} else {
+			std::fprintf(stderr, "unknown argument: %s\n", argument);
+			return 1;
+		}
+	}
+	return HeadlessRunner::Run(std::make_unique<SpriteStressScene>(spriteCount, mode), frameCount, csvPath);
+}